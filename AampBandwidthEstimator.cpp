@@ -0,0 +1,127 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampBandwidthEstimator.cpp
+ * @brief Network throughput estimate from byte-time samples taken during downloads
+ */
+
+#include "AampBandwidthEstimator.h"
+#include <math.h>
+
+/**
+ * @brief AampBandwidthEstimator constructor
+ */
+AampBandwidthEstimator::AampBandwidthEstimator() : mMutex(), mWindow(), mWindowBytes(0), mWindowDurationMS(0),
+	mAverageBps(0), mAverageWeight(0), mLastSampleTimeMS(-1)
+{
+	pthread_mutex_init(&mMutex, NULL);
+}
+
+/**
+ * @brief AampBandwidthEstimator destructor
+ */
+AampBandwidthEstimator::~AampBandwidthEstimator()
+{
+	pthread_mutex_destroy(&mMutex);
+}
+
+/**
+ * @brief Drop samples which ended before the window. Caller holds mMutex
+ * @param[in] timeMS current time
+ */
+void AampBandwidthEstimator::TrimWindow(long long timeMS)
+{
+	while (!mWindow.empty() && (timeMS - mWindow.front().timeMS > BANDWIDTH_WINDOW_MS))
+	{
+		mWindowBytes -= mWindow.front().bytes;
+		mWindowDurationMS -= mWindow.front().durationMS;
+		mWindow.pop_front();
+	}
+}
+
+/**
+ * @brief Add sample of an ongoing transfer
+ * @param[in] timeMS end time of the sampled interval, steady clock in milliseconds
+ * @param[in] bytes bytes received in the interval
+ * @param[in] durationMS length of the interval in milliseconds
+ */
+void AampBandwidthEstimator::AddSample(long long timeMS, long long bytes, long long durationMS)
+{
+	if (durationMS <= 0 || bytes < 0)
+	{
+		return;
+	}
+	double bps = (double)bytes * 8000 / durationMS;
+	double keep = pow(0.5, (double)durationMS / BANDWIDTH_EWMA_HALF_LIFE_MS);
+
+	pthread_mutex_lock(&mMutex);
+	mAverageBps = (keep * mAverageBps) + ((1 - keep) * bps);
+	mAverageWeight = (keep * mAverageWeight) + (1 - keep);
+	Sample sample = { timeMS, bytes, durationMS };
+	mWindow.push_back(sample);
+	mWindowBytes += bytes;
+	mWindowDurationMS += durationMS;
+	TrimWindow(timeMS);
+	mLastSampleTimeMS = timeMS;
+	pthread_mutex_unlock(&mMutex);
+}
+
+/**
+ * @brief Get estimated bandwidth
+ * @param[in] timeMS current time, steady clock in milliseconds
+ * @param[in] maxAgeMS samples older than this are not used
+ * @retval bandwidth in bits per second, -1 if no recent samples
+ */
+long AampBandwidthEstimator::GetBandwidth(long long timeMS, long long maxAgeMS)
+{
+	long ret = -1;
+	pthread_mutex_lock(&mMutex);
+	if (mLastSampleTimeMS >= 0 && (timeMS - mLastSampleTimeMS) <= maxAgeMS && mAverageWeight > 0)
+	{
+		double bps = mAverageBps / mAverageWeight;
+		TrimWindow(timeMS);
+		if (mWindowDurationMS >= BANDWIDTH_WINDOW_MIN_DURATION_MS)
+		{
+			double windowBps = (double)mWindowBytes * 8000 / mWindowDurationMS;
+			if (windowBps < bps)
+			{
+				bps = windowBps;
+			}
+		}
+		ret = (long)bps;
+	}
+	pthread_mutex_unlock(&mMutex);
+	return ret;
+}
+
+/**
+ * @brief Drop all samples
+ */
+void AampBandwidthEstimator::Reset()
+{
+	pthread_mutex_lock(&mMutex);
+	mWindow.clear();
+	mWindowBytes = 0;
+	mWindowDurationMS = 0;
+	mAverageBps = 0;
+	mAverageWeight = 0;
+	mLastSampleTimeMS = -1;
+	pthread_mutex_unlock(&mMutex);
+}
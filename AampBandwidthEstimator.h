@@ -0,0 +1,106 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampBandwidthEstimator.h
+ * @brief Network throughput estimate from byte-time samples taken during downloads
+ */
+
+#ifndef __AAMP_BANDWIDTH_ESTIMATOR_H__
+#define __AAMP_BANDWIDTH_ESTIMATOR_H__
+
+#include <pthread.h>
+#include <deque>
+
+#define BANDWIDTH_SAMPLE_MIN_INTERVAL_MS 50      /**< Min transfer time covered by one sample */
+#define BANDWIDTH_WINDOW_MS 2000                 /**< Span of the sliding window */
+#define BANDWIDTH_WINDOW_MIN_DURATION_MS 250     /**< Min transfer time in window for a window rate */
+#define BANDWIDTH_EWMA_HALF_LIFE_MS 3000         /**< Transfer time after which a sample weighs half */
+
+/**
+ * @brief Throughput estimate fed while fragments are being downloaded.
+ *
+ * Each sample is the number of bytes received over an interval of an ongoing transfer. Callers
+ * start sampling at the first received byte, so connection setup and request latency are not
+ * counted, and stop at the end of the transfer, so idle time between downloads is not counted
+ * either. Intervals without data during a transfer are fed as empty samples, which lets a stall
+ * show up in the estimate before the fragment completes.
+ * The estimate is the lower of the rate over a short sliding window, which follows a collapse
+ * quickly, and an exponentially weighted moving average of all samples, which smooths bursts.
+ */
+class AampBandwidthEstimator
+{
+public:
+	/**
+	 * @brief AampBandwidthEstimator constructor
+	 */
+	AampBandwidthEstimator();
+
+	/**
+	 * @brief AampBandwidthEstimator destructor
+	 */
+	~AampBandwidthEstimator();
+
+	AampBandwidthEstimator(const AampBandwidthEstimator&) = delete;
+	AampBandwidthEstimator& operator=(const AampBandwidthEstimator&) = delete;
+
+	/**
+	 * @brief Add sample of an ongoing transfer
+	 * @param[in] timeMS end time of the sampled interval, steady clock in milliseconds
+	 * @param[in] bytes bytes received in the interval
+	 * @param[in] durationMS length of the interval in milliseconds
+	 */
+	void AddSample(long long timeMS, long long bytes, long long durationMS);
+
+	/**
+	 * @brief Get estimated bandwidth
+	 * @param[in] timeMS current time, steady clock in milliseconds
+	 * @param[in] maxAgeMS samples older than this are not used
+	 * @retval bandwidth in bits per second, -1 if no recent samples
+	 */
+	long GetBandwidth(long long timeMS, long long maxAgeMS);
+
+	/**
+	 * @brief Drop all samples
+	 */
+	void Reset();
+
+private:
+	/**
+	 * @brief Sample in sliding window
+	 */
+	struct Sample
+	{
+		long long timeMS;     /**< End time of interval */
+		long long bytes;      /**< Bytes received */
+		long long durationMS; /**< Length of interval */
+	};
+
+	void TrimWindow(long long timeMS);
+
+	pthread_mutex_t mMutex;
+	std::deque<Sample> mWindow;     /**< Samples of last BANDWIDTH_WINDOW_MS */
+	long long mWindowBytes;         /**< Sum of bytes in window */
+	long long mWindowDurationMS;    /**< Sum of durations in window */
+	double mAverageBps;             /**< Exponentially weighted moving average */
+	double mAverageWeight;          /**< Total weight in average, corrects the zero start value */
+	long long mLastSampleTimeMS;    /**< End time of newest sample, -1 if none */
+};
+
+#endif /* __AAMP_BANDWIDTH_ESTIMATOR_H__ */
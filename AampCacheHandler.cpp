@@ -47,6 +47,7 @@ void AampCacheHandler::InsertToPlaylistCache(const std::string url, const Growab
 			{
 				// If new Manifest is inserted which is not present in the cache , flush out other playlist files related with old manifest,
 				ClearPlaylistCache();
+				ClearInitFragCache();
 			}
 			// Dont check for CacheSize if Max is configured as unlimited 
 			if(mMaxPlaylistCacheSize == PLAYLIST_CACHE_SIZE_UNLIMITED || (mMaxPlaylistCacheSize != PLAYLIST_CACHE_SIZE_UNLIMITED  && buffer->len < mMaxPlaylistCacheSize))
@@ -61,10 +62,11 @@ void AampCacheHandler::InsertToPlaylistCache(const std::string url, const Growab
 				}
 				if(cacheStoreReady)
 				{
+					GrowableBuffer cachedBuffer;
+					memset (&cachedBuffer, 0, sizeof(GrowableBuffer));
+					aamp_AppendBytes(&cachedBuffer, buffer->ptr, buffer->len );
 					tmpData = new PlayListCachedData();
-					tmpData->mCachedBuffer = new GrowableBuffer();
-					memset (tmpData->mCachedBuffer, 0, sizeof(GrowableBuffer));
-					aamp_AppendBytes(tmpData->mCachedBuffer, buffer->ptr, buffer->len );
+					tmpData->mCachedBlock = aamp_CreateSharedBlock(&cachedBuffer, NULL);
 
 					tmpData->mEffectiveUrl = effectiveUrl;
 					tmpData->mFileType = fileType;
@@ -75,14 +77,15 @@ void AampCacheHandler::InsertToPlaylistCache(const std::string url, const Growab
 					// Need to store both the entries with same content data 
 					// When retune happens within aamp due to failure , effective url wll be asked to read from cached manifest
 					// When retune happens from JS , regular Main url will be asked to read from cached manifest. 
-					// So need to have two entries in cache table but both pointing to same CachedBuffer (no space is consumed for storage)
+					// So need to have two entries in cache table but both referencing same CachedBlock (no space is consumed for storage)
 					{						
 						// if n only there is diff in url , need to store both
 						if(url != effectiveUrl)
 						{
 							newtmpData = new PlayListCachedData();
-							// Not to allocate for Cachebuffer again , use the same buffer as above
-							newtmpData->mCachedBuffer = tmpData->mCachedBuffer;
+							// Not to allocate for CachedBlock again , take reference on the same block as above
+							aamp_SharedBlockRef(tmpData->mCachedBlock);
+							newtmpData->mCachedBlock = tmpData->mCachedBlock;
 							newtmpData->mEffectiveUrl = effectiveUrl;
 							// This is a duplicate entry
 							newtmpData->mDuplicateEntry = true;
@@ -108,29 +111,44 @@ void AampCacheHandler::InsertToPlaylistCache(const std::string url, const Growab
  */
 bool AampCacheHandler::RetrieveFromPlaylistCache(const std::string url, GrowableBuffer* buffer, std::string& effectiveUrl)
 {
-	GrowableBuffer* buf = NULL;
-	bool ret;
-	std::string eUrl;
+	bool ret = false;
+	AampSharedBlock *block = RetrieveSharedFromPlaylistCache(url, effectiveUrl);
+	if (block)
+	{
+		// Caller parses the playlist in place, needs a private copy
+		buffer->len = 0;
+		aamp_AppendBytes(buffer, block->buffer.ptr, block->buffer.len );
+		aamp_SharedBlockUnref(block);
+		ret = true;
+	}
+	return ret;
+}
+
+/**
+ * @brief Retrieve playlist from playlist cache without copy
+ * @param url URL corresponding to playlist
+ * @param[out] effectiveUrl effective URL of retrieved playlist
+ * @retval playlist data with a reference taken for the caller, NULL if not cached
+ */
+AampSharedBlock* AampCacheHandler::RetrieveSharedFromPlaylistCache(const std::string url, std::string& effectiveUrl)
+{
+	AampSharedBlock *block = NULL;
 	pthread_mutex_lock(&mMutex);
 	PlaylistCacheIter it = mPlaylistCache.find(url);
 	if (it != mPlaylistCache.end())
 	{
 		PlayListCachedData *tmpData = it->second;
-		buf = tmpData->mCachedBuffer;
-		eUrl = tmpData->mEffectiveUrl;
-		buffer->len = 0;
-		aamp_AppendBytes(buffer, buf->ptr, buf->len );
-		effectiveUrl = eUrl;
+		block = tmpData->mCachedBlock;
+		aamp_SharedBlockRef(block);
+		effectiveUrl = tmpData->mEffectiveUrl;
 		traceprintf("%s:%d : url %s found", __FUNCTION__, __LINE__, url.c_str());
-		ret = true;
 	}
 	else
 	{
 		traceprintf("%s:%d : url %s not found", __FUNCTION__, __LINE__, url.c_str());
-		ret = false;
 	}
 	pthread_mutex_unlock(&mMutex);
-	return ret;
+	return block;
 }
 
 
@@ -144,12 +162,8 @@ void AampCacheHandler::ClearPlaylistCache()
 	for (;it != mPlaylistCache.end(); it++)
 	{
 		PlayListCachedData *tmpData = it->second;
-		if(!tmpData->mDuplicateEntry)
-		{
-			aamp_Free(&tmpData->mCachedBuffer->ptr);
-			delete tmpData->mCachedBuffer;
-			tmpData->mCachedBuffer = NULL;
-		}
+		// Memory is released once readers holding the block are done with it
+		aamp_SharedBlockUnref(tmpData->mCachedBlock);
 		delete tmpData;
 	}
 	mCacheStoredSize = 0;
@@ -189,11 +203,9 @@ bool AampCacheHandler::AllocatePlaylistCacheSlot(MediaType fileType,size_t newLe
 			}
 			if(!tmpData->mDuplicateEntry)
 			{
-				freedSize += tmpData->mCachedBuffer->len;
-				aamp_Free(&tmpData->mCachedBuffer->ptr);
-				delete tmpData->mCachedBuffer;
-				tmpData->mCachedBuffer = NULL;
+				freedSize += tmpData->mCachedBlock->buffer.len;
 			}
+			aamp_SharedBlockUnref(tmpData->mCachedBlock);
 			delete tmpData;
 			Iter = mPlaylistCache.erase(Iter);
 		}
@@ -211,11 +223,9 @@ bool AampCacheHandler::AllocatePlaylistCacheSlot(MediaType fileType,size_t newLe
 				}
 				if(!tmpData->mDuplicateEntry)
 				{
-					freedSize += tmpData->mCachedBuffer->len;
-					aamp_Free(&tmpData->mCachedBuffer->ptr);
-					delete tmpData->mCachedBuffer;
-					tmpData->mCachedBuffer = NULL;                                
+					freedSize += tmpData->mCachedBlock->buffer.len;
 				}
+				aamp_SharedBlockUnref(tmpData->mCachedBlock);
 				delete tmpData;
 				Iter = mPlaylistCache.erase(Iter);
 			}
@@ -233,6 +243,7 @@ AampCacheHandler::AampCacheHandler():
 	mCacheStoredSize(0),mAsyncThreadStartedFlag(false),mAsyncCleanUpTaskThreadId(0),mCacheActive(false),
 	mAsyncCacheCleanUpThread(false),mMutex(),mCondVarMutex(),mCondVar(),mPlaylistCache()
 	,mMaxPlaylistCacheSize(MAX_PLAYLIST_CACHE_SIZE)
+	,mInitFragCache(),mInitFragLru(),mInitFragCacheStoredSize(0)
 {
 	pthread_mutex_init(&mMutex, NULL);
 	pthread_mutex_init(&mCondVarMutex, NULL);
@@ -268,6 +279,7 @@ AampCacheHandler::~AampCacheHandler()
 		}
 	}
 	ClearPlaylistCache();
+	ClearInitFragCache();
 	pthread_mutex_destroy(&mMutex);
 	pthread_mutex_destroy(&mCondVarMutex);
 	pthread_cond_destroy(&mCondVar);
@@ -318,7 +330,10 @@ void AampCacheHandler::AsyncCacheCleanUpTask()
 			if(ETIMEDOUT == pthread_cond_timedwait(&mCondVar, &mCondVarMutex, &ts))
 			{
 				AAMPLOG_INFO("%s:%d[%p] Cacheflush timed out", __FUNCTION__, __LINE__, this);
+				pthread_mutex_lock(&mMutex);
 				ClearPlaylistCache();
+				ClearInitFragCache();
+				pthread_mutex_unlock(&mMutex);
 			}
 		}
 	}
@@ -355,3 +370,112 @@ bool AampCacheHandler::IsUrlCached(std::string url)
 	pthread_mutex_unlock(&mMutex);
 	return retval;
 }
+
+/**
+ * @brief Get init fragment cache key
+ * @param url URL of init fragment
+ * @param range byte range of init fragment, NULL if whole file
+ * @retval cache key
+ */
+std::string AampCacheHandler::GetInitFragCacheKey(const std::string &url, const char *range)
+{
+	std::string key = url;
+	if (range && range[0])
+	{
+		key += "|";
+		key += range;
+	}
+	return key;
+}
+
+/**
+ * @brief Insert init fragment into init fragment cache
+ * @param url URL of init fragment
+ * @param range byte range of init fragment, NULL if whole file
+ * @param buffer contains the init fragment
+ * @param effectiveUrl effective URL of init fragment
+ * @param fileType type of init fragment
+ */
+void AampCacheHandler::InsertToInitFragCache(const std::string url, const char *range, const GrowableBuffer* buffer, std::string effectiveUrl, MediaType fileType)
+{
+	size_t maxSize = (size_t)gpGlobalConfig->maxInitFragmentCacheSize;
+	if (!buffer->ptr || buffer->len == 0 || buffer->len > maxSize)
+	{
+		return;
+	}
+	std::string key = GetInitFragCacheKey(url, range);
+	pthread_mutex_lock(&mMutex);
+	if (mInitFragCache.find(key) == mInitFragCache.end())
+	{
+		// evict least recently used entries until the new one fits
+		while (!mInitFragLru.empty() && (mInitFragCacheStoredSize + buffer->len) > maxSize)
+		{
+			InitFragCacheIter it = mInitFragCache.find(mInitFragLru.back());
+			mInitFragLru.pop_back();
+			if (it != mInitFragCache.end())
+			{
+				InitFragCachedData *tmpData = it->second;
+				AAMPLOG_INFO("%s:%d : evict %s", __FUNCTION__, __LINE__, it->first.c_str());
+				mInitFragCacheStoredSize -= tmpData->mCachedBuffer.len;
+				aamp_Free(&tmpData->mCachedBuffer.ptr);
+				delete tmpData;
+				mInitFragCache.erase(it);
+			}
+		}
+		InitFragCachedData *tmpData = new InitFragCachedData();
+		aamp_AppendBytes(&tmpData->mCachedBuffer, buffer->ptr, buffer->len);
+		tmpData->mEffectiveUrl = effectiveUrl;
+		tmpData->mFileType = fileType;
+		mInitFragLru.push_front(key);
+		tmpData->mLruIter = mInitFragLru.begin();
+		mInitFragCache[key] = tmpData;
+		mInitFragCacheStoredSize += buffer->len;
+		AAMPLOG_INFO("%s:%d : Inserted. %s size %d total %d", __FUNCTION__, __LINE__, key.c_str(), (int)buffer->len, (int)mInitFragCacheStoredSize);
+	}
+	pthread_mutex_unlock(&mMutex);
+}
+
+/**
+ * @brief Retrieve init fragment from init fragment cache
+ * @param url URL of init fragment
+ * @param range byte range of init fragment, NULL if whole file
+ * @param[out] buffer output buffer containing init fragment
+ * @param[out] effectiveUrl effective URL of retrieved init fragment
+ * @retval true if init fragment is successfully retrieved.
+ */
+bool AampCacheHandler::RetrieveFromInitFragCache(const std::string url, const char *range, GrowableBuffer* buffer, std::string& effectiveUrl)
+{
+	bool ret = false;
+	std::string key = GetInitFragCacheKey(url, range);
+	pthread_mutex_lock(&mMutex);
+	InitFragCacheIter it = mInitFragCache.find(key);
+	if (it != mInitFragCache.end())
+	{
+		InitFragCachedData *tmpData = it->second;
+		buffer->len = 0;
+		aamp_AppendBytes(buffer, tmpData->mCachedBuffer.ptr, tmpData->mCachedBuffer.len);
+		effectiveUrl = tmpData->mEffectiveUrl;
+		// mark as most recently used
+		mInitFragLru.splice(mInitFragLru.begin(), mInitFragLru, tmpData->mLruIter);
+		traceprintf("%s:%d : %s found", __FUNCTION__, __LINE__, key.c_str());
+		ret = true;
+	}
+	pthread_mutex_unlock(&mMutex);
+	return ret;
+}
+
+/**
+ * @brief Clear init fragment cache
+ */
+void AampCacheHandler::ClearInitFragCache()
+{
+	AAMPLOG_INFO("%s:%d : cache size %d", __FUNCTION__, __LINE__, (int)mInitFragCache.size());
+	for (InitFragCacheIter it = mInitFragCache.begin(); it != mInitFragCache.end(); it++)
+	{
+		aamp_Free(&it->second->mCachedBuffer.ptr);
+		delete it->second;
+	}
+	mInitFragCache.clear();
+	mInitFragLru.clear();
+	mInitFragCacheStoredSize = 0;
+}
@@ -23,7 +23,9 @@
 #include <iostream>
 #include <memory>
 #include <unordered_map>
+#include <list>
 #include "priv_aamp.h"
+#include "AampMemoryUtils.h"
 
 #define PLAYLIST_CACHE_SIZE_UNLIMITED -1
 
@@ -32,31 +34,35 @@
  */
 typedef struct playlistcacheddata{
 	std::string mEffectiveUrl;
-	GrowableBuffer* mCachedBuffer;
+	AampSharedBlock* mCachedBlock;   /**< Immutable playlist data, one reference held per cache entry */
 	MediaType mFileType;
 	bool mDuplicateEntry;
 
-	playlistcacheddata() : mEffectiveUrl(""), mCachedBuffer(NULL), mFileType(eMEDIATYPE_DEFAULT),mDuplicateEntry(false)
+	playlistcacheddata() : mEffectiveUrl(""), mCachedBlock(NULL), mFileType(eMEDIATYPE_DEFAULT),mDuplicateEntry(false)
 	{
 	}
 
-	playlistcacheddata(const playlistcacheddata& p) : mEffectiveUrl(p.mEffectiveUrl), mCachedBuffer(p.mCachedBuffer), mFileType(p.mFileType),mDuplicateEntry(p.mDuplicateEntry)
-	{
-		mCachedBuffer->ptr = p.mCachedBuffer->ptr;
-		mCachedBuffer->len = p.mCachedBuffer->len;
-		mCachedBuffer->avail = p.mCachedBuffer->avail;
-	}
+	playlistcacheddata(const playlistcacheddata&) = delete;
+	playlistcacheddata& operator=(const playlistcacheddata&) = delete;
+
+}PlayListCachedData;
 
-	playlistcacheddata& operator=(const playlistcacheddata &p)
+/**
+ * @brief InitFragCachedData structure to store init fragment data
+ */
+typedef struct initfragcacheddata{
+	std::string mEffectiveUrl;
+	GrowableBuffer mCachedBuffer;
+	MediaType mFileType;
+	std::list<std::string>::iterator mLruIter;   /**< Position of the entry in LRU list */
+
+	initfragcacheddata() : mEffectiveUrl(""), mCachedBuffer(), mFileType(eMEDIATYPE_DEFAULT), mLruIter()
 	{
-		mEffectiveUrl = p.mEffectiveUrl;
-		mCachedBuffer = p.mCachedBuffer;
-		mFileType = p.mFileType;
-		mDuplicateEntry = p.mDuplicateEntry;
-		return *this;
+		memset(&mCachedBuffer, 0, sizeof(mCachedBuffer));
 	}
-
-}PlayListCachedData;
+	initfragcacheddata(const initfragcacheddata&) = delete;
+	initfragcacheddata& operator=(const initfragcacheddata&) = delete;
+}InitFragCachedData;
 
 
 class AampCacheHandler
@@ -75,8 +81,28 @@ private:
 	pthread_mutex_t mCondVarMutex;
 	pthread_cond_t mCondVar ;
 	pthread_t mAsyncCleanUpTaskThreadId;
+	typedef std::unordered_map<std::string, InitFragCachedData *> InitFragCache;
+	typedef std::unordered_map<std::string, InitFragCachedData *>::iterator InitFragCacheIter;
+	InitFragCache mInitFragCache;
+	std::list<std::string> mInitFragLru;    /**< Init fragment cache keys, most recently used first */
+	size_t mInitFragCacheStoredSize;
 private:
 
+	/**
+	 *	 @brief Get init fragment cache key
+	 *
+	 *	 @param[in] url - URL of init fragment
+	 *	 @param[in] range - Byte range of init fragment, NULL if whole file
+	 *	 @return cache key
+	 */
+	static std::string GetInitFragCacheKey(const std::string &url, const char *range);
+	/**
+	 *	 @brief Clear init fragment cache
+	 *
+	 *	 @return void
+	 */
+	void ClearInitFragCache();
+
 	/**
 	 *	 @brief Async Cache Cleanup task
 	 *
@@ -154,6 +180,16 @@ public:
 	 */
 	bool RetrieveFromPlaylistCache(const std::string url, GrowableBuffer* buffer, std::string& effectiveUrl);
 
+	/**
+	 *   @brief Retrieve playlist from cache without copying it. Returned data is shared
+	 *          with the cache and must not be modified, caller releases it with aamp_SharedBlockUnref
+	 *
+	 *   @param[in] url - URL
+	 *   @param[out] effectiveUrl - Final URL
+	 *   @return referenced playlist data, NULL if not found
+	 */
+	AampSharedBlock* RetrieveSharedFromPlaylistCache(const std::string url, std::string& effectiveUrl);
+
 	/**
 	*   @brief SetMaxPlaylistCacheSize - Set Max Cache Size
 	*
@@ -174,6 +210,30 @@ public:
 	*/
 	bool IsUrlCached(std::string);
 
+	/**
+	 *   @brief Insert init fragment into init fragment cache, evicting least recently used entries
+	 *          to stay within the configured size
+	 *
+	 *   @param[in] url - URL
+	 *   @param[in] range - Byte range, NULL if whole file
+	 *   @param[in] buffer - Pointer to growable buffer
+	 *   @param[in] effectiveUrl - Final URL
+	 *   @param[in] fileType - Type of the file inserted
+	 *   @return void
+	 */
+	void InsertToInitFragCache(const std::string url, const char *range, const GrowableBuffer* buffer, std::string effectiveUrl, MediaType fileType);
+
+	/**
+	 *   @brief Retrieve init fragment from init fragment cache
+	 *
+	 *   @param[in] url - URL
+	 *   @param[in] range - Byte range, NULL if whole file
+	 *   @param[out] buffer - Pointer to growable buffer
+	 *   @param[out] effectiveUrl - Final URL
+	 *   @return true: found, false: not found
+	 */
+	bool RetrieveFromInitFragCache(const std::string url, const char *range, GrowableBuffer* buffer, std::string& effectiveUrl);
+
 	// Copy constructor and Copy assignment disabled 
 	AampCacheHandler(const AampCacheHandler&) = delete;
 	AampCacheHandler& operator=(const AampCacheHandler&) = delete;
@@ -0,0 +1,95 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampDiscontinuityCounter.h
+ * @brief Count of pending discontinuities in the fragment cache of a track
+ */
+
+#ifndef __AAMP_DISCONTINUITY_COUNTER_H__
+#define __AAMP_DISCONTINUITY_COUNTER_H__
+
+#include <atomic>
+
+/**
+ * @brief Number of cached fragments whose discontinuity is not processed yet.
+ *
+ * Updated by fetcher and injector of the track, read by the other track without locking the cache.
+ * Each fragment keeps a counted flag, so a discontinuity is taken out exactly once, either when the
+ * injector processes it or when the fragment leaves the cache.
+ */
+class AampDiscontinuityCounter
+{
+public:
+	AampDiscontinuityCounter() : mCount(0)
+	{
+	}
+
+	AampDiscontinuityCounter(const AampDiscontinuityCounter&) = delete;
+	AampDiscontinuityCounter& operator=(const AampDiscontinuityCounter&) = delete;
+
+	/**
+	 * @brief Account a fetched fragment
+	 * @param[in] discontinuity discontinuity flag of the fragment
+	 * @param[out] counted counted flag of the fragment
+	 */
+	void Add(bool discontinuity, bool &counted)
+	{
+		counted = discontinuity;
+		if (discontinuity)
+		{
+			mCount.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	/**
+	 * @brief Take out discontinuity of a fragment if it is still counted
+	 * @param[in][out] counted counted flag of the fragment, cleared on return
+	 */
+	void Remove(bool &counted)
+	{
+		if (counted)
+		{
+			counted = false;
+			mCount.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	/**
+	 * @brief Get number of pending discontinuities
+	 * @retval count
+	 */
+	int Pending() const
+	{
+		return mCount.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief Clear count, when the fragment cache is flushed
+	 */
+	void Reset()
+	{
+		mCount.store(0, std::memory_order_release);
+	}
+
+private:
+	std::atomic<int> mCount;    /**< Pending discontinuities */
+};
+
+#endif /* __AAMP_DISCONTINUITY_COUNTER_H__ */
@@ -157,7 +157,8 @@ typedef enum
 typedef enum E_MetricsDataType
 {
 	AAMP_DATA_NONE,
-	AAMP_DATA_VIDEO_END
+	AAMP_DATA_VIDEO_END,
+	AAMP_DATA_PLAYBACK_PROFILE	/**< Latency histograms of fragment processing, cumulative since tune */
 } MetricsDataType;
 
 /**
@@ -97,3 +97,160 @@ void aamp_AppendNulTerminator(struct GrowableBuffer *buffer)
 	char zeros[2] = { 0, 0 }; // append two bytes, to distinguish between internal inserted 0x00's and a final 0x00 0x00
 	aamp_AppendBytes(buffer, zeros, 2);
 }
+
+/**
+ * @brief AampBufferPool constructor, reference count starts at 1
+ * @param name name used for logging
+ * @param maxBuffers max number of empty buffers kept for reuse
+ */
+AampBufferPool::AampBufferPool(const char *name, size_t maxBuffers) : mName(name ? name : ""), mBuffers(), mMaxBuffers(maxBuffers),
+	mMutex(), mRefCount(1), mHighWaterMark(0), mPeakSize(0), mAllocCount(0), mReuseCount(0)
+{
+	pthread_mutex_init(&mMutex, NULL);
+}
+
+/**
+ * @brief AampBufferPool destructor
+ */
+AampBufferPool::~AampBufferPool()
+{
+	AAMPLOG_INFO("%s:%d [%s] buffer pool: allocated %d reused %d high-water %d buffers, peak buffer size %d",
+		__FUNCTION__, __LINE__, mName.c_str(), mAllocCount, mReuseCount, (int)mHighWaterMark, (int)mPeakSize);
+	for (std::vector<GrowableBuffer>::iterator it = mBuffers.begin(); it != mBuffers.end(); it++)
+	{
+		aamp_Free(&it->ptr);
+	}
+	pthread_mutex_destroy(&mMutex);
+}
+
+/**
+ * @brief Take reference on pool
+ */
+void AampBufferPool::Ref()
+{
+	g_atomic_int_inc(&mRefCount);
+}
+
+/**
+ * @brief Drop reference on pool, deletes pool on last reference
+ */
+void AampBufferPool::Unref()
+{
+	if (g_atomic_int_dec_and_test(&mRefCount))
+	{
+		delete this;
+	}
+}
+
+/**
+ * @brief Get an empty buffer with at least expectedSize bytes available
+ * @param[out] buffer empty buffer
+ * @param expectedSize bytes expected to be appended, 0 if unknown
+ */
+void AampBufferPool::Acquire(struct GrowableBuffer *buffer, size_t expectedSize)
+{
+	pthread_mutex_lock(&mMutex);
+	if (!mBuffers.empty())
+	{
+		*buffer = mBuffers.back();
+		mBuffers.pop_back();
+		mReuseCount++;
+	}
+	pthread_mutex_unlock(&mMutex);
+	if (buffer->avail < expectedSize)
+	{
+		// contents are not needed, so replace instead of realloc to avoid a copy
+		aamp_Free(&buffer->ptr);
+		memset(buffer, 0x00, sizeof(GrowableBuffer));
+		aamp_Malloc(buffer, expectedSize);
+		pthread_mutex_lock(&mMutex);
+		mAllocCount++;
+		if (expectedSize > mPeakSize)
+		{
+			mPeakSize = expectedSize;
+		}
+		pthread_mutex_unlock(&mMutex);
+	}
+}
+
+/**
+ * @brief Return buffer memory for reuse, buffer is reset
+ * @param[in][out] buffer buffer to recycle
+ */
+void AampBufferPool::Release(struct GrowableBuffer *buffer)
+{
+	if (buffer->ptr)
+	{
+		pthread_mutex_lock(&mMutex);
+		if (mBuffers.size() < mMaxBuffers)
+		{
+			buffer->len = 0;
+			mBuffers.push_back(*buffer);
+			if (mBuffers.size() > mHighWaterMark)
+			{
+				mHighWaterMark = mBuffers.size();
+			}
+			if (buffer->avail > mPeakSize)
+			{
+				mPeakSize = buffer->avail;
+			}
+		}
+		else
+		{
+			aamp_Free(&buffer->ptr);
+		}
+		pthread_mutex_unlock(&mMutex);
+	}
+	memset(buffer, 0x00, sizeof(GrowableBuffer));
+}
+
+/**
+ * @brief Create shared block taking over memory of buffer, reference count starts at 1
+ * @param[in][out] buffer buffer whose memory is taken over, reset on return
+ * @param pool pool to return memory to when block is released, NULL to free memory
+ * @retval new block
+ */
+AampSharedBlock* aamp_CreateSharedBlock(struct GrowableBuffer *buffer, AampBufferPool *pool)
+{
+	AampSharedBlock *block = g_new0(AampSharedBlock, 1);
+	block->buffer = *buffer;
+	block->refCount = 1;
+	block->pool = pool;
+	if (pool)
+	{
+		pool->Ref();
+	}
+	memset(buffer, 0x00, sizeof(GrowableBuffer));
+	return block;
+}
+
+/**
+ * @brief Take reference on shared block
+ * @param block shared block
+ */
+void aamp_SharedBlockRef(AampSharedBlock *block)
+{
+	g_atomic_int_inc(&block->refCount);
+}
+
+/**
+ * @brief Drop reference on shared block, memory is released on last reference
+ * @param block shared block
+ */
+void aamp_SharedBlockUnref(void *block)
+{
+	AampSharedBlock *sharedBlock = (AampSharedBlock *)block;
+	if (g_atomic_int_dec_and_test(&sharedBlock->refCount))
+	{
+		if (sharedBlock->pool)
+		{
+			sharedBlock->pool->Release(&sharedBlock->buffer);
+			sharedBlock->pool->Unref();
+		}
+		else
+		{
+			aamp_Free(&sharedBlock->buffer.ptr);
+		}
+		g_free(sharedBlock);
+	}
+}
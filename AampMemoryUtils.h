@@ -27,6 +27,9 @@
 #define __AAMP_MEMORY_UTILS_H__
 
 #include <stddef.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
 
 /**
  * @brief Structure of GrowableBuffer
@@ -65,4 +68,89 @@ void aamp_AppendBytes(struct GrowableBuffer *buffer, const void *ptr, size_t len
  */
 void aamp_AppendNulTerminator(struct GrowableBuffer *buffer);
 
+/**
+ * @brief Pool of reusable media buffers.
+ *
+ * Reference counted, so buffers still held by the sink after the owner is gone
+ * can be returned safely; pool is deleted on last Unref.
+ */
+class AampBufferPool
+{
+public:
+	/**
+	 * @brief AampBufferPool constructor, reference count starts at 1
+	 * @param name name used for logging
+	 * @param maxBuffers max number of empty buffers kept for reuse
+	 */
+	AampBufferPool(const char *name, size_t maxBuffers);
+	AampBufferPool(const AampBufferPool&) = delete;
+	AampBufferPool& operator=(const AampBufferPool&) = delete;
+
+	/**
+	 * @brief Take reference on pool
+	 */
+	void Ref();
+
+	/**
+	 * @brief Drop reference on pool, deletes pool on last reference
+	 */
+	void Unref();
+
+	/**
+	 * @brief Get an empty buffer with at least expectedSize bytes available
+	 * @param[out] buffer empty buffer, must not hold memory
+	 * @param expectedSize bytes expected to be appended, 0 if unknown
+	 */
+	void Acquire(struct GrowableBuffer *buffer, size_t expectedSize);
+
+	/**
+	 * @brief Return buffer memory for reuse, buffer is reset
+	 * @param[in][out] buffer buffer to recycle
+	 */
+	void Release(struct GrowableBuffer *buffer);
+
+private:
+	~AampBufferPool();
+
+	std::string mName;                     /**< Name used for logging */
+	std::vector<GrowableBuffer> mBuffers;  /**< Empty buffers available for reuse */
+	size_t mMaxBuffers;                    /**< Max number of buffers kept */
+	pthread_mutex_t mMutex;                /**< Protects pool, used by fetcher, injector and sink threads */
+	int mRefCount;                         /**< Owner and shared blocks holding the pool */
+	size_t mHighWaterMark;                 /**< Max number of buffers held by pool */
+	size_t mPeakSize;                      /**< Largest buffer handed out */
+	int mAllocCount;                       /**< Buffers allocated */
+	int mReuseCount;                       /**< Buffers served from pool */
+};
+
+/**
+ * @brief Reference counted media block, lets the sink hold media data without a copy
+ */
+struct AampSharedBlock
+{
+	GrowableBuffer buffer;    /**< Media data */
+	int refCount;             /**< Holders of the block */
+	AampBufferPool *pool;     /**< Pool the memory returns to on last unref, NULL to free */
+};
+
+/**
+ * @brief Create shared block taking over memory of buffer, reference count starts at 1
+ * @param[in][out] buffer buffer whose memory is taken over, reset on return
+ * @param pool pool to return memory to when block is released, NULL to free memory
+ * @retval new block
+ */
+AampSharedBlock* aamp_CreateSharedBlock(struct GrowableBuffer *buffer, AampBufferPool *pool);
+
+/**
+ * @brief Take reference on shared block
+ * @param block shared block
+ */
+void aamp_SharedBlockRef(AampSharedBlock *block);
+
+/**
+ * @brief Drop reference on shared block, memory is released on last reference
+ * @param block shared block, void pointer to be usable as destroy notify
+ */
+void aamp_SharedBlockUnref(void *block);
+
 #endif /* __AAMP_MEMORY_UTILS_H__ */
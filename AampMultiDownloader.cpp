@@ -0,0 +1,562 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampMultiDownloader.cpp
+ * @brief Concurrent fragment prefetch for a media track using curl multi interface
+ */
+
+#include "AampMultiDownloader.h"
+#include "StreamAbstractionAAMP.h"
+#include <sys/time.h>
+#include <string.h>
+#include <algorithm>
+
+#define MULTI_DOWNLOADER_POLL_TIMEOUT_MS 100
+
+/**
+ * @brief Transfer constructor, prepares easy handle cloned from curl instance of the track
+ * @param parent owner of the transfer
+ * @param request url and range of the fragment
+ */
+AampMultiDownloader::Transfer::Transfer(AampMultiDownloader *parent, const PrefetchRequest &request) :
+	mParent(parent), mRequest(request), mCurl(NULL), mHeaders(NULL), mBuffer(), mDone(false), mInMulti(false),
+	mAttempt(0), mRetryTime(0), mResult(CURLE_OK), mHttpCode(0), mDownloadTime(0)
+{
+	memset(&mBuffer, 0x00, sizeof(mBuffer));
+	parent->mBufferPool->Acquire(&mBuffer, 0);
+	PrivateInstanceAAMP *aamp = parent->aamp;
+	mCurl = curl_easy_duphandle(aamp->curl[parent->mCurlInstance]);
+	if (mCurl)
+	{
+		curl_easy_setopt(mCurl, CURLOPT_URL, mRequest.first.c_str());
+		curl_easy_setopt(mCurl, CURLOPT_RANGE, mRequest.second.empty() ? NULL : mRequest.second.c_str());
+		curl_easy_setopt(mCurl, CURLOPT_WRITEFUNCTION, WriteCallback);
+		curl_easy_setopt(mCurl, CURLOPT_WRITEDATA, this);
+		curl_easy_setopt(mCurl, CURLOPT_HEADERFUNCTION, NULL);
+		curl_easy_setopt(mCurl, CURLOPT_HEADERDATA, NULL);
+		curl_easy_setopt(mCurl, CURLOPT_NOPROGRESS, 1L);
+		curl_easy_setopt(mCurl, CURLOPT_PRIVATE, this);
+		// same limits as GetFile on the curl instance; stall detection of its progress callback is
+		// done by curl low speed check, progress callback context is per GetFile call
+		curl_easy_setopt(mCurl, CURLOPT_TIMEOUT_MS, aamp->curlDLTimeout[parent->mCurlInstance]);
+		curl_easy_setopt(mCurl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONNECTTIMEOUT);
+		if (gpGlobalConfig->curlStallTimeout > 0)
+		{
+			curl_easy_setopt(mCurl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+			curl_easy_setopt(mCurl, CURLOPT_LOW_SPEED_TIME, gpGlobalConfig->curlStallTimeout);
+		}
+		if (gpGlobalConfig->disableSslVerifyPeer)
+		{
+			curl_easy_setopt(mCurl, CURLOPT_SSL_VERIFYHOST, 0L);
+			curl_easy_setopt(mCurl, CURLOPT_SSL_VERIFYPEER, 0L);
+		}
+		else
+		{
+			curl_easy_setopt(mCurl, CURLOPT_SSL_VERIFYPEER, 1L);
+		}
+		mHeaders = aamp->GetCustomHeaders(parent->mMediaType);
+		curl_easy_setopt(mCurl, CURLOPT_HTTPHEADER, mHeaders);
+	}
+}
+
+/**
+ * @brief Transfer destructor
+ */
+AampMultiDownloader::Transfer::~Transfer()
+{
+	if (mCurl)
+	{
+		curl_easy_cleanup(mCurl);
+	}
+	if (mHeaders)
+	{
+		curl_slist_free_all(mHeaders);
+	}
+	mParent->mBufferPool->Release(&mBuffer);
+}
+
+/**
+ * @brief AampMultiDownloader constructor
+ * @param aamp pointer to PrivateInstanceAAMP object
+ * @param mediaType media type of the track
+ * @param curlInstance curl instance of the track
+ * @param maxConcurrent max number of outstanding transfers
+ * @param bufferPool fragment buffer pool of the track
+ */
+AampMultiDownloader::AampMultiDownloader(PrivateInstanceAAMP *aamp, MediaType mediaType, AampCurlInstance curlInstance, int maxConcurrent, AampBufferPool *bufferPool) :
+	aamp(aamp), mMediaType(mediaType), mCurlInstance(curlInstance), mMaxConcurrent(maxConcurrent), mBufferPool(bufferPool), mMulti(NULL),
+	mTransfers(), mPending(), mRemoved(), mRetrying(), mMutex(), mCond(), mThreadId(), mThreadStarted(false), mStop(false),
+	mActiveCount(0), mBytesSinceSample(0), mSampleStartTime(0)
+{
+	mBufferPool->Ref();
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mCond, NULL);
+	mMulti = curl_multi_init();
+	if (mMulti)
+	{
+		curl_multi_setopt(mMulti, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)mMaxConcurrent);
+		if (0 == pthread_create(&mThreadId, NULL, WorkerThread, this))
+		{
+			mThreadStarted = true;
+		}
+		else
+		{
+			logprintf("%s:%d Failed to create prefetch thread", __FUNCTION__, __LINE__);
+		}
+	}
+	AAMPLOG_INFO("%s:%d type %d concurrency %d", __FUNCTION__, __LINE__, mMediaType, mMaxConcurrent);
+}
+
+/**
+ * @brief AampMultiDownloader destructor
+ */
+AampMultiDownloader::~AampMultiDownloader()
+{
+	pthread_mutex_lock(&mMutex);
+	mStop = true;
+	pthread_cond_signal(&mCond);
+	pthread_mutex_unlock(&mMutex);
+	if (mThreadStarted)
+	{
+		pthread_join(mThreadId, NULL);
+	}
+	// Worker is gone, remaining transfers can be freed from here
+	for (std::vector<Transfer *>::iterator it = mRemoved.begin(); it != mRemoved.end(); it++)
+	{
+		if ((*it)->mInMulti)
+		{
+			curl_multi_remove_handle(mMulti, (*it)->mCurl);
+		}
+		delete *it;
+	}
+	for (std::vector<Transfer *>::iterator it = mTransfers.begin(); it != mTransfers.end(); it++)
+	{
+		if ((*it)->mInMulti)
+		{
+			curl_multi_remove_handle(mMulti, (*it)->mCurl);
+		}
+		delete *it;
+	}
+	if (mMulti)
+	{
+		curl_multi_cleanup(mMulti);
+	}
+	pthread_cond_destroy(&mCond);
+	pthread_mutex_destroy(&mMutex);
+	mBufferPool->Unref();
+}
+
+/**
+ * @brief Curl write callback of prefetch transfers
+ */
+size_t AampMultiDownloader::WriteCallback(void *ptr, size_t size, size_t nmemb, void *userdata)
+{
+	Transfer *transfer = (Transfer *)userdata;
+	size_t numBytesForBlock = size * nmemb;
+	if (!transfer->mParent->aamp->DownloadsAreEnabled())
+	{
+		// returning a short count aborts the transfer
+		return 0;
+	}
+	aamp_AppendBytes(&transfer->mBuffer, ptr, numBytesForBlock);
+	transfer->mParent->mBytesSinceSample += numBytesForBlock;
+	return numBytesForBlock;
+}
+
+/**
+ * @brief Release a transfer no longer needed. Called with mMutex held.
+ * @param transfer transfer to release
+ */
+void AampMultiDownloader::ReleaseTransfer(Transfer *transfer)
+{
+	std::vector<Transfer *>::iterator it = std::find(mPending.begin(), mPending.end(), transfer);
+	if (it != mPending.end())
+	{
+		// never handed to worker, not part of multi handle
+		mPending.erase(it);
+		delete transfer;
+	}
+	else
+	{
+		mRemoved.push_back(transfer);
+		pthread_cond_signal(&mCond);
+	}
+}
+
+/**
+ * @brief Start downloads of upcoming fragments, cancelling outstanding ones not in the list
+ * @param requests fragments in playback order
+ */
+void AampMultiDownloader::Prefetch(const std::vector<PrefetchRequest> &requests)
+{
+	std::vector<Transfer *> transfers;
+	size_t count = std::min(requests.size(), (size_t)mMaxConcurrent);
+	pthread_mutex_lock(&mMutex);
+	for (size_t i = 0; i < count; i++)
+	{
+		Transfer *transfer = NULL;
+		for (std::vector<Transfer *>::iterator it = mTransfers.begin(); it != mTransfers.end(); it++)
+		{
+			if ((*it)->mRequest == requests[i])
+			{
+				transfer = *it;
+				mTransfers.erase(it);
+				break;
+			}
+		}
+		if (!transfer)
+		{
+			transfer = new Transfer(this, requests[i]);
+			if (!transfer->mCurl)
+			{
+				delete transfer;
+				continue;
+			}
+			AAMPLOG_TRACE("%s:%d type %d prefetch %s", __FUNCTION__, __LINE__, mMediaType, requests[i].first.c_str());
+			mPending.push_back(transfer);
+		}
+		transfers.push_back(transfer);
+	}
+	for (std::vector<Transfer *>::iterator it = mTransfers.begin(); it != mTransfers.end(); it++)
+	{
+		ReleaseTransfer(*it);
+	}
+	mTransfers.swap(transfers);
+	if (!mPending.empty())
+	{
+		pthread_cond_signal(&mCond);
+	}
+	pthread_mutex_unlock(&mMutex);
+}
+
+/**
+ * @brief Collect a prefetched fragment, waiting for its transfer to complete
+ * @param url url of the fragment
+ * @param range byte range of the fragment, "" for whole file
+ * @param[in][out] buffer pooled buffer, returned to pool and replaced by the downloaded one on success
+ * @param[out] httpCode http code of the transfer
+ * @param[out] downloadTime download time of the transfer in seconds
+ * @retval true if fragment was prefetched and downloaded successfully
+ */
+bool AampMultiDownloader::Take(const std::string &url, const std::string &range, GrowableBuffer *buffer, long &httpCode, double &downloadTime)
+{
+	bool ret = false;
+	PrefetchRequest request(url, range);
+	pthread_mutex_lock(&mMutex);
+	std::vector<Transfer *>::iterator it = mTransfers.begin();
+	while (it != mTransfers.end() && (*it)->mRequest != request)
+	{
+		it++;
+	}
+	if (it != mTransfers.end())
+	{
+		Transfer *transfer = *it;
+		mTransfers.erase(it);
+		while (!transfer->mDone && !mStop && aamp->DownloadsAreEnabled())
+		{
+			struct timespec ts;
+			struct timeval tv;
+			gettimeofday(&tv, NULL);
+			ts.tv_sec = tv.tv_sec + (tv.tv_usec / 1000 + MULTI_DOWNLOADER_POLL_TIMEOUT_MS) / 1000;
+			ts.tv_nsec = ((tv.tv_usec / 1000 + MULTI_DOWNLOADER_POLL_TIMEOUT_MS) % 1000) * 1000000;
+			pthread_cond_timedwait(&mCond, &mMutex, &ts);
+		}
+		if (transfer->mDone)
+		{
+			httpCode = transfer->mHttpCode;
+			downloadTime = transfer->mDownloadTime;
+			if (transfer->mResult == CURLE_OK && (transfer->mHttpCode == 200 || transfer->mHttpCode == 206) && transfer->mBuffer.len > 0)
+			{
+				mBufferPool->Release(buffer);
+				*buffer = transfer->mBuffer;
+				memset(&transfer->mBuffer, 0x00, sizeof(transfer->mBuffer));
+				ret = true;
+			}
+			else
+			{
+				AAMPLOG_WARN("%s:%d type %d prefetch failed curl %d http %ld, %s", __FUNCTION__, __LINE__, mMediaType, transfer->mResult, transfer->mHttpCode, url.c_str());
+			}
+		}
+		ReleaseTransfer(transfer);
+	}
+	pthread_mutex_unlock(&mMutex);
+	return ret;
+}
+
+/**
+ * @brief Cancel all outstanding transfers
+ */
+void AampMultiDownloader::Cancel()
+{
+	pthread_mutex_lock(&mMutex);
+	for (std::vector<Transfer *>::iterator it = mTransfers.begin(); it != mTransfers.end(); it++)
+	{
+		ReleaseTransfer(*it);
+	}
+	mTransfers.clear();
+	pthread_mutex_unlock(&mMutex);
+}
+
+/**
+ * @brief Feed aggregate throughput of concurrent transfers to ABR. Called with mMutex held.
+ *
+ * Per transfer download time is meaningless when N transfers share the link, so bytes received
+ * by all transfers over the wall clock time they were active is reported instead.
+ * @param transfer completed transfer
+ */
+void AampMultiDownloader::ReportBandwidth(Transfer *transfer)
+{
+	if (mMediaType == eMEDIATYPE_VIDEO && transfer->mResult == CURLE_OK && mSampleStartTime &&
+		transfer->mBuffer.len > gpGlobalConfig->aampAbrThresholdSize && aamp->CheckABREnabled())
+	{
+		long long now = aamp_GetCurrentTimeMS();
+		long long elapsed = now - mSampleStartTime;
+		if (elapsed > 0)
+		{
+			long downloadbps = (long)(mBytesSinceSample * 8000 / elapsed);
+			aamp->AddAbrBitrateSample(downloadbps);
+			mBytesSinceSample = 0;
+			mSampleStartTime = now;
+		}
+	}
+}
+
+/**
+ * @brief Check result of a transfer attempt like GetFile does, called by worker without mMutex.
+ *
+ * Logs network errors and latency, records metrics of the attempt and decides on a retry:
+ * connect failures, stalls and timeouts are retried at once, 5xx server errors other than 502
+ * after waitTimeBeforeRetryHttp5xxMS.
+ * @param transfer transfer of which an attempt completed, removed from multi handle
+ * @param result curl result of the attempt
+ * @retval true if transfer is to be retried, mRetryTime is set
+ */
+bool AampMultiDownloader::CompleteAttempt(Transfer *transfer, CURLcode result)
+{
+	CURL *curl = transfer->mCurl;
+	const char *url = transfer->mRequest.first.c_str();
+	long httpCode = 0;
+	double total = 0, connect = 0, lookup = 0, handshake = 0, requestSent = 0, firstByte = 0, dlSize = 0;
+	bool retry = false;
+	long long retryDelayMs = 0;
+
+	transfer->mAttempt++;
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+	curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total);
+	curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &connect);
+	curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD, &dlSize);
+	bool lastAttempt = (transfer->mAttempt >= (1 + DEFAULT_DOWNLOAD_RETRY_COUNT)) || !aamp->DownloadsAreEnabled();
+
+	if (result == CURLE_OK)
+	{
+		if (httpCode != 200 && httpCode != 204 && httpCode != 206)
+		{
+			AAMP_LOG_NETWORK_ERROR(url, AAMPNetworkErrorHttp, (int)httpCode, mMediaType);
+			if (httpCode >= 500 && httpCode != 502 && !lastAttempt)
+			{
+				retry = true;
+				retryDelayMs = gpGlobalConfig->waitTimeBeforeRetryHttp5xxMS;
+			}
+		}
+		else
+		{
+			double expectedContentLength = 0;
+			if (CURLE_OK == curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &expectedContentLength) &&
+				((int)expectedContentLength > 0) && ((int)expectedContentLength != (int)transfer->mBuffer.len))
+			{
+				AAMPLOG_WARN("%s:%d prefetch Content-Length=%d actual=%d", __FUNCTION__, __LINE__, (int)expectedContentLength, (int)transfer->mBuffer.len);
+				httpCode = 416; // Range Not Satisfiable
+			}
+			if ((int)(total * 1000) > FRAGMENT_DOWNLOAD_WARNING_THRESHOLD)
+			{
+				AAMP_LOG_NETWORK_LATENCY(url, (int)(total * 1000), FRAGMENT_DOWNLOAD_WARNING_THRESHOLD, mMediaType);
+			}
+			curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME, &lookup);
+			curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME, &handshake);
+			curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME, &requestSent);
+			curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &firstByte);
+			if (handshake < connect)
+			{ // no TLS
+				handshake = connect;
+			}
+			aamp->mPlaybackProfiler.Record(mMediaType, PLAYBACK_PHASE_DNS, (long long)(lookup * 1000000));
+			aamp->mPlaybackProfiler.Record(mMediaType, PLAYBACK_PHASE_CONNECT, (long long)((handshake - lookup) * 1000000));
+			aamp->mPlaybackProfiler.Record(mMediaType, PLAYBACK_PHASE_TTFB, (long long)((firstByte - requestSent) * 1000000));
+			aamp->mPlaybackProfiler.Record(mMediaType, PLAYBACK_PHASE_TRANSFER, (long long)((total - firstByte) * 1000000));
+		}
+	}
+	else
+	{
+		if (AAMP_IS_LOG_WORTHY_ERROR(result))
+		{
+			AAMP_LOG_NETWORK_ERROR(url, AAMPNetworkErrorCurl, (int)result, mMediaType);
+		}
+		// prefetch runs ahead of playback, so unlike GetFile a stalled transfer is retried regardless of buffer level
+		if ((result == CURLE_COULDNT_CONNECT || result == CURLE_OPERATION_TIMEDOUT || result == CURLE_PARTIAL_FILE) && !lastAttempt)
+		{
+			retry = true;
+		}
+		// curl errors are reported in place of http code, as by GetFile
+		httpCode = result;
+	}
+
+	if (gpGlobalConfig->enableMicroEvents)
+	{
+		aamp->profiler.addtuneEvent(aamp->mediaType2Bucket(mMediaType), aamp_GetCurrentTimeMS() - (long long)(total * 1000), (int)(total * 1000), (int)httpCode);
+	}
+	AAMP_LogLevel reqEndLogLevel = ((result != CURLE_OK) || (httpCode == 0) || (httpCode >= 400) || (total > 2.0)) ? eLOGLEVEL_WARN : eLOGLEVEL_INFO;
+	if (gpGlobalConfig->logging.isLogLevelAllowed(reqEndLogLevel))
+	{
+		AAMPLOG(reqEndLogLevel, "HttpRequestEnd: %d,%d,%ld,%2.4f,%2.4f,%2.4f,%2.4f,%2.4f,%2.4f,%2.4f,%g,prefetch attempt %d,%.500s",
+			eMEDIATYPE_TELEMETRY_AVS, mMediaType, httpCode, total, total, connect, firstByte, lookup, handshake, requestSent, dlSize,
+			transfer->mAttempt, url);
+	}
+
+	transfer->mResult = result;
+	transfer->mHttpCode = httpCode;
+	transfer->mDownloadTime = total;
+	if (retry)
+	{
+		logprintf("%s:%d type %d prefetch failed curl %d http %ld, retrying attempt %d", __FUNCTION__, __LINE__, mMediaType, result, httpCode, transfer->mAttempt);
+		transfer->mBuffer.len = 0;
+		transfer->mRetryTime = aamp_GetCurrentTimeMS() + retryDelayMs;
+	}
+	return retry;
+}
+
+/**
+ * @brief Prefetch thread entry
+ */
+void *AampMultiDownloader::WorkerThread(void *arg)
+{
+	AampMultiDownloader *downloader = (AampMultiDownloader *)arg;
+	if(aamp_pthread_setname(pthread_self(), "aampPrefetch"))
+	{
+		logprintf("%s:%d: aamp_pthread_setname failed", __FUNCTION__, __LINE__);
+	}
+	downloader->Run();
+	return NULL;
+}
+
+/**
+ * @brief Prefetch thread loop, drives all transfers of the multi handle
+ */
+void AampMultiDownloader::Run()
+{
+	pthread_mutex_lock(&mMutex);
+	while (!mStop)
+	{
+		std::vector<Transfer *> pending;
+		std::vector<Transfer *> removed;
+		pending.swap(mPending);
+		removed.swap(mRemoved);
+		if (mActiveCount == 0 && pending.empty() && removed.empty() && mRetrying.empty())
+		{
+			pthread_cond_wait(&mCond, &mMutex);
+			continue;
+		}
+		pthread_mutex_unlock(&mMutex);
+
+		for (std::vector<Transfer *>::iterator it = removed.begin(); it != removed.end(); it++)
+		{
+			if ((*it)->mInMulti)
+			{
+				curl_multi_remove_handle(mMulti, (*it)->mCurl);
+				mActiveCount--;
+			}
+			std::vector<Transfer *>::iterator retryIt = std::find(mRetrying.begin(), mRetrying.end(), *it);
+			if (retryIt != mRetrying.end())
+			{
+				mRetrying.erase(retryIt);
+			}
+			delete *it;
+		}
+		long long now = aamp_GetCurrentTimeMS();
+		for (std::vector<Transfer *>::iterator it = mRetrying.begin(); it != mRetrying.end();)
+		{
+			if ((*it)->mRetryTime <= now)
+			{
+				pending.push_back(*it);
+				it = mRetrying.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+		for (std::vector<Transfer *>::iterator it = pending.begin(); it != pending.end(); it++)
+		{
+			if (mActiveCount == 0)
+			{
+				// link was idle, start new throughput sample window
+				mBytesSinceSample = 0;
+				mSampleStartTime = aamp_GetCurrentTimeMS();
+			}
+			curl_multi_add_handle(mMulti, (*it)->mCurl);
+			(*it)->mInMulti = true;
+			mActiveCount++;
+		}
+
+		int running = 0;
+		curl_multi_perform(mMulti, &running);
+
+		CURLMsg *msg;
+		int msgsLeft;
+		while ((msg = curl_multi_info_read(mMulti, &msgsLeft)) != NULL)
+		{
+			if (msg->msg == CURLMSG_DONE)
+			{
+				Transfer *transfer = NULL;
+				CURL *easy = msg->easy_handle;
+				CURLcode result = msg->data.result;
+				curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char **)&transfer);
+				curl_multi_remove_handle(mMulti, easy);
+				transfer->mInMulti = false;
+				mActiveCount--;
+				if (CompleteAttempt(transfer, result))
+				{
+					mRetrying.push_back(transfer);
+					continue;
+				}
+				pthread_mutex_lock(&mMutex);
+				transfer->mDone = true;
+				ReportBandwidth(transfer);
+				if (mActiveCount == 0)
+				{
+					mSampleStartTime = 0;
+				}
+				pthread_cond_broadcast(&mCond);
+				pthread_mutex_unlock(&mMutex);
+			}
+		}
+		if (mActiveCount > 0)
+		{
+			curl_multi_wait(mMulti, NULL, 0, MULTI_DOWNLOADER_POLL_TIMEOUT_MS, NULL);
+		}
+		pthread_mutex_lock(&mMutex);
+		if (mActiveCount == 0 && !mRetrying.empty() && mPending.empty() && mRemoved.empty() && !mStop)
+		{
+			// nothing to drive, sleep until next retry is due or a request comes in
+			struct timespec ts = aamp_GetTimespec(MULTI_DOWNLOADER_POLL_TIMEOUT_MS);
+			pthread_cond_timedwait(&mCond, &mMutex, &ts);
+		}
+	}
+	pthread_mutex_unlock(&mMutex);
+}
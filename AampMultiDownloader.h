@@ -0,0 +1,150 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampMultiDownloader.h
+ * @brief Concurrent fragment prefetch for a media track using curl multi interface
+ */
+
+#ifndef __AAMP_MULTI_DOWNLOADER_H__
+#define __AAMP_MULTI_DOWNLOADER_H__
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <pthread.h>
+#include <curl/curl.h>
+#include "priv_aamp.h"
+
+/**
+ * @brief Url and byte range ("" for whole file) of a fragment to prefetch
+ */
+typedef std::pair<std::string, std::string> PrefetchRequest;
+
+/**
+ * @brief Keeps up to N fragment downloads of a track outstanding on a single curl multi handle.
+ *
+ * Fetch loop announces the fragments it is going to need next with Prefetch() and collects
+ * each one with Take() when it gets there. Transfers share the connection pool of the multi
+ * handle, so the requests are pipelined over kept-alive connections instead of being issued
+ * back to back on one easy handle.
+ *
+ * Transfers do not go through GetFile, but follow its rules: curl timeouts of the track's curl
+ * instance, a retry on connect failure, stall and 5xx server error, network error and latency
+ * logging, HttpRequestEnd and playback profiler metrics. A transfer failing all attempts makes
+ * Take() fail and the caller downloads the fragment with GetFile. ABR gets aggregate throughput
+ * of the transfers instead of per fragment samples, and there are no low bandwidth aborts.
+ */
+class AampMultiDownloader
+{
+public:
+	/**
+	 * @brief AampMultiDownloader constructor
+	 * @param aamp pointer to PrivateInstanceAAMP object
+	 * @param mediaType media type of the track, used for custom headers and ABR reporting
+	 * @param curlInstance curl instance of the track, used as template for transfers
+	 * @param maxConcurrent max number of outstanding transfers
+	 * @param bufferPool fragment buffer pool of the track, transfers download into its buffers
+	 */
+	AampMultiDownloader(PrivateInstanceAAMP *aamp, MediaType mediaType, AampCurlInstance curlInstance, int maxConcurrent, AampBufferPool *bufferPool);
+
+	/**
+	 * @brief AampMultiDownloader destructor
+	 */
+	~AampMultiDownloader();
+
+	AampMultiDownloader(const AampMultiDownloader&) = delete;
+	AampMultiDownloader& operator=(const AampMultiDownloader&) = delete;
+
+	/**
+	 * @brief Start downloads of upcoming fragments, cancelling outstanding ones not in the list
+	 * @param requests fragments in playback order; only first maxConcurrent entries are issued
+	 */
+	void Prefetch(const std::vector<PrefetchRequest> &requests);
+
+	/**
+	 * @brief Collect a prefetched fragment, waiting for its transfer to complete
+	 * @param url url of the fragment
+	 * @param range byte range of the fragment, "" for whole file
+	 * @param[in][out] buffer pooled buffer, returned to pool and replaced by the downloaded one on success
+	 * @param[out] httpCode http code of the transfer
+	 * @param[out] downloadTime download time of the transfer in seconds
+	 * @retval true if fragment was prefetched and downloaded successfully
+	 * @retval false if not prefetched or failed; caller has to download it on its own
+	 */
+	bool Take(const std::string &url, const std::string &range, GrowableBuffer *buffer, long &httpCode, double &downloadTime);
+
+	/**
+	 * @brief Cancel all outstanding transfers
+	 */
+	void Cancel();
+
+private:
+	/**
+	 * @brief State of one prefetch transfer
+	 */
+	struct Transfer
+	{
+		Transfer(AampMultiDownloader *parent, const PrefetchRequest &request);
+		~Transfer();
+		Transfer(const Transfer&) = delete;
+		Transfer& operator=(const Transfer&) = delete;
+
+		AampMultiDownloader *mParent;    /**< Owner of the transfer */
+		PrefetchRequest mRequest;        /**< Url and range */
+		CURL *mCurl;                     /**< Easy handle, NULL until issued */
+		struct curl_slist *mHeaders;     /**< Custom http headers */
+		GrowableBuffer mBuffer;          /**< Downloaded data */
+		bool mDone;                      /**< Transfer completed, after last attempt */
+		bool mInMulti;                   /**< Easy handle is part of multi handle, used by worker only */
+		int mAttempt;                    /**< Attempts made so far */
+		long long mRetryTime;            /**< Time to add handle again for a retry, used by worker only */
+		CURLcode mResult;                /**< Curl result of completed transfer */
+		long mHttpCode;                  /**< Http code of completed transfer */
+		double mDownloadTime;            /**< Total time of completed transfer */
+	};
+
+	static size_t WriteCallback(void *ptr, size_t size, size_t nmemb, void *userdata);
+	static void *WorkerThread(void *arg);
+	void Run();
+	bool CompleteAttempt(Transfer *transfer, CURLcode result);
+	void ReleaseTransfer(Transfer *transfer);
+	void ReportBandwidth(Transfer *transfer);
+
+	PrivateInstanceAAMP *aamp;
+	MediaType mMediaType;
+	AampCurlInstance mCurlInstance;
+	int mMaxConcurrent;
+	AampBufferPool *mBufferPool;         /**< Fragment buffer pool of the track, referenced */
+	CURLM *mMulti;
+	std::vector<Transfer *> mTransfers;  /**< Requested transfers in playback order */
+	std::vector<Transfer *> mPending;    /**< Transfers to be added to multi handle by worker */
+	std::vector<Transfer *> mRemoved;    /**< Transfers to be removed from multi handle and freed by worker */
+	std::vector<Transfer *> mRetrying;   /**< Transfers waiting to be retried, used by worker only */
+	pthread_mutex_t mMutex;
+	pthread_cond_t mCond;
+	pthread_t mThreadId;
+	bool mThreadStarted;
+	bool mStop;
+	int mActiveCount;                    /**< Transfers in multi handle */
+	long long mBytesSinceSample;         /**< Bytes received since last ABR sample */
+	long long mSampleStartTime;          /**< Start of current ABR sample window, 0 if idle */
+};
+
+#endif /* __AAMP_MULTI_DOWNLOADER_H__ */
@@ -0,0 +1,329 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampMutex.cpp
+ * @brief Lock contention profiling, built only with AAMP_LOCK_PROFILING
+ */
+
+#include "AampMutex.h"
+
+#ifdef AAMP_LOCK_PROFILING
+#include <time.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "AampLogManager.h"
+
+#define AAMP_LOCK_PROFILE_MAX_HELD 16  /**< Locks tracked as held at once per thread, deeper nesting is not profiled */
+
+/**
+ * @brief Lock held by the current thread
+ */
+struct HeldLock
+{
+	pthread_mutex_t *mutex;
+	AampLockSite *site;
+	long long acquiredNs;
+};
+
+static thread_local HeldLock gHeldLocks[AAMP_LOCK_PROFILE_MAX_HELD];
+static thread_local int gHeldLockCount = 0;
+
+/**
+ * @brief Registered call sites, sites are never removed
+ */
+static std::atomic<AampLockSite*> gLockSites(NULL);
+
+/**
+ * @brief Get monotonic time
+ * @retval time in nanoseconds
+ */
+static long long NowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+/**
+ * @brief Add duration to histogram
+ * @param[in] histogram histogram to update
+ * @param[in] durationNs duration in nanoseconds
+ */
+static void RecordDuration(AampLockSite::Histogram &histogram, long long durationNs)
+{
+	uint64_t value = (durationNs > 0) ? (uint64_t)durationNs : 0;
+	int bucket = 0;
+	for (uint64_t bound = 1000; (value >= bound) && (bucket < AAMP_LOCK_PROFILE_BUCKET_COUNT - 1); bound <<= 1)
+	{
+		bucket++;
+	}
+	histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	histogram.count.fetch_add(1, std::memory_order_relaxed);
+	histogram.sumNs.fetch_add(value, std::memory_order_relaxed);
+	uint64_t maxNs = histogram.maxNs.load(std::memory_order_relaxed);
+	while (value > maxNs && !histogram.maxNs.compare_exchange_weak(maxNs, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+/**
+ * @brief Clear histogram
+ * @param[in] histogram histogram to clear
+ */
+static void ResetHistogram(AampLockSite::Histogram &histogram)
+{
+	for (int bucket = 0; bucket < AAMP_LOCK_PROFILE_BUCKET_COUNT; bucket++)
+	{
+		histogram.buckets[bucket].store(0, std::memory_order_relaxed);
+	}
+	histogram.count.store(0, std::memory_order_relaxed);
+	histogram.sumNs.store(0, std::memory_order_relaxed);
+	histogram.maxNs.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Find latest entry of mutex among locks held by this thread
+ * @param[in] mutex mutex to find
+ * @retval index in gHeldLocks, -1 if not tracked
+ */
+static int FindHeldLock(pthread_mutex_t *mutex)
+{
+	for (int i = gHeldLockCount - 1; i >= 0; i--)
+	{
+		if (gHeldLocks[i].mutex == mutex)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Snapshot of histograms, summed per lock or per site for logging
+ */
+struct LockStats
+{
+	std::string name;
+	uint64_t waitBuckets[AAMP_LOCK_PROFILE_BUCKET_COUNT];
+	uint64_t holdBuckets[AAMP_LOCK_PROFILE_BUCKET_COUNT];
+	uint64_t count;
+	uint64_t waitSumNs;
+	uint64_t waitMaxNs;
+	uint64_t holdCount;
+	uint64_t holdSumNs;
+	uint64_t holdMaxNs;
+
+	LockStats(const std::string &name) : name(name), waitBuckets(), holdBuckets(), count(0), waitSumNs(0), waitMaxNs(0),
+		holdCount(0), holdSumNs(0), holdMaxNs(0)
+	{
+	}
+
+	/**
+	 * @brief Add histograms of a site
+	 * @param[in] site call site
+	 */
+	void Add(AampLockSite *site)
+	{
+		for (int bucket = 0; bucket < AAMP_LOCK_PROFILE_BUCKET_COUNT; bucket++)
+		{
+			waitBuckets[bucket] += site->mWait.buckets[bucket].load(std::memory_order_relaxed);
+			holdBuckets[bucket] += site->mHold.buckets[bucket].load(std::memory_order_relaxed);
+		}
+		count += site->mWait.count.load(std::memory_order_relaxed);
+		waitSumNs += site->mWait.sumNs.load(std::memory_order_relaxed);
+		waitMaxNs = std::max(waitMaxNs, (uint64_t)site->mWait.maxNs.load(std::memory_order_relaxed));
+		holdCount += site->mHold.count.load(std::memory_order_relaxed);
+		holdSumNs += site->mHold.sumNs.load(std::memory_order_relaxed);
+		holdMaxNs = std::max(holdMaxNs, (uint64_t)site->mHold.maxNs.load(std::memory_order_relaxed));
+	}
+};
+
+/**
+ * @brief Get percentile from histogram buckets
+ * @param[in] buckets bucket counts
+ * @param[in] count sample count
+ * @param[in] percent percentile
+ * @retval upper bound in microseconds of the bucket holding the percentile
+ */
+static unsigned long Percentile(const uint64_t *buckets, uint64_t count, int percent)
+{
+	uint64_t target = (count * percent + 99) / 100;
+	uint64_t cumulative = 0;
+	unsigned long boundUs = 1;
+	for (int bucket = 0; bucket < AAMP_LOCK_PROFILE_BUCKET_COUNT - 1; bucket++, boundUs <<= 1)
+	{
+		cumulative += buckets[bucket];
+		if (cumulative >= target)
+		{
+			break;
+		}
+	}
+	return boundUs;
+}
+
+/**
+ * @brief Log one line of statistics
+ * @param[in] stats summed histograms
+ */
+static void LogLockStats(const LockStats &stats)
+{
+	if (stats.count == 0)
+	{
+		return;
+	}
+	uint64_t holdCount = stats.holdCount ? stats.holdCount : 1;
+	logprintf("%-48s n=%llu wait(us) avg=%llu p50=%lu p99=%lu max=%llu total=%llu hold(us) avg=%llu p50=%lu p99=%lu max=%llu total=%llu",
+		stats.name.c_str(), (unsigned long long)stats.count,
+		(unsigned long long)(stats.waitSumNs / stats.count / 1000),
+		Percentile(stats.waitBuckets, stats.count, 50), Percentile(stats.waitBuckets, stats.count, 99),
+		(unsigned long long)(stats.waitMaxNs / 1000), (unsigned long long)(stats.waitSumNs / 1000),
+		(unsigned long long)(stats.holdSumNs / holdCount / 1000),
+		Percentile(stats.holdBuckets, stats.holdCount, 50), Percentile(stats.holdBuckets, stats.holdCount, 99),
+		(unsigned long long)(stats.holdMaxNs / 1000), (unsigned long long)(stats.holdSumNs / 1000));
+}
+
+/**
+ * @brief AampLockSite constructor
+ * @param[in] lockName name shared by all sites of the lock, e.g. "PrivateInstanceAAMP::mLock"
+ * @param[in] function function taking the lock
+ * @param[in] line source line taking the lock
+ */
+AampLockSite::AampLockSite(const char *lockName, const char *function, int line) : mLockName(lockName), mFunction(function), mLine(line),
+	mWait(), mHold(), mNext(NULL)
+{
+	ResetHistogram(mWait);
+	ResetHistogram(mHold);
+	mNext = gLockSites.load();
+	while (!gLockSites.compare_exchange_weak(mNext, this))
+	{
+	}
+}
+
+/**
+ * @brief Lock mutex, recording wait time on the site
+ * @param[in] mutex mutex to lock
+ * @param[in] site call site
+ */
+void AampLockProfiler::Lock(pthread_mutex_t *mutex, AampLockSite &site)
+{
+	long long startNs = NowNs();
+	pthread_mutex_lock(mutex);
+	long long acquiredNs = NowNs();
+	RecordDuration(site.mWait, acquiredNs - startNs);
+	if (gHeldLockCount < AAMP_LOCK_PROFILE_MAX_HELD)
+	{
+		HeldLock &held = gHeldLocks[gHeldLockCount++];
+		held.mutex = mutex;
+		held.site = &site;
+		held.acquiredNs = acquiredNs;
+	}
+}
+
+/**
+ * @brief Unlock mutex, recording hold time on the site which locked it
+ * @param[in] mutex mutex to unlock
+ */
+void AampLockProfiler::Unlock(pthread_mutex_t *mutex)
+{
+	int index = FindHeldLock(mutex);
+	if (index >= 0)
+	{
+		RecordDuration(gHeldLocks[index].site->mHold, NowNs() - gHeldLocks[index].acquiredNs);
+		gHeldLockCount--;
+		for (int i = index; i < gHeldLockCount; i++)
+		{
+			gHeldLocks[i] = gHeldLocks[i + 1];
+		}
+	}
+	pthread_mutex_unlock(mutex);
+}
+
+/**
+ * @brief Wait on condition, hold time of the mutex is paused during the wait
+ * @param[in] cond condition to wait on
+ * @param[in] mutex mutex held by caller
+ * @param[in] abstime absolute timeout, NULL to wait without timeout
+ * @retval return value of pthread_cond_wait / pthread_cond_timedwait
+ */
+int AampLockProfiler::CondWait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *abstime)
+{
+	int index = FindHeldLock(mutex);
+	if (index >= 0)
+	{
+		RecordDuration(gHeldLocks[index].site->mHold, NowNs() - gHeldLocks[index].acquiredNs);
+	}
+	int ret = abstime ? pthread_cond_timedwait(cond, mutex, abstime) : pthread_cond_wait(cond, mutex);
+	if (index >= 0)
+	{
+		gHeldLocks[index].acquiredNs = NowNs();
+	}
+	return ret;
+}
+
+/**
+ * @brief Log wait and hold statistics per lock and per call site
+ *
+ * Hold samples are counted at release or condition wait, so n can differ between wait and hold.
+ * Percentiles are the upper bound of the histogram bucket.
+ * @param[in] reset clear statistics after logging
+ */
+void AampLockProfiler::Dump(bool reset)
+{
+	std::vector<LockStats> locks;
+	std::vector<LockStats> sites;
+	for (AampLockSite *site = gLockSites.load(); site; site = site->mNext)
+	{
+		auto lock = std::find_if(locks.begin(), locks.end(), [site](const LockStats &stats) { return stats.name == site->mLockName; });
+		if (lock == locks.end())
+		{
+			locks.push_back(LockStats(site->mLockName));
+			lock = locks.end() - 1;
+		}
+		lock->Add(site);
+		char name[128];
+		snprintf(name, sizeof(name), "  %s %s:%d", site->mLockName, site->mFunction, site->mLine);
+		sites.push_back(LockStats(name));
+		sites.back().Add(site);
+		if (reset)
+		{
+			ResetHistogram(site->mWait);
+			ResetHistogram(site->mHold);
+		}
+	}
+	// most contended first
+	auto byWait = [](const LockStats &a, const LockStats &b) { return a.waitSumNs > b.waitSumNs; };
+	std::sort(locks.begin(), locks.end(), byWait);
+	std::sort(sites.begin(), sites.end(), byWait);
+
+	logprintf("Lock profile per lock:");
+	for (const LockStats &stats : locks)
+	{
+		LogLockStats(stats);
+	}
+	logprintf("Lock profile per call site:");
+	for (const LockStats &stats : sites)
+	{
+		LogLockStats(stats);
+	}
+}
+
+#endif /* AAMP_LOCK_PROFILING */
@@ -19,7 +19,11 @@
 
 /**
 * @file AampMutex.h
-* @brief Helper class for scoped mutex lock
+* @brief Helper class for scoped mutex lock, and optional lock contention profiling
+*
+* Locks taken with the AAMP_MUTEX_* / AAMP_COND_* macros record wait and hold time histograms per
+* call site when built with AAMP_LOCK_PROFILING (cmake -DCMAKE_AAMP_LOCK_PROFILING=1). Otherwise the
+* macros are plain pthread calls.
 */
 
 #ifndef _AAMP_MUTEX_H
@@ -27,11 +31,111 @@
 
 #include <pthread.h>
 
+#ifdef AAMP_LOCK_PROFILING
+#include <atomic>
+#include <stdint.h>
+
+#define AAMP_LOCK_PROFILE_BUCKET_COUNT 24      /**< Bucket i holds durations below 1us << i, last bucket holds longer ones */
+
+/**
+ * @brief Wait and hold time histograms of one lock call site.
+ *
+ * Defined as function static by the AAMP_MUTEX_* macros, registers itself on construction.
+ */
+class AampLockSite
+{
+public:
+	/**
+	 * @brief Duration histogram, updated without lock
+	 */
+	struct Histogram
+	{
+		std::atomic<uint32_t> buckets[AAMP_LOCK_PROFILE_BUCKET_COUNT]; /**< Sample count per bucket */
+		std::atomic<uint64_t> count;    /**< Sample count */
+		std::atomic<uint64_t> sumNs;    /**< Sum of durations */
+		std::atomic<uint64_t> maxNs;    /**< Longest duration */
+	};
+
+	/**
+	 * @brief AampLockSite constructor
+	 * @param[in] lockName name shared by all sites of the lock, e.g. "PrivateInstanceAAMP::mLock"
+	 * @param[in] function function taking the lock
+	 * @param[in] line source line taking the lock
+	 */
+	AampLockSite(const char *lockName, const char *function, int line);
+
+	AampLockSite(const AampLockSite&) = delete;
+	AampLockSite& operator=(const AampLockSite&) = delete;
+
+	const char *mLockName;
+	const char *mFunction;
+	int mLine;
+	Histogram mWait;                /**< Time blocked acquiring the lock */
+	Histogram mHold;                /**< Time from acquiring to releasing the lock */
+	AampLockSite *mNext;            /**< Next registered site */
+};
+
+/**
+ * @brief Profiled pthread mutex operations, used through the AAMP_MUTEX_* / AAMP_COND_* macros
+ *
+ * Hold time is tracked per thread, so a lock has to be released by the thread which took it. Time
+ * blocked in a condition wait is not counted as hold time.
+ */
+class AampLockProfiler
+{
+public:
+	/**
+	 * @brief Lock mutex, recording wait time on the site
+	 * @param[in] mutex mutex to lock
+	 * @param[in] site call site
+	 */
+	static void Lock(pthread_mutex_t *mutex, AampLockSite &site);
+
+	/**
+	 * @brief Unlock mutex, recording hold time on the site which locked it
+	 * @param[in] mutex mutex to unlock
+	 */
+	static void Unlock(pthread_mutex_t *mutex);
+
+	/**
+	 * @brief Wait on condition, hold time of the mutex is paused during the wait
+	 * @param[in] cond condition to wait on
+	 * @param[in] mutex mutex held by caller
+	 * @param[in] abstime absolute timeout, NULL to wait without timeout
+	 * @retval return value of pthread_cond_wait / pthread_cond_timedwait
+	 */
+	static int CondWait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *abstime);
+
+	/**
+	 * @brief Log wait and hold statistics per lock and per call site
+	 * @param[in] reset clear statistics after logging
+	 */
+	static void Dump(bool reset);
+};
+
+#define AAMP_MUTEX_LOCK(mutex, lockName) \
+	do { static AampLockSite aampLockSite(lockName, __FUNCTION__, __LINE__); AampLockProfiler::Lock(&(mutex), aampLockSite); } while (0)
+#define AAMP_MUTEX_UNLOCK(mutex) AampLockProfiler::Unlock(&(mutex))
+#define AAMP_COND_WAIT(cond, mutex) AampLockProfiler::CondWait(&(cond), &(mutex), NULL)
+#define AAMP_COND_TIMEDWAIT(cond, mutex, abstime) AampLockProfiler::CondWait(&(cond), &(mutex), &(abstime))
+#define AAMP_MUTEX_HOLD(var, mutex, lockName) \
+	static AampLockSite var##Site(lockName, __FUNCTION__, __LINE__); AampMutexHold var(mutex, var##Site)
+
+#else
+
+#define AAMP_MUTEX_LOCK(mutex, lockName) pthread_mutex_lock(&(mutex))
+#define AAMP_MUTEX_UNLOCK(mutex) pthread_mutex_unlock(&(mutex))
+#define AAMP_COND_WAIT(cond, mutex) pthread_cond_wait(&(cond), &(mutex))
+#define AAMP_COND_TIMEDWAIT(cond, mutex, abstime) pthread_cond_timedwait(&(cond), &(mutex), &(abstime))
+#define AAMP_MUTEX_HOLD(var, mutex, lockName) AampMutexHold var(mutex)
+
+#endif /* AAMP_LOCK_PROFILING */
+
 /**
- * @class AampMutexHold 
+ * @class AampMutexHold
  * @brief auto Lock the provided mutex during the object scope
  */
-class AampMutexHold 
+class AampMutexHold
 {
 	pthread_mutex_t& mutex_;
 public:
@@ -40,10 +144,25 @@ public:
 		pthread_mutex_lock(&mutex_);
 	}
 
+#ifdef AAMP_LOCK_PROFILING
+	AampMutexHold(pthread_mutex_t& mutex, AampLockSite& site): mutex_(mutex)
+	{
+		AampLockProfiler::Lock(&mutex_, site);
+	}
+
+	~AampMutexHold()
+	{
+		AampLockProfiler::Unlock(&mutex_);
+	}
+#else
 	~AampMutexHold()
 	{
 		pthread_mutex_unlock(&mutex_);
 	}
+#endif
+
+	AampMutexHold(const AampMutexHold&) = delete;
+	AampMutexHold& operator=(const AampMutexHold&) = delete;
 };
 
 #endif //_AAMP_MUTEX_H
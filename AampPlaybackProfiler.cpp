@@ -0,0 +1,208 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampPlaybackProfiler.cpp
+ * @brief Latency histograms of fragment processing phases, recorded through the whole playback
+ */
+
+#include "AampPlaybackProfiler.h"
+#include <cjson/cJSON.h>
+#include <chrono>
+
+static const char *gTrackNames[PLAYBACK_PROFILE_TRACK_COUNT] = { "video", "audio", "subtitle" };
+
+static const char *gPhaseNames[PLAYBACK_PHASE_COUNT] = { "dns", "connect", "ttfb", "transfer", "decrypt", "demux", "injectWait", "sinkPush" };
+
+/**
+ * @brief Duration of phases timed by AampPlaybackPhaseTimer on this thread
+ */
+static thread_local long long gThreadTimedUs = 0;
+
+/**
+ * @brief AampPlaybackProfiler constructor
+ */
+AampPlaybackProfiler::AampPlaybackProfiler() : mHistograms()
+{
+	Reset();
+}
+
+/**
+ * @brief Get monotonic time used for phase durations
+ * @retval time in microseconds
+ */
+long long AampPlaybackProfiler::NowUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Add duration of a phase
+ * @param[in] track track index, other values are ignored
+ * @param[in] phase profiled phase
+ * @param[in] durationUs duration in microseconds
+ */
+void AampPlaybackProfiler::Record(int track, PlaybackProfilePhase phase, long long durationUs)
+{
+	if (track < 0 || track >= PLAYBACK_PROFILE_TRACK_COUNT || phase < 0 || phase >= PLAYBACK_PHASE_COUNT)
+	{
+		return;
+	}
+	uint64_t value = (durationUs > 0) ? (uint64_t)durationUs : 0;
+	int bucket = 0;
+	for (uint64_t bound = PLAYBACK_PROFILE_FIRST_BUCKET_US; (value >= bound) && (bucket < PLAYBACK_PROFILE_BUCKET_COUNT - 1); bound <<= 1)
+	{
+		bucket++;
+	}
+	Histogram &histogram = mHistograms[track][phase];
+	histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	histogram.count.fetch_add(1, std::memory_order_relaxed);
+	histogram.sumUs.fetch_add(value, std::memory_order_relaxed);
+	uint64_t maxUs = histogram.maxUs.load(std::memory_order_relaxed);
+	while (value > maxUs && !histogram.maxUs.compare_exchange_weak(maxUs, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+/**
+ * @brief Clear all histograms, done at tune
+ */
+void AampPlaybackProfiler::Reset()
+{
+	for (int track = 0; track < PLAYBACK_PROFILE_TRACK_COUNT; track++)
+	{
+		for (int phase = 0; phase < PLAYBACK_PHASE_COUNT; phase++)
+		{
+			Histogram &histogram = mHistograms[track][phase];
+			for (int bucket = 0; bucket < PLAYBACK_PROFILE_BUCKET_COUNT; bucket++)
+			{
+				histogram.buckets[bucket].store(0, std::memory_order_relaxed);
+			}
+			histogram.count.store(0, std::memory_order_relaxed);
+			histogram.sumUs.store(0, std::memory_order_relaxed);
+			histogram.maxUs.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+/**
+ * @brief Get histograms as compact JSON
+ *
+ * Per phase: n sample count, avg and max in microseconds, p50/p90/p99 as upper bound of the
+ * bucket holding that percentile, and hist with bucket counts up to the last used bucket.
+ * Bucket i holds durations below 64us << i, the last bucket holds all longer durations.
+ * @retval JSON object with one member per track, holding one member per phase with samples
+ */
+std::string AampPlaybackProfiler::ToJsonString()
+{
+	std::string ret;
+	cJSON *root = cJSON_CreateObject();
+	if (!root)
+	{
+		return ret;
+	}
+	for (int track = 0; track < PLAYBACK_PROFILE_TRACK_COUNT; track++)
+	{
+		cJSON *trackItem = NULL;
+		for (int phase = 0; phase < PLAYBACK_PHASE_COUNT; phase++)
+		{
+			Histogram &histogram = mHistograms[track][phase];
+			uint32_t buckets[PLAYBACK_PROFILE_BUCKET_COUNT];
+			uint64_t count = 0;
+			int used = 0;
+			for (int bucket = 0; bucket < PLAYBACK_PROFILE_BUCKET_COUNT; bucket++)
+			{
+				buckets[bucket] = histogram.buckets[bucket].load(std::memory_order_relaxed);
+				count += buckets[bucket];
+				if (buckets[bucket])
+				{
+					used = bucket + 1;
+				}
+			}
+			if (count == 0)
+			{
+				continue;
+			}
+			if (!trackItem)
+			{
+				cJSON_AddItemToObject(root, gTrackNames[track], trackItem = cJSON_CreateObject());
+			}
+			cJSON *phaseItem = cJSON_CreateObject();
+			cJSON_AddItemToObject(trackItem, gPhaseNames[phase], phaseItem);
+			cJSON_AddNumberToObject(phaseItem, "n", (double)count);
+			cJSON_AddNumberToObject(phaseItem, "avg", (double)(histogram.sumUs.load(std::memory_order_relaxed) / count));
+			cJSON_AddNumberToObject(phaseItem, "max", (double)histogram.maxUs.load(std::memory_order_relaxed));
+
+			static const struct { const char *name; int percent; } percentiles[] = { { "p50", 50 }, { "p90", 90 }, { "p99", 99 } };
+			for (const auto &percentile : percentiles)
+			{
+				uint64_t target = (count * percentile.percent + 99) / 100;
+				uint64_t cumulative = 0;
+				uint64_t bound = PLAYBACK_PROFILE_FIRST_BUCKET_US;
+				for (int bucket = 0; bucket < used; bucket++, bound <<= 1)
+				{
+					cumulative += buckets[bucket];
+					if (cumulative >= target)
+					{
+						break;
+					}
+				}
+				cJSON_AddNumberToObject(phaseItem, percentile.name, (double)bound);
+			}
+
+			cJSON *hist = cJSON_CreateArray();
+			for (int bucket = 0; bucket < used; bucket++)
+			{
+				cJSON_AddItemToArray(hist, cJSON_CreateNumber(buckets[bucket]));
+			}
+			cJSON_AddItemToObject(phaseItem, "hist", hist);
+		}
+	}
+	char *json = cJSON_PrintUnformatted(root);
+	if (json)
+	{
+		ret = json;
+		cJSON_free(json);
+	}
+	cJSON_Delete(root);
+	return ret;
+}
+
+/**
+ * @brief Start timing
+ * @param[in] profiler profiler to record into
+ * @param[in] track track index
+ * @param[in] phase profiled phase
+ */
+AampPlaybackPhaseTimer::AampPlaybackPhaseTimer(AampPlaybackProfiler &profiler, int track, PlaybackProfilePhase phase) :
+	mProfiler(profiler), mTrack(track), mPhase(phase), mStartUs(AampPlaybackProfiler::NowUs()), mNestedStartUs(gThreadTimedUs)
+{
+}
+
+/**
+ * @brief Stop timing and record exclusive duration
+ */
+AampPlaybackPhaseTimer::~AampPlaybackPhaseTimer()
+{
+	long long elapsedUs = AampPlaybackProfiler::NowUs() - mStartUs;
+	long long nestedUs = gThreadTimedUs - mNestedStartUs;
+	mProfiler.Record(mTrack, mPhase, elapsedUs - nestedUs);
+	// enclosing timers exclude all of this scope
+	gThreadTimedUs = mNestedStartUs + elapsedUs;
+}
@@ -0,0 +1,143 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampPlaybackProfiler.h
+ * @brief Latency histograms of fragment processing phases, recorded through the whole playback
+ */
+
+#ifndef __AAMP_PLAYBACK_PROFILER_H__
+#define __AAMP_PLAYBACK_PROFILER_H__
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+#define PLAYBACK_PROFILE_TRACK_COUNT 3          /**< Video, audio and subtitle, indexed by MediaType / TrackType */
+#define PLAYBACK_PROFILE_BUCKET_COUNT 20        /**< Histogram buckets per phase */
+#define PLAYBACK_PROFILE_FIRST_BUCKET_US 64     /**< Upper bound of first bucket, each next bucket doubles it */
+
+/**
+ * @brief Phases of fragment processing profiled during playback
+ */
+typedef enum
+{
+	PLAYBACK_PHASE_DNS,             /**< Host name lookup */
+	PLAYBACK_PHASE_CONNECT,         /**< TCP and TLS connect, after name lookup */
+	PLAYBACK_PHASE_TTFB,            /**< Request sent until first byte received */
+	PLAYBACK_PHASE_TRANSFER,        /**< First until last byte received */
+	PLAYBACK_PHASE_DECRYPT,         /**< Fragment decryption, from first to last block when decrypted while downloading */
+	PLAYBACK_PHASE_DEMUX,           /**< Segment processing before sink, excluding sink push */
+	PLAYBACK_PHASE_INJECT_WAIT,     /**< Injector waiting for a fetched fragment or for sink to need data */
+	PLAYBACK_PHASE_SINK_PUSH,       /**< Buffer push to sink */
+	PLAYBACK_PHASE_COUNT            /**< Phase count */
+} PlaybackProfilePhase;
+
+/**
+ * @brief Always on profiler of fragment processing after tune.
+ *
+ * Each track and phase has a histogram of durations with power of two buckets. Recording only
+ * updates relaxed atomic counters, so it can be called from download, injector and sink threads
+ * without a lock. A report taken while recording goes on can be off by the samples in flight.
+ */
+class AampPlaybackProfiler
+{
+public:
+	/**
+	 * @brief AampPlaybackProfiler constructor
+	 */
+	AampPlaybackProfiler();
+
+	AampPlaybackProfiler(const AampPlaybackProfiler&) = delete;
+	AampPlaybackProfiler& operator=(const AampPlaybackProfiler&) = delete;
+
+	/**
+	 * @brief Add duration of a phase
+	 * @param[in] track track index, other values are ignored
+	 * @param[in] phase profiled phase
+	 * @param[in] durationUs duration in microseconds
+	 */
+	void Record(int track, PlaybackProfilePhase phase, long long durationUs);
+
+	/**
+	 * @brief Clear all histograms, done at tune
+	 */
+	void Reset();
+
+	/**
+	 * @brief Get histograms as compact JSON
+	 * @retval JSON object with one member per track, holding one member per phase with samples
+	 */
+	std::string ToJsonString();
+
+	/**
+	 * @brief Get monotonic time used for phase durations
+	 * @retval time in microseconds
+	 */
+	static long long NowUs();
+
+private:
+	/**
+	 * @brief Duration histogram of one phase
+	 */
+	struct Histogram
+	{
+		std::atomic<uint32_t> buckets[PLAYBACK_PROFILE_BUCKET_COUNT]; /**< Sample count per bucket */
+		std::atomic<uint64_t> count;    /**< Sample count */
+		std::atomic<uint64_t> sumUs;    /**< Sum of durations */
+		std::atomic<uint64_t> maxUs;    /**< Longest duration */
+	};
+
+	Histogram mHistograms[PLAYBACK_PROFILE_TRACK_COUNT][PLAYBACK_PHASE_COUNT];
+};
+
+/**
+ * @brief Scoped timer of a profiled phase.
+ *
+ * Time of phases timed within its scope on the same thread is not counted, so nested phases,
+ * e.g. sink push from demux, are reported once.
+ */
+class AampPlaybackPhaseTimer
+{
+public:
+	/**
+	 * @brief Start timing
+	 * @param[in] profiler profiler to record into
+	 * @param[in] track track index
+	 * @param[in] phase profiled phase
+	 */
+	AampPlaybackPhaseTimer(AampPlaybackProfiler &profiler, int track, PlaybackProfilePhase phase);
+
+	/**
+	 * @brief Stop timing and record exclusive duration
+	 */
+	~AampPlaybackPhaseTimer();
+
+	AampPlaybackPhaseTimer(const AampPlaybackPhaseTimer&) = delete;
+	AampPlaybackPhaseTimer& operator=(const AampPlaybackPhaseTimer&) = delete;
+
+private:
+	AampPlaybackProfiler &mProfiler;
+	int mTrack;
+	PlaybackProfilePhase mPhase;
+	long long mStartUs;             /**< Start time */
+	long long mNestedStartUs;       /**< Timed duration of this thread at start */
+};
+
+#endif /* __AAMP_PLAYBACK_PROFILER_H__ */
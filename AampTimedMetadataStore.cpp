@@ -0,0 +1,202 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampTimedMetadataStore.cpp
+ * @brief Time ordered, deduplicated store of timed metadata
+ */
+
+#include "AampTimedMetadataStore.h"
+#include <algorithm>
+#include <functional>
+
+/**
+ * @brief AampTimedMetadataStore constructor
+ */
+AampTimedMetadataStore::AampTimedMetadataStore() : mMutex(), mTimeline(), mIndex(), mNextSequence(0), mReportedSequence(0)
+{
+	pthread_mutex_init(&mMutex, NULL);
+}
+
+/**
+ * @brief AampTimedMetadataStore destructor
+ */
+AampTimedMetadataStore::~AampTimedMetadataStore()
+{
+	pthread_mutex_destroy(&mMutex);
+}
+
+/**
+ * @brief Hash of name and content
+ */
+size_t AampTimedMetadataStore::Hash(const std::string &name, const std::string &content)
+{
+	std::hash<std::string> hasher;
+	size_t seed = hasher(name);
+	// boost::hash_combine
+	seed ^= hasher(content) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	return seed;
+}
+
+/**
+ * @brief Add entry unless an entry with same name and content exists within the duplicate tolerance
+ * @param[in] timeMS time of metadata in milliseconds
+ * @param[in] name metadata name
+ * @param[in] content metadata content
+ * @param[in] id metadata id
+ * @param[in] durationMS duration in milliseconds
+ * @retval true if added, false for a duplicate
+ */
+bool AampTimedMetadataStore::Add(long long timeMS, const std::string &name, const std::string &content, const std::string &id, double durationMS)
+{
+	size_t hash = Hash(name, content);
+	pthread_mutex_lock(&mMutex);
+	auto range = mIndex.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		const TimedMetadata &existing = it->second->second.metadata;
+		// boundary check of 1 sec for rounding correction
+		if ((timeMS >= existing._timeMS - TIMED_METADATA_DUPLICATE_TOLERANCE_MS) &&
+			(timeMS <= existing._timeMS + TIMED_METADATA_DUPLICATE_TOLERANCE_MS) &&
+			(existing._name == name) && (existing._content == content))
+		{
+			pthread_mutex_unlock(&mMutex);
+			return false;
+		}
+	}
+	Entry entry = { TimedMetadata(timeMS, name, content, id, durationMS), hash, mNextSequence++ };
+	// upper bound keeps entries with same time in insertion order
+	Timeline::iterator inserted = mTimeline.insert(mTimeline.upper_bound(timeMS), std::make_pair(timeMS, entry));
+	mIndex.insert(std::make_pair(hash, inserted));
+	pthread_mutex_unlock(&mMutex);
+	return true;
+}
+
+/**
+ * @brief Remove entry from timeline and index. Caller holds mMutex
+ */
+void AampTimedMetadataStore::Erase(Timeline::iterator it)
+{
+	auto range = mIndex.equal_range(it->second.hash);
+	for (auto indexIt = range.first; indexIt != range.second; ++indexIt)
+	{
+		if (indexIt->second == it)
+		{
+			mIndex.erase(indexIt);
+			break;
+		}
+	}
+	mTimeline.erase(it);
+}
+
+/**
+ * @brief Remove entries older than limit. Entries at time 0 carry stream level tags and are kept
+ * @param[in] limitMS culled position in milliseconds
+ * @retval number of entries removed
+ */
+int AampTimedMetadataStore::Cull(long long limitMS)
+{
+	int count = 0;
+	pthread_mutex_lock(&mMutex);
+	Timeline::iterator end = mTimeline.lower_bound(limitMS);
+	for (Timeline::iterator it = mTimeline.begin(); it != end; )
+	{
+		// For X-CONTENT-IDENTIFIER, -X-IDENTITY-ADS, X-MESSAGE_REF in DASH which has _timeMS as 0
+		if (it->first == 0)
+		{
+			it = mTimeline.upper_bound(0);
+			continue;
+		}
+		Erase(it++);
+		count++;
+	}
+	pthread_mutex_unlock(&mMutex);
+	return count;
+}
+
+/**
+ * @brief Get entries added since previous call, in time order, and mark them reported
+ * @param[out] entries copies of unreported entries
+ */
+void AampTimedMetadataStore::TakeUnreported(std::vector<TimedMetadata> &entries)
+{
+	entries.clear();
+	pthread_mutex_lock(&mMutex);
+	if (mReportedSequence != mNextSequence)
+	{
+		entries.reserve(std::min<size_t>(mNextSequence - mReportedSequence, mTimeline.size()));
+		for (const auto &item : mTimeline)
+		{
+			if (item.second.sequence >= mReportedSequence)
+			{
+				entries.push_back(item.second.metadata);
+			}
+		}
+		mReportedSequence = mNextSequence;
+	}
+	pthread_mutex_unlock(&mMutex);
+}
+
+/**
+ * @brief Get all entries in time order
+ * @retval copies of stored entries
+ */
+std::vector<TimedMetadata> AampTimedMetadataStore::Snapshot()
+{
+	std::vector<TimedMetadata> entries;
+	pthread_mutex_lock(&mMutex);
+	entries.reserve(mTimeline.size());
+	for (const auto &item : mTimeline)
+	{
+		entries.push_back(item.second.metadata);
+	}
+	pthread_mutex_unlock(&mMutex);
+	return entries;
+}
+
+/**
+ * @brief Remove all entries
+ */
+void AampTimedMetadataStore::Clear()
+{
+	pthread_mutex_lock(&mMutex);
+	mIndex.clear();
+	mTimeline.clear();
+	mReportedSequence = mNextSequence;
+	pthread_mutex_unlock(&mMutex);
+}
+
+/**
+ * @brief Get number of stored entries
+ */
+size_t AampTimedMetadataStore::Size()
+{
+	pthread_mutex_lock(&mMutex);
+	size_t size = mTimeline.size();
+	pthread_mutex_unlock(&mMutex);
+	return size;
+}
+
+/**
+ * @brief Check if store has no entries
+ */
+bool AampTimedMetadataStore::Empty()
+{
+	return Size() == 0;
+}
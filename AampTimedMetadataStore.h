@@ -0,0 +1,158 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampTimedMetadataStore.h
+ * @brief Time ordered, deduplicated store of timed metadata
+ */
+
+#ifndef __AAMP_TIMED_METADATA_STORE_H__
+#define __AAMP_TIMED_METADATA_STORE_H__
+
+#include <pthread.h>
+#include <map>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+#define TIMED_METADATA_DUPLICATE_TOLERANCE_MS 1000    /**< Entries with same name and content this close in time are duplicates */
+
+/**
+ * @brief Class for Timed Metadata
+ */
+class TimedMetadata
+{
+public:
+
+	/**
+	 * @brief TimedMetadata Constructor
+	 */
+	TimedMetadata() : _timeMS(0), _name(""), _content(""), _id(""), _durationMS(0) {}
+
+	/**
+	 * @brief TimedMetadata Constructor
+	 *
+	 * @param[in] timeMS - Time in milliseconds
+	 * @param[in] name - Metadata name
+	 * @param[in] content - Metadata content
+	 */
+	TimedMetadata(long long timeMS, std::string name, std::string content, std::string id, double durMS) : _timeMS(timeMS), _name(name), _content(content), _id(id), _durationMS(durMS) {}
+
+public:
+	long long _timeMS;     /**< Time in milliseconds */
+	std::string _name;       /**< Metadata name */
+	std::string _content;    /**< Metadata content */
+	std::string _id;         /**< Id of the timedMetadata. If not available an Id will bre created */
+	double      _durationMS; /**< Duration in milliseconds */
+};
+
+/**
+ * @brief Timed metadata of the current playback, ordered by time.
+ *
+ * Live playlists repeat the same tags on every refresh. Entries are indexed by a hash of
+ * name and content so a repeated tag is found without scanning the store, and culling walks
+ * only the expired head of the timeline. Entries keep an insertion sequence number so bulk
+ * reporting can pick up only the entries added since the previous report.
+ * Entries are added from fetcher threads and read from the application thread, so all
+ * access is serialized by an internal mutex and readers get copies.
+ */
+class AampTimedMetadataStore
+{
+public:
+	/**
+	 * @brief AampTimedMetadataStore constructor
+	 */
+	AampTimedMetadataStore();
+
+	/**
+	 * @brief AampTimedMetadataStore destructor
+	 */
+	~AampTimedMetadataStore();
+
+	AampTimedMetadataStore(const AampTimedMetadataStore&) = delete;
+	AampTimedMetadataStore& operator=(const AampTimedMetadataStore&) = delete;
+
+	/**
+	 * @brief Add entry unless an entry with same name and content exists within the duplicate tolerance
+	 * @param[in] timeMS time of metadata in milliseconds
+	 * @param[in] name metadata name
+	 * @param[in] content metadata content
+	 * @param[in] id metadata id
+	 * @param[in] durationMS duration in milliseconds
+	 * @retval true if added, false for a duplicate
+	 */
+	bool Add(long long timeMS, const std::string &name, const std::string &content, const std::string &id, double durationMS);
+
+	/**
+	 * @brief Remove entries older than limit. Entries at time 0 carry stream level tags and are kept
+	 * @param[in] limitMS culled position in milliseconds
+	 * @retval number of entries removed
+	 */
+	int Cull(long long limitMS);
+
+	/**
+	 * @brief Get entries added since previous call, in time order, and mark them reported
+	 * @param[out] entries copies of unreported entries
+	 */
+	void TakeUnreported(std::vector<TimedMetadata> &entries);
+
+	/**
+	 * @brief Get all entries in time order
+	 * @retval copies of stored entries
+	 */
+	std::vector<TimedMetadata> Snapshot();
+
+	/**
+	 * @brief Remove all entries
+	 */
+	void Clear();
+
+	/**
+	 * @brief Get number of stored entries
+	 */
+	size_t Size();
+
+	/**
+	 * @brief Check if store has no entries
+	 */
+	bool Empty();
+
+private:
+	/**
+	 * @brief Stored entry
+	 */
+	struct Entry
+	{
+		TimedMetadata metadata;
+		size_t hash;                 /**< Hash of name and content */
+		unsigned long long sequence; /**< Insertion order */
+	};
+	typedef std::multimap<long long, Entry> Timeline;
+
+	static size_t Hash(const std::string &name, const std::string &content);
+	void Erase(Timeline::iterator it);
+
+	pthread_mutex_t mMutex;                                         /**< Protects all members below */
+	Timeline mTimeline;                                             /**< Entries by time */
+	std::unordered_multimap<size_t, Timeline::iterator> mIndex;     /**< Entries by hash of name and content */
+	unsigned long long mNextSequence;                               /**< Sequence number of next added entry */
+	unsigned long long mReportedSequence;                           /**< Entries below this sequence number were reported */
+};
+
+#endif /* __AAMP_TIMED_METADATA_STORE_H__ */
@@ -53,6 +53,18 @@
 #define RAND_STRING_LEN (MAC_STRING_LEN + 2*URAND_STRING_LEN)
 #define MAX_BUFF_LENGTH 4096 
 
+static long long (*gTimeSource)(void) = NULL; /**< Clock replacing system clock, NULL if none */
+
+/**
+ * @brief Replace clock of aamp_GetCurrentTimeMS, for simulation with a virtual clock
+ *
+ * @param[in] timeSource - function returning current time in milliseconds, NULL for system clock
+ */
+void aamp_SetTimeSource(long long (*timeSource)(void))
+{
+	gTimeSource = timeSource;
+}
+
 /**
  * @brief Get current time stamp
  *
@@ -60,6 +72,10 @@
  */
 long long aamp_GetCurrentTimeMS(void)
 {
+	if (gTimeSource)
+	{
+		return gTimeSource();
+	}
 	struct timeval t;
 	gettimeofday(&t, NULL);
 	return (long long)(t.tv_sec*1e3 + t.tv_usec*1e-3);
@@ -46,6 +46,13 @@
  */
 long long aamp_GetCurrentTimeMS(void); //TODO: Use NOW_STEADY_TS_MS/NOW_SYSTEM_TS_MS instead
 
+/**
+ * @brief Replace clock of aamp_GetCurrentTimeMS, for simulation with a virtual clock
+ *
+ * @param[in] timeSource - function returning current time in milliseconds, NULL for system clock
+ */
+void aamp_SetTimeSource(long long (*timeSource)(void));
+
 /**
  * @brief Get curl IPRESOLVE based on current IP protocol
  *
@@ -0,0 +1,263 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampWorkerPool.cpp
+ * @brief Bounded worker thread pool for short lived player tasks
+ */
+
+#include "AampWorkerPool.h"
+#include "priv_aamp.h"
+
+/**
+ * @brief State of a worker pool task
+ */
+enum AampTaskState
+{
+	eAAMP_TASK_QUEUED,
+	eAAMP_TASK_RUNNING,
+	eAAMP_TASK_DONE
+};
+
+/**
+ * @brief Worker pool task
+ */
+struct AampWorkerTask
+{
+	const char *name;           /**< Task name */
+	void *(*func)(void *);      /**< Task entry point */
+	void *arg;                  /**< Argument of entry point */
+	void *result;               /**< Return value of entry point */
+	AampTaskPriority priority;  /**< Task priority */
+	AampTaskState state;        /**< Execution state */
+	long long submitTimeMs;     /**< Time of submit */
+	long long startTimeMs;      /**< Time execution started */
+	long long endTimeMs;        /**< Time execution completed */
+};
+
+/**
+ * @brief AampWorkerPool constructor
+ * @param name name used in logs
+ * @param maxThreads max number of worker threads
+ */
+AampWorkerPool::AampWorkerPool(const char *name, int maxThreads) : mName(name), mMaxThreads(maxThreads), mIdleThreads(0),
+	mStop(false), mMutex(), mTaskQueued(), mTaskDone(), mQueue(), mThreads()
+{
+	if (mMaxThreads < 1)
+	{
+		mMaxThreads = 1;
+	}
+	pthread_mutex_init(&mMutex, NULL);
+	pthread_cond_init(&mTaskQueued, NULL);
+	pthread_cond_init(&mTaskDone, NULL);
+}
+
+/**
+ * @brief AampWorkerPool destructor, waits for running tasks and stops workers
+ */
+AampWorkerPool::~AampWorkerPool()
+{
+	pthread_mutex_lock(&mMutex);
+	mStop = true;
+	for (int i = 0; i < eAAMP_TASK_PRIORITY_COUNT; i++)
+	{
+		if (!mQueue[i].empty())
+		{
+			AAMPLOG_WARN("%s:%d [%s] %d tasks of priority %d were never joined", __FUNCTION__, __LINE__, mName, (int)mQueue[i].size(), i);
+		}
+	}
+	pthread_cond_broadcast(&mTaskQueued);
+	pthread_mutex_unlock(&mMutex);
+	for (pthread_t thread : mThreads)
+	{
+		pthread_join(thread, NULL);
+	}
+	logprintf("%s:%d [%s] stopped %d worker threads", __FUNCTION__, __LINE__, mName, (int)mThreads.size());
+	pthread_cond_destroy(&mTaskDone);
+	pthread_cond_destroy(&mTaskQueued);
+	pthread_mutex_destroy(&mMutex);
+}
+
+/**
+ * @brief Queue task for execution
+ * @param name task name used in logs and timing
+ * @param func task entry point
+ * @param arg argument passed to func
+ * @param priority task priority
+ * @retval task handle to be joined, NULL on failure
+ */
+AampWorkerTask* AampWorkerPool::Submit(const char *name, void *(*func)(void *), void *arg, AampTaskPriority priority)
+{
+	AampWorkerTask *task = new AampWorkerTask();
+	task->name = name;
+	task->func = func;
+	task->arg = arg;
+	task->result = NULL;
+	task->priority = priority;
+	task->state = eAAMP_TASK_QUEUED;
+	task->submitTimeMs = aamp_GetCurrentTimeMS();
+	task->startTimeMs = 0;
+	task->endTimeMs = 0;
+
+	pthread_mutex_lock(&mMutex);
+	if (mStop)
+	{
+		pthread_mutex_unlock(&mMutex);
+		delete task;
+		return NULL;
+	}
+	mQueue[priority].push_back(task);
+	if (mIdleThreads == 0 && (int)mThreads.size() < mMaxThreads)
+	{
+		pthread_t thread;
+		if (0 == pthread_create(&thread, NULL, &WorkerThread, this))
+		{
+			mThreads.push_back(thread);
+		}
+		else
+		{
+			// task stays queued, it runs on an existing worker or on the joining thread
+			AAMPLOG_ERR("%s:%d [%s] pthread_create failed for worker errno = %d, %s", __FUNCTION__, __LINE__, mName, errno, strerror(errno));
+		}
+	}
+	pthread_cond_signal(&mTaskQueued);
+	pthread_mutex_unlock(&mMutex);
+	return task;
+}
+
+/**
+ * @brief Wait for task completion and release its handle
+ * @param task handle returned by Submit
+ * @param[out] timing timing of the task, may be NULL
+ * @retval value returned by task entry point
+ */
+void* AampWorkerPool::Join(AampWorkerTask *task, AampTaskTiming *timing)
+{
+	void *result = NULL;
+	if (task)
+	{
+		bool runHere = false;
+		pthread_mutex_lock(&mMutex);
+		if (eAAMP_TASK_QUEUED == task->state)
+		{
+			std::deque<AampWorkerTask *> &queue = mQueue[task->priority];
+			for (auto it = queue.begin(); it != queue.end(); it++)
+			{
+				if (*it == task)
+				{
+					queue.erase(it);
+					break;
+				}
+			}
+			task->state = eAAMP_TASK_RUNNING;
+			runHere = true;
+		}
+		pthread_mutex_unlock(&mMutex);
+
+		if (runHere)
+		{
+			RunTask(task);
+			pthread_mutex_lock(&mMutex);
+			task->state = eAAMP_TASK_DONE;
+		}
+		else
+		{
+			pthread_mutex_lock(&mMutex);
+			while (eAAMP_TASK_DONE != task->state)
+			{
+				pthread_cond_wait(&mTaskDone, &mMutex);
+			}
+		}
+		pthread_mutex_unlock(&mMutex);
+
+		long long queuedMs = task->startTimeMs - task->submitTimeMs;
+		long long runMs = task->endTimeMs - task->startTimeMs;
+		AAMPLOG_INFO("%s:%d [%s] task %s queued %lld ms run %lld ms%s", __FUNCTION__, __LINE__, mName, task->name, queuedMs, runMs, runHere ? " (on joining thread)" : "");
+		if (timing)
+		{
+			timing->queuedMs = queuedMs;
+			timing->runMs = runMs;
+		}
+		result = task->result;
+		delete task;
+	}
+	return result;
+}
+
+/**
+ * @brief Execute task entry point, recording its timing
+ * @param task task to run
+ */
+void AampWorkerPool::RunTask(AampWorkerTask *task)
+{
+	task->startTimeMs = aamp_GetCurrentTimeMS();
+	task->result = task->func(task->arg);
+	task->endTimeMs = aamp_GetCurrentTimeMS();
+}
+
+/**
+ * @brief Worker thread entry point
+ * @param arg pointer to AampWorkerPool
+ * @retval NULL
+ */
+void* AampWorkerPool::WorkerThread(void *arg)
+{
+	if(aamp_pthread_setname(pthread_self(), "aampWorker"))
+	{
+		AAMPLOG_WARN("%s:%d: aamp_pthread_setname failed", __FUNCTION__, __LINE__);
+	}
+	static_cast<AampWorkerPool *>(arg)->WorkerLoop();
+	return NULL;
+}
+
+/**
+ * @brief Run queued tasks, most urgent priority first, until pool is stopped
+ */
+void AampWorkerPool::WorkerLoop()
+{
+	pthread_mutex_lock(&mMutex);
+	while (!mStop)
+	{
+		AampWorkerTask *task = NULL;
+		for (int i = 0; i < eAAMP_TASK_PRIORITY_COUNT && !task; i++)
+		{
+			if (!mQueue[i].empty())
+			{
+				task = mQueue[i].front();
+				mQueue[i].pop_front();
+			}
+		}
+		if (!task)
+		{
+			mIdleThreads++;
+			pthread_cond_wait(&mTaskQueued, &mMutex);
+			mIdleThreads--;
+			continue;
+		}
+		task->state = eAAMP_TASK_RUNNING;
+		pthread_mutex_unlock(&mMutex);
+
+		RunTask(task);
+
+		pthread_mutex_lock(&mMutex);
+		task->state = eAAMP_TASK_DONE;
+		pthread_cond_broadcast(&mTaskDone);
+	}
+	pthread_mutex_unlock(&mMutex);
+}
@@ -0,0 +1,115 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file AampWorkerPool.h
+ * @brief Bounded worker thread pool for short lived player tasks
+ */
+
+#ifndef __AAMP_WORKER_POOL_H__
+#define __AAMP_WORKER_POOL_H__
+
+#include <deque>
+#include <vector>
+#include <pthread.h>
+
+#define DEFAULT_WORKER_POOL_THREADS 4    /**< Default max number of worker threads per player */
+
+/**
+ * @brief Priority of a worker pool task
+ */
+enum AampTaskPriority
+{
+	eAAMP_TASK_PRIORITY_TUNE,          /**< Task on the tune/period change critical path, runs first */
+	eAAMP_TASK_PRIORITY_BACKGROUND,    /**< Task which can wait for tune critical tasks */
+	eAAMP_TASK_PRIORITY_COUNT
+};
+
+/**
+ * @brief Timing of a completed worker pool task
+ */
+struct AampTaskTiming
+{
+	long long queuedMs;    /**< Time from submit to start of execution */
+	long long runMs;       /**< Execution time */
+};
+
+struct AampWorkerTask;
+
+/**
+ * @brief Runs short lived tasks on a bounded set of reused threads instead of a thread per task.
+ *
+ * Tasks keep pthread entry point signature, so thread functions can be submitted as they are.
+ * Every submitted task must be joined exactly once with Join(), like a joinable pthread. A task
+ * joined before a worker picked it up runs on the joining thread, so joins from within tasks
+ * can not deadlock the pool. Threads are created on demand up to the configured maximum.
+ */
+class AampWorkerPool
+{
+public:
+	/**
+	 * @brief AampWorkerPool constructor
+	 * @param name name used in logs
+	 * @param maxThreads max number of worker threads
+	 */
+	AampWorkerPool(const char *name, int maxThreads);
+
+	/**
+	 * @brief AampWorkerPool destructor, waits for running tasks and stops workers
+	 */
+	~AampWorkerPool();
+
+	AampWorkerPool(const AampWorkerPool&) = delete;
+	AampWorkerPool& operator=(const AampWorkerPool&) = delete;
+
+	/**
+	 * @brief Queue task for execution
+	 * @param name task name used in logs and timing
+	 * @param func task entry point
+	 * @param arg argument passed to func
+	 * @param priority task priority
+	 * @retval task handle to be joined, NULL on failure
+	 */
+	AampWorkerTask* Submit(const char *name, void *(*func)(void *), void *arg, AampTaskPriority priority);
+
+	/**
+	 * @brief Wait for task completion and release its handle
+	 * @param task handle returned by Submit
+	 * @param[out] timing timing of the task, may be NULL
+	 * @retval value returned by task entry point
+	 */
+	void* Join(AampWorkerTask *task, AampTaskTiming *timing = NULL);
+
+private:
+	static void* WorkerThread(void *arg);
+	void WorkerLoop();
+	static void RunTask(AampWorkerTask *task);
+
+	const char *mName;                                     /**< Pool name for logging */
+	int mMaxThreads;                                       /**< Max number of worker threads */
+	int mIdleThreads;                                      /**< Workers waiting for a task */
+	bool mStop;                                            /**< Set on destruction */
+	pthread_mutex_t mMutex;                                /**< Protects queues and task states */
+	pthread_cond_t mTaskQueued;                            /**< Signaled on new task or stop */
+	pthread_cond_t mTaskDone;                              /**< Signaled when a task completes */
+	std::deque<AampWorkerTask *> mQueue[eAAMP_TASK_PRIORITY_COUNT];   /**< Pending tasks per priority */
+	std::vector<pthread_t> mThreads;                       /**< Worker threads */
+};
+
+#endif /* __AAMP_WORKER_POOL_H__ */
@@ -83,6 +83,19 @@ GlobalConfigAAMP::GlobalConfigAAMP():
 	, mTimeoutForSourceSetup(DEFAULT_TIMEOUT_FOR_SOURCE_SETUP)
 	, midFragmentSeekEnabled(false)
 	,mEnableSeekableRange(eUndefinedState)
+	,incrementalPlaylistIndex(false)
+	,aesStreamingDecrypt(false)
+	,fragmentDownloadConcurrency(DEFAULT_FRAGMENT_DOWNLOAD_CONCURRENCY)
+	,maxInitFragmentCacheSize(MAX_INIT_FRAGMENT_CACHE_SIZE)
+	,maxCachedFragmentBytesPerTrack(0)
+	,maxCachedFragmentSecondsPerTrack(0)
+	,parallelLicenseAcquisition(true)
+	,drmSessionCacheTTL(0)
+	,parallelTsDemux(false)
+	,abrThroughputEstimate(false)
+	,abrAbortSlowFragment(false)
+	,progressiveChunkSize(0)
+	,playbackProfileInterval(0)
 {
 	//XRE sends onStreamPlaying while receiving onTuned event.
 	//onVideoInfo depends on the metrics received from pipe.
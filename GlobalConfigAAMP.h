@@ -46,6 +46,7 @@
 #define DEFAULT_ABR_NW_CONSISTENCY_CNT 2            /**< ABR network consistency count */
 
 #define DEFAULT_CACHED_FRAGMENTS_PER_TRACK  3       /**< Default cached fragements per track */
+#define DEFAULT_FRAGMENT_DOWNLOAD_CONCURRENCY 1     /**< Default outstanding fragment downloads per track */
 #define DEFAULT_BUFFER_HEALTH_MONITOR_DELAY 10
 #define DEFAULT_BUFFER_HEALTH_MONITOR_INTERVAL 5
 #define DEFAULT_DISCONTINUITY_TIMEOUT 3000          /**< Default discontinuity timeout after cache is empty in MS */
@@ -78,6 +79,7 @@
 
 // HLS CDVR/VOD playlist size for 1hr -> 225K , 2hr -> 450-470K , 3hr -> 670K . Most played CDVR/Vod < 2hr
 #define MAX_PLAYLIST_CACHE_SIZE    (3*1024*1024) // Approx 3MB -> 2 video profiles + one audio profile + one iframe profile, 500-700K MainManifest
+#define MAX_INIT_FRAGMENT_CACHE_SIZE (1024*1024) // 1MB -> init fragments of all profiles of a typical multi-period asset
 #define DEFAULT_WAIT_TIME_BEFORE_RETRY_HTTP_5XX_MS (1000)    /**< Wait time in milliseconds before retry for 5xx errors */
 
 #define DEFAULT_TIMEOUT_FOR_SOURCE_SETUP (1000) /**< Default timeout value in milliseconds */
@@ -240,6 +242,19 @@ public:
 	TriState preferredCEA708; /*** To force 608/708 track selection in CC manager */
 	long mTimeoutForSourceSetup; /**< Max time to wait for gstreamer source to complete setup*/
 	TriState mEnableSeekableRange; /*** To force enable seekable range reporting in progress event */
+	bool incrementalPlaylistIndex; /**< Reuse index of fragments retained across HLS live playlist refresh */
+	bool aesStreamingDecrypt; /**< Decrypt HLS AES-128 fragments while they are downloaded */
+	int fragmentDownloadConcurrency; /**< Max outstanding fragment downloads per track */
+	int maxInitFragmentCacheSize; /**< Max size in bytes of init fragment cache */
+	int maxCachedFragmentBytesPerTrack; /**< Max bytes of fetched fragments cached per track, 0 for no limit */
+	double maxCachedFragmentSecondsPerTrack; /**< Max duration of fetched fragments cached per track, 0 for no limit */
+	bool parallelLicenseAcquisition; /**< Issue license requests of different keys concurrently */
+	int drmSessionCacheTTL; /**< Seconds a licensed DRM session stays reusable across tunes, 0 for no expiry */
+	bool parallelTsDemux; /**< Demux audio and video of muxed HLS TS segments concurrently */
+	bool abrThroughputEstimate; /**< Sample throughput during video fragment downloads for ABR */
+	bool abrAbortSlowFragment; /**< Abort video fragment download which can not complete in time at current throughput */
+	int progressiveChunkSize; /**< Size in bytes of range requests for progressive mp4 with appsrc, 0 to stream whole file */
+	int playbackProfileInterval; /**< Seconds between playback profile events, 0 for no events */
 public:
 
 	/**
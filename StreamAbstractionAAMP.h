@@ -26,8 +26,10 @@
 #define STREAMABSTRACTIONAAMP_H
 
 #include "AampMemoryUtils.h"
+#include "AampDiscontinuityCounter.h"
 #include "priv_aamp.h"
 #include <map>
+#include <atomic>
 #include <iterator>
 #include <vector>
 
@@ -68,6 +70,8 @@ struct StreamInfo
 
 
 
+#define FRAGMENT_BUFFER_SIZE_MARGIN 1.25   /**< Headroom over bitrate x duration when pre-sizing fragment buffers */
+
 /**
  * @brief Structure of cached fragment data
  *        Holds information about a cached fragment
@@ -78,7 +82,10 @@ struct CachedFragment
 	double position;            /**< Position in the playlist */
 	double duration;            /**< Fragment duration */
 	bool discontinuity;         /**< PTS discontinuity status */
+	bool countedDiscontinuity;  /**< Discontinuity still counted in cachedDiscontinuities of track; Updated internally */
 	int profileIndex;           /**< Profile index; Updated internally */
+	size_t cachedSize;          /**< Fragment size accounted to track cache budget; Updated internally */
+	long long cachedMs;         /**< Fragment duration accounted to track cache budget; Updated internally */
 #ifdef AAMP_DEBUG_INJECT
 	std::string uri;   /**< Fragment url */
 #endif
@@ -261,6 +268,27 @@ public:
 	 */
 	double GetTotalFetchedDuration() { return totalFetchedDuration; };
 
+	/**
+	 * @brief Get duration of fetched fragments waiting in cache for injection
+	 *
+	 * @return Cached duration in seconds
+	 */
+	double GetCachedFragmentDuration();
+
+	/**
+	 * @brief Get buffered duration ahead of play position, in fragment cache and in sink
+	 *
+	 * @return Buffered duration in seconds
+	 */
+	double GetTotalBufferedDuration();
+
+	/**
+	 * @brief Check if fragment cache reached its slot, byte or duration budget
+	 *
+	 * @return true if no more fragments to be cached
+	 */
+	bool IsFragmentCacheFull();
+
 	/**
 	 * @brief Check if discontinuity is being processed
 	 *
@@ -320,6 +348,14 @@ public:
 	 */
 	void FlushFragments();
 
+	/**
+	 * @brief Return a fragment buffer to the buffer pool of the track for reuse
+	 *
+	 * @param[in] buffer - Buffer to recycle, reset on return
+	 * @return void
+	 */
+	void ReleaseFragmentBuffer(GrowableBuffer *buffer);
+
 protected:
 
 	/**
@@ -366,10 +402,25 @@ protected:
 private:
 	static const char* GetBufferHealthStatusString(BufferHealthStatus status);
 
+	/**
+	 * @brief Get a pooled or newly allocated buffer, pre-sized for the upcoming fragment
+	 *
+	 * @param[out] buffer - Empty buffer to be filled by fragment download
+	 * @return void
+	 */
+	void AcquireFragmentBuffer(GrowableBuffer *buffer);
+
+	/**
+	 * @brief Estimate size of the upcoming fragment from profile bitrate and fragment duration
+	 *
+	 * @return expected size in bytes, 0 if unknown
+	 */
+	size_t GetExpectedFragmentSize();
+
 public:
 	bool eosReached;                    /**< set to true when a vod asset has been played to completion */
 	bool enabled;                       /**< set to true if track is enabled */
-	int numberOfFragmentsCached;        /**< Number of fragments cached in this track*/
+	std::atomic<int> numberOfFragmentsCached; /**< Number of fragments cached in this track, published by fetcher and released by injector*/
 	const char* name;                   /**< Track name used for debugging*/
 	double fragmentDurationSeconds;     /**< duration in seconds for current fragment-of-interest */
 	int segDLFailCount;                 /**< Segment download fail count*/
@@ -385,6 +436,7 @@ protected:
 	pthread_mutex_t mutex;              /**< protection of track variables accessed from multiple threads */
 	bool ptsError;                      /**< flag to indicate if last injected fragment has ptsError */
 	bool abortInject;                   /**< Abort inject operations if flag is set*/
+	AampBufferPool *mFragmentBufferPool; /**< Reusable fragment buffers, shared with blocks held by sink */
 private:
 	pthread_cond_t fragmentFetched;     /**< Signaled after a fragment is fetched*/
 	pthread_cond_t fragmentInjected;    /**< Signaled after a fragment is injected*/
@@ -397,10 +449,15 @@ private:
 	int currentInitialCacheDurationSeconds;    /**< Current cached fragments duration before playing*/
 	bool sinkBufferIsFull;                /**< True if sink buffer is full and do not want new fragments*/
 	bool cachingCompleted;              /**< Fragment caching completed or not*/
-	int fragmentIdxToInject;            /**< Write position */
-	int fragmentIdxToFetch;             /**< Read position */
+	std::atomic<int> fragmentIdxToInject; /**< Read position, owned by injector */
+	int fragmentIdxToFetch;             /**< Write position, owned by fetcher */
 	int bandwidthBitsPerSecond;        /**< Bandwidth of last selected profile*/
 	double totalFetchedDuration;        /**< Total fragment fetched duration*/
+	std::atomic<size_t> cachedFragmentBytes; /**< Size of fragments waiting in cache*/
+	std::atomic<long long> cachedFragmentMs; /**< Duration of fragments waiting in cache*/
+	AampDiscontinuityCounter cachedDiscontinuities; /**< Unprocessed discontinuities waiting in cache, read by other tracks*/
+	std::atomic<bool> fetcherWaiting;   /**< Fetcher blocked on fragmentInjected, injector signals only then */
+	std::atomic<bool> injectorWaiting;  /**< Injector blocked on fragmentFetched, fetcher signals only then */
 	bool discontinuityProcessed;
 
 	BufferHealthStatus bufferStatus;     /**< Buffer status of the track*/
@@ -179,6 +179,9 @@ struct AAMPGstPlayerPriv
 #endif
 	int32_t lastId3DataLen; // last sent ID3 data length
 	uint8_t *lastId3Data; // ptr with last sent ID3 data
+	std::atomic<long long> bytesCopied; // bytes copied into new GstBuffers since copyStatsStartMS
+	std::atomic<long long> bytesWrapped; // bytes wrapped into GstBuffers without copy since copyStatsStartMS
+	std::atomic<long long> copyStatsStartMS; // start of current copy statistics interval
 };
 
 /**
@@ -2001,6 +2004,63 @@ uint32_t getId3TagSize(const uint8_t *data, size_t &len0)
  * @param[in] fDuration duration of buffer (in sec)
  */
 void AAMPGstPlayer::Send(MediaType mediaType, const void *ptr, size_t len0, double fpts, double fdts, double fDuration)
+{
+	SendHelper(mediaType, NULL, ptr, len0, fpts, fdts, fDuration);
+}
+
+
+/**
+ * @brief Inject part of a shared block of a stream type to its pipeline without copying
+ * @param[in] mediaType stream type
+ * @param[in] block reference counted block holding the data; a reference is taken for each GstBuffer
+ * @param[in] ptr start of data within block
+ * @param[in] len0 length of data
+ * @param[in] fpts PTS of buffer (in sec)
+ * @param[in] fdts DTS of buffer (in sec)
+ * @param[in] fDuration duration of buffer (in sec)
+ */
+void AAMPGstPlayer::Send(MediaType mediaType, AampSharedBlock* block, const void *ptr, size_t len0, double fpts, double fdts, double fDuration)
+{
+	SendHelper(mediaType, block, ptr, len0, fpts, fdts, fDuration);
+}
+
+
+/**
+ * @brief Account bytes injected to pipeline, logs copied and zero-copy throughput once a second
+ * @param[in] bytesCopied bytes copied into newly allocated GstBuffers
+ * @param[in] bytesWrapped bytes handed over without copy
+ */
+void AAMPGstPlayer::UpdateCopyStatistics(size_t bytesCopied, size_t bytesWrapped)
+{
+	privateContext->bytesCopied += bytesCopied;
+	privateContext->bytesWrapped += bytesWrapped;
+	long long now = aamp_GetCurrentTimeMS();
+	long long start = privateContext->copyStatsStartMS;
+	if (0 == start)
+	{
+		privateContext->copyStatsStartMS.compare_exchange_strong(start, now);
+	}
+	else if ((now - start) >= 1000 && privateContext->copyStatsStartMS.compare_exchange_strong(start, now))
+	{
+		long long copied = privateContext->bytesCopied.exchange(0);
+		long long wrapped = privateContext->bytesWrapped.exchange(0);
+		AAMPLOG_INFO("%s:%d bytes copied %lld/s zero-copy %lld/s", __FUNCTION__, __LINE__,
+			(copied * 1000) / (now - start), (wrapped * 1000) / (now - start));
+	}
+}
+
+
+/**
+ * @brief Inject stream buffer to gstreamer pipeline, copying unless a shared block is given
+ * @param[in] mediaType stream type
+ * @param[in] block shared block holding ptr, NULL to copy the data
+ * @param[in] ptr buffer pointer
+ * @param[in] len0 length of buffer
+ * @param[in] fpts PTS of buffer (in sec)
+ * @param[in] fdts DTS of buffer (in sec)
+ * @param[in] fDuration duration of buffer (in sec)
+ */
+void AAMPGstPlayer::SendHelper(MediaType mediaType, AampSharedBlock* block, const void *ptr, size_t len0, double fpts, double fdts, double fDuration)
 {
 #define MAX_BYTES_TO_SEND (128*1024)
 	GstClockTime pts = (GstClockTime)(fpts * GST_SECOND);
@@ -2126,7 +2186,19 @@ void AAMPGstPlayer::Send(MediaType mediaType, const void *ptr, size_t len0, doub
 		{
 			len = maxBytes;
 		}
-		GstBuffer *buffer = gst_buffer_new_and_alloc((guint)len);
+		GstBuffer *buffer;
+	#ifdef USE_GST1
+		if (block)
+		{
+			// GstBuffer holds a reference on the block, released by gstreamer when buffer is freed
+			aamp_SharedBlockRef(block);
+			buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY, (gpointer)ptr, len, 0, len, block, aamp_SharedBlockUnref);
+		}
+		else
+	#endif
+		{
+			buffer = gst_buffer_new_and_alloc((guint)len);
+		}
 		if(buffer != NULL)
 		{
 			if (discontinuity )
@@ -2135,15 +2207,24 @@ void AAMPGstPlayer::Send(MediaType mediaType, const void *ptr, size_t len0, doub
 				discontinuity = FALSE;
 			}
 	#ifdef USE_GST1
-			GstMapInfo map;
-			gst_buffer_map(buffer, &map, GST_MAP_WRITE);
-			memcpy(map.data, ptr, len);
-			gst_buffer_unmap(buffer, &map);
+			if (block)
+			{
+				UpdateCopyStatistics(0, len);
+			}
+			else
+			{
+				GstMapInfo map;
+				gst_buffer_map(buffer, &map, GST_MAP_WRITE);
+				memcpy(map.data, ptr, len);
+				gst_buffer_unmap(buffer, &map);
+				UpdateCopyStatistics(len, 0);
+			}
 			GST_BUFFER_PTS(buffer) = pts;
 			GST_BUFFER_DTS(buffer) = dts;
 		//GST_BUFFER_DURATION(buffer) = duration;
 	#else
 			memcpy(GST_BUFFER_DATA(buffer), ptr, len);
+			UpdateCopyStatistics(len, 0);
 			GST_BUFFER_TIMESTAMP(buffer) = pts;
 			GST_BUFFER_DURATION(buffer) = duration;
 	#endif
@@ -2278,6 +2359,7 @@ void AAMPGstPlayer::Send(MediaType mediaType, GrowableBuffer* pBuffer, double fp
 	GST_BUFFER_DURATION(buffer) = duration;
 #endif
 
+	UpdateCopyStatistics(0, pBuffer->len);
 	GstFlowReturn ret = gst_app_src_push_buffer(GST_APP_SRC(stream->source), buffer);
 	if (ret != GST_FLOW_OK)
 	{
@@ -46,6 +46,7 @@ public:
 	void Configure(StreamOutputFormat format, StreamOutputFormat audioFormat, bool bESChangeStatus);
 	void Send(MediaType mediaType, const void *ptr, size_t len, double fpts, double fdts, double duration);
 	void Send(MediaType mediaType, GrowableBuffer* buffer, double fpts, double fdts, double duration);
+	void Send(MediaType mediaType, AampSharedBlock* block, const void *ptr, size_t len, double fpts, double fdts, double duration);
 	void EndOfStreamReached(MediaType type);
 	void Stream(void);
 	void Stop(bool keepLastFrame);
@@ -97,6 +98,8 @@ private:
 	void Flush(void);
 	void DisconnectCallbacks();
 	void FlushLastId3Data();
+	void SendHelper(MediaType mediaType, AampSharedBlock* block, const void *ptr, size_t len, double fpts, double fdts, double duration);
+	void UpdateCopyStatistics(size_t bytesCopied, size_t bytesWrapped);
 
 	pthread_mutex_t mBufferingLock;
 	pthread_mutex_t mProtectionLock;
@@ -25,6 +25,7 @@
 #include "admanager_mpd.h"
 #include "AampUtils.h"
 #include "fragmentcollector_mpd.h"
+#include "AampWorkerPool.h"
 #include <inttypes.h>
 
 #include <algorithm>
@@ -32,10 +33,6 @@
 static void *AdFulfillThreadEntry(void *arg)
 {
     PrivateCDAIObjectMPD *_this = (PrivateCDAIObjectMPD *)arg;
-    if(aamp_pthread_setname(pthread_self(), "aampADFulfill"))
-    {
-        logprintf("%s:%d: aamp_pthread_setname failed", __FUNCTION__, __LINE__);
-    }
     _this->FulFillAdObject();
     return NULL;
 }
@@ -61,7 +58,7 @@ void CDAIObjectMPD::SetAlternateContents(const std::string &periodId, const std:
 
 
 
-PrivateCDAIObjectMPD::PrivateCDAIObjectMPD(PrivateInstanceAAMP* aamp) : mAamp(aamp),mDaiMtx(), mIsFogTSB(false), mAdBreaks(), mPeriodMap(), mCurPlayingBreakId(), mAdObjThreadID(0), mAdFailed(false), mCurAds(nullptr),
+PrivateCDAIObjectMPD::PrivateCDAIObjectMPD(PrivateInstanceAAMP* aamp) : mAamp(aamp),mDaiMtx(), mIsFogTSB(false), mAdBreaks(), mPeriodMap(), mCurPlayingBreakId(), mAdObjTask(NULL), mAdFailed(false), mCurAds(nullptr),
 					mCurAdIdx(-1), mContentSeekOffset(0), mAdState(AdState::OUTSIDE_ADBREAK),mPlacementObj(), mAdFulfillObj()
 {
 	mAamp->CurlInit(eCURLINSTANCE_DAI,1,mAamp->GetNetworkProxy());
@@ -69,14 +66,10 @@ PrivateCDAIObjectMPD::PrivateCDAIObjectMPD(PrivateInstanceAAMP* aamp) : mAamp(aa
 
 PrivateCDAIObjectMPD::~PrivateCDAIObjectMPD()
 {
-	if(mAdObjThreadID)
+	if(mAdObjTask)
 	{
-		int rc = pthread_join(mAdObjThreadID, NULL);
-		if (rc != 0)
-		{
-			logprintf("%s:%d ***pthread_join failed, returned %d", __FUNCTION__, __LINE__, rc);
-		}
-		mAdObjThreadID = 0;
+		mAamp->GetWorkerPool()->Join(mAdObjTask);
+		mAdObjTask = NULL;
 	}
 	mAamp->CurlTerm(eCURLINSTANCE_DAI);
 }
@@ -495,7 +488,7 @@ MPD* PrivateCDAIObjectMPD::GetAdMPD(std::string &manifestUrl, bool &finalManifes
 	if (gotManifest)
 	{
 		finalManifest = true;
-		xmlTextReaderPtr reader = xmlReaderForMemory(manifest.ptr, (int) manifest.len, NULL, NULL, 0);
+		xmlTextReaderPtr reader = xmlReaderForMemory(manifest.ptr, (int) manifest.len, NULL, NULL, MPD_XML_PARSE_OPTIONS);
 		if(tryFog && !(gpGlobalConfig->playAdFromCDN) && reader && mIsFogTSB)	//Main content from FOG. Ad is expected from FOG.
 		{
 			std::string channelUrl = mAamp->GetManifestUrl();	//TODO: Get FOG URL from channel URL
@@ -528,7 +521,7 @@ MPD* PrivateCDAIObjectMPD::GetAdMPD(std::string &manifestUrl, bool &finalManifes
 				{
 					//FOG already has the manifest. Releasing the one from CDN and using FOG's
 					xmlFreeTextReader(reader);
-					reader = xmlReaderForMemory(fogManifest.ptr, (int) fogManifest.len, NULL, NULL, 0);
+					reader = xmlReaderForMemory(fogManifest.ptr, (int) fogManifest.len, NULL, NULL, MPD_XML_PARSE_OPTIONS);
 					aamp_Free(&manifest.ptr);
 					manifest = fogManifest;
 					fogManifest.ptr = NULL;
@@ -715,15 +708,11 @@ void PrivateCDAIObjectMPD::SetAlternateContents(const std::string &periodId, con
 	}
 	else
 	{
-		if(mAdObjThreadID)
+		if(mAdObjTask)
 		{
-			//Clearing the previous thread
-			int rc = pthread_join(mAdObjThreadID, NULL);
-			if(rc != 0)  //CID:101068 - Resolving the local variable rc initialized but not used
-			{
-				logprintf("%s:%d pthread_join(mAdObjThreadID) failed , errno = %d, %s , Rejecting promise.", __FUNCTION__,__LINE__,errno,strerror(errno));
-			}
-			mAdObjThreadID = 0;
+			//Clearing the previous task
+			mAamp->GetWorkerPool()->Join(mAdObjTask);
+			mAdObjTask = NULL;
 		}
 		if(isAdBreakObjectExist(periodId))
 		{
@@ -739,10 +728,11 @@ void PrivateCDAIObjectMPD::SetAlternateContents(const std::string &periodId, con
 				mAdFulfillObj.periodId = periodId;
 				mAdFulfillObj.adId = adId;
 				mAdFulfillObj.url = url;
-				int ret = pthread_create(&mAdObjThreadID, NULL, &AdFulfillThreadEntry, this);
-				if(ret != 0)
+				mAdObjTask = mAamp->GetWorkerPool()->Submit("AdFulfill", &AdFulfillThreadEntry, this, eAAMP_TASK_PRIORITY_BACKGROUND);
+				if(!mAdObjTask)
 				{
-					logprintf("%s:%d pthread_create(FulFillAdObject) failed, errno = %d, %s. Rejecting promise.", __FUNCTION__, __LINE__, errno, strerror(errno));
+					logprintf("%s:%d Submit(FulFillAdObject) failed. Rejecting promise.", __FUNCTION__, __LINE__);
+					ret = -1;
 				}
 			}
 			if(ret != 0)
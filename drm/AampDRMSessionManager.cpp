@@ -58,12 +58,18 @@
 
 #define INVALID_SESSION_SLOT -1
 #define DEFUALT_CDM_WAIT_TIMEOUT_MS 2000
+#define LICENSE_WAIT_INTERVAL_MS 100
 
 static const char *sessionTypeName[] = {"video", "audio"};
 
 static pthread_mutex_t drmSessionMutex = PTHREAD_MUTEX_INITIALIZER;
 
-KeyID::KeyID() : creationTime(0), isFailedKeyId(false), isPrimaryKeyId(false), data()
+KeyID::KeyID() : creationTime(0), licenseTime(0), isFailedKeyId(false), isPrimaryKeyId(false), isAcquiring(false), isInUse(false), data(), keySystem()
+{
+}
+
+DrmSessionCacheMetrics::DrmSessionCacheMetrics() : cacheHits(0), cacheMisses(0), cacheExpired(0), licenseRequests(0),
+		licenseFailures(0), licenseRoundTripTotalMs(0), licenseRoundTripMaxMs(0)
 {
 }
 
@@ -115,11 +121,12 @@ AampDRMSessionManager::AampDRMSessionManager() : drmSessionContexts(new DrmSessi
 		accessTokenLen(0), sessionMgrState(SessionMgrState::eSESSIONMGR_ACTIVE), accessTokenMutex(PTHREAD_MUTEX_INITIALIZER),
 		cachedKeyMutex(PTHREAD_MUTEX_INITIALIZER)
 		,curlSessionAbort(false), mEnableAccessAtrributes(true)
-		,mDrmSessionLock()
+		,mDrmSessionLock(), mLicenseAcquiredCond(), mKeySlotIndex(), mCacheMetrics()
 {
 	mEnableAccessAtrributes = gpGlobalConfig->getUnknownValue("enableAccessAttributes", true);
 	AAMPLOG_INFO("AccessAttribute : %s", mEnableAccessAtrributes? "enabled" : "disabled");
 	pthread_mutex_init(&mDrmSessionLock, NULL);
+	pthread_cond_init(&mLicenseAcquiredCond, NULL);
 }
 
 /**
@@ -129,6 +136,7 @@ AampDRMSessionManager::~AampDRMSessionManager()
 {
 	clearAccessToken();
 	clearSessionData();
+	pthread_cond_destroy(&mLicenseAcquiredCond);
 	pthread_mutex_destroy(&mDrmSessionLock);
 }
 
@@ -140,6 +148,7 @@ AampDRMSessionManager::~AampDRMSessionManager()
 void AampDRMSessionManager::clearSessionData()
 {
 	logprintf("%s:%d AampDRMSessionManager:: Clearing session data", __FUNCTION__, __LINE__);
+	mKeySlotIndex.clear();
 	for(int i = 0 ; i < gpGlobalConfig->dash_MaxDRMSessions; i++)
 	{
 		if (drmSessionContexts != NULL && drmSessionContexts[i].drmSession != NULL)
@@ -209,21 +218,23 @@ bool AampDRMSessionManager::getCurlAbort(){
  */
 void AampDRMSessionManager::clearFailedKeyIds()
 {
-	pthread_mutex_lock(&cachedKeyMutex);
+	AAMP_MUTEX_LOCK(cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
 	for(int i = 0 ; i < gpGlobalConfig->dash_MaxDRMSessions; i++)
 	{
 		if(cachedKeyIDs[i].isFailedKeyId)
 		{
 			if(!cachedKeyIDs[i].data.empty())
 			{
+				mKeySlotIndex.erase(getKeySlotIndexKey(cachedKeyIDs[i].keySystem, cachedKeyIDs[i].data));
 				cachedKeyIDs[i].data.clear();
 			}
 			cachedKeyIDs[i].isFailedKeyId = false;
 			cachedKeyIDs[i].creationTime = 0;
 		}
 		cachedKeyIDs[i].isPrimaryKeyId = false;
+		cachedKeyIDs[i].isInUse = false;
 	}
-	pthread_mutex_unlock(&cachedKeyMutex);
+	AAMP_MUTEX_UNLOCK(cachedKeyMutex);
 }
 
 /**
@@ -454,7 +465,7 @@ static void mssleep(int milliseconds)
 bool AampDRMSessionManager::IsKeyIdUsable(std::vector<uint8_t> keyIdArray)
 {
 	bool ret = true;
-	pthread_mutex_lock(&cachedKeyMutex);
+	AAMP_MUTEX_LOCK(cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
 	for (int sessionSlot = 0; sessionSlot < gpGlobalConfig->dash_MaxDRMSessions; sessionSlot++)
 	{
 		if (keyIdArray == cachedKeyIDs[sessionSlot].data)
@@ -464,11 +475,77 @@ bool AampDRMSessionManager::IsKeyIdUsable(std::vector<uint8_t> keyIdArray)
 			break;
 		}
 	}
-	pthread_mutex_unlock(&cachedKeyMutex);
+	AAMP_MUTEX_UNLOCK(cachedKeyMutex);
 
 	return ret;
 }
 
+/**
+ *  @brief		Get session cache hit rate and license round trip metrics.
+ *  @return		copy of metrics collected since session manager creation.
+ */
+DrmSessionCacheMetrics AampDRMSessionManager::getCacheMetrics()
+{
+	AAMP_MUTEX_HOLD(keymutex, cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
+	return mCacheMetrics;
+}
+
+/**
+ *  @brief		Get key of session slot index.
+ *  @param[in]	keySystem - DRM system id
+ *  @param[in]	keyId - key id
+ *  @return		index key, unique per DRM system and key id.
+ */
+std::string AampDRMSessionManager::getKeySlotIndexKey(const std::string &keySystem, const std::vector<uint8_t> &keyId)
+{
+	std::string indexKey(keySystem);
+	indexKey.push_back('|');
+	indexKey.append(keyId.begin(), keyId.end());
+	return indexKey;
+}
+
+/**
+ *  @brief		Mark end of license acquisition of a session slot and wake up
+ *  			threads waiting for a session with the same key.
+ *  @param[in]	sessionSlot - slot of the session
+ *  @param[in]	success - true if license was acquired
+ */
+void AampDRMSessionManager::finishLicenseAcquisition(int sessionSlot, bool success)
+{
+	AAMP_MUTEX_HOLD(keymutex, cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
+	cachedKeyIDs[sessionSlot].isAcquiring = false;
+	if (success)
+	{
+		cachedKeyIDs[sessionSlot].licenseTime = aamp_GetCurrentTimeMS();
+	}
+	pthread_cond_broadcast(&mLicenseAcquiredCond);
+}
+
+/**
+ *  @brief		Account a license request in the metrics and log them.
+ *  @param[in]	roundTripMs - time taken by license request
+ *  @param[in]	success - true if license response was received
+ */
+void AampDRMSessionManager::updateLicenseMetrics(long long roundTripMs, bool success)
+{
+	AAMP_MUTEX_HOLD(keymutex, cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
+	mCacheMetrics.licenseRequests++;
+	if (!success)
+	{
+		mCacheMetrics.licenseFailures++;
+	}
+	mCacheMetrics.licenseRoundTripTotalMs += roundTripMs;
+	if (roundTripMs > mCacheMetrics.licenseRoundTripMaxMs)
+	{
+		mCacheMetrics.licenseRoundTripMaxMs = roundTripMs;
+	}
+	int lookups = mCacheMetrics.cacheHits + mCacheMetrics.cacheMisses;
+	AAMPLOG_WARN("%s:%d License round trip %lld ms avg %lld ms max %lld ms failures %d/%d, session cache hit rate %d%% (%d/%d) expired %d", __FUNCTION__, __LINE__,
+			roundTripMs, mCacheMetrics.licenseRoundTripTotalMs / mCacheMetrics.licenseRequests, mCacheMetrics.licenseRoundTripMaxMs,
+			mCacheMetrics.licenseFailures, mCacheMetrics.licenseRequests, lookups ? (mCacheMetrics.cacheHits * 100 / lookups) : 0,
+			mCacheMetrics.cacheHits, lookups, mCacheMetrics.cacheExpired);
+}
+
 
 #ifdef USE_SECCLIENT
 DrmData * AampDRMSessionManager::getLicenseSec(const AampLicenseRequest &licenseRequest, std::shared_ptr<AampDrmHelper> drmHelper,
@@ -848,14 +925,17 @@ AampDrmSession* AampDRMSessionManager::createDrmSession(std::shared_ptr<AampDrmH
 	}
 
 	// Mutex lock to handle createDrmSession multi-thread calls to avoid timing issues observed in AXi6 as part of DELIA-43939 during Playready-4.0 testing.
-	AampMutexHold drmSessionLock(mDrmSessionLock);
+	// With parallel license acquisition, it is released while the license request of the selected slot is in progress.
+	pthread_mutex_lock(&mDrmSessionLock);
 
 	int cdmError = -1;
 	KeyState code = KEY_ERROR;
+	AampDrmSession *drmSession = nullptr;
 
 	if (SessionMgrState::eSESSIONMGR_INACTIVE == sessionMgrState)
 	{
 		logprintf("%s:%d SessionManager state inactive, aborting request", __FUNCTION__, __LINE__);
+		pthread_mutex_unlock(&mDrmSessionLock);
 		return nullptr;
 	}
 
@@ -873,35 +953,63 @@ AampDrmSession* AampDRMSessionManager::createDrmSession(std::shared_ptr<AampDrmH
 	 */
 	if (code == KEY_READY)
 	{
-		return drmSessionContexts[selectedSlot].drmSession;
+		drmSession = drmSessionContexts[selectedSlot].drmSession;
+		AAMP_MUTEX_LOCK(cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
+		mCacheMetrics.cacheHits++;
+		AAMP_MUTEX_UNLOCK(cachedKeyMutex);
+		pthread_mutex_unlock(&mDrmSessionLock);
+		return drmSession;
 	}
 
 	if ((code != KEY_INIT) || (selectedSlot == INVALID_SESSION_SLOT))
 	{
 		logprintf("%s:%d Unable to get DrmSession : Key State %d ", __FUNCTION__, __LINE__, code);
+		pthread_mutex_unlock(&mDrmSessionLock);
 		return nullptr;
 	}
 
+	// Slot is kept from replacement, and requests for the same key wait for this one, until finishLicenseAcquisition
+	AAMP_MUTEX_LOCK(cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
+	cachedKeyIDs[selectedSlot].isAcquiring = true;
+	mCacheMetrics.cacheMisses++;
+	AAMP_MUTEX_UNLOCK(cachedKeyMutex);
+
+	bool sessionLockHeld = true;
 	code = initializeDrmSession(drmHelper, selectedSlot, eventHandle);
 	if (code != KEY_INIT)
 	{
 		logprintf("%s:%d Unable to initialize DrmSession : Key State %d ", __FUNCTION__, __LINE__, code);
-		return nullptr;
 	}
-
-	code = acquireLicense(drmHelper, selectedSlot, cdmError, eventHandle, aampInstance, streamType);
-	if (code != KEY_READY)
+	else
 	{
-		logprintf("%s:%d Unable to get Ready Status DrmSession : Key State %d ", __FUNCTION__, __LINE__, code);
-		return nullptr;
+		if (gpGlobalConfig->parallelLicenseAcquisition)
+		{
+			pthread_mutex_unlock(&mDrmSessionLock);
+			sessionLockHeld = false;
+		}
+		code = acquireLicense(drmHelper, selectedSlot, cdmError, eventHandle, aampInstance, streamType);
+		if (code != KEY_READY)
+		{
+			logprintf("%s:%d Unable to get Ready Status DrmSession : Key State %d ", __FUNCTION__, __LINE__, code);
+		}
+		else
+		{
+			drmSession = drmSessionContexts[selectedSlot].drmSession;
+		}
 	}
+	finishLicenseAcquisition(selectedSlot, (code == KEY_READY));
 
-	return drmSessionContexts[selectedSlot].drmSession;
+	if (sessionLockHeld)
+	{
+		pthread_mutex_unlock(&mDrmSessionLock);
+	}
+	return drmSession;
 }
 
 /**
  * Create a DRM Session using the Drm Helper
  * Determine a slot in the drmSession Contexts which can be used
+ * Called with mDrmSessionLock held, it is released while waiting for a license of the same key
  * @return index to the selected drmSessionContext which has been selected
  */
 KeyState AampDRMSessionManager::getDrmSession(std::shared_ptr<AampDrmHelper> drmHelper, int &selectedSlot, DrmMetaDataEventPtr eventHandle, PrivateInstanceAAMP* aampInstance, bool isPrimarySession)
@@ -928,35 +1036,49 @@ KeyState AampDRMSessionManager::getDrmSession(std::shared_ptr<AampDrmHelper> drm
 	* Check if requested keyId is already cached
 	*/
 	int sessionSlot = 0;
+	bool isSessionExpired = false;
+	const std::string indexKey = getKeySlotIndexKey(drmHelper->ocdmSystemId(), keyIdArray);
 
 	{
-		AampMutexHold keymutex(cachedKeyMutex);
+		AAMP_MUTEX_HOLD(keymutex, cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
 
-		for (; sessionSlot < gpGlobalConfig->dash_MaxDRMSessions; sessionSlot++)
+		std::unordered_map<std::string, int>::iterator indexIter = mKeySlotIndex.find(indexKey);
+		while ((indexIter != mKeySlotIndex.end()) && cachedKeyIDs[indexIter->second].isAcquiring &&
+				(SessionMgrState::eSESSIONMGR_ACTIVE == sessionMgrState))
 		{
-			if (keyIdArray == cachedKeyIDs[sessionSlot].data)
-			{
-				AAMPLOG_INFO("%s:%d Session created/inprogress with same keyID %s at slot %d",__FUNCTION__, __LINE__, keyIdDebugStr.c_str(), sessionSlot);
-				keySlotFound = true;
-				isCachedKeyId = true;
-				break;
-			}
+			// License of the same key is requested by another thread, wait for it instead of sending a duplicate request.
+			// Session lock is not held while waiting, so sessions of other keys can be created meanwhile
+			pthread_mutex_unlock(&mDrmSessionLock);
+			struct timespec ts = aamp_GetTimespec(LICENSE_WAIT_INTERVAL_MS);
+			AAMP_COND_TIMEDWAIT(mLicenseAcquiredCond, cachedKeyMutex, ts);
+			// retake in lock order, session lock before key cache lock
+			AAMP_MUTEX_UNLOCK(cachedKeyMutex);
+			pthread_mutex_lock(&mDrmSessionLock);
+			AAMP_MUTEX_LOCK(cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
+			indexIter = mKeySlotIndex.find(indexKey);
+		}
+
+		if (indexIter != mKeySlotIndex.end())
+		{
+			sessionSlot = indexIter->second;
+			AAMPLOG_INFO("%s:%d Session created/inprogress with same keyID %s at slot %d",__FUNCTION__, __LINE__, keyIdDebugStr.c_str(), sessionSlot);
+			keySlotFound = true;
+			isCachedKeyId = true;
 		}
 
 		if (!keySlotFound)
 		{
-			/* Key Id not in cached list so we need to find out oldest slot to use;
-			 * Oldest slot may be used by current playback which is marked primary
-			 * Avoid selecting that slot
+			/* Key Id not in cached list so we need to find out least recently used slot;
+			 * Slot may be used by current playback which is marked primary, or
+			 * have a license request in progress. Avoid selecting those slots
 			 * */
-			/*select the first slot that is not primary*/
 			for (int index = 0; index < gpGlobalConfig->dash_MaxDRMSessions; index++)
 			{
-				if (!cachedKeyIDs[index].isPrimaryKeyId)
+				if (!cachedKeyIDs[index].isPrimaryKeyId && !cachedKeyIDs[index].isAcquiring &&
+					(!keySlotFound || cachedKeyIDs[index].creationTime < cachedKeyIDs[sessionSlot].creationTime))
 				{
 					keySlotFound = true;
 					sessionSlot = index;
-					break;
 				}
 			}
 
@@ -965,15 +1087,6 @@ KeyState AampDRMSessionManager::getDrmSession(std::shared_ptr<AampDrmHelper> drm
 				logprintf("%s:%d  Unable to find keySlot for keyId %s ",__FUNCTION__, __LINE__, keyIdDebugStr.c_str());
 				return KEY_ERROR;
 			}
-
-			/*Check if there's an older slot */
-			for (int index= sessionSlot + 1; index< gpGlobalConfig->dash_MaxDRMSessions; index++)
-			{
-				if (cachedKeyIDs[index].creationTime < cachedKeyIDs[sessionSlot].creationTime)
-				{
-					sessionSlot = index;
-				}
-			}
 			logprintf("%s:%d  Selected slot %d for keyId %s",__FUNCTION__, __LINE__, sessionSlot, keyIdDebugStr.c_str());
 		}
 		else
@@ -984,31 +1097,63 @@ KeyState AampDRMSessionManager::getDrmSession(std::shared_ptr<AampDrmHelper> drm
 				logprintf("%s:%d Found FailedKeyId at sesssionSlot :%d, return key error",__FUNCTION__, __LINE__,sessionSlot);
 				return KEY_ERROR;
 			}
+			if(cachedKeyIDs[sessionSlot].isAcquiring)
+			{
+				logprintf("%s:%d License acquisition still in progress at sesssionSlot :%d, return key error",__FUNCTION__, __LINE__,sessionSlot);
+				return KEY_ERROR;
+			}
+			if((gpGlobalConfig->drmSessionCacheTTL > 0) && (cachedKeyIDs[sessionSlot].licenseTime != 0) &&
+				((aamp_GetCurrentTimeMS() - cachedKeyIDs[sessionSlot].licenseTime) > (gpGlobalConfig->drmSessionCacheTTL * 1000LL)))
+			{
+				if (cachedKeyIDs[sessionSlot].isInUse)
+				{
+					// Decrypters of the current playback still hold the session, it is replaced
+					// on the first request for this key after the next tune starts
+					AAMPLOG_INFO("%s:%d License of keyId %s at sesssionSlot :%d expired, session in use, reusing it", __FUNCTION__, __LINE__,
+							keyIdDebugStr.c_str(), sessionSlot);
+				}
+				else
+				{
+					logprintf("%s:%d License of keyId %s at sesssionSlot :%d older than %d sec, requesting again",__FUNCTION__, __LINE__,
+							keyIdDebugStr.c_str(), sessionSlot, gpGlobalConfig->drmSessionCacheTTL);
+					isSessionExpired = true;
+					cachedKeyIDs[sessionSlot].licenseTime = 0;
+					mCacheMetrics.cacheExpired++;
+				}
+			}
 		}
-		
 
 		if (!isCachedKeyId)
 		{
 			if(cachedKeyIDs[sessionSlot].data.size() != 0)
 			{
+				mKeySlotIndex.erase(getKeySlotIndexKey(cachedKeyIDs[sessionSlot].keySystem, cachedKeyIDs[sessionSlot].data));
 				cachedKeyIDs[sessionSlot].data.clear();
 			}
 			cachedKeyIDs[sessionSlot].isFailedKeyId = false;
 			cachedKeyIDs[sessionSlot].data = keyIdArray;
+			cachedKeyIDs[sessionSlot].keySystem = drmHelper->ocdmSystemId();
+			cachedKeyIDs[sessionSlot].licenseTime = 0;
+			mKeySlotIndex[indexKey] = sessionSlot;
 		}
 		cachedKeyIDs[sessionSlot].creationTime = aamp_GetCurrentTimeMS();
 		cachedKeyIDs[sessionSlot].isPrimaryKeyId = isPrimarySession;
+		cachedKeyIDs[sessionSlot].isInUse = true;
 	}
 
 	selectedSlot = sessionSlot;
 	const std::string systemId = drmHelper->ocdmSystemId();
-	AampMutexHold sessionMutex(drmSessionContexts[sessionSlot].sessionMutex);
+	AAMP_MUTEX_HOLD(sessionMutex, drmSessionContexts[sessionSlot].sessionMutex, "DrmSessionContext::sessionMutex");
 	if (drmSessionContexts[sessionSlot].drmSession != NULL)
 	{
 		if (drmHelper->ocdmSystemId() != drmSessionContexts[sessionSlot].drmSession->getKeySystem())
 		{
 			AAMPLOG_WARN("%s:%d changing DRM session for %s to %s", __FUNCTION__, __LINE__, drmSessionContexts[sessionSlot].drmSession->getKeySystem().c_str(), drmHelper->ocdmSystemId().c_str());
 		}
+		else if (isSessionExpired)
+		{
+			AAMPLOG_WARN("%s:%d cached DRM session for %s expired in slot %d", __FUNCTION__, __LINE__, drmSessionContexts[sessionSlot].drmSession->getKeySystem().c_str(), sessionSlot);
+		}
 		else if (keyIdArray == drmSessionContexts[sessionSlot].data)
 		{
 			KeyState existingState = drmSessionContexts[sessionSlot].drmSession->getState();
@@ -1081,7 +1226,7 @@ KeyState AampDRMSessionManager::initializeDrmSession(std::shared_ptr<AampDrmHelp
 	std::vector<uint8_t> drmInitData;
 	drmHelper->createInitData(drmInitData);
 
-	AampMutexHold sessionMutex(drmSessionContexts[sessionSlot].sessionMutex);
+	AAMP_MUTEX_HOLD(sessionMutex, drmSessionContexts[sessionSlot].sessionMutex, "DrmSessionContext::sessionMutex");
 	drmSessionContexts[sessionSlot].drmSession->generateAampDRMSession(drmInitData.data(), drmInitData.size());
 
 	code = drmSessionContexts[sessionSlot].drmSession->getState();
@@ -1120,7 +1265,7 @@ KeyState AampDRMSessionManager::acquireLicense(std::shared_ptr<AampDrmHelper> dr
 	}
 	else
 	{
-		AampMutexHold sessionMutex(drmSessionContexts[sessionSlot].sessionMutex);
+		AAMP_MUTEX_HOLD(sessionMutex, drmSessionContexts[sessionSlot].sessionMutex, "DrmSessionContext::sessionMutex");
 		
 		/**
 		 * Generate a License challenge from the CDM
@@ -1145,7 +1290,7 @@ KeyState AampDRMSessionManager::acquireLicense(std::shared_ptr<AampDrmHelper> dr
 
 			if (!(drmHelper->getDrmMetaData().empty() || gpGlobalConfig->licenseAnonymousRequest))
 			{
-				AampMutexHold accessTokenMutexHold(accessTokenMutex);
+				AAMP_MUTEX_HOLD(accessTokenMutexHold, accessTokenMutex, "AampDRMSessionManager::accessTokenMutex");
 
 				int tokenLen = 0;
 				long tokenError = 0;
@@ -1198,6 +1343,7 @@ KeyState AampDRMSessionManager::acquireLicense(std::shared_ptr<AampDrmHelper> dr
 				 */
 				AAMPLOG_WARN("%s:%d Request License from the Drm Server %s", __FUNCTION__, __LINE__, licenseRequest.url.c_str());
 				aampInstance->profiler.ProfileBegin(PROFILE_BUCKET_LA_NETWORK);
+				long long licenseRequestTime = aamp_GetCurrentTimeMS();
 
 #ifdef USE_SECCLIENT
 				if (isContentMetadataAvailable || usingAppDefinedAuthToken)
@@ -1207,6 +1353,8 @@ KeyState AampDRMSessionManager::acquireLicense(std::shared_ptr<AampDrmHelper> dr
 					if (412 == httpResponseCode && 401 == httpExtendedStatusCode && !usingAppDefinedAuthToken)
 					{
 						AAMPLOG_INFO("%s:%d License Req failure by Expired access token httpResCode %d statusCode %d", __FUNCTION__, __LINE__, httpResponseCode, httpExtendedStatusCode);
+						// License requests of other keys may run concurrently
+						AAMP_MUTEX_HOLD(accessTokenMutexHold, accessTokenMutex, "AampDRMSessionManager::accessTokenMutex");
 						if(accessToken)
 						{
 							free(accessToken);
@@ -1230,6 +1378,7 @@ KeyState AampDRMSessionManager::acquireLicense(std::shared_ptr<AampDrmHelper> dr
 				{
 					licenseResponse.reset(getLicense(licenseRequest, &httpResponseCode, streamType, aampInstance, isContentMetadataAvailable, licenseServerProxy));
 				}
+				updateLicenseMetrics(aamp_GetCurrentTimeMS() - licenseRequestTime, (licenseResponse.get() != NULL));
 
 			}
 		}
@@ -1296,7 +1445,7 @@ KeyState AampDRMSessionManager::handleLicenseResponse(std::shared_ptr<AampDrmHel
 				{
 					eventHandle->setFailure(AAMP_TUNE_AUTHORISATION_FAILURE);
 				}
-				AampMutexHold sessionMutex(drmSessionContexts[sessionSlot].sessionMutex);
+				AAMP_MUTEX_HOLD(sessionMutex, drmSessionContexts[sessionSlot].sessionMutex, "DrmSessionContext::sessionMutex");
 				AAMPLOG_WARN("%s:%d deleting existing DRM session for %s, Authorisation failed", __FUNCTION__, __LINE__, drmSessionContexts[sessionSlot].drmSession->getKeySystem().c_str());
 				delete drmSessionContexts[sessionSlot].drmSession;
 				drmSessionContexts[sessionSlot].drmSession = nullptr;
@@ -1310,7 +1459,7 @@ KeyState AampDRMSessionManager::handleLicenseResponse(std::shared_ptr<AampDrmHel
 				eventHandle->setFailure(AAMP_TUNE_LICENCE_REQUEST_FAILED);
 				eventHandle->setResponseCode(httpResponseCode);
 			}
-			AampMutexHold keymutex(cachedKeyMutex);
+			AAMP_MUTEX_HOLD(keymutex, cachedKeyMutex, "AampDRMSessionManager::cachedKeyMutex");
 			cachedKeyIDs[sessionSlot].isFailedKeyId = true;
 
 			return KEY_ERROR;
@@ -31,6 +31,7 @@
 #include "priv_aamp.h"
 #include "main_aamp.h"
 #include <string>
+#include <unordered_map>
 #include <curl/curl.h>
 #include "AampDrmHelper.h"
 
@@ -117,13 +118,34 @@ struct DrmSessionParams
 struct KeyID
 {
 	std::vector<uint8_t> data;
-	long long creationTime;
+	std::string keySystem;      /**< DRM system the key is licensed for */
+	long long creationTime;     /**< Time of last use, least recently used slot is replaced first */
+	long long licenseTime;      /**< Time license was acquired, used for cache expiry */
 	bool isFailedKeyId;
 	bool isPrimaryKeyId;
+	bool isAcquiring;           /**< License request in progress, slot must not be replaced */
+	bool isInUse;               /**< Session handed out since the tune started, its license does not expire meanwhile */
 
 	KeyID();
 };
 
+/**
+ *  @struct	DrmSessionCacheMetrics
+ *  @brief	Hit rate of the DRM session cache and license round trip times
+ */
+struct DrmSessionCacheMetrics
+{
+	int cacheHits;                      /**< Sessions reused from cache */
+	int cacheMisses;                    /**< Sessions created */
+	int cacheExpired;                   /**< Cached sessions dropped on TTL expiry */
+	int licenseRequests;                /**< License requests sent to server */
+	int licenseFailures;                /**< License requests without a response */
+	long long licenseRoundTripTotalMs;  /**< Sum of license round trip times */
+	long long licenseRoundTripMaxMs;    /**< Max license round trip time */
+
+	DrmSessionCacheMetrics();
+};
+
 /**
  *  @brief	Enum to represent session manager state.
  *  		Session manager would abort any createDrmSession
@@ -150,8 +172,15 @@ private:
 	pthread_mutex_t accessTokenMutex;
 	pthread_mutex_t cachedKeyMutex;
 	pthread_mutex_t mDrmSessionLock;
+	pthread_cond_t mLicenseAcquiredCond;
 	bool curlSessionAbort;
 	bool mEnableAccessAtrributes;
+	std::unordered_map<std::string, int> mKeySlotIndex;	/**< Session slot indexed by DRM system and key ID */
+	DrmSessionCacheMetrics mCacheMetrics;
+
+	static std::string getKeySlotIndexKey(const std::string &keySystem, const std::vector<uint8_t> &keyId);
+	void finishLicenseAcquisition(int sessionSlot, bool success);
+	void updateLicenseMetrics(long long roundTripMs, bool success);
 
 	AampDRMSessionManager(const AampDRMSessionManager &) = delete;
 	AampDRMSessionManager& operator=(const AampDRMSessionManager &) = delete;
@@ -183,6 +212,8 @@ public:
 
 	bool IsKeyIdUsable(std::vector<uint8_t> keyIdArray);
 
+	DrmSessionCacheMetrics getCacheMetrics();
+
 	void clearSessionData();
 
 	void clearAccessToken();
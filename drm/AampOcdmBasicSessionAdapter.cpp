@@ -9,7 +9,7 @@ int AAMPOCDMBasicSessionAdapter::decrypt(const uint8_t *f_pbIV, uint32_t f_cbIV,
 		return HDCP_COMPLIANCE_CHECK_FAILURE;
 	}
 
-	AampMutexHold decryptMutexHold(decryptMutex);
+	AAMP_MUTEX_HOLD(decryptMutexHold, decryptMutex, "AAMPOCDMSessionAdapter::decryptMutex");
 
 	uint8_t *dataToSend = const_cast<uint8_t *>(payloadData);
 	uint32_t sizeToSend = payloadDataSize;
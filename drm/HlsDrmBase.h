@@ -52,6 +52,44 @@ enum DRMState
 	eDRM_KEY_FLUSH
 };
 
+/**
+ * @class HlsDrmStreamDecryptor
+ * @brief Decrypts a fragment in place while it is being downloaded
+ */
+class HlsDrmStreamDecryptor
+{
+public:
+	/**
+	 * @brief Restart decryption, for a new download attempt
+	 */
+	virtual void Reset() = 0;
+
+	/**
+	 * @brief Decrypt data appended to buffer since last call
+	 * @param buffer fragment being downloaded
+	 * @retval false on decrypt failure
+	 */
+	virtual bool Update(GrowableBuffer *buffer) = 0;
+
+	/**
+	 * @brief Complete decryption once download is done
+	 * @param buffer downloaded fragment
+	 * @retval eDRM_SUCCESS if complete buffer is decrypted
+	 */
+	virtual DrmReturn Finish(GrowableBuffer *buffer) = 0;
+
+	/**
+	 * @brief Get time decryption of the first block started
+	 * @retval AampPlaybackProfiler::NowUs() time, 0 if nothing is decrypted yet
+	 */
+	virtual long long GetStartTimeUs() = 0;
+
+	/**
+	 * @brief HlsDrmStreamDecryptor Destructor
+	 */
+	virtual ~HlsDrmStreamDecryptor(){};
+};
+
 /**
  * @class HlsDrmBase
  * @brief Base class of HLS DRM implementations
@@ -114,6 +152,14 @@ public:
 	*
 	*/
 	virtual DRMState GetState() = 0;
+	/**
+	 * @brief Create decryptor to decrypt a fragment while it is downloaded
+	 *
+	 * @param drmInfo Drm information of the fragment
+	 * @param bucketType Type of bucket for profiling
+	 * @retval decryptor to be deleted by caller, NULL if not supported or key not available yet
+	 */
+	virtual HlsDrmStreamDecryptor* CreateStreamDecryptor(const struct DrmInfo *drmInfo, ProfilerBucketType bucketType) { return NULL; }
 	/**
 	 * @brief HlsDrmBase Destructor
 	 */
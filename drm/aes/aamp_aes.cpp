@@ -422,6 +422,146 @@ void AesDec::RestoreKeyState()
 	pthread_mutex_unlock(&mMutex);
 }
 
+/**
+ * @brief Create decryptor to decrypt a fragment in place while it is downloaded.
+ * Only done once key for the fragment is available, so that download is never delayed
+ *
+ * @param drmInfo Drm information of the fragment
+ * @param bucketType Type of bucket for profiling
+ * @retval decryptor to be deleted by caller, NULL if key is not acquired
+ */
+HlsDrmStreamDecryptor* AesDec::CreateStreamDecryptor(const struct DrmInfo *drmInfo, ProfilerBucketType bucketType)
+{
+	HlsDrmStreamDecryptor *decryptor = NULL;
+	pthread_mutex_lock(&mMutex);
+	if (mDrmState == eDRM_KEY_ACQUIRED && drmInfo->iv && !drmInfo->useFirst16BytesAsIV &&
+		drmInfo->keyURI == mDrmUrl && AES_128_KEY_LEN_BYTES == mAesKeyBuf.len)
+	{
+		decryptor = new AesStreamDecryptor(mpAamp, bucketType, (const unsigned char *)mAesKeyBuf.ptr, drmInfo->iv);
+	}
+	pthread_mutex_unlock(&mMutex);
+	return decryptor;
+}
+
+/**
+ * @brief AesStreamDecryptor Constructor
+ * @param aamp AAMP instance of the fragment
+ * @param bucketType Type of bucket for profiling
+ * @param key AES-128 key
+ * @param iv initialization vector
+ */
+AesStreamDecryptor::AesStreamDecryptor(PrivateInstanceAAMP *aamp, ProfilerBucketType bucketType, const unsigned char *key, const unsigned char *iv) : mOpensslCtx(),
+		mKey(), mIV(), mDecryptedLen(0), mError(false), mpAamp(aamp), mBucketType(bucketType), mDecryptStarted(false), mStartTimeUs(0)
+{
+	memcpy(mKey, key, AES_128_KEY_LEN_BYTES);
+	memcpy(mIV, iv, AES_128_KEY_LEN_BYTES);
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+	OPEN_SSL_CONTEXT = EVP_CIPHER_CTX_new();
+#else
+	EVP_CIPHER_CTX_init(OPEN_SSL_CONTEXT);
+#endif
+	Reset();
+}
+
+/**
+ * @brief AesStreamDecryptor Destructor
+ */
+AesStreamDecryptor::~AesStreamDecryptor()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+	EVP_CIPHER_CTX_free(OPEN_SSL_CONTEXT);
+#else
+	EVP_CIPHER_CTX_cleanup(OPEN_SSL_CONTEXT);
+#endif
+}
+
+/**
+ * @brief Restart decryption, for a new download attempt
+ */
+void AesStreamDecryptor::Reset()
+{
+	mDecryptedLen = 0;
+	mError = false;
+	mDecryptStarted = false;
+	mStartTimeUs = 0;
+	if (!EVP_DecryptInit_ex(OPEN_SSL_CONTEXT, EVP_aes_128_cbc(), NULL, mKey, mIV))
+	{
+		logprintf("AesStreamDecryptor::%s:%d: EVP_DecryptInit_ex failed", __FUNCTION__, __LINE__);
+		mError = true;
+	}
+	// Padding is checked in Finish; disabling it lets every complete block be decrypted in place
+	EVP_CIPHER_CTX_set_padding(OPEN_SSL_CONTEXT, 0);
+}
+
+/**
+ * @brief Decrypt complete blocks appended to buffer since last call
+ * @param buffer fragment being downloaded
+ * @retval false on decrypt failure
+ */
+bool AesStreamDecryptor::Update(GrowableBuffer *buffer)
+{
+	size_t blocksLen = buffer->len - (buffer->len % AES_128_KEY_LEN_BYTES);
+	if (!mError && blocksLen > mDecryptedLen)
+	{
+		unsigned char *ptr = (unsigned char *)buffer->ptr + mDecryptedLen;
+		int decLen = 0;
+		if (!mDecryptStarted)
+		{
+			// profiled from first block until Finish, as decryption is spread over the download
+			mpAamp->LogDrmDecryptBegin(mBucketType);
+			mDecryptStarted = true;
+			mStartTimeUs = AampPlaybackProfiler::NowUs();
+		}
+		if (!EVP_DecryptUpdate(OPEN_SSL_CONTEXT, ptr, &decLen, ptr, (int)(blocksLen - mDecryptedLen)))
+		{
+			logprintf("AesStreamDecryptor::%s:%d: EVP_DecryptUpdate failed", __FUNCTION__, __LINE__);
+			mError = true;
+		}
+		else
+		{
+			mDecryptedLen += decLen;
+		}
+	}
+	return !mError;
+}
+
+/**
+ * @brief Complete decryption once download is done, checking PKCS7 padding.
+ * As with AesDec::Decrypt, padding is left in the buffer
+ * @param buffer downloaded fragment
+ * @retval eDRM_SUCCESS if complete buffer is decrypted
+ */
+DrmReturn AesStreamDecryptor::Finish(GrowableBuffer *buffer)
+{
+	DrmReturn err = eDRM_ERROR;
+	if (Update(buffer) && buffer->len && mDecryptedLen == buffer->len)
+	{
+		const unsigned char *end = (const unsigned char *)buffer->ptr + buffer->len;
+		unsigned char padLen = end[-1];
+		if (padLen > 0 && padLen <= AES_128_KEY_LEN_BYTES)
+		{
+			err = eDRM_SUCCESS;
+			for (int i = 1; i <= padLen; i++)
+			{
+				if (end[-i] != padLen)
+				{
+					err = eDRM_ERROR;
+					break;
+				}
+			}
+		}
+	}
+	if (mDecryptStarted)
+	{
+		mpAamp->LogDrmDecryptEnd(mBucketType);
+	}
+	if (err != eDRM_SUCCESS)
+	{
+		logprintf("AesStreamDecryptor::%s:%d: decrypt failed len %d decrypted %d", __FUNCTION__, __LINE__, (int)buffer->len, (int)mDecryptedLen);
+	}
+	return err;
+}
+
 std::shared_ptr<AesDec> AesDec::mInstance = nullptr;
 
 /**
@@ -26,6 +26,38 @@
 #include <openssl/evp.h>
 #include <memory>
 
+/**
+ * @class AesStreamDecryptor
+ * @brief AES-128 CBC decryption of a fragment, done in place as blocks are downloaded
+ */
+class AesStreamDecryptor : public HlsDrmStreamDecryptor
+{
+public:
+	AesStreamDecryptor(PrivateInstanceAAMP *aamp, ProfilerBucketType bucketType, const unsigned char *key, const unsigned char *iv);
+	~AesStreamDecryptor();
+	AesStreamDecryptor(const AesStreamDecryptor&) = delete;
+	AesStreamDecryptor& operator=(const AesStreamDecryptor&) = delete;
+	void Reset();
+	bool Update(GrowableBuffer *buffer);
+	DrmReturn Finish(GrowableBuffer *buffer);
+	long long GetStartTimeUs() { return mStartTimeUs; }
+
+private:
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+	EVP_CIPHER_CTX *mOpensslCtx;
+#else
+	EVP_CIPHER_CTX mOpensslCtx;
+#endif
+	unsigned char mKey[16];		/**< AES-128 key */
+	unsigned char mIV[16];		/**< Initialization vector of fragment */
+	size_t mDecryptedLen;		/**< Bytes of buffer already decrypted */
+	bool mError;
+	PrivateInstanceAAMP *mpAamp;
+	ProfilerBucketType mBucketType;	/**< Profiler bucket of the fragment decryption */
+	bool mDecryptStarted;		/**< Decryption profiling started, with first decrypted block */
+	long long mStartTimeUs;		/**< Time first block was decrypted */
+};
+
 /**
  * @class AesDec
  * @brief Vanilla AES based DRM management
@@ -42,6 +74,7 @@ public:
 	void Release();
 	void CancelKeyWait();
 	void RestoreKeyState();
+	HlsDrmStreamDecryptor* CreateStreamDecryptor(const struct DrmInfo *drmInfo, ProfilerBucketType bucketType);
 
 	/*Functions to support internal operations*/
 	void AcquireKey();
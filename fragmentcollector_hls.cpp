@@ -38,6 +38,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include "priv_aamp.h"
+#include "AampMutex.h"
 #include <pthread.h>
 #include <signal.h>
 #include <semaphore.h>
@@ -52,6 +53,7 @@
 #include <string>
 #include "HlsDrmBase.h"
 #include "AampCacheHandler.h"
+#include "AampWorkerPool.h"
 #ifdef USE_OPENCDM
 #include "AampHlsDrmSessionManager.h"
 #endif
@@ -605,6 +607,71 @@ static char *mystrpbrk(char *ptr)
 	return next;
 }
 
+/***************************************************************************
+* @fn FindFirstNodeCompletingAfter
+* @brief Binary search of index for first fragment completing after position.
+* Completion times of IndexNodes are cumulative, so the index is sorted by them
+*
+* @param index[in] index nodes
+* @param first[in] first node to search
+* @param last[in] end of range to search
+* @param position[in] position in seconds from playlist start
+* @param inclusive[in] true to also accept a fragment completing at position
+* @return node index, last if no fragment in range completes after position
+***************************************************************************/
+static int FindFirstNodeCompletingAfter(const IndexNode *index, int first, int last, double position, bool inclusive = false)
+{
+	if (first >= last)
+	{
+		return last;
+	}
+	const IndexNode *node;
+	if (inclusive)
+	{
+		node = std::lower_bound(index + first, index + last, position,
+				[](const IndexNode &n, double value) { return n.completionTimeSecondsFromStart < value; });
+	}
+	else
+	{
+		node = std::upper_bound(index + first, index + last, position,
+				[](double value, const IndexNode &n) { return value < n.completionTimeSecondsFromStart; });
+	}
+	return (int)(node - index);
+}
+
+/***************************************************************************
+* @fn FindFirstDiscontinuityAfterPosition
+* @brief Binary search of discontinuity index for first discontinuity after position.
+* Discontinuities are indexed in playlist order, so the index is sorted by position
+*
+* @return discontinuity index, count if none is after position
+***************************************************************************/
+static int FindFirstDiscontinuityAfterPosition(const DiscontinuityIndexNode *discontinuityIndex, int count, double position)
+{
+	if (count <= 0)
+	{
+		return 0;
+	}
+	return (int)(std::upper_bound(discontinuityIndex, discontinuityIndex + count, position,
+			[](double value, const DiscontinuityIndexNode &n) { return value < n.position; }) - discontinuityIndex);
+}
+
+/***************************************************************************
+* @fn FindFirstDiscontinuityAfterFragment
+* @brief Binary search of discontinuity index for first discontinuity starting after fragment
+*
+* @return discontinuity index, count if none starts after fragment
+***************************************************************************/
+static int FindFirstDiscontinuityAfterFragment(const DiscontinuityIndexNode *discontinuityIndex, int count, int fragmentIdx)
+{
+	if (count <= 0)
+	{
+		return 0;
+	}
+	return (int)(std::upper_bound(discontinuityIndex, discontinuityIndex + count, fragmentIdx,
+			[](int value, const DiscontinuityIndexNode &n) { return value < n.fragmentIdx; }) - discontinuityIndex);
+}
+
 /**
 * @param attrName pointer to HLS Attribute List, as a NUL-terminated CString
 */
@@ -1262,39 +1329,32 @@ char *TrackState::GetFragmentUriFromIndex(bool &bSegmentRepeated)
 		{ // search forward from beginning
 			currentIdx = 0;
 		}
-		for (idx = currentIdx; idx < indexCount; idx++)
-		{ // search in direction until out-of-bounds
-			const IndexNode *node = &index[idx];
-			//logprintf("%s rate %f completionTimeSecondsFromStart %f playTarget %f",__FUNCTION__, rate, node->completionTimeSecondsFromStart, playTarget);
-			if (node->completionTimeSecondsFromStart >= playTarget)
-			{ // found target iframe
+		// search in direction until out-of-bounds
+		idx = FindFirstNodeCompletingAfter(index, currentIdx, indexCount, playTarget, true);
+		if (idx < indexCount)
+		{ // found target iframe
+			idxNode = &index[idx];
 #ifdef TRACE
-				logprintf("%s Found node - rate %f completionTimeSecondsFromStart %f playTarget %f", __FUNCTION__,
-				        context->rate, node->completionTimeSecondsFromStart, playTarget);
+			logprintf("%s Found node - rate %f completionTimeSecondsFromStart %f playTarget %f", __FUNCTION__,
+			        context->rate, idxNode->completionTimeSecondsFromStart, playTarget);
 #endif
-				idxNode = node;
-				break;
-			}
 		}
 	}
 	else
 	{
-		if (-1 == currentIdx)
+		if ((-1 == currentIdx) || (currentIdx >= indexCount))
 		{ // search backward from end
 			currentIdx = indexCount - 1;
 		}
-		for (idx = currentIdx; idx >= 0; idx--)
-		{ // search in direction until out-of-bounds
-			const IndexNode *node = &index[idx];
-			if (node->completionTimeSecondsFromStart <= playTarget)
-			{ // found target iframe
+		// search in direction until out-of-bounds, last node completing at or before playTarget
+		idx = FindFirstNodeCompletingAfter(index, 0, currentIdx + 1, playTarget) - 1;
+		if (idx >= 0)
+		{ // found target iframe
+			idxNode = &index[idx];
 #ifdef TRACE
-				logprintf("%s Found node - rate %f completionTimeSecondsFromStart %f playTarget %f",
-						__FUNCTION__, context->rate, node->completionTimeSecondsFromStart, playTarget);
+			logprintf("%s Found node - rate %f completionTimeSecondsFromStart %f playTarget %f",
+					__FUNCTION__, context->rate, idxNode->completionTimeSecondsFromStart, playTarget);
 #endif
-				idxNode = node;
-				break;
-			}
 		}
 	}
 	if (idxNode)
@@ -1309,10 +1369,9 @@ char *TrackState::GetFragmentUriFromIndex(bool &bSegmentRepeated)
 		}
 
 		currentIdx = idx;
-		byteRangeOffset = 0;
-		byteRangeLength = 0;
-		//logprintf("%s fragmentinfo %s", __FUNCTION__, idxNode->pFragmentInfo);
-		const char *fragmentInfo = idxNode->pFragmentInfo;
+		// byte range and URI come from the record parsed at indexing
+		byteRangeOffset = idxNode->byteRangeOffset;
+		byteRangeLength = idxNode->byteRangeLength;
 		fragmentDurationSeconds = idxNode->completionTimeSecondsFromStart;
 		if (idx > 0)
 		{
@@ -1329,60 +1388,23 @@ char *TrackState::GetFragmentUriFromIndex(bool &bSegmentRepeated)
 			bSegmentRepeated = false;
 			lastDownloadedIFrameTarget = idxNode->completionTimeSecondsFromStart;
 		}
-	
-		while (fragmentInfo[0] == '#')
-		{
-			if (!memcmp(fragmentInfo, "#EXT-X-BYTERANGE:", 17))
-			{
-				char temp[1024];
-				const char * end = fragmentInfo;
-				while (end[0] != CHAR_LF)
-				{
-					end++;
-				}
-				int len = end - fragmentInfo;
-				assert(len < 1024);
-				strncpy(temp, fragmentInfo + 17, len);
-				temp[1023] = 0x00;
-				char * offsetDelim = strchr(temp, '@'); // optional
-				if (offsetDelim)
-				{
-					*offsetDelim++ = 0x00;
-					byteRangeOffset = atoi(offsetDelim);
-				}
-				byteRangeLength = atoi(temp);
-			}
-			/*Skip to next line*/
-			while (fragmentInfo[0] != CHAR_LF)
-			{
-				fragmentInfo++;
-			}
-			fragmentInfo++;
-		}
-		const char *urlEnd = strchr(fragmentInfo, CHAR_LF);
-		if (urlEnd)
+
+		if (idxNode->uri && idxNode->uriLength > 0)
 		{
-			if (*(urlEnd - 1) == CHAR_CR)
-			{
-				urlEnd--;
-			}
-			int urlLen = urlEnd - fragmentInfo;
-			mFragmentURIFromIndex.assign(fragmentInfo, urlLen);
-			if(!mFragmentURIFromIndex.empty()){
-				uri = (char *)mFragmentURIFromIndex.c_str();
-			}
+			mFragmentURIFromIndex.assign(idxNode->uri, idxNode->uriLength);
+			uri = (char *)mFragmentURIFromIndex.c_str();
 			
 			//The EXT-X-TARGETDURATION tag specifies the maximum Media Segment   duration.  
 			//The EXTINF duration of each Media Segment in the Playlist   file, when rounded to the nearest integer, 
 			//MUST be less than or equal   to the target duration
-			if(uri && std::round(fragmentDurationSeconds) > targetDurationSeconds) 
+			if(std::round(fragmentDurationSeconds) > targetDurationSeconds) 
 			{
 				AAMPLOG_WARN("%s WARN - Fragment duration[%f] > TargetDuration[%f] for URI:%s",__FUNCTION__,fragmentDurationSeconds ,targetDurationSeconds,uri);
 			}
 		}
 		else
 		{
-			logprintf("%s - unable to find end", __FUNCTION__);
+			logprintf("%s - no uri for fragment %d", __FUNCTION__, idx);
 		}
 		if (-1 == idxNode->drmMetadataIdx)
 		{
@@ -1422,9 +1444,104 @@ char *TrackState::GetFragmentUriFromIndex(bool &bSegmentRepeated)
 	return uri;
 }
 
+/***************************************************************************
+* @fn SkipFragmentsBeforePlayTarget
+* @brief Function to skip playlist walk from first fragment to fragments around playTarget.
+* The fragment is found by binary search of the index, and the state the walk would have
+* collected from skipped fragments (position, sequence number, key and init fragment) is
+* restored from index. The walk resumes one fragment before the target and takes the
+* final decision itself. Nothing is skipped if the records do not match the index.
+*
+* @param firstFragmentInfo[in] #EXTINF line of first fragment, as reached by the walk
+* @param walkEnd[in] end of playlist data already walked, data after it is unmodified
+* @return position to resume walk, NULL if walk has to continue with first fragment
+***************************************************************************/
+char *TrackState::SkipFragmentsBeforePlayTarget(const char *firstFragmentInfo, const char *walkEnd)
+{
+	const IndexNode *nodes = (const IndexNode *) index.ptr;
+	if ((NULL == nodes) || (indexCount < 3) || (nodes[0].pFragmentInfo != firstFragmentInfo) || (NULL == walkEnd))
+	{
+		return NULL;
+	}
+	// first fragment returned by walk, see URI handling of GetNextFragmentUriFromPlaylist
+	int target = std::min(FindFirstNodeCompletingAfter(nodes, 0, indexCount, playTarget),
+			FindFirstNodeCompletingAfter(nodes, 0, indexCount, playTarget - PLAYLIST_TIME_DIFF_THRESHOLD_SECONDS) + 1);
+	int skipCount = target - 1;
+	if (skipCount < 2)
+	{
+		return NULL;
+	}
+	int last = skipCount - 1;
+	const IndexNode *lastNode = &nodes[last];
+	const char *playlistEnd = playlist.ptr + playlist.len;
+	if ((lastNode->pFragmentInfo < walkEnd) || (lastNode->pFragmentInfo >= playlistEnd) || strncmp(lastNode->pFragmentInfo, "#EXTINF:", 8) != 0)
+	{
+		return NULL;
+	}
+	// last skipped fragment has to be a plain #EXTINF and URI record. Other tags (byte range,
+	// key, map) on fragment records are left to the walk
+	const char *prevLine = lastNode->pFragmentInfo - 1;
+	while (prevLine > walkEnd && prevLine[-1] != CHAR_LF)
+	{
+		prevLine--;
+	}
+	const char *extinfEnd = strchr(lastNode->pFragmentInfo, CHAR_LF);
+	if ((*prevLine == '#') || (*prevLine == CHAR_CR) || (*prevLine == CHAR_LF) || (NULL == extinfEnd) ||
+		(lastNode->uri != extinfEnd + 1) || (0 != lastNode->byteRangeLength))
+	{
+		return NULL;
+	}
+	const char *uriEnd = strchr(lastNode->uri, CHAR_LF);
+	if (NULL == uriEnd)
+	{
+		return NULL;
+	}
+
+	playlistPosition = (last > 0) ? nodes[last - 1].completionTimeSecondsFromStart : 0;
+	fragmentDurationSeconds = lastNode->completionTimeSecondsFromStart - playlistPosition;
+	nextMediaSequenceNumber += skipCount;
+	// Key tags of skipped records, in playlist order. mFragmentIdx of a key tag is the number of
+	// fragments indexed before it, tags before first #EXTINF are already parsed by the walk
+	for (size_t i = 0; i < mKeyHashTable.size(); i++)
+	{
+		const KeyTagStruct &keyTag = mKeyHashTable[i];
+		if (keyTag.mFragmentIdx > last)
+		{
+			break;
+		}
+		if (keyTag.mFragmentIdx > 0 && keyTag.mKeyTagStr.size())
+		{
+			// ParseAttrList function modifies the input string, parse a copy
+			char* key = (char*) malloc(keyTag.mKeyTagStr.size() + 1);
+			memcpy(key, keyTag.mKeyTagStr.c_str(), keyTag.mKeyTagStr.size() + 1);
+			ParseAttrList(key, ParseKeyAttributeCallback, this);
+			free(key);
+		}
+	}
+	const char *initFragmentPtr = lastNode->initFragmentPtr;
+	if (initFragmentPtr && initFragmentPtr != mInitFragmentInfo)
+	{
+		if (initFragmentPtr >= walkEnd)
+		{
+			// terminate line as the walk does
+			mystrpbrk((char *)initFragmentPtr);
+		}
+		if ((!mInitFragmentInfo) || strcmp(mInitFragmentInfo, initFragmentPtr) != 0)
+		{
+			mInitFragmentInfo = initFragmentPtr;
+			mInjectInitFragment = true;
+			AAMPLOG_INFO("%s:%d: Found #EXT-X-MAP data: %s", __FUNCTION__, __LINE__, mInitFragmentInfo);
+		}
+	}
+	AAMPLOG_INFO("%s:%d [%s] playTarget %f skipped %d fragments to position %f", __FUNCTION__, __LINE__, name, playTarget, skipCount, playlistPosition);
+	return (char *)uriEnd + 1;
+}
+
 /***************************************************************************
 * @fn GetNextFragmentUriFromPlaylist
-* @brief Function to get next fragment URI from playlist based on playtarget
+* @brief Function to get next fragment URI from playlist based on playtarget.
+* Walks the playlist text from the current fragment, tags of each record are parsed as they are
+* passed. Only the start of the walk uses the parsed IndexNode records, see SkipFragmentsBeforePlayTarget
 * @param ignoreDiscontinuity Ignore discontinuity
 * @return string fragment URI pointer
 ***************************************************************************/
@@ -1480,15 +1597,31 @@ char *TrackState::GetNextFragmentUriFromPlaylist(bool ignoreDiscontinuity)
 				}
 				else if (startswith(&ptr, "INF:"))
 				{// preceeds each advertised fragment in a playlist
-					if (-1 != playlistPosition)
+					char *resume = NULL;
+					if (-1 == playlistPosition)
 					{
-						playlistPosition += fragmentDurationSeconds;
+						// walk from playlist start, skip fragments far before playTarget with the index
+						resume = SkipFragmentsBeforePlayTarget(ptr - 8, next);
+					}
+					if (resume)
+					{
+						// position and duration of last skipped fragment are set, as after its #EXTINF
+						discontinuity = false;
+						programDateTime = NULL;
+						next = resume;
 					}
 					else
 					{
-						playlistPosition = 0;
+						if (-1 != playlistPosition)
+						{
+							playlistPosition += fragmentDurationSeconds;
+						}
+						else
+						{
+							playlistPosition = 0;
+						}
+						fragmentDurationSeconds = atof(ptr);
 					}
-					fragmentDurationSeconds = atof(ptr);
 #ifdef TRACE
 					logprintf("Next - EXTINF - playlistPosition updated to %f", playlistPosition);
 					// optionally followed by human-readable title
@@ -1848,6 +1981,61 @@ char *TrackState::FindMediaForSequenceNumber()
 	}
 	return NULL;
 }
+/***************************************************************************
+* @fn PrefetchUpcomingFragments
+* @brief Function to start concurrent download of current and upcoming fragments
+*
+* Walks the playlist following current fragment and hands current fragment and
+* next ones, up to configured concurrency, to prefetch downloader. Byte range
+* addressed fragments are not prefetched.
+* @param fragmentUrl[in] resolved url of current fragment
+* @return void
+***************************************************************************/
+void TrackState::PrefetchUpcomingFragments(const std::string &fragmentUrl)
+{
+	std::vector<PrefetchRequest> requests;
+	requests.push_back(PrefetchRequest(fragmentUrl, ""));
+	const char *ptr = fragmentURI + strlen(fragmentURI) + 1;
+	const char *playlistEnd = playlist.ptr + playlist.len;
+	while (ptr < playlistEnd && requests.size() < (size_t)gpGlobalConfig->fragmentDownloadConcurrency)
+	{
+		const char *fin = ptr;
+		while (fin < playlistEnd && *fin && *fin != CHAR_LF && *fin != CHAR_CR)
+		{
+			fin++;
+		}
+		if (*ptr == '#')
+		{
+			if (strncmp(ptr, "#EXT-X-BYTERANGE", 16) == 0)
+			{
+				break;
+			}
+		}
+		else if (fin > ptr)
+		{
+			std::string uri(ptr, fin - ptr);
+			std::string url;
+			aamp_ResolveURL(url, mEffectiveUrl, uri.c_str());
+			requests.push_back(PrefetchRequest(url, ""));
+		}
+		// lines already walked by mystrpbrk end with nul in place of LF or CR, others with LF or CR LF
+		if (fin < playlistEnd && *fin == 0x00)
+		{
+			fin++;
+		}
+		if (fin < playlistEnd && *fin == CHAR_CR)
+		{
+			fin++;
+		}
+		if (fin < playlistEnd && *fin == CHAR_LF)
+		{
+			fin++;
+		}
+		ptr = fin;
+	}
+	mPrefetchDownloader->Prefetch(requests);
+}
+
 /***************************************************************************
 * @fn FetchFragmentHelper
 * @brief Helper function to download fragment
@@ -1956,9 +2144,34 @@ bool TrackState::FetchFragmentHelper(long &http_error, bool &decryption_error, b
 			// patch for http://bitdash-a.akamaihd.net/content/sintel/hls/playlist.m3u8
 			// if fragment URI uses relative path, we don't want to replace effective URI
 			std::string tempEffectiveUrl;
-			traceprintf("%s:%d Calling Getfile . buffer %p avail %d", __FUNCTION__, __LINE__, &cachedFragment->fragment, (int)cachedFragment->fragment.avail);
-			bool fetched = aamp->GetFile(fragmentUrl, &cachedFragment->fragment,
-			 tempEffectiveUrl, &http_error, &downloadTime, range, type, false, (MediaType)(type), NULL, NULL, fragmentDurationSeconds);
+			HlsDrmStreamDecryptor *streamDecryptor = NULL;
+			if (gpGlobalConfig->aesStreamingDecrypt && fragmentEncrypted && mDrmMethod == eDRM_KEY_METHOD_AES_128)
+			{
+				streamDecryptor = CreateStreamDecryptor();
+			}
+			bool fetched = false;
+			if (gpGlobalConfig->fragmentDownloadConcurrency > 1 && !context->trickplayMode)
+			{
+				if (!mPrefetchDownloader)
+				{
+					mPrefetchDownloader = new AampMultiDownloader(aamp, (MediaType)(type), (AampCurlInstance)(type), gpGlobalConfig->fragmentDownloadConcurrency, mFragmentBufferPool);
+				}
+				if (!range)
+				{
+					PrefetchUpcomingFragments(fragmentUrl);
+					fetched = mPrefetchDownloader->Take(fragmentUrl, "", &cachedFragment->fragment, http_error, downloadTime);
+				}
+				else
+				{
+					mPrefetchDownloader->Cancel();
+				}
+			}
+			if (!fetched)
+			{
+				traceprintf("%s:%d Calling Getfile . buffer %p avail %d", __FUNCTION__, __LINE__, &cachedFragment->fragment, (int)cachedFragment->fragment.avail);
+				fetched = aamp->GetFile(fragmentUrl, &cachedFragment->fragment,
+				 tempEffectiveUrl, &http_error, &downloadTime, range, type, false, (MediaType)(type), NULL, NULL, fragmentDurationSeconds, streamDecryptor);
+			}
 			//Workaround for 404 of subtitle fragments
 			//TODO: This needs to be handled at server side and this workaround has to be removed
 			if (!fetched && http_error == 404 && type == eTRACK_SUBTITLE)
@@ -1995,6 +2208,7 @@ bool TrackState::FetchFragmentHelper(long &http_error, bool &decryption_error, b
 				}
 				aamp_Free(&cachedFragment->fragment.ptr);
 				lastDownloadedIFrameTarget = -1;
+				delete streamDecryptor;
 				return false;
 			}
 			else
@@ -2030,7 +2244,9 @@ bool TrackState::FetchFragmentHelper(long &http_error, bool &decryption_error, b
 				bKeyChanged = mKeyTagChanged;
 				{	
 					traceprintf("%s:%d [%s] uri %s - calling  DrmDecrypt()", __FUNCTION__, __LINE__, name, fragmentURI);
-					DrmReturn drmReturn = DrmDecrypt(cachedFragment, mediaTrackDecryptBucketTypes[type]);
+					DrmReturn drmReturn = DrmDecrypt(cachedFragment, mediaTrackDecryptBucketTypes[type], streamDecryptor);
+					delete streamDecryptor;
+					streamDecryptor = NULL;
 
 					if(eDRM_SUCCESS != drmReturn)
 					{
@@ -2087,6 +2303,7 @@ bool TrackState::FetchFragmentHelper(long &http_error, bool &decryption_error, b
 				context->HarvestFile(fragmentUrl, &cachedFragment->fragment, true);
 			}
 #endif
+			delete streamDecryptor;
 		}
 		else
 		{
@@ -2283,14 +2500,21 @@ void TrackState::InjectFragmentInternal(CachedFragment* cachedFragment, bool &fr
 		{
 			position = cachedFragment->position;
 		}
-		fragmentDiscarded = !playContext->sendSegment(cachedFragment->fragment.ptr, cachedFragment->fragment.len,
-				position, cachedFragment->duration, cachedFragment->discontinuity, ptsError);
+		// fragment memory goes back to the pool once sink has released all of it
+		AampSharedBlock *block = aamp_CreateSharedBlock(&cachedFragment->fragment, mFragmentBufferPool);
+		size_t len = block->buffer.len;
+		AampPlaybackPhaseTimer demuxTimer(aamp->mPlaybackProfiler, type, PLAYBACK_PHASE_DEMUX);
+		fragmentDiscarded = !playContext->sendSegment(block->buffer.ptr, len,
+				position, cachedFragment->duration, cachedFragment->discontinuity, ptsError, block);
+		aamp_SharedBlockUnref(block);
 	}
 	else
 	{
 		fragmentDiscarded = false;
-		aamp->SendStream((MediaType)type, cachedFragment->fragment.ptr, cachedFragment->fragment.len,
+		AampSharedBlock *block = aamp_CreateSharedBlock(&cachedFragment->fragment, mFragmentBufferPool);
+		aamp->SendStream((MediaType)type, block, block->buffer.ptr, block->buffer.len,
 		        cachedFragment->position, cachedFragment->position, cachedFragment->duration);
+		aamp_SharedBlockUnref(block);
 	}
 #endif
 #endif
@@ -2358,6 +2582,7 @@ void TrackState::FlushIndex()
 	aamp_Free(&index.ptr);
 	indexFirstMediaSequenceNumber = 0;
 	mProgramDateTime = 0.0; // new member - stored first program date time (if any) from playlist
+	mProgramDateTimeIdx = 0;
 	indexCount = 0;
 	index.len = 0;
 	index.avail = 0;
@@ -2663,16 +2888,274 @@ static size_t FindLineLength(const char* ptr)
 	return len;
 }
 
+/***************************************************************************
+* @fn RetainedPlaylistMatches
+* @brief Function to compare a playlist region against its refreshed copy.
+* mystrpbrk replaces line terminators of an indexed playlist with nul,
+* so nul in previous playlist matches CR/LF in refreshed one
+* @param[in] prev region of previously indexed playlist
+* @param[in] next region of refreshed playlist
+* @param[in] len length of region
+* @return true if both regions hold the same playlist text
+***************************************************************************/
+static bool RetainedPlaylistMatches(const char *prev, const char *next, size_t len)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		if (prev[i] != next[i] && !(prev[i] == 0x00 && (next[i] == CHAR_LF || next[i] == CHAR_CR)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/***************************************************************************
+* @fn BeginIncrementalIndex
+* @brief Function to check if refreshed live playlist only appends to and culls
+* from currently indexed playlist. If so, index state is kept for reuse by
+* SpliceRetainedIndex instead of being flushed
+*
+* @param[in] prevPlaylist previously indexed playlist, referenced by index
+* @param[out] info state needed to splice retained index
+* @return true if incremental indexing can be done
+***************************************************************************/
+bool TrackState::BeginIncrementalIndex(const GrowableBuffer *prevPlaylist, IncrementalIndexInfo &info)
+{
+	if (!gpGlobalConfig->incrementalPlaylistIndex || !prevPlaylist || !prevPlaylist->ptr || !playlist.ptr ||
+		memcmp(playlist.ptr, "#EXTM3U", 7) != 0 || !IsLive() || refreshPlaylist || indexCount <= 0 || !index.ptr)
+	{
+		return false;
+	}
+	if (mDrmMetaDataIndexCount || mCMSha1Hash)
+	{
+		// Adobe access metadata is tracked per indexing by AveDrmManager, always do full indexing
+		return false;
+	}
+
+	// Only header tags are needed here; locate media sequence and first fragment of refreshed playlist
+	long long mediaSequenceNumber = -1;
+	const char *firstFragmentInfo = NULL;
+	const char *playlistEnd = playlist.ptr + playlist.len;
+	char *ptr = playlist.ptr;
+	while (ptr && ptr < playlistEnd)
+	{
+		if (strncmp(ptr, "#EXT-X-MEDIA-SEQUENCE:", 22) == 0)
+		{
+			mediaSequenceNumber = atoll(ptr + 22);
+		}
+		else if (strncmp(ptr, "#EXTINF:", 8) == 0)
+		{
+			firstFragmentInfo = ptr;
+			break;
+		}
+		ptr = GetNextLineStart(ptr);
+	}
+	if (mediaSequenceNumber < 0 || !firstFragmentInfo)
+	{
+		AAMPLOG_INFO("%s:%d [%s] no media sequence, full indexing", __FUNCTION__, __LINE__, name);
+		return false;
+	}
+	long long culledCount = mediaSequenceNumber - indexFirstMediaSequenceNumber;
+	if (culledCount < 0 || culledCount >= indexCount)
+	{
+		AAMPLOG_INFO("%s:%d [%s] no overlap (culled %lld of %d), full indexing", __FUNCTION__, __LINE__, name, culledCount, indexCount);
+		return false;
+	}
+
+	const IndexNode *nodes = (const IndexNode *) index.ptr;
+	const char *prevStart = nodes[culledCount].pFragmentInfo;
+	const char *prevLast = nodes[indexCount - 1].pFragmentInfo;
+	const char *prevEnd = prevPlaylist->ptr + prevPlaylist->len;
+	if (prevStart < prevPlaylist->ptr || prevLast >= prevEnd)
+	{
+		return false;
+	}
+	long offsetShift = (long)(firstFragmentInfo - playlist.ptr) - (long)(prevStart - prevPlaylist->ptr);
+
+	// Retained window ends with uri line of last previously indexed fragment
+	char *lastUri = playlist.ptr + (prevLast - prevPlaylist->ptr) + offsetShift;
+	while (lastUri && lastUri < playlistEnd && (*lastUri == '#' || *lastUri == CHAR_CR || *lastUri == CHAR_LF))
+	{
+		lastUri = GetNextLineStart(lastUri);
+	}
+	if (!lastUri || lastUri < firstFragmentInfo || lastUri >= playlistEnd)
+	{
+		AAMPLOG_INFO("%s:%d [%s] retained fragments not found, full indexing", __FUNCTION__, __LINE__, name);
+		return false;
+	}
+	const char *retainedEnd = lastUri + FindLineLength(lastUri);
+	size_t retainedLen = retainedEnd - firstFragmentInfo;
+	if (prevStart + retainedLen > prevEnd || !RetainedPlaylistMatches(prevStart, firstFragmentInfo, retainedLen))
+	{
+		AAMPLOG_INFO("%s:%d [%s] retained fragments changed, full indexing", __FUNCTION__, __LINE__, name);
+		return false;
+	}
+
+	info.prevPlaylist = prevPlaylist;
+	info.prevIndexCount = indexCount;
+	info.culledCount = (int)culledCount;
+	info.culledDuration = (culledCount > 0) ? nodes[culledCount - 1].completionTimeSecondsFromStart : 0;
+	info.offsetShift = offsetShift;
+	info.lastRetainedUri = lastUri;
+	info.prevKeyHashTable.swap(mKeyHashTable);
+	info.prevDiscontinuityIndex = mDiscontinuityIndex;
+	info.prevDiscontinuityIndexCount = mDiscontinuityIndexCount;
+	info.prevProgramDateTime = mProgramDateTime;
+	info.prevProgramDateTimeIdx = mProgramDateTimeIdx;
+
+	// Same as FlushIndex, but index buffer is kept to hold retained IndexNodes
+	memset(&mDiscontinuityIndex, 0, sizeof(mDiscontinuityIndex));
+	mDiscontinuityIndexCount = 0;
+	indexFirstMediaSequenceNumber = 0;
+	mProgramDateTime = 0.0;
+	mProgramDateTimeIdx = 0;
+	indexCount = 0;
+	currentIdx = -1;
+	mDrmKeyTagCount = 0;
+	mLastKeyTagIdx = -1;
+	mDeferredDrmKeyMaxTime = 0;
+	mInitFragmentInfo = NULL;
+	traceprintf("%s:%d [%s] culled %d retained %d", __FUNCTION__, __LINE__, name, info.culledCount, info.prevIndexCount - info.culledCount);
+	return true;
+}
+
+/***************************************************************************
+* @fn SpliceRetainedIndex
+* @brief Function to reuse IndexNodes, key tags and discontinuities of fragments
+* retained across playlist refresh. Called when first fragment of refreshed
+* playlist is reached; header tags are already parsed at this point
+*
+* @param[in] info state from BeginIncrementalIndex
+* @param[in,out] drmMetadataIdx drm index in effect after retained fragments
+* @param[in,out] initFragmentPtr init fragment in effect after retained fragments
+* @param[out] totalDuration duration of retained fragments
+* @return uri line of last retained fragment, to resume parsing after
+***************************************************************************/
+char *TrackState::SpliceRetainedIndex(IncrementalIndexInfo &info, int &drmMetadataIdx, const char *&initFragmentPtr, double &totalDuration)
+{
+	const char *prevStart = info.prevPlaylist->ptr;
+	const char *prevEnd = prevStart + info.prevPlaylist->len;
+	IndexNode *nodes = (IndexNode *) index.ptr;
+	const char *retainedStart = nodes[info.culledCount].pFragmentInfo;
+	const int lastFragmentIdx = info.prevIndexCount - 1;
+	const int headerKeyTagCount = mDrmKeyTagCount;
+	const int headerDrmMetadataIdx = drmMetadataIdx;
+	const char *headerInitFragmentPtr = initFragmentPtr;
+	// Translates position in previous playlist into refreshed playlist
+	auto rebase = [&](const char *ptr) { return (const char *)playlist.ptr + (ptr - prevStart) + info.offsetShift; };
+
+	// Key tags placed after first retained fragment are not parsed again
+	int firstRetainedKey = -1;
+	int firstKeyedFragment = info.prevIndexCount;
+	for (int i = 0; i < (int)info.prevKeyHashTable.size(); i++)
+	{
+		const KeyTagStruct &keyinfo = info.prevKeyHashTable[i];
+		if (keyinfo.mFragmentIdx > info.culledCount && keyinfo.mFragmentIdx <= lastFragmentIdx)
+		{
+			if (firstRetainedKey < 0)
+			{
+				firstRetainedKey = i;
+				firstKeyedFragment = keyinfo.mFragmentIdx;
+			}
+			KeyTagStruct retainedKey = keyinfo;
+			retainedKey.mKeyStartDuration -= info.culledDuration;
+			retainedKey.mFragmentIdx -= info.culledCount;
+			mKeyHashTable.push_back(retainedKey);
+			mDrmKeyTagCount++;
+		}
+	}
+
+	for (int i = info.culledCount; i <= lastFragmentIdx; i++)
+	{
+		IndexNode node = nodes[i];
+		node.completionTimeSecondsFromStart -= info.culledDuration;
+		node.pFragmentInfo = rebase(node.pFragmentInfo);
+		if (node.uri)
+		{
+			node.uri = rebase(node.uri);
+		}
+		if (i < firstKeyedFragment)
+		{
+			node.drmMetadataIdx = headerDrmMetadataIdx;
+		}
+		else if (node.drmMetadataIdx != -1)
+		{
+			node.drmMetadataIdx = node.drmMetadataIdx - firstRetainedKey + headerKeyTagCount;
+		}
+		if (node.initFragmentPtr >= retainedStart && node.initFragmentPtr < prevEnd)
+		{
+			node.initFragmentPtr = rebase(node.initFragmentPtr);
+		}
+		else
+		{
+			node.initFragmentPtr = headerInitFragmentPtr;
+		}
+		nodes[indexCount++] = node;
+	}
+	index.len = indexCount * sizeof(IndexNode);
+	drmMetadataIdx = nodes[indexCount - 1].drmMetadataIdx;
+	initFragmentPtr = nodes[indexCount - 1].initFragmentPtr;
+	totalDuration = nodes[indexCount - 1].completionTimeSecondsFromStart;
+
+	if (mDrmKeyTagCount > headerKeyTagCount)
+	{
+		// Restore encryption state of last retained key tag
+		const std::string &keyTagStr = mKeyHashTable.back().mKeyTagStr;
+		char* key = (char*) malloc(keyTagStr.size() + 1);
+		memcpy(key, keyTagStr.data(), keyTagStr.size());
+		key[keyTagStr.size()] = '\0';
+		ParseAttrList(key, ParseKeyAttributeCallback, this);
+		mKeyTagChanged = false;
+		free(key);
+	}
+
+	const DiscontinuityIndexNode *discontinuities = (const DiscontinuityIndexNode *) info.prevDiscontinuityIndex.ptr;
+	for (int i = 0; i < info.prevDiscontinuityIndexCount; i++)
+	{
+		if (discontinuities[i].fragmentIdx > info.culledCount && discontinuities[i].fragmentIdx <= lastFragmentIdx)
+		{
+			DiscontinuityIndexNode discontinuityIndexNode = discontinuities[i];
+			discontinuityIndexNode.fragmentIdx -= info.culledCount;
+			discontinuityIndexNode.position -= info.culledDuration;
+			if (discontinuityIndexNode.programDateTime >= retainedStart && discontinuityIndexNode.programDateTime < prevEnd)
+			{
+				discontinuityIndexNode.programDateTime = rebase(discontinuityIndexNode.programDateTime);
+			}
+			else
+			{
+				discontinuityIndexNode.programDateTime = NULL;
+				discontinuityIndexNode.programDateTimeSeconds = 0;
+			}
+			aamp_AppendBytes(&mDiscontinuityIndex, &discontinuityIndexNode, sizeof(DiscontinuityIndexNode));
+			mDiscontinuityIndexCount++;
+		}
+	}
+	aamp_Free(&info.prevDiscontinuityIndex.ptr);
+
+	if (info.prevProgramDateTimeIdx > info.culledCount && info.prevProgramDateTimeIdx <= lastFragmentIdx)
+	{
+		mProgramDateTime = info.prevProgramDateTime;
+		mProgramDateTimeIdx = info.prevProgramDateTimeIdx - info.culledCount;
+	}
+	if (mFirstEncInitFragmentInfo >= retainedStart && mFirstEncInitFragmentInfo < prevEnd)
+	{
+		mFirstEncInitFragmentInfo = rebase(mFirstEncInitFragmentInfo);
+	}
+	AAMPLOG_INFO("%s:%d [%s] reused %d of %d indexed fragments", __FUNCTION__, __LINE__, name, indexCount, info.prevIndexCount);
+	return (char *) info.lastRetainedUri;
+}
+
 /***************************************************************************
 * @fn IndexPlaylist
 * @brief Function to parse playlist
 *
 * @return double total duration from playlist
 ***************************************************************************/
-void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec)
+void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec, const GrowableBuffer *prevPlaylist)
 {
 	double totalDuration = 0.0;
-	pthread_mutex_lock(&mPlaylistMutex);
+	AAMP_MUTEX_LOCK(mPlaylistMutex, "TrackState::mPlaylistMutex");
 	double prevProgramDateTime = mProgramDateTime;
 	long long commonPlayPosition = nextMediaSequenceNumber - 1; 
 	double prevSecondsBeforePlayPoint; 
@@ -2683,7 +3166,12 @@ void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec)
 		prevSecondsBeforePlayPoint = GetCompletionTimeForFragment(this, commonPlayPosition); 
 	}
 
-	FlushIndex();
+	IncrementalIndexInfo incremental;
+	bool indexIncrementally = (IsRefresh && BeginIncrementalIndex(prevPlaylist, incremental));
+	if (!indexIncrementally)
+	{
+		FlushIndex();
+	}
 	mIndexingInProgress = true;
 	if (playlist.ptr )
 	{
@@ -2699,7 +3187,7 @@ void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec)
 		    aamp->SendErrorEvent(AAMP_TUNE_INVALID_MANIFEST_FAILURE);
 		    mDuration = totalDuration;
 		    pthread_cond_signal(&mPlaylistIndexed);
-		    pthread_mutex_unlock(&mPlaylistMutex);
+		    AAMP_MUTEX_UNLOCK(mPlaylistMutex);
 		    return;
 		}
 		DrmMetadataNode drmMetadataNode;
@@ -2711,6 +3199,9 @@ void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec)
 		bool mediaSequence = false;
 		const char* programDateTimeIdxOfFragment = NULL;
 		bool discontinuity = false;
+		int pendingByteRangeOffset = -1;	// byte range tag seen before fragment URI, -1 for implicit offset
+		int pendingByteRangeLength = 0;
+		int byteRangeEnd = 0;				// end of previous byte range, offset of a range without offset
 
 		mDrmInfo.mediaFormat = eMEDIAFORMAT_HLS;
 		mDrmInfo.manifestURL = mEffectiveUrl;
@@ -2731,19 +3222,44 @@ void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec)
 						discontinuityIndexNode.fragmentIdx = indexCount;
 						discontinuityIndexNode.position = totalDuration;
 						discontinuityIndexNode.programDateTime = programDateTimeIdxOfFragment;
+						discontinuityIndexNode.programDateTimeSeconds = (programDateTimeIdxOfFragment != NULL) ? mProgramDateTime : 0;
 						discontinuityIndexNode.fragmentDuration = atof(ptr);
 						aamp_AppendBytes(&mDiscontinuityIndex, &discontinuityIndexNode, sizeof(DiscontinuityIndexNode));
 						mDiscontinuityIndexCount++;
 						discontinuity = false;
 					}
 					programDateTimeIdxOfFragment = NULL;
-					node.pFragmentInfo = ptr-8;//Point to beginning of #EXTINF
-					indexCount++;
-					totalDuration += atof(ptr);
-					node.completionTimeSecondsFromStart = totalDuration;
-					node.drmMetadataIdx = drmMetadataIdx;
-					node.initFragmentPtr = initFragmentPtr;
-					aamp_AppendBytes(&index, &node, sizeof(node));
+					if (indexIncrementally)
+					{
+						// First fragment of refreshed playlist is already indexed, reuse retained nodes
+						// and continue parsing after the last of them
+						ptr = SpliceRetainedIndex(incremental, drmMetadataIdx, initFragmentPtr, totalDuration);
+						indexIncrementally = false;
+						const IndexNode *lastRetained = &((const IndexNode *) index.ptr)[indexCount - 1];
+						byteRangeEnd = lastRetained->byteRangeOffset + lastRetained->byteRangeLength;
+					}
+					else
+					{
+						node.pFragmentInfo = ptr-8;//Point to beginning of #EXTINF
+						indexCount++;
+						totalDuration += atof(ptr);
+						node.completionTimeSecondsFromStart = totalDuration;
+						node.drmMetadataIdx = drmMetadataIdx;
+						node.initFragmentPtr = initFragmentPtr;
+						// URI and byte range are filled in when URI line is reached
+						node.uri = NULL;
+						node.uriLength = 0;
+						node.byteRangeOffset = 0;
+						node.byteRangeLength = 0;
+						aamp_AppendBytes(&index, &node, sizeof(node));
+					}
+				}
+				else if(startswith(&ptr,"-X-BYTERANGE:"))
+				{
+					// <length>[@<offset>], without offset the range follows previous one
+					pendingByteRangeLength = atoi(ptr);
+					const char *offsetDelim = strchr(ptr, '@');
+					pendingByteRangeOffset = (offsetDelim && offsetDelim < ptr + FindLineLength(ptr)) ? atoi(offsetDelim + 1) : -1;
 				}
 				else if(startswith(&ptr,"-X-MEDIA-SEQUENCE:"))
 				{
@@ -2816,6 +3332,7 @@ void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec)
 				{
 					programDateTimeIdxOfFragment = ptr;					
 					mProgramDateTime = ISO8601DateTimeToUTCSeconds(ptr);
+					mProgramDateTimeIdx = indexCount;
 					//AAMPLOG_INFO("%s EXT-X-PROGRAM-DATE-TIME: %.*s ",name, 30, programDateTimeIdxOfFragment);
 					// The first X-PROGRAM-DATE-TIME tag holds the start time for each track
 					if (startTimeForPlaylistSync == 0.0 )
@@ -2841,6 +3358,7 @@ void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec)
 					// check if during trickplay drmInfo is considered.
 					KeyTagStruct keyinfo;
 					keyinfo.mKeyStartDuration = totalDuration;
+					keyinfo.mFragmentIdx = indexCount;
 					keyinfo.mKeyTagStr.resize(len);
 					memcpy((char*)keyinfo.mKeyTagStr.data(),key,len);
 
@@ -2936,6 +3454,24 @@ void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec)
 					}
 				}
 			}
+			else if (*ptr != '#' && *ptr != CHAR_CR && *ptr != CHAR_LF && *ptr != '\0' && indexCount > 0)
+			{
+				// URI line completes record of last indexed fragment
+				IndexNode *lastNode = &((IndexNode *) index.ptr)[indexCount - 1];
+				if (NULL == lastNode->uri)
+				{
+					lastNode->uri = ptr;
+					lastNode->uriLength = (int)FindLineLength(ptr);
+					if (pendingByteRangeLength)
+					{
+						lastNode->byteRangeOffset = (pendingByteRangeOffset >= 0) ? pendingByteRangeOffset : byteRangeEnd;
+						lastNode->byteRangeLength = pendingByteRangeLength;
+						byteRangeEnd = lastNode->byteRangeOffset + lastNode->byteRangeLength;
+					}
+				}
+				pendingByteRangeOffset = -1;
+				pendingByteRangeLength = 0;
+			}
 			ptr=GetNextLineStart(ptr);
 		}
 
@@ -3044,7 +3580,7 @@ void TrackState::IndexPlaylist(bool IsRefresh, double &culledSec)
 	}	
 
 	pthread_cond_signal(&mPlaylistIndexed);
-	pthread_mutex_unlock(&mPlaylistMutex);
+	AAMP_MUTEX_UNLOCK(mPlaylistMutex);
 }
 
 #ifdef AAMP_HARVEST_SUPPORT_ENABLED
@@ -3101,7 +3637,7 @@ void TrackState::ABRProfileChanged()
 	{
 		traceprintf("%s:%d playlistPosition %f", __FUNCTION__,__LINE__, playlistPosition);
 		aamp_ResolveURL(mPlaylistUrl, aamp->GetManifestUrl(), pcontext);
-		pthread_mutex_lock(&mutex);
+		AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
 		//playlistPosition reset will be done by RefreshPlaylist once playlist downloaded successfully
 		//refreshPlaylist is used to reset the profile index if playlist download fails! Be careful with it.
 		//Video profile change will definitely require new init headers
@@ -3114,7 +3650,7 @@ void TrackState::ABRProfileChanged()
 	{
 		AAMPLOG_WARN("%s:%d :  GetPlaylistURI  is null", __FUNCTION__, __LINE__);  //CID:83060 - Null Returns
 	}
-	pthread_mutex_unlock(&mutex);
+	AAMP_MUTEX_UNLOCK(mutex);
 
 }
 /***************************************************************************
@@ -3199,7 +3735,6 @@ void TrackState::RefreshPlaylist(void)
 		{
 			context->mNetworkDownDetected = false;
 		}
-		aamp_Free(&tempBuff.ptr);
 		aamp_AppendNulTerminator(&playlist); // hack: make safe for cstring operations
 #ifdef TRACE
 		if (gpGlobalConfig->logging.trace)
@@ -3209,7 +3744,10 @@ void TrackState::RefreshPlaylist(void)
 #endif
 
 		double culled;
-		IndexPlaylist(true, culled);
+		// Previous playlist is kept until indexing completes, so that fragments retained
+		// across the refresh can be reused instead of being parsed again
+		IndexPlaylist(true, culled, &tempBuff);
+		aamp_Free(&tempBuff.ptr);
 		// Update culled seconds if playlist download was successful
 		// DELIA-40121: We need culledSeconds to find the timedMetadata position in playlist
 		// culledSeconds and FindTimedMetadata have been moved up here, because FindMediaForSequenceNumber
@@ -4305,7 +4843,7 @@ AAMPStatusType StreamAbstractionAAMP_HLS::Init(TuneType tuneType)
 		}
 		aamp->profiler.SetBandwidthBitsPerSecondAudio(audio->GetCurrentBandWidth());
 
-		pthread_t trackPLDownloadThreadID;
+		AampWorkerTask *trackPLDownloadTask = NULL;
 		bool trackPLDownloadThreadStarted = false;
 		if (audio->enabled)
 		{
@@ -4317,10 +4855,10 @@ AAMPStatusType StreamAbstractionAAMP_HLS::Init(TuneType tuneType)
 			{
 				if (aamp->mParallelFetchPlaylist)
 				{
-					int ret = pthread_create(&trackPLDownloadThreadID, NULL, TrackPLDownloader, audio);
-					if(ret != 0)
+					trackPLDownloadTask = aamp->GetWorkerPool()->Submit("TrackPLDownloader", TrackPLDownloader, audio, eAAMP_TASK_PRIORITY_TUNE);
+					if(NULL == trackPLDownloadTask)
 					{
-						logprintf("StreamAbstractionAAMP_HLS::%s:%d pthread_create failed for TrackPLDownloader with errno = %d, %s", __FUNCTION__, __LINE__, errno, strerror(errno));
+						logprintf("StreamAbstractionAAMP_HLS::%s:%d Submit failed for TrackPLDownloader", __FUNCTION__, __LINE__);
 					}
 					else
 					{
@@ -4414,7 +4952,7 @@ AAMPStatusType StreamAbstractionAAMP_HLS::Init(TuneType tuneType)
 
 		if (trackPLDownloadThreadStarted)
 		{
-			pthread_join(trackPLDownloadThreadID, NULL);
+			aamp->GetWorkerPool()->Join(trackPLDownloadTask);
 		}
 		if (video->enabled && !video->playlist.len)
 		{
@@ -5222,14 +5760,10 @@ void StreamAbstractionAAMP_HLS::PreCachePlaylist()
 	
 	// Set the download list to PrivateInstance to download it 
 	aamp->SetPreCacheDownloadList(dnldList);
-	int ret = pthread_create(&aamp->mPreCachePlaylistThreadId, NULL, CachePlaylistThreadFunction,(void *)aamp );
-	if(ret != 0)
-	{
-		AAMPLOG_ERR("%s:%d pthread_create failed for PreCachePlaylist with errno = %d, %s", __FUNCTION__, __LINE__, errno, strerror(errno));
-	}
-	else
+	aamp->mPreCachePlaylistTask = aamp->GetWorkerPool()->Submit("PreCachePlaylist", CachePlaylistThreadFunction, (void *)aamp, eAAMP_TASK_PRIORITY_BACKGROUND);
+	if(!aamp->mPreCachePlaylistTask)
 	{
-		aamp->mPreCachePlaylistThreadFlag = true;
+		AAMPLOG_ERR("%s:%d Submit failed for PreCachePlaylist", __FUNCTION__, __LINE__);
 	}
 }
 
@@ -5285,7 +5819,7 @@ void TrackState::SwitchSubtitleTrack()
 {
 	if (eTRACK_SUBTITLE == type && mSubtitleParser)
 	{
-		pthread_mutex_lock(&mutex);
+		AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
 		
 		AAMPLOG_INFO("%s:%d Preparing to flush fragments and switch playlist", __FUNCTION__, __LINE__);
 		// Flush all counters, reset the playlist URL and refresh the playlist
@@ -5299,7 +5833,7 @@ void TrackState::SwitchSubtitleTrack()
 
 		mSubtitleParser->init(aamp->GetPositionMilliseconds() / 1000.0, aamp->GetBasePTS());
 
-		pthread_mutex_unlock(&mutex);		
+		AAMP_MUTEX_UNLOCK(mutex);		
 	}
 }
 
@@ -5404,14 +5938,14 @@ void TrackState::RunFetchLoop()
 				SwitchSubtitleTrack();
 			}
 			
-			pthread_mutex_lock(&mutex);
+			AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
 			if(refreshPlaylist)
 			{
 				//AAMPLOG_INFO("%s:%d: Refreshing '%s' playlist", __FUNCTION__, __LINE__, name);
 				RefreshPlaylist();
 				refreshPlaylist = false;
 			}
-			pthread_mutex_unlock(&mutex);
+			AAMP_MUTEX_UNLOCK(mutex);
 		}
 		// reached end of vod stream
 		//teststreamer_EndOfStreamReached();
@@ -5600,8 +6134,10 @@ TrackState::TrackState(TrackType type, StreamAbstractionAAMP_HLS* parent, Privat
 		mCheckForInitialFragEnc(false), mFirstEncInitFragmentInfo(NULL), mDrmMethod(eDRM_KEY_METHOD_NONE)
 		,mXStartTimeOFfset(0), mCulledSecondsAtStart(0.0)
 		,mProgramDateTime(0.0)
+		,mProgramDateTimeIdx(0)
 		,mDiscontinuityCheckingOn(false)
 		,mSkipSegmentOnError(true)
+		,mPrefetchDownloader(NULL)
 {
 	memset(&playlist, 0, sizeof(playlist));
 	memset(&index, 0, sizeof(index));
@@ -5645,6 +6181,11 @@ TrackState::~TrackState()
 		free(mDrmInfo.iv);
 		mDrmInfo.iv = NULL;
 	}
+	if (mPrefetchDownloader)
+	{
+		delete mPrefetchDownloader;
+		mPrefetchDownloader = NULL;
+	}
 	pthread_cond_destroy(&mPlaylistIndexed);
 	pthread_mutex_destroy(&mPlaylistMutex);
 	pthread_mutex_destroy(&mTrackDrmMutex);
@@ -5974,9 +6515,10 @@ void StreamAbstractionAAMP_HLS::NotifyPlaybackPaused(bool pause)
 *
 * @param cachedFragment[in] CachedFragment struction pointer
 * @param bucketTypeFragmentDecrypt[in] ProfilerBucketType enum
+* @param streamDecryptor[in] decryptor already applied during download, if any
 * @return bool true if successfully decrypted
 ***************************************************************************/
-DrmReturn TrackState::DrmDecrypt( CachedFragment * cachedFragment, ProfilerBucketType bucketTypeFragmentDecrypt)
+DrmReturn TrackState::DrmDecrypt( CachedFragment * cachedFragment, ProfilerBucketType bucketTypeFragmentDecrypt, HlsDrmStreamDecryptor *streamDecryptor)
 {
 		DrmReturn drmReturn = eDRM_ERROR;
 
@@ -5993,8 +6535,20 @@ DrmReturn TrackState::DrmDecrypt( CachedFragment * cachedFragment, ProfilerBucke
 				SetDrmContext();
 				mKeyTagChanged = false;
 			}
-			if(mDrm)
+			if(streamDecryptor)
 			{
+				// fragment is decrypted as it was downloaded, only check completion
+				drmReturn = streamDecryptor->Finish(&cachedFragment->fragment);
+				long long startTimeUs = streamDecryptor->GetStartTimeUs();
+				if (startTimeUs)
+				{
+					// whole chunked decrypt, from first block decrypted during download until completion
+					aamp->mPlaybackProfiler.Record(type, PLAYBACK_PHASE_DECRYPT, AampPlaybackProfiler::NowUs() - startTimeUs);
+				}
+			}
+			else if(mDrm)
+			{
+				AampPlaybackPhaseTimer decryptTimer(aamp->mPlaybackProfiler, type, PLAYBACK_PHASE_DECRYPT);
 				drmReturn = mDrm->Decrypt(bucketTypeFragmentDecrypt, cachedFragment->fragment.ptr,
 						cachedFragment->fragment.len, MAX_LICENSE_ACQ_WAIT_TIME);
 
@@ -6009,6 +6563,25 @@ DrmReturn TrackState::DrmDecrypt( CachedFragment * cachedFragment, ProfilerBucke
 		return drmReturn;
 }
 
+/***************************************************************************
+* @fn CreateStreamDecryptor
+* @brief Function to get decryptor to decrypt the fragment while it is downloaded.
+* Only available when DRM context of track is already set up and key acquired
+*
+* @return HlsDrmStreamDecryptor to be deleted by caller, NULL to decrypt after download
+***************************************************************************/
+HlsDrmStreamDecryptor* TrackState::CreateStreamDecryptor()
+{
+	HlsDrmStreamDecryptor *streamDecryptor = NULL;
+	pthread_mutex_lock(&mTrackDrmMutex);
+	if (mDrm && !mKeyTagChanged)
+	{
+		streamDecryptor = mDrm->CreateStreamDecryptor(&mDrmInfo, mediaTrackDecryptBucketTypes[type]);
+	}
+	pthread_mutex_unlock(&mTrackDrmMutex);
+	return streamDecryptor;
+}
+
 /***************************************************************************
 * @fn GetContext
 * @brief Function to get current StreamAbstractionAAMP instance value
@@ -6271,17 +6844,16 @@ void TrackState::GetNextFragmentPeriodInfo(int &periodIdx, double &offsetFromPer
 	int idx;
 	double prevCompletionTimeSecondsFromStart = 0;
 	assert(context->rate > 0);
-	for (idx = 0; idx < indexCount; idx++)
+	idx = FindFirstNodeCompletingAfter(index, 0, indexCount, playTarget);
+	if (idx < indexCount)
 	{
-		const IndexNode *node = &index[idx];
-		if (node->completionTimeSecondsFromStart > playTarget)
+		idxNode = &index[idx];
+		logprintf("%s (%s) Found node - rate %f completionTimeSecondsFromStart %f playTarget %f", __FUNCTION__, name,
+		        context->rate, idxNode->completionTimeSecondsFromStart, playTarget);
+		if (idx > 0)
 		{
-			logprintf("%s (%s) Found node - rate %f completionTimeSecondsFromStart %f playTarget %f", __FUNCTION__, name,
-			        context->rate, node->completionTimeSecondsFromStart, playTarget);
-			idxNode = node;
-			break;
+			prevCompletionTimeSecondsFromStart = index[idx - 1].completionTimeSecondsFromStart;
 		}
-		prevCompletionTimeSecondsFromStart = node->completionTimeSecondsFromStart;
 	}
 	if (idxNode)
 	{
@@ -6290,20 +6862,18 @@ void TrackState::GetNextFragmentPeriodInfo(int &periodIdx, double &offsetFromPer
 			offsetFromPeriodStart = prevCompletionTimeSecondsFromStart;
 			double periodStartPosition = 0;
 			DiscontinuityIndexNode* discontinuityIndex = (DiscontinuityIndexNode*)mDiscontinuityIndex.ptr;
-			for (int i = 0; i < mDiscontinuityIndexCount; i++)
+			// period of fragment is started by last discontinuity at or before it
+			int i = FindFirstDiscontinuityAfterFragment(discontinuityIndex, mDiscontinuityIndexCount, idx);
+			if (i > 0)
 			{
-				traceprintf("TrackState::%s [%s] Loop periodItr %d idx %d first %d second %f", __FUNCTION__, name, i, idx,
-				        discontinuityIndex[i].fragmentIdx, discontinuityIndex[i].position);
-				if (discontinuityIndex[i].fragmentIdx > idx)
-				{
-					logprintf("TrackState::%s [%s] Found periodItr %d idx %d first %d offsetFromPeriodStart %f",
-					        __FUNCTION__, name, i, idx, discontinuityIndex[i].fragmentIdx, periodStartPosition);
-
-					fragmentIdx = discontinuityIndex[i].fragmentIdx;
-					break;
-				}
-				periodIdx = i;
-				periodStartPosition = discontinuityIndex[i].position;
+				periodIdx = i - 1;
+				periodStartPosition = discontinuityIndex[periodIdx].position;
+			}
+			if (i < mDiscontinuityIndexCount)
+			{
+				logprintf("TrackState::%s [%s] Found periodItr %d idx %d first %d offsetFromPeriodStart %f",
+				        __FUNCTION__, name, i, idx, discontinuityIndex[i].fragmentIdx, periodStartPosition);
+				fragmentIdx = discontinuityIndex[i].fragmentIdx;
 			}
 			offsetFromPeriodStart -= periodStartPosition;
 		}
@@ -6327,24 +6897,12 @@ double TrackState::GetPeriodStartPosition(int periodIdx)
 	double offset = 0;
 	logprintf("TrackState::%s [%s] periodIdx %d periodCount %d", __FUNCTION__, name, periodIdx,
 	        (int) mDiscontinuityIndexCount);
-	if (periodIdx < mDiscontinuityIndexCount)
+	if (periodIdx >= 0 && periodIdx < mDiscontinuityIndexCount)
 	{
-		int count = 0;
 		DiscontinuityIndexNode* discontinuityIndex = (DiscontinuityIndexNode*)mDiscontinuityIndex.ptr;
-		for (int i = 0; i < mDiscontinuityIndexCount; i++)
-		{
-			if (count == periodIdx)
-			{
-				offset = discontinuityIndex[i].position;
-				logprintf("TrackState::%s [%s] offset %f periodCount %d", __FUNCTION__, name, offset,
-				        (int) mDiscontinuityIndexCount);
-				break;
-			}
-			else
-			{
-				count++;
-			}
-		}
+		offset = discontinuityIndex[periodIdx].position;
+		logprintf("TrackState::%s [%s] offset %f periodCount %d", __FUNCTION__, name, offset,
+		        (int) mDiscontinuityIndexCount);
 	}
 	else
 	{
@@ -6381,7 +6939,7 @@ bool TrackState::HasDiscontinuityAroundPosition(double position, bool useDiscont
 	int playlistRefreshCount = 0;
 	diffBetweenDiscontinuities = DBL_MAX;
 	bool newDiscHandling = true;
-	pthread_mutex_lock(&mPlaylistMutex);
+	AAMP_MUTEX_LOCK(mPlaylistMutex, "TrackState::mPlaylistMutex");
 	mDiscontinuityCheckingOn = true;
 
 	while (aamp->DownloadsAreEnabled())
@@ -6394,12 +6952,18 @@ bool TrackState::HasDiscontinuityAroundPosition(double position, bool useDiscont
 			DiscontinuityIndexNode* discontinuityIndex = (DiscontinuityIndexNode*)mDiscontinuityIndex.ptr;
 			double deltaCulledSec = inputCulledSec - mCulledSeconds;
 			bool foundmatchingdisc = false;
-			for (int i = 0; i < mDiscontinuityIndexCount; i++)
+			int first = 0;
+			double positionMargin = abs(deltaCulledSec) + targetDurationSeconds + 1.0;
+			if (!useDiscontinuityDateTime)
+			{
+				// all entries are matched by position, skip those ending before the position limits
+				first = FindFirstDiscontinuityAfterPosition(discontinuityIndex, mDiscontinuityIndexCount, std::round(position) - positionMargin - 1.0);
+			}
+			for (int i = first; i < mDiscontinuityIndexCount; i++)
 			{
 				// Live is complicated lets finish that 
-					double discdatetime = 0.0;
-					if(discontinuityIndex[i].programDateTime)
-						discdatetime = ISO8601DateTimeToUTCSeconds(discontinuityIndex[i].programDateTime);
+					// parsed at indexing
+					double discdatetime = discontinuityIndex[i].programDateTimeSeconds;
 
 
 					if (IsLive())
@@ -6428,8 +6992,8 @@ bool TrackState::HasDiscontinuityAroundPosition(double position, bool useDiscont
 						// No PDT , now compare the position based on culled delta 
 						// Additional fragmentDuration is considered as rounding with decimal is missing the position when culled delta is same 
 						// Ignore milli second accuracy 
-						int limit1 = (int)(discontinuityIndex[i].position - abs(deltaCulledSec) - targetDurationSeconds - 1.0);
-						int limit2 = (int)(discontinuityIndex[i].position + abs(deltaCulledSec) + targetDurationSeconds + 1.0);
+						int limit1 = (int)(discontinuityIndex[i].position - positionMargin);
+						int limit2 = (int)(discontinuityIndex[i].position + positionMargin);
 						// DELIA-46385 
 						// Due to increase in fragment duration and mismatch between audio and video,
 						// Discontinuity pairing is missed 
@@ -6446,6 +7010,11 @@ bool TrackState::HasDiscontinuityAroundPosition(double position, bool useDiscont
 							AAMPLOG_WARN("%s:%d [%s] Found the matching discontinuity at position:%f for position:%f",__FUNCTION__, __LINE__, name,discontinuityIndex[i].position,position);
 							break;
 						}
+						if (!useDiscontinuityDateTime && roundedPosn < limit1)
+						{
+							// index is sorted by position, later discontinuities are further away
+							break;
+						}
 					}
 			}
 
@@ -6492,7 +7061,7 @@ bool TrackState::HasDiscontinuityAroundPosition(double position, bool useDiscont
 						}							
 					}
 					AAMPLOG_WARN("%s:%d Wait for [%s] playlist update over for playlistRefreshCount %d", __FUNCTION__, __LINE__, name, playlistRefreshCount);
-					pthread_cond_wait(&mPlaylistIndexed, &mPlaylistMutex);
+					AAMP_COND_WAIT(mPlaylistIndexed, mPlaylistMutex);
 					playlistRefreshCount++;
 				}
 				else
@@ -6512,8 +7081,29 @@ bool TrackState::HasDiscontinuityAroundPosition(double position, bool useDiscont
 			if (0 != mDiscontinuityIndexCount)
 			{
 				DiscontinuityIndexNode* discontinuityIndex = (DiscontinuityIndexNode*)mDiscontinuityIndex.ptr;
-				for (int i = 0; i < mDiscontinuityIndexCount; i++)
+				int first = 0;
+				if (!useDiscontinuityDateTime)
+				{
+					// only discontinuities after low and after the last matched one can match
+					double searchStart = low;
+					if (mLastMatchedDiscontPosition >= 0)
+					{
+						searchStart = std::max(low, mLastMatchedDiscontPosition - mCulledSeconds);
+					}
+					first = FindFirstDiscontinuityAfterPosition(discontinuityIndex, mDiscontinuityIndexCount, searchStart);
+					// step back over entries equal within floating point error of the limit, the exact checks below decide
+					while (first > 0 && discontinuityIndex[first - 1].position >= searchStart - PLAYLIST_TIME_DIFF_THRESHOLD_SECONDS)
+					{
+						first--;
+					}
+				}
+				for (int i = first; i < mDiscontinuityIndexCount; i++)
 				{
+					if (!useDiscontinuityDateTime && discontinuityIndex[i].position >= high)
+					{
+						// index is sorted by position, no later discontinuity is within tolerance
+						break;
+					}
 					if (IsLive())
 					{
 						AAMPLOG_WARN("%s:%d [%s] loop %d mLastMatchedDiscontPosition %f mDiscontinuityIndexCount %d discontinuity-pos %f mCulledSeconds %f",
@@ -6536,7 +7126,7 @@ bool TrackState::HasDiscontinuityAroundPosition(double position, bool useDiscont
 						}
 						else
 						{
-							double discPos = ISO8601DateTimeToUTCSeconds(discontinuityIndex[i].programDateTime);
+							double discPos = discontinuityIndex[i].programDateTimeSeconds;
 							{
 								logprintf ("%s:%d [%s] low %f high %f position %f discontinuity %f discontinuity-discardTolreanceInSec %f",
 									__FUNCTION__, __LINE__, name, low, high, position, discPos, discDiscardTolreanceInSec);
@@ -6585,7 +7175,7 @@ bool TrackState::HasDiscontinuityAroundPosition(double position, bool useDiscont
 						{
 							logprintf("%s:%d Waiting for [%s] playlist update mDuration %f mCulledSeconds %f playlistRefreshCount %d", __FUNCTION__,
 							        __LINE__, name, mDuration, mCulledSeconds, playlistRefreshCount);
-							pthread_cond_wait(&mPlaylistIndexed, &mPlaylistMutex);
+							AAMP_COND_WAIT(mPlaylistIndexed, mPlaylistMutex);
 							logprintf("%s:%d Wait for [%s] playlist update over for playlistRefreshCount %d", __FUNCTION__, __LINE__, name, playlistRefreshCount);
 							playlistRefreshCount++;
 						}
@@ -6614,7 +7204,7 @@ bool TrackState::HasDiscontinuityAroundPosition(double position, bool useDiscont
 
 	}
 	mDiscontinuityCheckingOn = false;
-	pthread_mutex_unlock(&mPlaylistMutex);
+	AAMP_MUTEX_UNLOCK(mPlaylistMutex);
 	return discontinuityFound;
 }
 
@@ -6821,11 +7411,24 @@ bool TrackState::FetchInitFragmentHelper(long &http_code, bool forcePushEncrypte
 				actualType = eMEDIATYPE_INIT_AUDIO ;
 			}
 			double downloadTime;
-			bool fetched = aamp->GetFile(fragmentUrl, &cachedFragment->fragment, tempEffectiveUrl, &http_code, &downloadTime, range,
-			        type, false,  actualType);
+			bool fetched = aamp->getAampCacheHandler()->RetrieveFromInitFragCache(fragmentUrl, range, &cachedFragment->fragment, tempEffectiveUrl);
+			if (fetched)
+			{
+				AAMPLOG_INFO("TrackState::%s:%d [%s] init-fragment served from cache", __FUNCTION__, __LINE__, name);
+				http_code = 200;
+			}
+			else
+			{
+				fetched = aamp->GetFile(fragmentUrl, &cachedFragment->fragment, tempEffectiveUrl, &http_code, &downloadTime, range,
+				        type, false,  actualType);
 
-			long main_error = getOriginalCurlError(http_code);
-			aamp->UpdateVideoEndMetrics(actualType, this->GetCurrentBandWidth(), main_error, mEffectiveUrl, downloadTime);
+				long main_error = getOriginalCurlError(http_code);
+				aamp->UpdateVideoEndMetrics(actualType, this->GetCurrentBandWidth(), main_error, mEffectiveUrl, downloadTime);
+				if (fetched)
+				{
+					aamp->getAampCacheHandler()->InsertToInitFragCache(fragmentUrl, range, &cachedFragment->fragment, tempEffectiveUrl, actualType);
+				}
+			}
 
 			if (!fetched)
 			{
@@ -6931,9 +7534,9 @@ void StreamAbstractionAAMP_HLS::StartInjection(void)
 void TrackState::StopWaitForPlaylistRefresh()
 {
 	logprintf("%s:%d track [%s]", __FUNCTION__, __LINE__, name);
-	pthread_mutex_lock(&mPlaylistMutex);
+	AAMP_MUTEX_LOCK(mPlaylistMutex, "TrackState::mPlaylistMutex");
 	pthread_cond_signal(&mPlaylistIndexed);
-	pthread_mutex_unlock(&mPlaylistMutex);
+	AAMP_MUTEX_UNLOCK(mPlaylistMutex);
 }
 
 /***************************************************************************
@@ -6987,7 +7590,7 @@ void TrackState::FindTimedMetadata(bool reportBulkMeta, bool bInitCall)
 	double totalDuration = 0.0;
 	if (gpGlobalConfig->enableSubscribedTags && (eTRACK_VIDEO == type))
 	{
-		pthread_mutex_lock(&mPlaylistMutex);
+		AAMP_MUTEX_LOCK(mPlaylistMutex, "TrackState::mPlaylistMutex");
 		if (playlist.ptr)
 		{
 			char *ptr = GetNextLineStart(playlist.ptr);
@@ -7024,7 +7627,7 @@ void TrackState::FindTimedMetadata(bool reportBulkMeta, bool bInitCall)
 				ptr=GetNextLineStart(ptr);
 			}
 		}
-		pthread_mutex_unlock(&mPlaylistMutex);
+		AAMP_MUTEX_UNLOCK(mPlaylistMutex);
 	}
 	traceprintf("%s:%d Exit", __FUNCTION__, __LINE__);
 }
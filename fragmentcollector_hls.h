@@ -39,6 +39,7 @@
 #include "StreamAbstractionAAMP.h"
 #include "mediaprocessor.h"
 #include "drm.h"
+#include "AampMultiDownloader.h"
 #include <sys/time.h>
 
 
@@ -113,7 +114,10 @@ typedef struct MediaInfo
 
 /**
 *	\struct	IndexNode
-* 	\brief	IndexNode structure for Node/DRM Index
+* 	\brief	IndexNode structure for Node/DRM Index. URI and byte range are parsed once by
+* 		IndexPlaylist, so fetch from index (trick play) does not parse tag text again.
+* 		Normal rate fetch still walks the playlist text with GetNextFragmentUriFromPlaylist,
+* 		using the nodes only to skip fragments before playTarget, so the text has to stay loaded
 */
 struct IndexNode
 {
@@ -121,6 +125,10 @@ struct IndexNode
 	const char *pFragmentInfo;				/**< Fragment Information pointer */
 	int drmMetadataIdx;						/**< DRM Index for Fragment */
 	const char *initFragmentPtr;			/**< Fragmented MP4 specific pointer to associated (preceding) initialization fragment */
+	const char *uri;						/**< Fragment URI in playlist, not NUL terminated */
+	int uriLength;							/**< Length of fragment URI */
+	int byteRangeOffset;					/**< Offset of #EXT-X-BYTERANGE, resolved for ranges without offset */
+	int byteRangeLength;					/**< Length of #EXT-X-BYTERANGE, 0 if fragment is not a byte range */
 };
 
 /**
@@ -129,17 +137,19 @@ struct IndexNode
 */
 struct KeyTagStruct
 {
-	KeyTagStruct() : mShaID(""), mKeyStartDuration(0), mKeyTagStr("")
+	KeyTagStruct() : mShaID(""), mKeyStartDuration(0), mKeyTagStr(""), mFragmentIdx(0)
 	{
 	}
 	std::string mShaID;		/**< ShaID of Key tag */
 	double mKeyStartDuration;		/**< duration in playlist where Keytag starts */
 	std::string mKeyTagStr;			/**< String to store key tag,needed for trickplay */
+	int mFragmentIdx;			/**< number of fragments indexed before Keytag */
 };
 
 /**
 *	\struct	DiscontinuityIndexNode
-* 	\brief	Index Node structure for Discontinuity Index
+* 	\brief	Index Node structure for Discontinuity Index. Records are in playlist order,
+* 		so the index is sorted by fragmentIdx and position and is binary searched
 */
 struct DiscontinuityIndexNode
 {
@@ -147,6 +157,33 @@ struct DiscontinuityIndexNode
 	double position;	         /**< Time of index from start */
 	double fragmentDuration;	/**< Fragment duration of current discontinuity index */
 	const char* programDateTime; /**Program Date time */
+	double programDateTimeSeconds; /**< programDateTime in UTC seconds, 0 if not tagged */
+};
+
+/**
+*	\struct	IncrementalIndexInfo
+* 	\brief	Overlap between indexed playlist and its refreshed copy, used for incremental indexing
+*/
+struct IncrementalIndexInfo
+{
+	IncrementalIndexInfo() : prevPlaylist(NULL), prevIndexCount(0), culledCount(0), culledDuration(0), offsetShift(0),
+		lastRetainedUri(NULL), prevKeyHashTable(), prevDiscontinuityIndex(), prevDiscontinuityIndexCount(0),
+		prevProgramDateTime(0), prevProgramDateTimeIdx(0)
+	{
+	}
+	IncrementalIndexInfo(const IncrementalIndexInfo&) = delete;
+	IncrementalIndexInfo& operator=(const IncrementalIndexInfo&) = delete;
+	const GrowableBuffer *prevPlaylist;	/**< Previously indexed playlist, still referenced by IndexNodes */
+	int prevIndexCount;			/**< Number of IndexNodes from previous indexing */
+	int culledCount;			/**< Number of leading IndexNodes culled by the refresh */
+	double culledDuration;			/**< Duration of culled fragments */
+	long offsetShift;			/**< Offset to translate previous playlist positions into refreshed playlist */
+	const char *lastRetainedUri;		/**< URI line of last retained fragment in refreshed playlist */
+	std::vector<KeyTagStruct> prevKeyHashTable;	/**< Key tags from previous indexing */
+	GrowableBuffer prevDiscontinuityIndex;	/**< Discontinuity records from previous indexing */
+	int prevDiscontinuityIndexCount;	/**< Number of discontinuity records from previous indexing */
+	double prevProgramDateTime;		/**< Last program date time from previous indexing */
+	int prevProgramDateTimeIdx;		/**< Fragment index of last program date time from previous indexing */
 };
 
 /**
@@ -190,7 +227,7 @@ public:
 	/// Fragment Collector thread execution function
 	void RunFetchLoop();
 	/// Function to parse playlist file and update data structures 
-	void IndexPlaylist(bool IsRefresh, double &culledSec);
+	void IndexPlaylist(bool IsRefresh, double &culledSec, const GrowableBuffer *prevPlaylist = NULL);
 	/// Function to handle Profile change after ABR  
 	void ABRProfileChanged(void);
 	/// Function to get next fragment URI for download 
@@ -200,7 +237,11 @@ public:
 	/// Function to update SHA1 ID from DRM information
 	void UpdateDrmCMSha1Hash(const char *ptr);
 	/// Function to decrypt the fragment data 
-	DrmReturn DrmDecrypt(CachedFragment* cachedFragment, ProfilerBucketType bucketType);
+	DrmReturn DrmDecrypt(CachedFragment* cachedFragment, ProfilerBucketType bucketType, HlsDrmStreamDecryptor *streamDecryptor = NULL);
+	/// Function to get decryptor to decrypt the fragment while it is downloaded
+	HlsDrmStreamDecryptor* CreateStreamDecryptor();
+	/// Function to start concurrent download of current and upcoming fragments
+	void PrefetchUpcomingFragments(const std::string &fragmentUrl);
 	/// Function to fetch the Playlist file
 	void FetchPlaylist();
 	/**
@@ -265,8 +306,14 @@ public:
 private:
 	/// Function to get fragment URI based on Index 
 	char *GetFragmentUriFromIndex(bool &bSegmentRepeated);
+	/// Function to skip playlist walk to fragments around playTarget using index, returns position to resume walk
+	char *SkipFragmentsBeforePlayTarget(const char *firstFragmentInfo, const char *walkEnd);
 	/// Function to flush all the downloads done 
 	void FlushIndex();
+	/// Function to check refreshed playlist overlaps current index and prepare incremental indexing
+	bool BeginIncrementalIndex(const GrowableBuffer *prevPlaylist, IncrementalIndexInfo &info);
+	/// Function to reuse IndexNodes retained across refresh, returns position to resume parsing
+	char *SpliceRetainedIndex(IncrementalIndexInfo &info, int &drmMetadataIdx, const char *&initFragmentPtr, double &totalDuration);
 	/// Function to Fetch the fragment and inject for playback 
 	void FetchFragment();
 	/// Helper function fetch the fragments 
@@ -297,9 +344,10 @@ private:
 public:
 	std::string mEffectiveUrl; 		/**< uri associated with downloaded playlist (takes into account 302 redirect) */
 	std::string mPlaylistUrl; 		/**< uri associated with downloaded playlist */
-	GrowableBuffer playlist; 				/**< downloaded playlist contents */
+	GrowableBuffer playlist; 				/**< downloaded playlist contents, walked by normal rate fetch and referenced by index */
 	
 	double mProgramDateTime;
+	int mProgramDateTimeIdx;		/**< fragment index at which mProgramDateTime was found */
 	GrowableBuffer index; 			/**< packed IndexNode records for associated playlist */
 	int indexCount; 				/**< number of indexed fragments in currently indexed playlist */
 	int currentIdx; 				/**< index for currently-presenting fragment used during FF/REW (-1 if undefined) */
@@ -371,6 +419,7 @@ private:
 	double mXStartTimeOFfset;		/**< Holds value of time offset from X-Start tag */
 	double mCulledSecondsAtStart;		/**< Total culled duration with this asset prior to streamer instantiation*/
 	bool mSkipSegmentOnError;				/**< Flag used to enable segment skip on fetch error */
+	AampMultiDownloader *mPrefetchDownloader;	/**< Concurrent fragment downloader, NULL if disabled */
 };
 
 class StreamAbstractionAAMP_HLS;
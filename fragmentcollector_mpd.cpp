@@ -37,6 +37,7 @@
 #include <assert.h>
 #include <unistd.h>
 #include <set>
+#include <deque>
 #include <iomanip>
 #include <ctime>
 #include <inttypes.h>
@@ -47,6 +48,7 @@
 #include <cctype>
 #include <regex>
 #include "AampCacheHandler.h"
+#include "AampWorkerPool.h"
 #include "AampUtils.h"
 //#define DEBUG_TIMELINE
 //#define AAMP_HARVEST_SUPPORT_ENABLED
@@ -281,6 +283,18 @@ static void WriteFile(std::string fileName, const char* data, int len);
  */
 static bool IsEmptyPeriod(IPeriod *period);
 
+/**
+ * @struct SegmentIndexEntry
+ * @brief Reference decoded from Segment Index Box
+ */
+struct SegmentIndexEntry
+{
+	uint64_t offset;	/**< byte offset of referenced segment from first referenced segment */
+	unsigned int size;	/**< referenced size */
+	float duration;		/**< referenced duration in seconds */
+	double startTime;	/**< start time in seconds from first referenced segment */
+};
+
 
 /**
  * @class MediaStreamContext
@@ -300,7 +314,7 @@ public:
 			MediaTrack(type, aamp, name),
 			mediaType((MediaType)type), adaptationSet(NULL), representation(NULL),
 			fragmentIndex(0), timeLineIndex(0), fragmentRepeatCount(0), fragmentOffset(0),
-			eos(false), fragmentTime(0), periodStartOffset(0), index_ptr(NULL), index_len(0),
+			eos(false), fragmentTime(0), periodStartOffset(0), segmentIndex(), segmentIndexKey(),
 			lastSegmentTime(0), lastSegmentNumber(0), lastSegmentDuration(0), adaptationSetIdx(0), representationIndex(0), profileChanged(true),
 			adaptationSetId(0), fragmentDescriptor(), mContext(context), initialization(""),
                         mDownloadedFragment(), discontinuity(false), mSkipSegmentOnError(true)
@@ -382,15 +396,22 @@ public:
 		long bitrate = 0;
 		double downloadTime = 0;
 		MediaType actualType = (MediaType)(initSegment?(eMEDIATYPE_INIT_VIDEO+mediaType):mediaType); //Need to revisit the logic
+		std::string initEffectiveUrl;
 
 		if(!initSegment && mDownloadedFragment.ptr)
 		{
 			ret = true;
+			ReleaseFragmentBuffer(&cachedFragment->fragment);
 			cachedFragment->fragment.ptr = mDownloadedFragment.ptr;
 			cachedFragment->fragment.len = mDownloadedFragment.len;
 			cachedFragment->fragment.avail = mDownloadedFragment.avail;
 			memset(&mDownloadedFragment, 0, sizeof(GrowableBuffer));
 		}
+		else if(initSegment && aamp->getAampCacheHandler()->RetrieveFromInitFragCache(fragmentUrl, range, &cachedFragment->fragment, initEffectiveUrl))
+		{
+			AAMPLOG_INFO("%s:%d [%s] init fragment served from cache", __FUNCTION__, __LINE__, name);
+			ret = true;
+		}
 		else
 		{
 			std::string effectiveUrl;
@@ -416,6 +437,11 @@ public:
 			aamp->UpdateVideoEndMetrics( actualType,
 									bitrate? bitrate : fragmentDescriptor.Bandwidth,
 									(iFogError > 0 ? iFogError : http_code),effectiveUrl,duration, downloadTime);
+
+			if(initSegment && ret && (bitrate <= 0 || bitrate == fragmentDescriptor.Bandwidth))
+			{
+				aamp->getAampCacheHandler()->InsertToInitFragCache(fragmentUrl, range, &cachedFragment->fragment, effectiveUrl, actualType);
+			}
 		}
 
 		mContext->mCheckForRampdown = false;
@@ -625,8 +651,8 @@ public:
 
 	double fragmentTime;
 	double periodStartOffset;
-	char *index_ptr;
-	size_t index_len;
+	std::vector<SegmentIndexEntry> segmentIndex;	/**< decoded sidx of SegmentBase representation */
+	std::string segmentIndexKey;	/**< period and representation id segmentIndex belongs to, empty if not loaded */
 	uint64_t lastSegmentTime;
 	uint64_t lastSegmentNumber;
 	uint64_t lastSegmentDuration;
@@ -736,7 +762,7 @@ public:
 #endif
 private:
 	AAMPStatusType UpdateMPD(bool init = false);
-	void FindTimedMetadata(MPD* mpd, Node* root, bool init = false, bool reportBulkMet = false);
+	void FindTimedMetadata(MPD* mpd, const std::vector<Node*> &subNodes, bool init = false, bool reportBulkMet = false);
 	void ProcessPeriodSupplementalProperty(Node* node, std::string& AdID, uint64_t startMS, uint64_t durationMS, bool isInit, bool reportBulkMeta=false);
 	void ProcessPeriodAssetIdentifier(Node* node, uint64_t startMS, uint64_t durationMS, std::string& assetID, std::string& providerID,bool isInit, bool reportBulkMeta=false);
 	bool ProcessEventStream(uint64_t startMS, IPeriod * period);
@@ -749,11 +775,14 @@ private:
 	bool CheckForInitalClearPeriod();
 	void PushEncryptedHeaders();
 	int GetProfileIdxForBandwidthNotification(uint32_t bandwidth);
-	AAMPStatusType UpdateTrackInfo(bool modifyDefaultBW, bool periodChanged, bool resetTimeLineIndex=false);
+	AAMPStatusType UpdateTrackInfo(bool modifyDefaultBW, bool periodChanged, bool resetTimeLineIndex=false, bool preservePosition=false);
 	double SkipFragments( MediaStreamContext *pMediaStreamContext, double skipTime, bool updateFirstPTS = false);
 	void SkipToEnd( MediaStreamContext *pMediaStreamContext); //Added to support rewind in multiperiod assets
+	std::string GetSegmentIndexKey(MediaStreamContext *pMediaStreamContext);
 	void ProcessContentProtection(IAdaptationSet * adaptationSet,MediaType mediaType, std::shared_ptr<AampDrmHelper> drmHelper = nullptr);
+	void JoinDrmSessionTasks();
 #ifdef AAMP_MPD_DRM
+	void SubmitDrmSessionTask(DrmSessionParams* sessionParams, MediaType mediaType);
 	void ProcessVssContentProtection(std::shared_ptr<AampDrmHelper> drmHelper, MediaType mediaType);
 	std::shared_ptr<AampDrmHelper> CreateDrmHelper(IAdaptationSet * adaptationSet,MediaType mediaType);
 #endif
@@ -763,7 +792,14 @@ private:
 	int GetBestAudioTrackByLanguage(int &desiredRepIdx,AudioType &selectedCodecType);
 	int GetPreferredAudioTrackByLanguage();
 	std::string GetLanguageForAdaptationSet( IAdaptationSet *adaptationSet );
-	AAMPStatusType GetMpdFromManfiest(const GrowableBuffer &manifest, MPD * &mpd, std::string manifestUrl, bool init = false);
+	AAMPStatusType GetMpdFromManfiest(const GrowableBuffer &manifest, MPD * &mpd, std::string manifestUrl, bool init = false, std::vector<MPDPeriodSignature> *periodSignatures = NULL);
+	void UpdatePeriodSignatures(const std::vector<MPDPeriodSignature> &periodSignatures);
+	MPDPeriodUpdateType GetPeriodUpdateType(const std::string &periodId);
+	bool IsPeriodStructureUnchanged(const std::string &periodId)
+	{
+		MPDPeriodUpdateType updateType = GetPeriodUpdateType(periodId);
+		return (eMPD_PERIOD_UNCHANGED == updateType || eMPD_PERIOD_TIMELINE_UPDATED == updateType);
+	}
 	bool IsEmptyPeriod(IPeriod *period);
 	int GetDrmPrefs(const std::string& uuid);
 	void GetAvailableVSSPeriods(std::vector<IPeriod*>& PeriodIds);
@@ -775,11 +811,10 @@ private:
 	double seekPosition;
 	float rate;
 	pthread_t fragmentCollectorThreadID;
-	pthread_t createDRMSessionThreadID;
+	std::deque<AampWorkerTask *> createDRMSessionTasks; /**< License acquisitions in progress, one per DRM helper */
 	std::thread *deferredDRMRequestThread;
 	bool deferredDRMRequestThreadStarted;
 	bool mAbortDeferredLicenseLoop;
-	bool drmSessionThreadStarted;
 	dash::mpd::IMPD *mpd;
 	MediaStreamContext *mMediaStreamContext[AAMP_TRACK_COUNT];
 	int mNumberOfTracks;
@@ -829,6 +864,10 @@ private:
 	double mAvailabilityStartTime;
 	std::map<std::string, int> mDrmPrefs;
 	int mMaxTracks; /* Max number of tracks for this session */
+	std::vector<MPDPeriodSignature> mPeriodSignatures; /* Period signatures of current MPD */
+	std::map<std::string, MPDPeriodUpdateType> mPeriodUpdates; /* Change of each period in last MPD refresh */
+	uint64_t mManifestHash; /* Hash of manifest the current MPD was parsed from */
+	size_t mManifestLength; /* Length of manifest the current MPD was parsed from */
 };
 
 
@@ -840,8 +879,8 @@ private:
  * @param rate playback rate
  */
 PrivateStreamAbstractionMPD::PrivateStreamAbstractionMPD( StreamAbstractionAAMP_MPD* context, PrivateInstanceAAMP *aamp,double seekpos, float rate) : aamp(aamp),
-	fragmentCollectorThreadStarted(false), mLangList(), seekPosition(seekpos), rate(rate), fragmentCollectorThreadID(0), createDRMSessionThreadID(0),
-	drmSessionThreadStarted(false), mpd(NULL), mNumberOfTracks(0), mCurrentPeriodIdx(0), mEndPosition(0), mIsLiveStream(true), mIsLiveManifest(true), mContext(context),
+	fragmentCollectorThreadStarted(false), mLangList(), seekPosition(seekpos), rate(rate), fragmentCollectorThreadID(0), createDRMSessionTasks(),
+	mpd(NULL), mNumberOfTracks(0), mCurrentPeriodIdx(0), mEndPosition(0), mIsLiveStream(true), mIsLiveManifest(true), mContext(context),
 	mStreamInfo(NULL), mPrevStartTimeSeconds(0), mPrevLastSegurlMedia(""), mPrevLastSegurlOffset(0),
 	mPeriodEndTime(0), mPeriodStartTime(0), mPeriodDuration(0), mMinUpdateDurationMs(DEFAULT_INTERVAL_BETWEEN_MPD_UPDATES_MS),
 	mLastPlaylistDownloadTimeMs(0), mFirstPTS(0), mAudioType(eAUDIO_UNKNOWN),
@@ -858,6 +897,7 @@ PrivateStreamAbstractionMPD::PrivateStreamAbstractionMPD( StreamAbstractionAAMP_
 	,deferredDRMRequestThread(NULL), deferredDRMRequestThreadStarted(false), mCommonKeyDuration(0)
 	,mEarlyAvailableKeyIDMap(), mPendingKeyIDs(), mAbortDeferredLicenseLoop(false), mEarlyAvailablePeriodIds()
 	, mMaxTracks(0)
+	, mPeriodSignatures(), mPeriodUpdates(), mManifestHash(0), mManifestLength(0)
 {
 	this->aamp = aamp;
 	memset(&mMediaStreamContext, 0, sizeof(mMediaStreamContext));
@@ -1191,16 +1231,21 @@ static unsigned int Read32( const char **pptr)
 /**
  * @brief Parse segment index box
  * @note The SegmentBase indexRange attribute points to Segment Index Box location with segments and random access points.
+ * Box is decoded once per representation, so that fragments can be located without walking the references again
  * @param start start of box
  * @param size size of box
- * @param segmentIndex segment index
- * @param[out] referenced_size referenced size
- * @param[out] referenced_duration referenced duration
+ * @param[out] segmentIndex decoded references
  * @retval true on success
  */
-static bool ParseSegmentIndexBox( const char *start, size_t size, int segmentIndex, unsigned int *referenced_size, float *referenced_duration )
+static bool ParseSegmentIndexBox( const char *start, size_t size, std::vector<SegmentIndexEntry> &segmentIndex )
 {
 	const char **f = &start;
+	segmentIndex.clear();
+	if (size < 32)
+	{
+		AAMPLOG_WARN("Wrong size in ParseSegmentIndexBox %zu", size);
+		return false;
+	}
 	unsigned int len = Read32(f);
 	if (len != size) {
 		AAMPLOG_WARN("Wrong size in ParseSegmentIndexBox %d found, %zu expected", len, size);
@@ -1213,20 +1258,72 @@ static bool ParseSegmentIndexBox( const char *start, size_t size, int segmentInd
 		return false;
 
 	}
-	unsigned int version = Read32(f);
-	unsigned int reference_ID = Read32(f);
+	unsigned int version = Read32(f) >> 24;
+	Read32(f); // reference_ID
 	unsigned int timescale = Read32(f);
-	unsigned int earliest_presentation_time = Read32(f);
-	unsigned int first_offset = Read32(f);
-	unsigned int count = Read32(f);
+	if (version != 0)
+	{ // 64 bit earliest_presentation_time and first_offset
+		if (size < 40)
+		{
+			return false;
+		}
+		Read32(f);
+		Read32(f);
+	}
+	Read32(f); // earliest_presentation_time
+	Read32(f); // first_offset
+	unsigned int count = Read32(f) & 0xffff;
+	if (timescale == 0 || (size_t)(*f - start) + count * 12 > size)
+	{
+		AAMPLOG_WARN("Invalid ParseSegmentIndexBox timescale %u reference count %u", timescale, count);
+		return false;
+	}
+	segmentIndex.reserve(count);
+	SegmentIndexEntry entry = {0, 0, 0.0, 0.0};
 	for (unsigned int i = 0; i < count; i++)
 	{
-		*referenced_size = Read32(f);
-		*referenced_duration = Read32(f)/(float)timescale;
-		unsigned int flags = Read32(f);
-		if (i == segmentIndex) return true;
+		entry.size = Read32(f);
+		entry.duration = Read32(f)/(float)timescale;
+		Read32(f); // SAP flags
+		segmentIndex.push_back(entry);
+		entry.offset += entry.size;
+		// Same rounding as applied to fragmentTime while fragments are fetched
+		entry.startTime = ceil((entry.startTime + entry.duration) * 1000.0) / 1000.0;
 	}
-	return false;
+	return true;
+}
+
+/**
+ * @brief Find number of sidx references completed at given time
+ * @param segmentIndex decoded references
+ * @param time position in seconds from first referenced segment
+ * @param[out] endTime end time of last completed reference
+ * @retval number of references, segmentIndex.size()+1 if time is beyond the last one
+ */
+static size_t FindSegmentIndexByTime( const std::vector<SegmentIndexEntry> &segmentIndex, double time, double &endTime )
+{
+	endTime = 0.0;
+	if (time <= 0 || segmentIndex.empty())
+	{
+		return (time <= 0) ? 0 : 1;
+	}
+	const SegmentIndexEntry &last = segmentIndex.back();
+	double totalDuration = ceil((last.startTime + last.duration) * 1000.0) / 1000.0;
+	if (totalDuration < time)
+	{
+		endTime = totalDuration;
+		return segmentIndex.size() + 1;
+	}
+	// first reference starting at or after time, the preceding one completes time
+	std::vector<SegmentIndexEntry>::const_iterator it = std::lower_bound(segmentIndex.begin() + 1, segmentIndex.end(), time,
+		[](const SegmentIndexEntry &entry, double value) { return entry.startTime < value; });
+	if (it == segmentIndex.end())
+	{
+		endTime = totalDuration;
+		return segmentIndex.size();
+	}
+	endTime = it->startTime;
+	return it - segmentIndex.begin();
 }
 
 
@@ -1560,6 +1657,23 @@ bool PrivateStreamAbstractionMPD::FetchFragment(MediaStreamContext *pMediaStream
 	return retval;
 }
 
+/**
+ * @brief Get key of the sidx of current representation, representation objects are not unique across MPD refreshes
+ * @param pMediaStreamContext Track object
+ * @retval period id and representation id
+ */
+std::string PrivateStreamAbstractionMPD::GetSegmentIndexKey(MediaStreamContext *pMediaStreamContext)
+{
+	std::string key;
+	if (mCurrentPeriod)
+	{
+		key = mCurrentPeriod->GetId();
+	}
+	key.push_back('|');
+	key.append(pMediaStreamContext->representation->GetId());
+	return key;
+}
+
 /**
  * @brief Fetch and push next fragment
  * @param pMediaStreamContext Track object
@@ -1621,7 +1735,7 @@ bool PrivateStreamAbstractionMPD::PushNextFragment( struct MediaStreamContext *p
 						uint64_t startTime = 0;
 						ITimeline *timeline = timelines.at(index);
 						// Some timeline may not have attribute for timeline , check it .
-						map<string, string> attributeMap = timeline->GetRawAttributes();
+						const map<string, string> &attributeMap = timeline->GetRawAttributes();
 						if(attributeMap.find("t") != attributeMap.end())
 						{
 							startTime = timeline->GetStartTime();
@@ -1655,7 +1769,7 @@ bool PrivateStreamAbstractionMPD::PushNextFragment( struct MediaStreamContext *p
 								while(index<timelines.size())
 								{
 									timeline = timelines.at(index);
-									map<string, string> attributeMap = timeline->GetRawAttributes();
+									const map<string, string> &attributeMap = timeline->GetRawAttributes();
 									if(attributeMap.find("t") != attributeMap.end())
 									{
 										startTime = timeline->GetStartTime();
@@ -1718,7 +1832,7 @@ bool PrivateStreamAbstractionMPD::PushNextFragment( struct MediaStreamContext *p
 					{
 						ITimeline *timeline = timelines.at(pMediaStreamContext->timeLineIndex);
 						uint64_t startTime = 0;
-						map<string, string> attributeMap = timeline->GetRawAttributes();
+						const map<string, string> &attributeMap = timeline->GetRawAttributes();
 						if(attributeMap.find("t") != attributeMap.end())
 						{
 							// If there is a presentation offset time, update start time to that value.
@@ -1742,7 +1856,7 @@ bool PrivateStreamAbstractionMPD::PushNextFragment( struct MediaStreamContext *p
 								for(;index<timelines.size();index++)
 								{
 									timeline = timelines.at(index);
-									map<string, string> attributeMap = timeline->GetRawAttributes();
+									const map<string, string> &attributeMap = timeline->GetRawAttributes();
 									if(attributeMap.find("t") != attributeMap.end())
 									{
 										startTime = timeline->GetStartTime();
@@ -2061,7 +2175,8 @@ bool PrivateStreamAbstractionMPD::PushNextFragment( struct MediaStreamContext *p
 		{ // single-segment
 			std::string fragmentUrl;
 			GetFragmentUrl(fragmentUrl, &pMediaStreamContext->fragmentDescriptor, "");
-			if (!pMediaStreamContext->index_ptr)
+			const std::string segmentIndexKey = GetSegmentIndexKey(pMediaStreamContext);
+			if (pMediaStreamContext->segmentIndexKey != segmentIndexKey)
 			{ // lazily load index
 				std::string range = segmentBase->GetIndexRange();
 				int start;
@@ -2074,7 +2189,19 @@ bool PrivateStreamAbstractionMPD::PushNextFragment( struct MediaStreamContext *p
 				double downloadTime;
 				int iFogError = -1;
 				int iCurrentRate = aamp->rate; //  Store it as back up, As sometimes by the time File is downloaded, rate might have changed due to user initiated Trick-Play
-				pMediaStreamContext->index_ptr = aamp->LoadFragment(bucketType, fragmentUrl, effectiveUrl,&pMediaStreamContext->index_len, curlInstance, range.c_str(),&http_code, &downloadTime, actualType,&iFogError);
+				size_t indexLen = 0;
+				char *indexPtr = aamp->LoadFragment(bucketType, fragmentUrl, effectiveUrl,&indexLen, curlInstance, range.c_str(),&http_code, &downloadTime, actualType,&iFogError);
+				if (indexPtr)
+				{
+					// a parse failure is kept as an empty index, so a broken sidx is not downloaded again for every fragment
+					if (!ParseSegmentIndexBox(indexPtr, indexLen, pMediaStreamContext->segmentIndex))
+					{
+						AAMPLOG_WARN("%s:%d %s invalid segment index %s", __FUNCTION__, __LINE__, mMediaTypeName[pMediaStreamContext->mediaType], segmentIndexKey.c_str());
+						pMediaStreamContext->segmentIndex.clear();
+					}
+					pMediaStreamContext->segmentIndexKey = segmentIndexKey;
+					aamp_Free(&indexPtr);
+				}
 
 				if (iCurrentRate != AAMP_NORMAL_PLAY_RATE)
 				{
@@ -2096,28 +2223,22 @@ bool PrivateStreamAbstractionMPD::PushNextFragment( struct MediaStreamContext *p
 
 				pMediaStreamContext->fragmentOffset++; // first byte following packed index
 
-				if (pMediaStreamContext->fragmentIndex != 0)
+				if (pMediaStreamContext->fragmentIndex > 0 && !pMediaStreamContext->segmentIndex.empty())
 				{
-					unsigned int referenced_size;
-					float fragmentDuration;
 					AAMPLOG_INFO("%s:%d current fragmentIndex = %d", __FUNCTION__, __LINE__, pMediaStreamContext->fragmentIndex);
 					//Find the offset of previous fragment in new representation
-					for (int i = 0; i < pMediaStreamContext->fragmentIndex; i++)
-					{
-						if (ParseSegmentIndexBox(pMediaStreamContext->index_ptr, pMediaStreamContext->index_len, i,
-							&referenced_size, &fragmentDuration))
-						{
-							pMediaStreamContext->fragmentOffset += referenced_size;
-						}
-					}
+					size_t prevIdx = std::min((size_t)pMediaStreamContext->fragmentIndex, pMediaStreamContext->segmentIndex.size()) - 1;
+					const SegmentIndexEntry &prevEntry = pMediaStreamContext->segmentIndex[prevIdx];
+					pMediaStreamContext->fragmentOffset += prevEntry.offset + prevEntry.size;
 				}
 			}
-			if (pMediaStreamContext->index_ptr)
+			if (pMediaStreamContext->segmentIndexKey == segmentIndexKey)
 			{
-				unsigned int referenced_size;
-				float fragmentDuration;
-				if (ParseSegmentIndexBox(pMediaStreamContext->index_ptr, pMediaStreamContext->index_len, pMediaStreamContext->fragmentIndex++, &referenced_size, &fragmentDuration))
+				if (pMediaStreamContext->fragmentIndex >= 0 && pMediaStreamContext->fragmentIndex < (int)pMediaStreamContext->segmentIndex.size())
 				{
+					const SegmentIndexEntry &entry = pMediaStreamContext->segmentIndex[pMediaStreamContext->fragmentIndex++];
+					unsigned int referenced_size = entry.size;
+					float fragmentDuration = entry.duration;
 					char range[128];
 					sprintf(range, "%d-%d", pMediaStreamContext->fragmentOffset, pMediaStreamContext->fragmentOffset + referenced_size - 1);
 					AAMPLOG_INFO("%s:%d %s [%s]", __FUNCTION__, __LINE__,mMediaTypeName[pMediaStreamContext->mediaType], range);
@@ -2131,7 +2252,7 @@ bool PrivateStreamAbstractionMPD::PushNextFragment( struct MediaStreamContext *p
 				}
 				else
 				{ // done with index
-					aamp_Free(&pMediaStreamContext->index_ptr);
+					pMediaStreamContext->fragmentIndex++;
 					pMediaStreamContext->eos = true;
 				}
 			}
@@ -2394,7 +2515,7 @@ double PrivateStreamAbstractionMPD::SkipFragments( MediaStreamContext *pMediaStr
 					uint32_t repeatCount = timeline->GetRepeatCount();
 					if (pMediaStreamContext->fragmentRepeatCount == 0)
 					{
-						map<string, string> attributeMap = timeline->GetRawAttributes();
+						const map<string, string> &attributeMap = timeline->GetRawAttributes();
 						if(attributeMap.find("t") != attributeMap.end())
 						{
 							uint64_t startTime = timeline->GetStartTime();
@@ -2572,7 +2693,8 @@ double PrivateStreamAbstractionMPD::SkipFragments( MediaStreamContext *pMediaStr
 		if (segmentBase)
 		{ // single-segment
 			std::string range = segmentBase->GetIndexRange();
-			if (!pMediaStreamContext->index_ptr)
+			const std::string segmentIndexKey = GetSegmentIndexKey(pMediaStreamContext);
+			if (pMediaStreamContext->segmentIndexKey != segmentIndexKey)
 			{   // lazily load index
 				std::string fragmentUrl;
 				GetFragmentUrl(fragmentUrl, &pMediaStreamContext->fragmentDescriptor, "");
@@ -2582,33 +2704,38 @@ double PrivateStreamAbstractionMPD::SkipFragments( MediaStreamContext *pMediaStr
 				long http_code;
 				double downloadTime;
 				int iFogError = -1;
-				pMediaStreamContext->index_ptr = aamp->LoadFragment(bucketType, fragmentUrl, effectiveUrl,&pMediaStreamContext->index_len, pMediaStreamContext->mediaType, range.c_str(),&http_code, &downloadTime, actualType,&iFogError);
-			}
-			if (pMediaStreamContext->index_ptr)
-			{
-				unsigned int referenced_size = 0;
-				float fragmentDuration = 0.00;
-				float fragmentTime = 0.00;
-				int fragmentIndex =0;
-				while (fragmentTime < skipTime)
+				size_t indexLen = 0;
+				char *indexPtr = aamp->LoadFragment(bucketType, fragmentUrl, effectiveUrl,&indexLen, pMediaStreamContext->mediaType, range.c_str(),&http_code, &downloadTime, actualType,&iFogError);
+				if (indexPtr)
 				{
-					if (ParseSegmentIndexBox(pMediaStreamContext->index_ptr, pMediaStreamContext->index_len, fragmentIndex++, &referenced_size, &fragmentDuration))
+					// a parse failure is kept as an empty index, so a broken sidx is not downloaded again for every fragment
+					if (!ParseSegmentIndexBox(indexPtr, indexLen, pMediaStreamContext->segmentIndex))
 					{
-						fragmentTime += fragmentDuration;
-						fragmentTime = ceil(fragmentTime * 1000.0) / 1000.0;
-						pMediaStreamContext->fragmentOffset += referenced_size;
-					}
-					else
-					{ 
-						// done with index
-						aamp_Free(&pMediaStreamContext->index_ptr);
-						pMediaStreamContext->eos = true;
-						break;
+						AAMPLOG_WARN("%s:%d %s invalid segment index %s", __FUNCTION__, __LINE__, mMediaTypeName[pMediaStreamContext->mediaType], segmentIndexKey.c_str());
+						pMediaStreamContext->segmentIndex.clear();
 					}
+					pMediaStreamContext->segmentIndexKey = segmentIndexKey;
+					aamp_Free(&indexPtr);
 				}
-				
+			}
+			if (pMediaStreamContext->segmentIndexKey == segmentIndexKey)
+			{
+				const std::vector<SegmentIndexEntry> &segmentIndex = pMediaStreamContext->segmentIndex;
+				double fragmentTime = 0.0;
+				size_t fragmentIndex = FindSegmentIndexByTime(segmentIndex, skipTime, fragmentTime);
+				if (fragmentIndex > 0 && !segmentIndex.empty())
+				{
+					const SegmentIndexEntry &lastEntry = segmentIndex[std::min(fragmentIndex, segmentIndex.size()) - 1];
+					pMediaStreamContext->fragmentOffset += lastEntry.offset + lastEntry.size;
+				}
+				if (fragmentIndex > segmentIndex.size())
+				{
+					// done with index
+					pMediaStreamContext->eos = true;
+				}
+
 				//updated seeked position
-				pMediaStreamContext->fragmentIndex = fragmentIndex;
+				pMediaStreamContext->fragmentIndex = (int)fragmentIndex;
 				pMediaStreamContext->fragmentTime = fragmentTime;
 			}
 			else
@@ -2723,12 +2850,49 @@ double PrivateStreamAbstractionMPD::SkipFragments( MediaStreamContext *pMediaStr
 }
 
 
+/**
+ * @brief Get 64 bit FNV-1a hash of a manifest
+ * @param manifest manifest data
+ * @retval hash of manifest content
+ */
+static uint64_t HashManifest(const GrowableBuffer &manifest)
+{
+	const uint64_t fnvPrime = 1099511628211ULL;
+	uint64_t hash = 14695981039346656037ULL;
+	const unsigned char *data = (const unsigned char *)manifest.ptr;
+	for (size_t i = 0; i < manifest.len; i++)
+	{
+		hash ^= data[i];
+		hash *= fnvPrime;
+	}
+	return hash;
+}
+
+/**
+ * @brief Accumulate string into 64 bit FNV-1a hash
+ * @param hash hash to update
+ * @param str string to add
+ */
+static void HashString(uint64_t &hash, const char *str)
+{
+	const uint64_t fnvPrime = 1099511628211ULL;
+	while (*str)
+	{
+		hash ^= (unsigned char)(*str++);
+		hash *= fnvPrime;
+	}
+	// separator, so that "ab"+"c" and "a"+"bc" differ
+	hash ^= 0xff;
+	hash *= fnvPrime;
+}
+
 /**
  * @brief Add attriblutes to xml node
  * @param reader xmlTextReaderPtr
  * @param node xml Node
+ * @param hash hash to accumulate attributes into, NULL if not needed
  */
-static void AddAttributesToNode(xmlTextReaderPtr *reader, Node *node)
+static void AddAttributesToNode(xmlTextReaderPtr *reader, Node *node, uint64_t *hash = NULL)
 {
 	if (xmlTextReaderHasAttributes(*reader))
 	{
@@ -2738,6 +2902,11 @@ static void AddAttributesToNode(xmlTextReaderPtr *reader, Node *node)
 			if(!key.empty())
 			{
 				std::string value = (const char *)xmlTextReaderConstValue(*reader);
+				if (hash)
+				{
+					HashString(*hash, key.c_str());
+					HashString(*hash, value.c_str());
+				}
 				node->AddAttribute(key, value);
 			}
 			else
@@ -2756,17 +2925,19 @@ static void AddAttributesToNode(xmlTextReaderPtr *reader, Node *node)
  * @param mpd MPD object of manifest
  * @param manifestUrl manifest url
  * @param init true if this is the first playlist download for a tune/seek/trickplay
+ * @param[out] periodSignatures signature of each period of the manifest, may be NULL
  * @retval AAMPStatusType indicates if success or fail
 */
-AAMPStatusType PrivateStreamAbstractionMPD::GetMpdFromManfiest(const GrowableBuffer &manifest, MPD * &mpd, std::string manifestUrl, bool init)
+AAMPStatusType PrivateStreamAbstractionMPD::GetMpdFromManfiest(const GrowableBuffer &manifest, MPD * &mpd, std::string manifestUrl, bool init, std::vector<MPDPeriodSignature> *periodSignatures)
 {
 	AAMPStatusType ret = eAAMPSTATUS_GENERIC_ERROR;
-	xmlTextReaderPtr reader = xmlReaderForMemory(manifest.ptr, (int) manifest.len, NULL, NULL, 0);
+	xmlTextReaderPtr reader = xmlReaderForMemory(manifest.ptr, (int) manifest.len, NULL, NULL, MPD_XML_PARSE_OPTIONS);
 	if (reader != NULL)
 	{
 		if (xmlTextReaderRead(reader))
 		{
-			Node *root = aamp_ProcessNode(&reader, manifestUrl);
+			MPDParseInfo parseInfo;
+			Node *root = aamp_ParseMPDNodes(reader, manifestUrl, false, &parseInfo);
 			if(root != NULL)
 			{
 				uint32_t fetchTime = Time::GetCurrentUTCTimeInSec();
@@ -2775,16 +2946,20 @@ AAMPStatusType PrivateStreamAbstractionMPD::GetMpdFromManfiest(const GrowableBuf
 				{
 					mpd->SetFetchTime(fetchTime);
 #if 1
-					FindTimedMetadata(mpd, root, init, aamp->mBulkTimedMetadata);
+					FindTimedMetadata(mpd, parseInfo.timedMetadataNodes, init, aamp->mBulkTimedMetadata);
 					if(aamp->mBulkTimedMetadata && init && aamp->IsNewTune())
 					{
 						// Send bulk report
 						aamp->ReportBulkTimedMetadata();
 					}
+					if (periodSignatures)
+					{
+						periodSignatures->swap(parseInfo.periods);
+					}
 					ret = AAMPStatusType::eAAMPSTATUS_OK;
 #else
 					size_t prevPrdCnt = mCdaiObject->mAdBreaks.size();
-					FindTimedMetadata(mpd, root, init);
+					FindTimedMetadata(mpd, parseInfo.timedMetadataNodes, init);
 					size_t newPrdCnt = mCdaiObject->mAdBreaks.size();
 					if(prevPrdCnt < newPrdCnt)
 					{
@@ -2816,91 +2991,231 @@ AAMPStatusType PrivateStreamAbstractionMPD::GetMpdFromManfiest(const GrowableBuf
 }
 
 /**
- * @brief Get xml node form reader
+ * @brief Build xml node tree of an MPD in a single streaming pass over the reader
  *
- * @param[in] reader Pointer to reader object
+ * Nodes are built iteratively while reading, the MPD path is resolved once for the
+ * whole document and blank/comment nodes are dropped without allocation. MPD level
+ * nodes which can carry timed metadata are collected on the way, so that they need
+ * not be searched for in the tree afterwards, and each period is signed with a hash
+ * of its content so that live refreshes can tell unchanged periods apart.
+ *
+ * @param[in] reader Reader positioned at the root element
  * @param[in] url    manifest url
+ * @param[in] isAd   true if ad manifest, period ids are made unique
+ * @param[out] parseInfo timed metadata nodes and period signatures, may be NULL
  *
- * @retval xml node
+ * @retval xml root node, NULL on parse error
  */
-Node* aamp_ProcessNode(xmlTextReaderPtr *reader, std::string url, bool isAd)
+Node* aamp_ParseMPDNodes(xmlTextReaderPtr reader, const std::string &url, bool isAd, MPDParseInfo *parseInfo)
 {
-	int type = xmlTextReaderNodeType(*reader);
+	const std::string mpdPath = Path::GetDirectoryPath(url);
+	std::vector<Node*> openNodes;
+	Node *root = NULL;
+	MPDPeriodSignature *period = NULL;
+	int ret = 1;
 
-	if (type != WhiteSpace && type != Text)
+	while (ret == 1)
 	{
-		while (type == Comment || type == WhiteSpace)
+		int type = xmlTextReaderNodeType(reader);
+		if (type == Start)
 		{
-			xmlTextReaderRead(*reader);
-			type = xmlTextReaderNodeType(*reader);
-		}
+			const char *name = (const char *)xmlTextReaderConstName(reader);
+			if (name == NULL)
+			{
+				AAMPLOG_WARN("%s:%d :  element name is null", __FUNCTION__, __LINE__);
+				break;
+			}
+			int isEmpty = xmlTextReaderIsEmptyElement(reader);
+			Node *node = new Node();
+			node->SetType(type);
+			node->SetMPDPath(mpdPath);
+			node->SetName(name);
+			if (parseInfo && openNodes.size() == 1 && !strcmp("Period", name))
+			{
+				parseInfo->periods.push_back(MPDPeriodSignature());
+				period = &parseInfo->periods.back();
+			}
+			else if (openNodes.size() < 2)
+			{
+				period = NULL;
+			}
+			uint64_t *hash = NULL;
+			if (period)
+			{
+				hash = strcmp("S", name) ? &period->structureHash : &period->timelineHash;
+				HashString(*hash, name);
+			}
+			AddAttributesToNode(&reader, node, hash);
+			if (period && openNodes.size() == 1)
+			{
+				period->id = node->GetAttributeValue("id");
+			}
+
+			if(isAd && !strcmp("Period", name))
+			{
+				//Making period ids unique. It needs for playing same ad back to back.
+				static int UNIQ_PID = 0;
+				std::string periodId = std::to_string(UNIQ_PID++) + "-";
+				if(node->HasAttribute("id"))
+				{
+					periodId += node->GetAttributeValue("id");
+				}
+				node->AddAttribute("id", periodId);
+			}
 
-		Node *node = new Node();
-		node->SetType(type);
-		node->SetMPDPath(Path::GetDirectoryPath(url));
+			if (openNodes.empty())
+			{
+				root = node;
+			}
+			else
+			{
+				openNodes.back()->AddSubNode(node);
+				if (parseInfo && openNodes.size() == 1 &&
+					(!strcmp("Period", name) || !strcmp("ProgramInformation", name) || !strcmp("SupplementalProperty", name)))
+				{
+					parseInfo->timedMetadataNodes.push_back(node);
+				}
+			}
 
-		const char *name = (const char *)xmlTextReaderConstName(*reader);
-		if (name == NULL)
+			if (!isEmpty)
+			{
+				openNodes.push_back(node);
+			}
+			else if (openNodes.empty())
+			{
+				break;
+			}
+		}
+		else if (type == End)
 		{
-			delete node;
-			return NULL;
+			if (period && openNodes.size() > 2)
+			{
+				HashString(period->structureHash, "/");
+			}
+			if (!openNodes.empty())
+			{
+				openNodes.pop_back();
+			}
+			if (openNodes.empty())
+			{
+				break;
+			}
 		}
-
-		int         isEmpty = xmlTextReaderIsEmptyElement(*reader);
-
-		node->SetName(name);
-
-		AddAttributesToNode(reader, node);
-
-		if(isAd && !strcmp("Period", name))
+		else if (type == Text && !openNodes.empty())
 		{
-			//Making period ids unique. It needs for playing same ad back to back.
-			static int UNIQ_PID = 0;
-			std::string periodId = std::to_string(UNIQ_PID++) + "-";
-			if(node->HasAttribute("id"))
+			xmlChar * text = xmlTextReaderReadString(reader);
+			if (text != NULL)
 			{
-				periodId += node->GetAttributeValue("id");
+				Node *node = new Node();
+				node->SetType(type);
+				node->SetText((const char*)text);
+				if (period)
+				{
+					HashString(period->structureHash, (const char*)text);
+				}
+				xmlFree(text);
+				openNodes.back()->AddSubNode(node);
 			}
-			node->AddAttribute("id", periodId);
 		}
+		ret = xmlTextReaderRead(reader);
+	}
+	if (ret == -1)
+	{
+		AAMPLOG_WARN("%s:%d :  xml read error, %d elements left open", __FUNCTION__, __LINE__, (int)openNodes.size());
+	}
+	return root;
+}
 
-		if (isEmpty)
-			return node;
-
-		Node    *subnode = NULL;
-		int     ret = xmlTextReaderRead(*reader);
-
-		while (ret == 1)
+/**
+ * @brief Compare period signatures of refreshed MPD with the previous one
+ *
+ * Classifies each period as new, unchanged, timeline updated or changed, and prunes
+ * per period state kept for periods which expired from the manifest.
+ * @param periodSignatures signatures of periods in refreshed MPD
+ */
+void PrivateStreamAbstractionMPD::UpdatePeriodSignatures(const std::vector<MPDPeriodSignature> &periodSignatures)
+{
+	std::map<std::string, const MPDPeriodSignature *> previous;
+	for (const MPDPeriodSignature &signature : mPeriodSignatures)
+	{
+		if (!signature.id.empty())
 		{
-			if (!strcmp(name, (const char *)xmlTextReaderConstName(*reader)))
+			previous[signature.id] = &signature;
+		}
+	}
+	int counts[eMPD_PERIOD_CHANGED + 1] = {0};
+	std::map<std::string, MPDPeriodUpdateType> updates;
+	for (const MPDPeriodSignature &signature : periodSignatures)
+	{
+		MPDPeriodUpdateType updateType = eMPD_PERIOD_NEW;
+		auto it = previous.find(signature.id);
+		if (it != previous.end())
+		{
+			if (it->second->structureHash != signature.structureHash)
 			{
-				return node;
+				updateType = eMPD_PERIOD_CHANGED;
 			}
-
-			subnode = aamp_ProcessNode(reader, url, isAd);
-
-			if (subnode != NULL)
-				node->AddSubNode(subnode);
-
-			ret = xmlTextReaderRead(*reader);
+			else if (it->second->timelineHash != signature.timelineHash)
+			{
+				updateType = eMPD_PERIOD_TIMELINE_UPDATED;
+			}
+			else
+			{
+				updateType = eMPD_PERIOD_UNCHANGED;
+			}
+			previous.erase(it);
+		}
+		counts[updateType]++;
+		if (!signature.id.empty())
+		{
+			updates[signature.id] = updateType;
 		}
-
-		return node;
 	}
-	else if (type == Text)
+	for (auto it = previous.begin(); it != previous.end(); it++)
 	{
-		xmlChar * text = xmlTextReaderReadString(*reader);
-
-		if (text != NULL)
+		// Expired period, it will not come back to the manifest
+		auto expiredIt = std::find(mEarlyAvailablePeriodIds.begin(), mEarlyAvailablePeriodIds.end(), it->first);
+		if (expiredIt != mEarlyAvailablePeriodIds.end())
 		{
-			Node *node = new Node();
-			node->SetType(type);
-			node->SetText((const char*)text);
-			xmlFree(text);
-			return node;
+			mEarlyAvailablePeriodIds.erase(expiredIt);
 		}
 	}
-	return NULL;
+	if (!mPeriodSignatures.empty())
+	{
+		AAMPLOG_INFO("%s:%d Periods new %d unchanged %d timeline updated %d changed %d expired %d", __FUNCTION__, __LINE__,
+			counts[eMPD_PERIOD_NEW], counts[eMPD_PERIOD_UNCHANGED], counts[eMPD_PERIOD_TIMELINE_UPDATED], counts[eMPD_PERIOD_CHANGED], (int)previous.size());
+	}
+	mPeriodUpdates.swap(updates);
+	mPeriodSignatures = periodSignatures;
+}
+
+/**
+ * @brief Get change of a period in last MPD refresh
+ * @param periodId id of period
+ * @retval change of period, eMPD_PERIOD_NEW if not known
+ */
+MPDPeriodUpdateType PrivateStreamAbstractionMPD::GetPeriodUpdateType(const std::string &periodId)
+{
+	MPDPeriodUpdateType updateType = eMPD_PERIOD_NEW;
+	auto it = mPeriodUpdates.find(periodId);
+	if (it != mPeriodUpdates.end())
+	{
+		updateType = it->second;
+	}
+	return updateType;
+}
+
+/**
+ * @brief Get xml node form reader
+ *
+ * @param[in] reader Pointer to reader object
+ * @param[in] url    manifest url
+ *
+ * @retval xml node
+ */
+Node* aamp_ProcessNode(xmlTextReaderPtr *reader, std::string url, bool isAd)
+{
+	return aamp_ParseMPDNodes(*reader, url, isAd, NULL);
 }
 
 
@@ -3115,6 +3430,41 @@ std::shared_ptr<AampDrmHelper> PrivateStreamAbstractionMPD::CreateDrmHelper(IAda
 	return drmHelper;
 }
 
+/**
+ * @brief Start license acquisition of a DRM helper on the worker pool.
+ *        License requests of different helpers (e.g. separate audio and video keys)
+ *        run concurrently, AampDRMSessionManager avoids duplicate requests for a key.
+ * @param sessionParams session parameters, released in CreateDRMSession
+ * @param mediaType type of track
+ */
+void PrivateStreamAbstractionMPD::SubmitDrmSessionTask(DrmSessionParams* sessionParams, MediaType mediaType)
+{
+	std::shared_ptr<AampDrmHelper> drmHelper = sessionParams->drmHelper;
+	if((int)createDRMSessionTasks.size() >= gpGlobalConfig->dash_MaxDRMSessions) //In the case of license rotation
+	{
+		aamp->GetWorkerPool()->Join(createDRMSessionTasks.front());
+		createDRMSessionTasks.pop_front();
+	}
+	/*
+	*
+	* Memory allocated for data via base64_Decode() and memory for sessionParams
+	* is released in CreateDRMSession.
+	*/
+	AampWorkerTask *createDRMSessionTask = aamp->GetWorkerPool()->Submit("CreateDRMSession", CreateDRMSession, sessionParams, eAAMP_TASK_PRIORITY_TUNE);
+	if(NULL != createDRMSessionTask)
+	{
+		AAMPLOG_INFO("%s:%d (%s) CreateDRMSession submitted, %d in progress",__FUNCTION__, __LINE__, mMediaTypeName[mediaType], (int)createDRMSessionTasks.size());
+		createDRMSessionTasks.push_back(createDRMSessionTask);
+		mLastDrmHelper = drmHelper;
+		aamp->setCurrentDrm(drmHelper);
+	}
+	else
+	{
+		AAMPLOG_ERR("%s:%d (%s) Submit failed for CreateDRMSession", __FUNCTION__, __LINE__, mMediaTypeName[mediaType]);
+		delete sessionParams;
+	}
+}
+
 /**
  * @brief Process content protection of vss EAP
  * @param drmHelper created
@@ -3132,33 +3482,7 @@ void PrivateStreamAbstractionMPD::ProcessVssContentProtection(std::shared_ptr<Aa
 			sessionParams->aamp = aamp;
 			sessionParams->drmHelper = drmHelper;
 			sessionParams->stream_type = mediaType;
-
-			if(drmSessionThreadStarted) //In the case of license rotation
-			{
-				void *value_ptr = NULL;
-				int rc = pthread_join(createDRMSessionThreadID, &value_ptr);
-				if (rc != 0)
-				{
-					AAMPLOG_ERR("%s:%d (%s) pthread_join returned %d for createDRMSession Thread", __FUNCTION__, __LINE__, mMediaTypeName[mediaType], rc);
-				}
-				drmSessionThreadStarted = false;
-			}
-			/*
-			*
-			* Memory allocated for data via base64_Decode() and memory for sessionParams
-			* is released in CreateDRMSession.
-			*/
-			if(0 == pthread_create(&createDRMSessionThreadID,NULL,CreateDRMSession,sessionParams))
-			{
-				AAMPLOG_INFO("%s:%d Thread created",__FUNCTION__, __LINE__);
-				drmSessionThreadStarted = true;
-				mLastDrmHelper = drmHelper;
-				aamp->setCurrentDrm(drmHelper);
-			}
-			else
-			{
-				AAMPLOG_ERR("%s:%d (%s) pthread_create failed for CreateDRMSession : error code %d, %s", __FUNCTION__, __LINE__, mMediaTypeName[mediaType], errno, strerror(errno));
-			}
+			SubmitDrmSessionTask(sessionParams, mediaType);
 		}
 		else
 		{
@@ -3192,32 +3516,7 @@ void PrivateStreamAbstractionMPD::ProcessContentProtection(IAdaptationSet * adap
 		sessionParams->aamp = aamp;
 		sessionParams->drmHelper = drmHelper;
 		sessionParams->stream_type = mediaType;
-
-		if(drmSessionThreadStarted) //In the case of license rotation
-		{
-			void *value_ptr = NULL;
-			int rc = pthread_join(createDRMSessionThreadID, &value_ptr);
-			if (rc != 0)
-			{
-				AAMPLOG_ERR("%s:%d (%s) pthread_join returned %d for createDRMSession Thread", __FUNCTION__, __LINE__, mMediaTypeName[mediaType], rc);
-			}
-			drmSessionThreadStarted = false;
-		}
-		/*
-		*
-		* Memory allocated for data via base64_Decode() and memory for sessionParams
-		* is released in CreateDRMSession.
-		*/
-		if(0 == pthread_create(&createDRMSessionThreadID,NULL,CreateDRMSession,sessionParams))
-		{
-			drmSessionThreadStarted = true;
-			mLastDrmHelper = drmHelper;
-			aamp->setCurrentDrm(drmHelper);
-		}
-		else
-		{
-			AAMPLOG_ERR("%s:%d (%s) pthread_create failed for CreateDRMSession : error code %d, %s", __FUNCTION__, __LINE__, mMediaTypeName[mediaType], errno, strerror(errno));
-		}
+		SubmitDrmSessionTask(sessionParams, mediaType);
 	}
 	else
 	{
@@ -3238,6 +3537,23 @@ void PrivateStreamAbstractionMPD::ProcessContentProtection(IAdaptationSet * adap
 }
 #endif
 
+/**
+ * @brief Wait for all license acquisitions started by SubmitDrmSessionTask
+ */
+void PrivateStreamAbstractionMPD::JoinDrmSessionTasks()
+{
+	if(!createDRMSessionTasks.empty())
+	{
+		AAMPLOG_INFO("Waiting to join %d CreateDRMSession tasks", (int)createDRMSessionTasks.size());
+		for (AampWorkerTask *createDRMSessionTask : createDRMSessionTasks)
+		{
+			aamp->GetWorkerPool()->Join(createDRMSessionTask);
+		}
+		createDRMSessionTasks.clear();
+		AAMPLOG_INFO("Joined CreateDRMSession tasks");
+	}
+}
+
 
 /**
  *   @brief  GetFirstSegment start time from period
@@ -4399,9 +4715,12 @@ AAMPStatusType PrivateStreamAbstractionMPD::UpdateMPD(bool init)
 	bool gotManifest = false;
 	bool retrievedPlaylistFromCache = false;
 	memset(&manifest, 0, sizeof(manifest));
-	if (aamp->getAampCacheHandler()->RetrieveFromPlaylistCache(manifestUrl, &manifest, manifestUrl))
+	// MPD is parsed read-only, use cached data without copying it
+	AampSharedBlock *cachedManifest = aamp->getAampCacheHandler()->RetrieveSharedFromPlaylistCache(manifestUrl, manifestUrl);
+	if (cachedManifest)
 	{
 		logprintf("PrivateStreamAbstractionMPD::%s:%d manifest retrieved from cache", __FUNCTION__, __LINE__);
+		manifest = cachedManifest->buffer;
 		retrievedPlaylistFromCache = true;
 	}
 	if (!retrievedPlaylistFromCache)
@@ -4474,9 +4793,22 @@ AAMPStatusType PrivateStreamAbstractionMPD::UpdateMPD(bool init)
 
 		MPD* mpd = nullptr;
 		vector<std::string> locationUrl;
-		ret = GetMpdFromManfiest(manifest, mpd, manifestUrl, init);
-		if (eAAMPSTATUS_OK == ret)
-		{
+		std::vector<MPDPeriodSignature> periodSignatures;
+		uint64_t manifestHash = HashManifest(manifest);
+		if (!init && this->mpd && mIsLiveManifest && manifest.len == mManifestLength && manifestHash == mManifestHash)
+		{
+			// Live refresh returned the same document, keep the current MPD instead of building the node tree and MPD again
+			AAMPLOG_INFO("%s:%d manifest unchanged, skipped parsing %zu bytes", __FUNCTION__, __LINE__, manifest.len);
+			static_cast<MPD *>(this->mpd)->SetFetchTime(Time::GetCurrentUTCTimeInSec());
+			UpdatePeriodSignatures(mPeriodSignatures);
+			mpd = static_cast<MPD *>(this->mpd);
+			ret = AAMPStatusType::eAAMPSTATUS_OK;
+		}
+		else if (eAAMPSTATUS_OK == (ret = GetMpdFromManfiest(manifest, mpd, manifestUrl, init, &periodSignatures)))
+		{
+			mManifestHash = manifestHash;
+			mManifestLength = manifest.len;
+			UpdatePeriodSignatures(periodSignatures);
 			/* DELIA-42794: All manifest requests after the first should
 			 * reference the url from the Location element. This is per MPEG
 			 * specification */
@@ -4506,7 +4838,16 @@ AAMPStatusType PrivateStreamAbstractionMPD::UpdateMPD(bool init)
 			logprintf("%s:%d Error while processing MPD, GetMpdFromManfiest returned %d", __FUNCTION__, __LINE__, ret);
 			retrievedPlaylistFromCache = false;
 		}
-		aamp_Free(&manifest.ptr);
+		if (cachedManifest)
+		{
+			aamp_SharedBlockUnref(cachedManifest);
+			cachedManifest = NULL;
+			memset(&manifest, 0, sizeof(manifest));
+		}
+		else
+		{
+			aamp_Free(&manifest.ptr);
+		}
 		mLastPlaylistDownloadTimeMs = aamp_GetCurrentTimeMS();
 		if(mIsLiveStream && gpGlobalConfig->enableClientDai)
 		{
@@ -4615,13 +4956,12 @@ bool PrivateStreamAbstractionMPD::IsEmptyPeriod(IPeriod *period)
 /**
  * @brief Find timed metadata from mainifest
  * @param mpd MPD top level element
- * @param root XML root node
+ * @param subNodes MPD child nodes carrying timed metadata, collected while parsing
  * @param init true if this is the first playlist download for a tune/seek/trickplay
  * @param reportBulkMeta true if bulkTimedMetadata feature is enabled
  */
-void PrivateStreamAbstractionMPD::FindTimedMetadata(MPD* mpd, Node* root, bool init, bool reportBulkMeta)
+void PrivateStreamAbstractionMPD::FindTimedMetadata(MPD* mpd, const std::vector<Node*> &subNodes, bool init, bool reportBulkMeta)
 {
-	std::vector<Node*> subNodes = root->GetSubNodes();
 	if(!subNodes.empty())
 		{
 		uint64_t periodStartMS = 0;
@@ -6066,7 +6406,7 @@ int PrivateStreamAbstractionMPD::GetProfileIdxForBandwidthNotification(uint32_t
 /**
  * @brief Updates track information based on current state
  */
-AAMPStatusType PrivateStreamAbstractionMPD::UpdateTrackInfo(bool modifyDefaultBW, bool periodChanged, bool resetTimeLineIndex)
+AAMPStatusType PrivateStreamAbstractionMPD::UpdateTrackInfo(bool modifyDefaultBW, bool periodChanged, bool resetTimeLineIndex, bool preservePosition)
 {
 	AAMPStatusType ret = eAAMPSTATUS_OK;
 	long defaultBitrate = gpGlobalConfig->defaultBitrate;
@@ -6312,6 +6652,12 @@ AAMPStatusType PrivateStreamAbstractionMPD::UpdateTrackInfo(bool modifyDefaultBW
 			}
 			pMediaStreamContext->fragmentDescriptor.SetBaseURLs(baseUrls);
 
+			if(preservePosition && !pMediaStreamContext->eos)
+			{
+				// Period content is same as before the MPD refresh, current fragment position stays valid.
+				// A track at eos has dropped its position (lastSegmentNumber is reset), so it takes the full reset below
+				continue;
+			}
 			pMediaStreamContext->fragmentIndex = 0;
 
 			if(resetTimeLineIndex)
@@ -6320,6 +6666,9 @@ AAMPStatusType PrivateStreamAbstractionMPD::UpdateTrackInfo(bool modifyDefaultBW
 			}
 			pMediaStreamContext->fragmentRepeatCount = 0;
 			pMediaStreamContext->fragmentOffset = 0;
+			// offset restarts from the first sidx entry, decoded sidx is loaded again for the track
+			pMediaStreamContext->segmentIndex.clear();
+			pMediaStreamContext->segmentIndexKey.clear();
 			pMediaStreamContext->periodStartOffset = pMediaStreamContext->fragmentTime;
 			pMediaStreamContext->eos = false;
 			if(0 == pMediaStreamContext->fragmentDescriptor.Bandwidth || !aamp->IsTSBSupported())
@@ -6573,7 +6922,7 @@ double PrivateStreamAbstractionMPD::GetCulledSeconds()
  */
 void PrivateStreamAbstractionMPD::FetchAndInjectInitialization(bool discontinuity)
 {
-	pthread_t trackDownloadThreadID;
+	AampWorkerTask *trackDownloadTask = NULL;
 	HeaderFetchParams *fetchParams = NULL;
 	bool dlThreadCreated = false;
 	int numberOfTracks = mNumberOfTracks;
@@ -6610,10 +6959,10 @@ void PrivateStreamAbstractionMPD::FetchAndInjectInitialization(bool discontinuit
 							fetchParams->isinitialization = true;
 							fetchParams->pMediaStreamContext = pMediaStreamContext;
 							fetchParams->discontinuity = pMediaStreamContext->discontinuity;
-							int ret = pthread_create(&trackDownloadThreadID, NULL, TrackDownloader, fetchParams);
-							if(ret != 0)
+							trackDownloadTask = aamp->GetWorkerPool()->Submit("TrackDownloader", TrackDownloader, fetchParams, eAAMP_TASK_PRIORITY_TUNE);
+							if(NULL == trackDownloadTask)
 							{
-								logprintf("PrivateStreamAbstractionMPD::%s:%d pthread_create failed for TrackDownloader with errno = %d, %s", __FUNCTION__, __LINE__, errno, strerror(errno));
+								logprintf("PrivateStreamAbstractionMPD::%s:%d Submit failed for TrackDownloader", __FUNCTION__, __LINE__);
 								delete fetchParams;
 							}
 							else
@@ -6643,10 +6992,9 @@ void PrivateStreamAbstractionMPD::FetchAndInjectInitialization(bool discontinuit
 					if (segmentBase)
 					{
 						pMediaStreamContext->fragmentOffset = 0;
-						if (pMediaStreamContext->index_ptr)
-						{
-							aamp_Free(&pMediaStreamContext->index_ptr);
-						}
+						// sidx is decoded again for new representation
+						pMediaStreamContext->segmentIndex.clear();
+						pMediaStreamContext->segmentIndexKey.clear();
 						const IURLType *urlType = segmentBase->GetInitialization();
 						if (urlType)
 						{
@@ -6690,10 +7038,10 @@ void PrivateStreamAbstractionMPD::FetchAndInjectInitialization(bool discontinuit
 									fetchParams->initialization = initialization;
 									fetchParams->isinitialization = true;
 									fetchParams->pMediaStreamContext = pMediaStreamContext;
-									int ret = pthread_create(&trackDownloadThreadID, NULL, TrackDownloader, fetchParams);
-									if(ret != 0)
+									trackDownloadTask = aamp->GetWorkerPool()->Submit("TrackDownloader", TrackDownloader, fetchParams, eAAMP_TASK_PRIORITY_TUNE);
+									if(NULL == trackDownloadTask)
 									{
-										logprintf("PrivateStreamAbstractionMPD::%s:%d pthread_create failed for TrackDownloader with errno = %d, %s", __FUNCTION__, __LINE__, errno, strerror(errno));
+										logprintf("PrivateStreamAbstractionMPD::%s:%d Submit failed for TrackDownloader", __FUNCTION__, __LINE__);
 										delete fetchParams;
 									}
 									else
@@ -6787,9 +7135,9 @@ void PrivateStreamAbstractionMPD::FetchAndInjectInitialization(bool discontinuit
 
 	if(dlThreadCreated)
 	{
-		AAMPLOG_TRACE("Waiting for pthread_join trackDownloadThread");
-		pthread_join(trackDownloadThreadID, NULL);
-		AAMPLOG_TRACE("Joined trackDownloadThread");
+		AAMPLOG_TRACE("Waiting for trackDownloadTask");
+		aamp->GetWorkerPool()->Join(trackDownloadTask);
+		AAMPLOG_TRACE("Joined trackDownloadTask");
 		delete fetchParams;
 	}
 }
@@ -7061,6 +7409,7 @@ void PrivateStreamAbstractionMPD::FetcherLoop()
 				{
 					bool discontinuity = false;
 					bool requireStreamSelection = false;
+					bool mpdRefreshed = mpdChanged;
 					uint64_t nextSegmentTime = mMediaStreamContext[eMEDIATYPE_VIDEO]->fragmentDescriptor.Time;
 
 					if(mpdChanged)
@@ -7214,7 +7563,7 @@ void PrivateStreamAbstractionMPD::FetcherLoop()
 						mPrevAdaptationSetCount = adaptationSetCount;
 						requireStreamSelection = true;
 					}
-					else
+					else if(!mpdRefreshed || !IsPeriodStructureUnchanged(currentPeriodId))
 					{
 						for (int i = 0; i < mNumberOfTracks; i++)
 						{
@@ -7238,7 +7587,10 @@ void PrivateStreamAbstractionMPD::FetcherLoop()
 					if(AdState::IN_ADBREAK_AD_PLAYING != mCdaiObject->mAdState || (AdState::IN_ADBREAK_AD_PLAYING == mCdaiObject->mAdState && periodChanged))
 					{
 						bool resetTimeLineIndex = (mIsLiveStream || lastLiveFlag|| periodChanged);
-						UpdateTrackInfo(true, periodChanged, resetTimeLineIndex);
+						// Refresh did not touch playing period, keep fragment position instead of walking timeline again
+						bool preservePosition = (mpdRefreshed && !periodChanged && !requireStreamSelection &&
+									eMPD_PERIOD_UNCHANGED == GetPeriodUpdateType(currentPeriodId));
+						UpdateTrackInfo(true, periodChanged, resetTimeLineIndex, preservePosition);
 					}
 
 					if(mIsLiveStream || lastLiveFlag)
@@ -7372,7 +7724,7 @@ void PrivateStreamAbstractionMPD::FetcherLoop()
 						{
 							if (pMediaStreamContext->adaptationSet )
 							{
-								if((pMediaStreamContext->numberOfFragmentsCached != gpGlobalConfig->maxCachedFragmentsPerTrack) && !(pMediaStreamContext->profileChanged))
+								if(!pMediaStreamContext->IsFragmentCacheFull() && !(pMediaStreamContext->profileChanged))
 								{	// profile not changed and Cache not full scenario
 									if (!pMediaStreamContext->eos)
 									{
@@ -7428,7 +7780,7 @@ void PrivateStreamAbstractionMPD::FetcherLoop()
 									FetchAndInjectInitialization();
 								}
 
-								if(pMediaStreamContext->numberOfFragmentsCached != gpGlobalConfig->maxCachedFragmentsPerTrack)
+								if(!pMediaStreamContext->IsFragmentCacheFull())
 								{
 									bCacheFullState = false;
 								}
@@ -7906,17 +8258,7 @@ void PrivateStreamAbstractionMPD::Stop()
 		}
 	}
 
-	if(drmSessionThreadStarted)
-	{
-		AAMPLOG_INFO("Waiting to join CreateDRMSession thread");
-		int rc = pthread_join(createDRMSessionThreadID, NULL);
-		if (rc != 0)
-		{
-			logprintf("pthread_join returned %d for createDRMSession Thread", rc);
-		}
-		AAMPLOG_INFO("Joined CreateDRMSession thread");
-		drmSessionThreadStarted = false;
-	}
+	JoinDrmSessionTasks();
 
 	if(deferredDRMRequestThreadStarted)
 	{
@@ -41,11 +41,54 @@ using namespace dash::mpd;
 using namespace dash::xml;
 using namespace dash::helpers;
 #define MAX_MANIFEST_DOWNLOAD_RETRY_MPD 2
+#define MPD_XML_PARSE_OPTIONS (XML_PARSE_NOBLANKS | XML_PARSE_COMPACT) // Drop blank text nodes and pack short text into node storage
+
+/**
+ * @brief Content signature of an MPD period, used to find what changed across live refreshes
+ */
+struct MPDPeriodSignature
+{
+	std::string id;          /**< Period id */
+	uint64_t structureHash;  /**< Hash of period content other than SegmentTimeline S entries */
+	uint64_t timelineHash;   /**< Hash of SegmentTimeline S entries */
+
+	MPDPeriodSignature() : id(), structureHash(0), timelineHash(0)
+	{
+	}
+};
+
+/**
+ * @brief Information collected in the MPD parse pass
+ */
+struct MPDParseInfo
+{
+	std::vector<Node*> timedMetadataNodes;      /**< MPD level Period, ProgramInformation and SupplementalProperty nodes */
+	std::vector<MPDPeriodSignature> periods;    /**< Signature of each period, in document order */
+
+	MPDParseInfo() : timedMetadataNodes(), periods()
+	{
+	}
+};
+
+/**
+ * @brief Change of a period compared to previous MPD refresh
+ *
+ * Only the playing position is carried over for unchanged periods, the refreshed MPD
+ * still replaces the previous one as a whole
+ */
+enum MPDPeriodUpdateType
+{
+	eMPD_PERIOD_NEW,                /**< Period was not in previous MPD */
+	eMPD_PERIOD_UNCHANGED,          /**< Period content is identical */
+	eMPD_PERIOD_TIMELINE_UPDATED,   /**< Only SegmentTimeline entries changed */
+	eMPD_PERIOD_CHANGED             /**< Period structure changed */
+};
 
 /*Common MPD util functions*/
 uint64_t aamp_GetPeriodNewContentDuration(IPeriod * period, uint64_t &curEndNumber);
 uint64_t aamp_GetPeriodDuration(dash::mpd::IMPD *mpd, int periodIndex, uint64_t mpdDownloadTime = 0);
 Node* aamp_ProcessNode(xmlTextReaderPtr *reader, std::string url, bool isAd = false);
+Node* aamp_ParseMPDNodes(xmlTextReaderPtr reader, const std::string &url, bool isAd, MPDParseInfo *parseInfo);
 uint64_t aamp_GetDurationFromRepresentation(dash::mpd::IMPD *mpd);
 
 /**
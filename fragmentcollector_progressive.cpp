@@ -29,14 +29,24 @@
 #include <pthread.h>
 #include <signal.h>
 #include <assert.h>
+#include <inttypes.h>
+#include <algorithm>
+
+#define PROGRESSIVE_BOX_HEADER_SIZE 16 /**< Size and type of a box, with 64 bit size */
+#define PROGRESSIVE_STREAM_BLOCK_SIZE (64*1024) /**< Bytes collected from curl callbacks before a block is sent to the sink */
+#define PROGRESSIVE_STREAM_POOL_SIZE 16 /**< Max empty stream blocks kept for reuse once sink releases them */
 
 struct StreamWriteCallbackContext
 {
     bool sentTunedEvent;
     PrivateInstanceAAMP *aamp;
-    StreamWriteCallbackContext() : aamp(NULL), sentTunedEvent(false)
+    AampBufferPool *pool;       /**< Pool of blocks handed to the sink */
+    GrowableBuffer block;       /**< Block being collected from pool */
+    StreamWriteCallbackContext() : sentTunedEvent(false), aamp(NULL), pool(NULL), block()
     {
     }
+    StreamWriteCallbackContext(const StreamWriteCallbackContext&) = delete;
+    StreamWriteCallbackContext& operator=(const StreamWriteCallbackContext&) = delete;
 };
 
 /**
@@ -74,6 +84,69 @@ http://commondatastorage.googleapis.com/gtv-videos-bucket/sample/BigBuckBunny.mp
  TODO: profiling - stream based, not fragment based
  */
 
+/**
+ * @brief ProgressiveTrack Constructor
+ * @param aamp pointer to PrivateInstanceAAMP object associated with player
+ * @param context stream abstraction owning the track
+ */
+ProgressiveTrack::ProgressiveTrack(class PrivateInstanceAAMP *aamp, StreamAbstractionAAMP *context) :
+    MediaTrack(eTRACK_VIDEO, aamp, "video"), context(context)
+{
+}
+
+/**
+ * @brief Get buffered duration ahead of play position
+ * @retval buffered duration in seconds
+ */
+double ProgressiveTrack::GetBufferedDuration(void)
+{
+    return GetTotalBufferedDuration();
+}
+
+/**
+ * @brief Get stream abstraction owning the track
+ * @retval stream abstraction
+ */
+StreamAbstractionAAMP* ProgressiveTrack::GetContext()
+{
+    return context;
+}
+
+/**
+ * @brief Send cached chunk to the sink
+ * @param cachedFragment chunk to inject
+ * @param[out] fragmentDiscarded always false
+ */
+void ProgressiveTrack::InjectFragmentInternal(CachedFragment* cachedFragment, bool &fragmentDiscarded)
+{
+    fragmentDiscarded = false;
+    // chunk memory goes back to the pool once sink has released all of it
+    AampSharedBlock *block = aamp_CreateSharedBlock(&cachedFragment->fragment, mFragmentBufferPool);
+    aamp->SendStream(eMEDIATYPE_VIDEO, block, block->buffer.ptr, block->buffer.len,
+            cachedFragment->position, cachedFragment->position, cachedFragment->duration);
+    aamp_SharedBlockUnref(block);
+}
+
+/**
+ * @brief Hand collected block over to the sink without copying, memory returns to the pool
+ *        once sink releases it
+ * @param context stream context holding the block
+ */
+static void SendStreamBlock( StreamWriteCallbackContext *context )
+{
+    double fpts = 0.0;
+    double fdts = 0.0;
+    double fDuration = 2.0; // HACK!
+    AampSharedBlock *block = aamp_CreateSharedBlock( &context->block, context->pool );
+    context->aamp->SendStream( eMEDIATYPE_VIDEO, block, block->buffer.ptr, block->buffer.len, fpts, fdts, fDuration );
+    aamp_SharedBlockUnref( block );
+    if( !context->sentTunedEvent )
+    { // send TunedEvent after first chunk injected - this is hint for XRE to hide the "tuning overcard"
+        context->aamp->SendTunedEvent(false);
+        context->sentTunedEvent = true;
+    }
+}
+
 /**
  * @param ptr
  * @param size always 1, per curl documentation
@@ -91,16 +164,17 @@ static size_t StreamWriteCallback( void *ptr, size_t size, size_t nmemb, void *u
         AAMPLOG_INFO("StreamWriteCallback(%d bytes)\n", nmemb);
         // throttle download speed if gstreamer isn't hungry
         aamp->BlockUntilGstreamerWantsData( NULL/*CB*/, 0.0/*periodMs*/, eMEDIATYPE_VIDEO );
-        double fpts = 0.0;
-        double fdts = 0.0;
-        double fDuration = 2.0; // HACK!  //CID:113073 - Position variable initialized but not used
         if( nmemb>0 )
         {
-           aamp->SendStream( eMEDIATYPE_VIDEO, ptr, nmemb, fpts, fdts, fDuration);
-           if( !context->sentTunedEvent )
-           { // send TunedEvent after first chunk injected - this is hint for XRE to hide the "tuning overcard"
-               aamp->SendTunedEvent(false);
-               context->sentTunedEvent = true;
+           // curl reuses ptr, collect chunks into a pooled block which the sink takes over
+           if( !context->block.ptr )
+           {
+               context->pool->Acquire( &context->block, PROGRESSIVE_STREAM_BLOCK_SIZE + CURL_MAX_WRITE_SIZE );
+           }
+           aamp_AppendBytes( &context->block, ptr, nmemb );
+           if( context->block.len >= PROGRESSIVE_STREAM_BLOCK_SIZE )
+           {
+               SendStreamBlock( context );
            }
        }
    }
@@ -125,6 +199,7 @@ void StreamAbstractionAAMP_PROGRESSIVE::StreamFile( const char *uri, long *http_
         StreamWriteCallbackContext context;
         context.aamp = aamp;
         context.sentTunedEvent = false;
+        context.pool = new AampBufferPool("progressiveStream", PROGRESSIVE_STREAM_POOL_SIZE);
 
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, StreamWriteCallback );
         curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&context );
@@ -135,6 +210,16 @@ void StreamAbstractionAAMP_PROGRESSIVE::StreamFile( const char *uri, long *http_
         { // all data collected
             curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
         }
+        if( context.block.len > 0 && aamp->DownloadsAreEnabled() )
+        { // tail of file
+            SendStreamBlock( &context );
+        }
+        if( context.block.ptr )
+        {
+            context.pool->Release( &context.block );
+        }
+        // blocks still held by the sink keep the pool alive
+        context.pool->Unref();
         if (http_error)
         {
             *http_error = http_code;
@@ -143,7 +228,223 @@ void StreamAbstractionAAMP_PROGRESSIVE::StreamFile( const char *uri, long *http_
     }
 }
 /**
-  * TODO: harvest chunks from large mp3/mp4
+ * @brief Locate moov and mdat boxes with range requests and build sync points from moov
+ * @param uri file url
+ * @retval true if moov is ahead of mdat and has a usable sample table
+ */
+bool StreamAbstractionAAMP_PROGRESSIVE::ReadMovieHeader( const std::string &uri )
+{
+    std::string effectiveUrl;
+    char range[64];
+    uint64_t offset = 0;
+    uint64_t moovOffset = 0;
+    uint64_t moovSize = 0;
+    long http_error = 0;
+
+    mediaDataOffset = 0;
+    while( aamp->DownloadsAreEnabled() )
+    {
+        GrowableBuffer boxHeader;
+        memset(&boxHeader, 0x00, sizeof(boxHeader));
+        snprintf( range, sizeof(range), "%" PRIu64 "-%" PRIu64, offset, offset + PROGRESSIVE_BOX_HEADER_SIZE - 1 );
+        if( !aamp->GetFile( uri, &boxHeader, effectiveUrl, &http_error, NULL, range, eCURLINSTANCE_VIDEO, true, eMEDIATYPE_INIT_VIDEO ) ||
+            http_error != 206 || boxHeader.len < 8 )
+        {
+            AAMPLOG_WARN("%s:%d no box at offset %" PRIu64 ", http error %ld", __FUNCTION__, __LINE__, offset, http_error);
+            aamp_Free(&boxHeader.ptr);
+            break;
+        }
+        uint8_t *ptr = (uint8_t *)boxHeader.ptr;
+        uint64_t size = (uint32_t)READ_U32(ptr);
+        uint64_t headerSize = 8;
+        bool isMoov = IS_TYPE(ptr, Box::MOOV);
+        bool isMdat = IS_TYPE(ptr, Box::MDAT);
+        ptr += 4;
+        if( size == 1 && boxHeader.len >= PROGRESSIVE_BOX_HEADER_SIZE )
+        { // 64 bit size follows type
+            size = ReadUint64(ptr);
+            headerSize = PROGRESSIVE_BOX_HEADER_SIZE;
+        }
+        aamp_Free(&boxHeader.ptr);
+
+        if( isMdat )
+        {
+            mediaDataOffset = offset + headerSize;
+            // size 0 - mdat extends to end of file
+            mediaDataEnd = size ? (offset + size) : 0;
+            break;
+        }
+        if( size < headerSize )
+        {
+            AAMPLOG_WARN("%s:%d invalid box size %" PRIu64 " at offset %" PRIu64, __FUNCTION__, __LINE__, size, offset);
+            break;
+        }
+        if( isMoov )
+        {
+            moovOffset = offset;
+            moovSize = (headerSize == 8) ? size : 0;
+        }
+        offset += size;
+    }
+    if( !moovSize || !mediaDataOffset )
+    {
+        AAMPLOG_WARN("%s:%d moov not found ahead of mdat", __FUNCTION__, __LINE__);
+        return false;
+    }
+
+    snprintf( range, sizeof(range), "0-%" PRIu64, mediaDataOffset - 1 );
+    if( !aamp->GetFile( uri, &movieHeader, effectiveUrl, &http_error, NULL, range, eCURLINSTANCE_VIDEO, true, eMEDIATYPE_INIT_VIDEO ) ||
+        movieHeader.len != mediaDataOffset )
+    {
+        AAMPLOG_WARN("%s:%d failed to read %s, http error %ld", __FUNCTION__, __LINE__, range, http_error);
+        aamp_Free(&movieHeader.ptr);
+        return false;
+    }
+
+    IsoBmffBuffer buffer;
+    buffer.setBuffer( (uint8_t *)movieHeader.ptr + moovOffset, moovSize );
+    if( !buffer.parseBuffer() || !buffer.getTrackIndex( trackIndex ) )
+    {
+        AAMPLOG_WARN("%s:%d no sample table in moov", __FUNCTION__, __LINE__);
+        aamp_Free(&movieHeader.ptr);
+        return false;
+    }
+    primaryTrack = 0;
+    for( size_t i = 0; i < trackIndex.size(); i++ )
+    {
+        if( trackIndex[i].isVideo )
+        {
+            primaryTrack = (int)i;
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Estimate position of data at a file offset, from sync points of primary track
+ * @param offset file offset
+ * @retval position in seconds
+ */
+double StreamAbstractionAAMP_PROGRESSIVE::GetPositionAtOffset( uint64_t offset )
+{
+    const IsoBmffTrackIndex &index = trackIndex[primaryTrack];
+    auto it = std::upper_bound( index.points.begin(), index.points.end(), offset,
+        []( uint64_t value, const IsoBmffSyncPoint &point ) { return value < point.offset; } );
+    if( it == index.points.begin() )
+    {
+        return it->time;
+    }
+    const IsoBmffSyncPoint &prev = *(it - 1);
+    double nextTime = index.duration;
+    uint64_t nextOffset = mediaDataEnd;
+    if( it != index.points.end() )
+    {
+        nextTime = it->time;
+        nextOffset = it->offset;
+    }
+    if( nextOffset <= prev.offset )
+    { // end of mdat not known
+        return prev.time;
+    }
+    if( offset >= nextOffset )
+    {
+        return nextTime;
+    }
+    return prev.time + (nextTime - prev.time) * (offset - prev.offset) / (nextOffset - prev.offset);
+}
+
+/**
+ * @brief Download mdat in byte range chunks into the track cache.
+ *        Failed chunks are requested again from the same offset, chunks already cached are kept
+ * @param uri file url
+ */
+void StreamAbstractionAAMP_PROGRESSIVE::FetchChunks( const std::string &uri )
+{
+    std::string effectiveUrl;
+    char range[64];
+    // chunks follow the header without a gap, sample offsets in moov stay valid for the demuxer
+    uint64_t offset = mediaDataOffset;
+    bool endOfFile = false;
+    bool sentTunedEvent = false;
+
+    // moov and boxes ahead of mdat go first
+    CachedFragment *cachedFragment = track->GetFetchBuffer(true);
+    aamp_AppendBytes(&cachedFragment->fragment, movieHeader.ptr, movieHeader.len);
+    cachedFragment->position = 0;
+    cachedFragment->duration = 0;
+    cachedFragment->discontinuity = false;
+    track->UpdateTSAfterFetch();
+    aamp_Free(&movieHeader.ptr);
+    memset(&movieHeader, 0x00, sizeof(movieHeader));
+
+    while( aamp->DownloadsAreEnabled() && !endOfFile )
+    {
+        if( !track->WaitForFreeFragmentAvailable() )
+        {
+            continue;
+        }
+        uint64_t end = offset + gpGlobalConfig->progressiveChunkSize;
+        if( mediaDataEnd && end > mediaDataEnd )
+        {
+            end = mediaDataEnd;
+        }
+        snprintf( range, sizeof(range), "%" PRIu64 "-%" PRIu64, offset, end - 1 );
+        cachedFragment = track->GetFetchBuffer(true);
+        long http_error = 0;
+        double downloadTime = 0;
+        aamp->profiler.ProfileBegin(PROFILE_BUCKET_FRAGMENT_VIDEO);
+        if( aamp->GetFile( uri, &cachedFragment->fragment, effectiveUrl, &http_error, &downloadTime, range, eCURLINSTANCE_VIDEO, false, eMEDIATYPE_VIDEO ) &&
+            cachedFragment->fragment.len > 0 )
+        {
+            aamp->profiler.ProfileEnd(PROFILE_BUCKET_FRAGMENT_VIDEO);
+            track->segDLFailCount = 0;
+            cachedFragment->position = GetPositionAtOffset( offset );
+            offset += cachedFragment->fragment.len;
+            cachedFragment->duration = GetPositionAtOffset( offset ) - cachedFragment->position;
+            cachedFragment->discontinuity = false;
+            track->fragmentDurationSeconds = cachedFragment->duration;
+            // short read of an mdat extending to end of file
+            endOfFile = mediaDataEnd ? (offset >= mediaDataEnd) : (offset < end);
+            track->UpdateTSAfterFetch();
+            if( !sentTunedEvent )
+            { // send TunedEvent after first chunk cached - this is hint for XRE to hide the "tuning overcard"
+                aamp->SendTunedEvent(false);
+                sentTunedEvent = true;
+            }
+        }
+        else if( http_error == 416 && !mediaDataEnd )
+        { // range starts past end of file
+            aamp_Free(&cachedFragment->fragment.ptr);
+            endOfFile = true;
+        }
+        else
+        {
+            aamp->profiler.ProfileError(PROFILE_BUCKET_FRAGMENT_VIDEO, http_error);
+            aamp_Free(&cachedFragment->fragment.ptr);
+            if( aamp->DownloadsAreEnabled() )
+            {
+                track->segDLFailCount++;
+                AAMPLOG_WARN("%s:%d range %s failed, http error %ld, failedCount:%d", __FUNCTION__, __LINE__, range, http_error, track->segDLFailCount);
+                if( track->segDLFailCount >= MAX_SEG_DOWNLOAD_FAIL_COUNT )
+                {
+                    AAMPLOG_ERR("Not able to download fragments; reached failure threshold sending tune failed event");
+                    aamp->SendDownloadErrorEvent(AAMP_TUNE_FRAGMENT_DOWNLOAD_FAILURE, http_error);
+                    break;
+                }
+            }
+        }
+    }
+    if( endOfFile )
+    {
+        logprintf("%s:%d all chunks fetched, last offset %" PRIu64, __FUNCTION__, __LINE__, offset);
+        track->eosReached = true;
+        track->AbortWaitForCachedAndFreeFragment(false);
+    }
+}
+
+/**
+ * @brief Stream progressive file to the sink, in byte range chunks when moov could be indexed
  */
 void StreamAbstractionAAMP_PROGRESSIVE::FetcherLoop()
 {
@@ -153,7 +454,14 @@ void StreamAbstractionAAMP_PROGRESSIVE::FetcherLoop()
     
     if(gpGlobalConfig->useAppSrcForProgressivePlayback)
     {
-	    StreamFile( contentUrl.c_str(), &http_error );
+        if( track )
+        {
+            FetchChunks( contentUrl );
+        }
+        else
+        {
+            StreamFile( contentUrl.c_str(), &http_error );
+        }
     }
     else
     {
@@ -199,6 +507,28 @@ AAMPStatusType StreamAbstractionAAMP_PROGRESSIVE::Init(TuneType tuneType)
     {
         aamp->SetCurlTimeout(aamp->mNetworkTimeoutMs, (AampCurlInstance) i);
     }
+    if (seekPosition > 0)
+    {
+        // Chunked seek is not supported. qtdemux reads samples in push mode from the first entry of the
+        // sample tables on, so starting inside mdat would need a moov trimmed to the samples from the seek point
+        AAMPLOG_WARN("%s:%d range chunks not supported for seek position %f, streaming whole file", __FUNCTION__, __LINE__, seekPosition);
+    }
+    else if (gpGlobalConfig->useAppSrcForProgressivePlayback && gpGlobalConfig->progressiveChunkSize > 0)
+    {
+        if (ReadMovieHeader(aamp->GetManifestUrl()))
+        {
+            double duration = trackIndex[primaryTrack].duration;
+            aamp->UpdateDuration(duration);
+            track = new ProgressiveTrack(aamp, this);
+            track->enabled = true;
+            logprintf("%s:%d range chunks of %d bytes, duration %f, mdat offset %" PRIu64, __FUNCTION__, __LINE__,
+                    gpGlobalConfig->progressiveChunkSize, duration, mediaDataOffset);
+        }
+        else
+        {
+            AAMPLOG_WARN("%s:%d unable to index file, streaming it whole", __FUNCTION__, __LINE__);
+        }
+    }
     return retval;
 }
 
@@ -226,7 +556,8 @@ AAMPStatusType StreamAbstractionAAMP_PROGRESSIVE::Init(TuneType tuneType)
  * @param rate playback rate
  */
 StreamAbstractionAAMP_PROGRESSIVE::StreamAbstractionAAMP_PROGRESSIVE(class PrivateInstanceAAMP *aamp,double seek_pos, float rate): StreamAbstractionAAMP(aamp),
-fragmentCollectorThreadStarted(false), fragmentCollectorThreadID(0)
+fragmentCollectorThreadStarted(false), fragmentCollectorThreadID(0), seekPosition(seek_pos), track(NULL), movieHeader(),
+trackIndex(), primaryTrack(0), mediaDataOffset(0), mediaDataEnd(0)
 {
     trickplayMode = (rate != AAMP_NORMAL_PLAY_RATE);
 }
@@ -236,6 +567,8 @@ fragmentCollectorThreadStarted(false), fragmentCollectorThreadID(0)
  */
 StreamAbstractionAAMP_PROGRESSIVE::~StreamAbstractionAAMP_PROGRESSIVE()
 {
+    delete track;
+    aamp_Free(&movieHeader.ptr);
 }
 
 /**
@@ -245,6 +578,10 @@ void StreamAbstractionAAMP_PROGRESSIVE::Start(void)
 {
     pthread_create(&fragmentCollectorThreadID, NULL, &FragmentCollector, this);
     fragmentCollectorThreadStarted = true;
+    if (track && aamp->IsPlayEnabled())
+    {
+        track->StartInjectLoop();
+    }
 }
 
 /**
@@ -255,6 +592,11 @@ void StreamAbstractionAAMP_PROGRESSIVE::Stop(bool clearChannelData)
     if(fragmentCollectorThreadStarted)
     {
         aamp->DisableDownloads();
+        if (track)
+        {
+            // unblock fetcher waiting for a free slot in cache
+            track->AbortWaitForCachedAndFreeFragment(true);
+        }
 
         int rc = pthread_join(fragmentCollectorThreadID, NULL);
         if (rc != 0)
@@ -262,6 +604,10 @@ void StreamAbstractionAAMP_PROGRESSIVE::Stop(bool clearChannelData)
             logprintf("%s:%d ***pthread_join failed, returned %d\n", __FUNCTION__, __LINE__, rc);
         }
         fragmentCollectorThreadStarted = false;
+        if (track)
+        {
+            track->StopInjectLoop();
+        }
 
         aamp->EnableDownloads();
     }
@@ -294,7 +640,7 @@ void StreamAbstractionAAMP_PROGRESSIVE::GetStreamFormat(StreamOutputFormat &prim
  */
 MediaTrack* StreamAbstractionAAMP_PROGRESSIVE::GetMediaTrack(TrackType type)
 {
-    return NULL;//mPriv->GetMediaTrack(type);
+    return (type == eTRACK_VIDEO) ? track : NULL;
 }
 
 /**
@@ -330,7 +676,7 @@ double StreamAbstractionAAMP_PROGRESSIVE::GetFirstPTS()
 
 double StreamAbstractionAAMP_PROGRESSIVE::GetBufferedDuration()
 {
-	return -1.0;
+	return track ? track->GetBufferedDuration() : -1.0;
 }
 
 bool StreamAbstractionAAMP_PROGRESSIVE::IsInitialCachingSupported()
@@ -26,10 +26,31 @@
 #define FRAGMENTCOLLECTOR_PROGRESSIVE_H_
 
 #include "StreamAbstractionAAMP.h"
+#include "isobmffbuffer.h"
 #include <string>
+#include <vector>
 #include <stdint.h>
 using namespace std;
 
+/**
+ * @class ProgressiveTrack
+ * @brief Cache of byte range chunks of a progressive mp4 file, injected as they are
+ */
+class ProgressiveTrack : public MediaTrack
+{
+public:
+    ProgressiveTrack(class PrivateInstanceAAMP *aamp, StreamAbstractionAAMP *context);
+    ProgressiveTrack(const ProgressiveTrack&) = delete;
+    ProgressiveTrack& operator=(const ProgressiveTrack&) = delete;
+    void ABRProfileChanged(void) override { };
+    double GetBufferedDuration(void) override;
+protected:
+    StreamAbstractionAAMP* GetContext() override;
+    void InjectFragmentInternal(CachedFragment* cachedFragment, bool &fragmentDiscarded) override;
+private:
+    StreamAbstractionAAMP *context;
+};
+
 /**
  * @class StreamAbstractionAAMP_PROGRESSIVE
  * @brief Streamer for progressive mp3/mp4 playback
@@ -65,8 +86,18 @@ protected:
     StreamInfo* GetStreamInfo(int idx) override;
 private:
     void StreamFile( const char *uri, long *http_error );
+    bool ReadMovieHeader( const std::string &uri );
+    double GetPositionAtOffset( uint64_t offset );
+    void FetchChunks( const std::string &uri );
     bool fragmentCollectorThreadStarted;
     pthread_t fragmentCollectorThreadID;
+    double seekPosition;                        /**< Requested start position */
+    ProgressiveTrack *track;                    /**< Chunk cache, NULL when the whole file is streamed */
+    GrowableBuffer movieHeader;                 /**< File bytes before the mdat payload, including moov */
+    std::vector<IsoBmffTrackIndex> trackIndex;  /**< Sync points from sample tables of moov, map chunk offsets to positions */
+    int primaryTrack;                           /**< Index of the track used to map offsets to positions */
+    uint64_t mediaDataOffset;                   /**< File offset of the mdat payload */
+    uint64_t mediaDataEnd;                      /**< File offset after mdat, 0 if mdat extends to end of file */
 };
 
 #endif //FRAGMENTCOLLECTOR_PROGRESSIVE_H_
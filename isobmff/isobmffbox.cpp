@@ -175,6 +175,23 @@ Box* Box::constructBox(uint8_t *hdr, uint32_t maxSz)
 	{
 		return MdhdBox::constructMdhdBox(size,  hdr);
 	}
+	else if (IS_TYPE(type, MINF))
+	{
+		return GenericContainerBox::constructContainer(size, MINF, hdr);
+	}
+	else if (IS_TYPE(type, STBL))
+	{
+		return GenericContainerBox::constructContainer(size, STBL, hdr);
+	}
+	else if (IS_TYPE(type, HDLR))
+	{
+		return HdlrBox::constructHdlrBox(size, hdr);
+	}
+	else if (IS_TYPE(type, STTS) || IS_TYPE(type, STSS) || IS_TYPE(type, STSZ) ||
+			IS_TYPE(type, STSC) || IS_TYPE(type, STCO) || IS_TYPE(type, CO64))
+	{
+		return TableBox::constructTableBox(size, (const char *)type, hdr);
+	}
 
 	return new Box(size, (const char *)type);
 }
@@ -250,6 +267,11 @@ GenericContainerBox* GenericContainerBox::constructContainer(uint32_t sz, const
 		Box *box = Box::constructBox(ptr, sz-curOffset);
 		box->setOffset(curOffset);
 		cbox->addChildren(box);
+		if (box->getSize() < sizeof(uint32_t) + sizeof(uint32_t))
+		{
+			AAMPLOG_WARN("Box[%s] Size error:size[%u] in container[%s]\n", box->getType(), box->getSize(), btype);
+			break;
+		}
 		curOffset += box->getSize();
 		ptr += box->getSize();
 	}
@@ -476,3 +498,158 @@ TfdtBox* TfdtBox::constructTfdtBox(uint32_t sz, uint8_t *ptr)
 	FullBox fbox(sz, Box::TFDT, version, flags);
 	return new TfdtBox(fbox, mdt);
 }
+
+/**
+ * @brief HdlrBox constructor
+ *
+ * @param[in] fbox - box object
+ * @param[in] hType - handler type
+ */
+HdlrBox::HdlrBox(FullBox &fbox, const char hType[4]) : FullBox(fbox), handlerType{}
+{
+	memcpy(handlerType, hType, 4);
+}
+
+/**
+ * @brief Get handler type
+ *
+ * @return handler type
+ */
+const char *HdlrBox::getHandlerType()
+{
+	return handlerType;
+}
+
+/**
+ * @brief Static function to construct a HdlrBox object
+ *
+ * @param[in] sz - box size
+ * @param[in] ptr - pointer to box
+ * @return newly constructed HdlrBox object
+ */
+HdlrBox* HdlrBox::constructHdlrBox(uint32_t sz, uint8_t *ptr)
+{
+	uint8_t version = READ_VERSION(ptr);
+	uint32_t flags  = READ_FLAGS(ptr);
+	char hType[4] = {};
+
+	//Skipping pre_defined
+	ptr += sizeof(uint32_t);
+	if (sz >= (sizeof(uint32_t)*5))
+	{
+		READ_U8(hType, ptr, 4);
+	}
+
+	FullBox fbox(sz, Box::HDLR, version, flags);
+	return new HdlrBox(fbox, hType);
+}
+
+/**
+ * @brief TableBox constructor
+ *
+ * @param[in] fbox - box object
+ * @param[in] fields - number of values in each entry
+ */
+TableBox::TableBox(FullBox &fbox, uint32_t fields) : FullBox(fbox), entryCount(0), fieldCount(fields), fixedValue(0), values()
+{
+
+}
+
+/**
+ * @brief Get number of entries
+ *
+ * @return entry count, for STSZ the sample count
+ */
+uint32_t TableBox::getEntryCount()
+{
+	return entryCount;
+}
+
+/**
+ * @brief Get value of an entry
+ *
+ * @param[in] entry - entry index
+ * @param[in] field - field index within entry
+ * @return value, for STSZ with a fixed sample size that size
+ */
+uint64_t TableBox::getValue(uint32_t entry, uint32_t field)
+{
+	if (fixedValue)
+	{
+		return fixedValue;
+	}
+	return values[(size_t)entry * fieldCount + field];
+}
+
+/**
+ * @brief Static function to construct a TableBox object
+ *
+ * @param[in] sz - box size
+ * @param[in] btype - box type
+ * @param[in] ptr - pointer to box
+ * @return newly constructed TableBox object
+ */
+TableBox* TableBox::constructTableBox(uint32_t sz, const char btype[4], uint8_t *ptr)
+{
+	uint8_t version = READ_VERSION(ptr);
+	uint32_t flags  = READ_FLAGS(ptr);
+	uint32_t fields = 1;
+	uint32_t valueSize = sizeof(uint32_t);
+	uint32_t fixedValue = 0;
+	//Sizes of size, type, version & flags and entry_count fields
+	uint32_t headerSize = sizeof(uint32_t)*4;
+
+	if (IS_TYPE(btype, Box::STTS))
+	{
+		fields = 2;
+	}
+	else if (IS_TYPE(btype, Box::STSC))
+	{
+		fields = 3;
+	}
+	else if (IS_TYPE(btype, Box::CO64))
+	{
+		valueSize = sizeof(uint64_t);
+	}
+	else if (IS_TYPE(btype, Box::STSZ))
+	{
+		fixedValue = READ_U32(ptr);
+		headerSize += sizeof(uint32_t);
+	}
+
+	FullBox fbox(sz, btype, version, flags);
+	TableBox *tbox = new TableBox(fbox, fields);
+	if (sz < headerSize)
+	{
+		AAMPLOG_WARN("Box[%s] Size error:size[%u]\n", tbox->getType(), sz);
+		return tbox;
+	}
+	uint32_t count = READ_U32(ptr);
+	tbox->fixedValue = fixedValue;
+	if (fixedValue)
+	{
+		tbox->entryCount = count;
+		return tbox;
+	}
+	if ((uint64_t)count * fields * valueSize > (sz - headerSize))
+	{
+		AAMPLOG_WARN("Box[%s] Size error:entries[%u] size[%u]\n", tbox->getType(), count, sz);
+		return tbox;
+	}
+	tbox->values.reserve((size_t)count * fields);
+	for (uint64_t i = 0; i < (uint64_t)count * fields; i++)
+	{
+		uint64_t value;
+		if (valueSize == sizeof(uint64_t))
+		{
+			value = READ_BMDT64(ptr);
+		}
+		else
+		{
+			value = (uint32_t)READ_U32(ptr);
+		}
+		tbox->values.push_back(value);
+	}
+	tbox->entryCount = count;
+	return tbox;
+}
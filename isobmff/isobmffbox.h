@@ -72,6 +72,15 @@ public:
 	static constexpr const char *TRAK = "trak";
 	static constexpr const char *MDIA = "mdia";
 	static constexpr const char *MDHD = "mdhd";
+	static constexpr const char *HDLR = "hdlr";
+	static constexpr const char *MINF = "minf";
+	static constexpr const char *STBL = "stbl";
+	static constexpr const char *STTS = "stts";
+	static constexpr const char *STSS = "stss";
+	static constexpr const char *STSZ = "stsz";
+	static constexpr const char *STSC = "stsc";
+	static constexpr const char *STCO = "stco";
+	static constexpr const char *CO64 = "co64";
 
 	static constexpr const char *MOOF = "moof";
 	static constexpr const char *TRAF = "traf";
@@ -381,4 +390,88 @@ public:
 	static TfdtBox* constructTfdtBox(uint32_t sz, uint8_t *ptr);
 };
 
+
+/**
+ * @brief Class for ISO BMFF HDLR Box
+ */
+class HdlrBox : public FullBox
+{
+private:
+	char handlerType[5];	//Handler type Including \0, Eg: vide, soun
+
+public:
+	/**
+	 * @brief HdlrBox constructor
+	 *
+	 * @param[in] fbox - box object
+	 * @param[in] hType - handler type
+	 */
+	HdlrBox(FullBox &fbox, const char hType[4]);
+
+	/**
+	 * @brief Get handler type
+	 *
+	 * @return handler type
+	 */
+	const char *getHandlerType();
+
+	/**
+	 * @brief Static function to construct a HdlrBox object
+	 *
+	 * @param[in] sz - box size
+	 * @param[in] ptr - pointer to box
+	 * @return newly constructed HdlrBox object
+	 */
+	static HdlrBox* constructHdlrBox(uint32_t sz, uint8_t *ptr);
+};
+
+
+/**
+ * @brief Class for ISO BMFF sample table boxes, which hold an array of fixed size entries
+ * Eg: STTS, STSS, STSZ, STSC, STCO, CO64
+ */
+class TableBox : public FullBox
+{
+private:
+	uint32_t entryCount;		//Number of entries
+	uint32_t fieldCount;		//Number of values in each entry
+	uint32_t fixedValue;		//STSZ sample size shared by all samples, 0 if sizes are listed
+	std::vector<uint64_t> values;	//Entry values, fieldCount per entry
+
+public:
+	/**
+	 * @brief TableBox constructor
+	 *
+	 * @param[in] fbox - box object
+	 * @param[in] fields - number of values in each entry
+	 */
+	TableBox(FullBox &fbox, uint32_t fields);
+
+	/**
+	 * @brief Get number of entries
+	 *
+	 * @return entry count, for STSZ the sample count
+	 */
+	uint32_t getEntryCount();
+
+	/**
+	 * @brief Get value of an entry
+	 *
+	 * @param[in] entry - entry index
+	 * @param[in] field - field index within entry
+	 * @return value, for STSZ with a fixed sample size that size
+	 */
+	uint64_t getValue(uint32_t entry, uint32_t field = 0);
+
+	/**
+	 * @brief Static function to construct a TableBox object
+	 *
+	 * @param[in] sz - box size
+	 * @param[in] btype - box type
+	 * @param[in] ptr - pointer to box
+	 * @return newly constructed TableBox object
+	 */
+	static TableBox* constructTableBox(uint32_t sz, const char btype[4], uint8_t *ptr);
+};
+
 #endif /* __ISOBMFFBOX_H__ */
@@ -291,6 +291,139 @@ void IsoBmffBuffer::printBoxesInternal(const std::vector<Box*> *boxes)
 
 
 
+/**
+ * @brief Find first child box of a type
+ *
+ * @param[in] box - container box, can be NULL
+ * @param[in] type - child box type
+ * @return child box, NULL if not found
+ */
+static Box* findChildBox(Box *box, const char *type)
+{
+	if (box && box->hasChildren())
+	{
+		const std::vector<Box*> *children = box->getChildren();
+		for (size_t i = 0; i < children->size(); i++)
+		{
+			if (IS_TYPE(children->at(i)->getType(), type))
+			{
+				return children->at(i);
+			}
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Build sync points of a track from its sample table
+ *
+ * @param[in] trak - TRAK box
+ * @param[out] index - track index
+ * @return true if track has a usable sample table. false otherwise
+ */
+bool IsoBmffBuffer::getTrackIndexInternal(Box *trak, IsoBmffTrackIndex &index)
+{
+	Box *mdia = findChildBox(trak, Box::MDIA);
+	MdhdBox *mdhd = dynamic_cast<MdhdBox *>(findChildBox(mdia, Box::MDHD));
+	HdlrBox *hdlr = dynamic_cast<HdlrBox *>(findChildBox(mdia, Box::HDLR));
+	Box *stbl = findChildBox(findChildBox(mdia, Box::MINF), Box::STBL);
+	TableBox *stts = dynamic_cast<TableBox *>(findChildBox(stbl, Box::STTS));
+	TableBox *stss = dynamic_cast<TableBox *>(findChildBox(stbl, Box::STSS));
+	TableBox *stsz = dynamic_cast<TableBox *>(findChildBox(stbl, Box::STSZ));
+	TableBox *stsc = dynamic_cast<TableBox *>(findChildBox(stbl, Box::STSC));
+	TableBox *stco = dynamic_cast<TableBox *>(findChildBox(stbl, Box::STCO));
+	if (!stco)
+	{
+		stco = dynamic_cast<TableBox *>(findChildBox(stbl, Box::CO64));
+	}
+	if (!mdhd || !mdhd->getTimeScale() || !stts || !stsz || !stsc || !stco || !stsc->getEntryCount())
+	{
+		return false;
+	}
+
+	double timeScale = mdhd->getTimeScale();
+	uint32_t sampleCount = stsz->getEntryCount();
+	uint32_t sample = 0;
+	uint64_t time = 0;
+	uint32_t sttsEntry = 0;
+	uint64_t sttsLeft = stts->getEntryCount() ? stts->getValue(0, 0) : 0;
+	uint32_t stssEntry = 0;
+	uint32_t stscEntry = 0;
+
+	index.isVideo = (hdlr && IS_TYPE(hdlr->getHandlerType(), "vide"));
+	index.points.clear();
+	for (uint32_t chunk = 0; chunk < stco->getEntryCount() && sample < sampleCount; chunk++)
+	{
+		//first_chunk in STSC is 1 based
+		while ((stscEntry + 1 < stsc->getEntryCount()) && (stsc->getValue(stscEntry + 1, 0) <= chunk + 1))
+		{
+			stscEntry++;
+		}
+		uint64_t samplesInChunk = stsc->getValue(stscEntry, 1);
+		uint64_t offset = stco->getValue(chunk);
+		for (uint64_t i = 0; i < samplesInChunk && sample < sampleCount; i++, sample++)
+		{
+			bool sync = (i == 0);
+			if (stss)
+			{
+				//sample_number in STSS is 1 based
+				while ((stssEntry < stss->getEntryCount()) && (stss->getValue(stssEntry) < sample + 1))
+				{
+					stssEntry++;
+				}
+				sync = ((stssEntry < stss->getEntryCount()) && (stss->getValue(stssEntry) == sample + 1));
+			}
+			if (sync)
+			{
+				IsoBmffSyncPoint point = { time / timeScale, offset };
+				index.points.push_back(point);
+			}
+			offset += stsz->getValue(sample);
+
+			while ((sttsLeft == 0) && (sttsEntry + 1 < stts->getEntryCount()))
+			{
+				sttsEntry++;
+				sttsLeft = stts->getValue(sttsEntry, 0);
+			}
+			if (sttsLeft)
+			{
+				time += stts->getValue(sttsEntry, 1);
+				sttsLeft--;
+			}
+		}
+	}
+	index.duration = time / timeScale;
+	return !index.points.empty();
+}
+
+/**
+ * @brief Get sync points of all tracks in a parsed MOOV box
+ *
+ * @param[out] tracks - index of each track with a usable sample table
+ * @return true if at least one track was indexed. false otherwise
+ */
+bool IsoBmffBuffer::getTrackIndex(std::vector<IsoBmffTrackIndex> &tracks)
+{
+	tracks.clear();
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		Box *box = boxes.at(i);
+		if (IS_TYPE(box->getType(), Box::MOOV))
+		{
+			const std::vector<Box*> *children = box->getChildren();
+			for (size_t j = 0; j < children->size(); j++)
+			{
+				IsoBmffTrackIndex index = { false, 0, std::vector<IsoBmffSyncPoint>() };
+				if (IS_TYPE(children->at(j)->getType(), Box::TRAK) && getTrackIndexInternal(children->at(j), index))
+				{
+					tracks.push_back(std::move(index));
+				}
+			}
+		}
+	}
+	return !tracks.empty();
+}
+
 /**
  * @brief Print ISOBMFF boxes
  *
@@ -30,6 +30,25 @@
 #include <vector>
 #include <cstdint>
 
+/**
+ * @brief Sync sample of a track, maps a file offset to a decode time
+ */
+struct IsoBmffSyncPoint
+{
+	double time;		//Decode time in seconds
+	uint64_t offset;	//File offset of sample data
+};
+
+/**
+ * @brief Sync points of a track, built from its sample table
+ */
+struct IsoBmffTrackIndex
+{
+	bool isVideo;				//Track has a video handler
+	double duration;			//Sum of sample durations in seconds
+	std::vector<IsoBmffSyncPoint> points;	//Sync samples in decode order, start of each chunk if all samples are sync samples
+};
+
 /**
  * @brief Class for ISO BMFF Buffer
  */
@@ -66,6 +85,15 @@ private:
 	 * @return void
 	 */
 	void printBoxesInternal(const std::vector<Box*> *boxes);
+
+	/**
+	 * @brief Build sync points of a track from its sample table
+	 *
+	 * @param[in] trak - TRAK box
+	 * @param[out] index - track index
+	 * @return true if track has a usable sample table. false otherwise
+	 */
+	bool getTrackIndexInternal(Box *trak, IsoBmffTrackIndex &index);
 	bool parseBoxInternal(const std::vector<Box*> *boxes, const char *name, uint8_t *buf, size_t &size);
 	bool getBoxSizeInternal(const std::vector<Box*> *boxes, const char *name, size_t &size);
 	
@@ -150,6 +178,14 @@ public:
 	 */
 	bool isInitSegment();
 	
+	/**
+	 * @brief Get sync points of all tracks in a parsed MOOV box
+	 *
+	 * @param[out] tracks - index of each track with a usable sample table
+	 * @return true if at least one track was indexed. false otherwise
+	 */
+	bool getTrackIndex(std::vector<IsoBmffTrackIndex> &tracks);
+
 	bool parseMdatBox(uint8_t *buf, size_t &size);
 	bool getMdatBoxSize(size_t &size);
 };
@@ -75,7 +75,7 @@ IsoBmffProcessor::~IsoBmffProcessor()
  * @param[out] ptsError - flag indicates if any PTS error occurred
  * @return true if fragment was sent, false otherwise
  */
-bool IsoBmffProcessor::sendSegment(char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError)
+bool IsoBmffProcessor::sendSegment(char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError, AampSharedBlock *block)
 {
 	ptsError = false;
 	bool ret = true;
@@ -124,7 +124,14 @@ bool IsoBmffProcessor::sendSegment(char *segment, size_t& size, double position,
 				{
 					// We have no cached init fragment, maybe audio download was delayed very much
 					// Push this fragment with calculated PTS
-					p_aamp->SendStream((MediaType)type, segment, size, pos, pos, duration);
+					if (block)
+					{
+						p_aamp->SendStream((MediaType)type, block, segment, size, pos, pos, duration);
+					}
+					else
+					{
+						p_aamp->SendStream((MediaType)type, segment, size, pos, pos, duration);
+					}
 					ret = false;
 				}
 				initSegmentProcessComplete = true;
@@ -229,7 +236,14 @@ bool IsoBmffProcessor::sendSegment(char *segment, size_t& size, double position,
 
 	if (ret)
 	{
-		p_aamp->SendStream((MediaType)type, segment, size, position, position, duration);
+		if (block)
+		{
+			p_aamp->SendStream((MediaType)type, block, segment, size, position, position, duration);
+		}
+		else
+		{
+			p_aamp->SendStream((MediaType)type, segment, size, position, position, duration);
+		}
 	}
 	return true;
 }
@@ -88,9 +88,10 @@ public:
 	 * @param[in] duration - duration of fragment
 	 * @param[in] discontinuous - true if discontinuous fragment
 	 * @param[out] ptsError - flag indicates if any PTS error occurred
+	 * @param[in] block - shared block holding segment, NULL if not shared
 	 * @return true if fragment was sent, false otherwise
 	 */
-	bool sendSegment(char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError) override;
+	bool sendSegment(char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError, AampSharedBlock *block = NULL) override;
 
 	/**
 	 * @brief Abort all operations
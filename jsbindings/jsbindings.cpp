@@ -370,12 +370,13 @@ static JSValueRef AAMP_getProperty_timedMetadata(JSContextRef context, JSObjectR
 		return JSValueMakeUndefined(context);
 	}
 
-	int32_t length = privAAMP->timedMetadata.size();
+	std::vector<TimedMetadata> timedMetadata = privAAMP->timedMetadata.Snapshot();
+	int32_t length = timedMetadata.size();
 
 	JSValueRef* array = new JSValueRef[length];
 	for (int32_t i = 0; i < length; i++)
 	{
-		TimedMetadata item = privAAMP->timedMetadata.at(i);
+		const TimedMetadata &item = timedMetadata[i];
 		JSObjectRef ref = aamp_CreateTimedMetadataJSObject(context, item._timeMS, item._name.c_str(), item._content.c_str(), item._id.c_str(), item._durationMS);
 		array[i] = ref;
 	}
@@ -1687,6 +1687,16 @@ std::string PlayerInstanceAAMP::GetAvailableAudioTracks()
 	return aamp->GetAvailableAudioTracks();
 }
 
+/**
+ *   @brief Get latency histograms of fragment processing phases since tune.
+ *
+ *   @return std::string JSON formatted histograms per track and phase
+ */
+std::string PlayerInstanceAAMP::GetPlaybackProfile()
+{
+	return aamp->GetPlaybackProfile();
+}
+
 /**
  *   @brief Get available text tracks.
  *
@@ -285,6 +285,25 @@ public:
 	 */
 	virtual void Send( MediaType mediaType, struct GrowableBuffer* buffer, double fpts, double fdts, double duration)= 0;
 
+	/**
+	 *   @brief  API to send part of a shared media block into the sink without copying.
+	 *           Sink takes its own references on the block for as long as it holds the data,
+	 *           caller keeps its reference. Default implementation copies the data.
+	 *
+	 *   @param[in]  mediaType - Type of the media.
+	 *   @param[in]  block - Reference counted block holding the data
+	 *   @param[in]  ptr - Start of data within block.
+	 *   @param[in]  len - Length of data.
+	 *   @param[in]  fpts - Presentation Time Stamp.
+	 *   @param[in]  fdts - Decode Time Stamp
+	 *   @param[in]  duration - Buffer duration.
+	 *   @return void
+	 */
+	virtual void Send( MediaType mediaType, struct AampSharedBlock* block, const void *ptr, size_t len, double fpts, double fdts, double duration)
+	{
+		Send(mediaType, ptr, len, fpts, fdts, duration);
+	}
+
 	/**
 	 *   @brief  Notifies EOS to sink
 	 *
@@ -1120,6 +1139,13 @@ public:
 	 */
 	std::string GetAvailableAudioTracks();
 
+	/**
+	 *   @brief Get latency histograms of fragment processing phases since tune.
+	 *
+	 *   @return std::string JSON formatted histograms per track and phase
+	 */
+	std::string GetPlaybackProfile();
+
 	/**
 	 *   @brief Get available text tracks.
 	 *
@@ -26,6 +26,7 @@
 #define __MEDIA_PROCESSOR_H__
 
 #include <stddef.h>
+#include "AampMemoryUtils.h"
 
 /**
 * @enum _PlayMode
@@ -79,9 +80,10 @@ public:
 	 * @param[in] duration - duration of fragment
 	 * @param[in] discontinuous - true if discontinuous fragment
 	 * @param[out] ptsError - flag indicates if any PTS error occurred
+	 * @param[in] block - shared block holding segment, lets sink keep data without copy; NULL if not shared
 	 * @return true if fragment was sent, false otherwise
 	 */
-	virtual bool sendSegment( char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError) = 0;
+	virtual bool sendSegment( char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError, AampSharedBlock *block = NULL) = 0;
 
 	/**
 	 * @brief Set playback rate
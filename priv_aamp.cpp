@@ -25,7 +25,9 @@
 #include "priv_aamp.h"
 #include "AampConstants.h"
 #include "AampCacheHandler.h"
+#include "AampWorkerPool.h"
 #include "AampUtils.h"
+#include "AampMutex.h"
 #include "iso639map.h"
 #include "fragmentcollector_mpd.h"
 #include "admanager_mpd.h"
@@ -165,8 +167,9 @@ struct CurlCallbackContext
 	httpRespHeaderData *responseHeaderData;
 	long bitrate;
 	bool downloadIsEncoded;
+	HlsDrmStreamDecryptor *streamDecryptor;
 
-	CurlCallbackContext() : aamp(NULL), buffer(NULL), responseHeaderData(NULL),bitrate(0),downloadIsEncoded(false), fileType(eMEDIATYPE_DEFAULT), allResponseHeadersForErrorLogging{""}
+	CurlCallbackContext() : aamp(NULL), buffer(NULL), responseHeaderData(NULL),bitrate(0),downloadIsEncoded(false), fileType(eMEDIATYPE_DEFAULT), allResponseHeadersForErrorLogging{""}, streamDecryptor(NULL)
 	{
 
 	}
@@ -190,6 +193,11 @@ struct CurlProgressCbContext
 	long stallTimeout;
 	double downloadSize;
 	CurlAbortReason abortReason;
+	AampBandwidthEstimator *bandwidthEstimator; /**< Fed with throughput samples if not NULL */
+	long long sampleTime;                      /**< End of last throughput sample, -1 before first byte */
+	double sampleSize;                         /**< Downloaded bytes at end of last throughput sample */
+	long fragmentDurationMs;                   /**< Fragment duration, abort download which would take longer if non zero */
+	long profileBitrate;                       /**< Bitrate of profile being downloaded */
 };
 
 /**
@@ -402,35 +410,24 @@ static gboolean PrivateInstanceAAMP_Retune(gpointer ptr)
 }
 
 /**
- * @brief Function invoked at the end of idle task for freeing resources
- * @param user_data pointer to AsyncEventDescriptor object
- */
-static void AsyncEventDestroyNotify(gpointer user_data)
-{
-	AsyncEventDescriptor* e = (AsyncEventDescriptor*)user_data;
-	delete e;
-}
-
-/**
- * @brief Idle task for sending asynchronous event
- * @param user_data pointer to AsyncEventDescriptor object
+ * @brief Idle task for sending queued asynchronous events
+ * @param user_data pointer to PrivateInstanceAAMP object
  * @retval G_SOURCE_REMOVE
  */
 static gboolean SendAsynchronousEvent(gpointer user_data)
 {
-	//TODO protect mEventListener
-	AsyncEventDescriptor* e = (AsyncEventDescriptor*)user_data;
+	PrivateInstanceAAMP* aamp = (PrivateInstanceAAMP*)user_data;
 	//Get current idle handler's id
 	guint callbackID = aamp_GetSourceID();
 	if (callbackID != 0)
 	{
-		e->aamp->SetCallbackAsDispatched(callbackID);
+		aamp->SetCallbackAsDispatched(callbackID);
 	}
 	else
 	{
-		AAMPLOG_ERR("PrivateInstanceAAMP::%s:%d [type = %d] aamp_GetSourceID returned zero, which is unexpected behavior!", __FUNCTION__, __LINE__, e->event->getType());
+		AAMPLOG_ERR("PrivateInstanceAAMP::%s:%d aamp_GetSourceID returned zero, which is unexpected behavior!", __FUNCTION__, __LINE__);
 	}
-	e->aamp->SendEventSync(e->event);
+	aamp->DispatchScheduledEvents();
 	return G_SOURCE_REMOVE;
 }
 
@@ -1280,6 +1277,20 @@ static void ProcessConfigEntry(std::string cfg)
 			VALIDATE_INT("fragment-cache-length", gpGlobalConfig->maxCachedFragmentsPerTrack, DEFAULT_CACHED_FRAGMENTS_PER_TRACK)
 			logprintf("aamp fragment cache length: %d", gpGlobalConfig->maxCachedFragmentsPerTrack);
 		}
+		else if (ReadConfigNumericHelper(cfg, "fragment-cache-size=", gpGlobalConfig->maxCachedFragmentBytesPerTrack) == 1)
+		{
+			// Read value in KB , convert it to bytes
+			gpGlobalConfig->maxCachedFragmentBytesPerTrack = (gpGlobalConfig->maxCachedFragmentBytesPerTrack > 0) ? (gpGlobalConfig->maxCachedFragmentBytesPerTrack * 1024) : 0;
+			logprintf("aamp fragment cache size: %d", gpGlobalConfig->maxCachedFragmentBytesPerTrack);
+		}
+		else if (ReadConfigNumericHelper(cfg, "fragment-cache-duration=", gpGlobalConfig->maxCachedFragmentSecondsPerTrack) == 1)
+		{
+			if (gpGlobalConfig->maxCachedFragmentSecondsPerTrack < 0)
+			{
+				gpGlobalConfig->maxCachedFragmentSecondsPerTrack = 0;
+			}
+			logprintf("aamp fragment cache duration: %f", gpGlobalConfig->maxCachedFragmentSecondsPerTrack);
+		}
 		else if (ReadConfigNumericHelper(cfg, "pts-error-threshold=", gpGlobalConfig->ptsErrorThreshold) == 1)
 		{
 			VALIDATE_INT("pts-error-threshold", gpGlobalConfig->ptsErrorThreshold, MAX_PTS_ERRORS_THRESHOLD)
@@ -1489,6 +1500,67 @@ static void ProcessConfigEntry(std::string cfg)
 			gpGlobalConfig->mEnableSeekableRange = (TriState) (value == 1);
 			logprintf("Seekable range reporting: %d", gpGlobalConfig->mEnableSeekableRange);
 		}
+		else if(ReadConfigNumericHelper(cfg, "incremental-playlist-index=", value) == 1)
+		{
+			gpGlobalConfig->incrementalPlaylistIndex = (value == 1);
+			logprintf("incremental-playlist-index=%d", gpGlobalConfig->incrementalPlaylistIndex);
+		}
+		else if(ReadConfigNumericHelper(cfg, "aes-streaming-decrypt=", value) == 1)
+		{
+			gpGlobalConfig->aesStreamingDecrypt = (value == 1);
+			logprintf("aes-streaming-decrypt=%d", gpGlobalConfig->aesStreamingDecrypt);
+		}
+		else if (ReadConfigNumericHelper(cfg, "fragment-download-concurrency=", gpGlobalConfig->fragmentDownloadConcurrency) == 1)
+		{
+			VALIDATE_INT("fragment-download-concurrency", gpGlobalConfig->fragmentDownloadConcurrency, DEFAULT_FRAGMENT_DOWNLOAD_CONCURRENCY)
+			logprintf("fragment-download-concurrency=%d", gpGlobalConfig->fragmentDownloadConcurrency);
+		}
+		else if (ReadConfigNumericHelper(cfg, "max-init-fragment-cache=", gpGlobalConfig->maxInitFragmentCacheSize) == 1)
+		{
+			// Read value in KB , convert it to bytes
+			gpGlobalConfig->maxInitFragmentCacheSize = gpGlobalConfig->maxInitFragmentCacheSize * 1024;
+			VALIDATE_INT("max-init-fragment-cache", gpGlobalConfig->maxInitFragmentCacheSize, MAX_INIT_FRAGMENT_CACHE_SIZE)
+			logprintf("max-init-fragment-cache=%d", gpGlobalConfig->maxInitFragmentCacheSize);
+		}
+		else if(ReadConfigNumericHelper(cfg, "parallel-license-acquisition=", value) == 1)
+		{
+			gpGlobalConfig->parallelLicenseAcquisition = (value == 1);
+			logprintf("parallel-license-acquisition=%d", gpGlobalConfig->parallelLicenseAcquisition);
+		}
+		else if (ReadConfigNumericHelper(cfg, "drm-session-cache-ttl=", gpGlobalConfig->drmSessionCacheTTL) == 1)
+		{
+			if (gpGlobalConfig->drmSessionCacheTTL < 0)
+			{
+				gpGlobalConfig->drmSessionCacheTTL = 0;
+			}
+			logprintf("drm-session-cache-ttl=%d", gpGlobalConfig->drmSessionCacheTTL);
+		}
+		else if(ReadConfigNumericHelper(cfg, "parallel-ts-demux=", value) == 1)
+		{
+			gpGlobalConfig->parallelTsDemux = (value == 1);
+			logprintf("parallel-ts-demux=%d", gpGlobalConfig->parallelTsDemux);
+		}
+		else if(ReadConfigNumericHelper(cfg, "abr-throughput-estimate=", value) == 1)
+		{
+			gpGlobalConfig->abrThroughputEstimate = (value == 1);
+			logprintf("abr-throughput-estimate=%d", gpGlobalConfig->abrThroughputEstimate);
+		}
+		else if(ReadConfigNumericHelper(cfg, "abr-abort-slow-fragment=", value) == 1)
+		{
+			gpGlobalConfig->abrAbortSlowFragment = (value == 1);
+			logprintf("abr-abort-slow-fragment=%d", gpGlobalConfig->abrAbortSlowFragment);
+		}
+		else if (ReadConfigNumericHelper(cfg, "progressive-chunk-size=", gpGlobalConfig->progressiveChunkSize) == 1)
+		{
+			// Read value in KB , convert it to bytes
+			gpGlobalConfig->progressiveChunkSize = (gpGlobalConfig->progressiveChunkSize > 0) ? (gpGlobalConfig->progressiveChunkSize * 1024) : 0;
+			logprintf("progressive-chunk-size=%d", gpGlobalConfig->progressiveChunkSize);
+		}
+		else if (ReadConfigNumericHelper(cfg, "playback-profile-interval=", gpGlobalConfig->playbackProfileInterval) == 1)
+		{
+			VALIDATE_INT("playback-profile-interval", gpGlobalConfig->playbackProfileInterval, 0)
+			logprintf("playback-profile-interval=%d", gpGlobalConfig->playbackProfileInterval);
+		}
 		else if (cfg.at(0) == '*')
 		{
 			std::size_t pos = cfg.find_first_of(' ');
@@ -1558,6 +1630,11 @@ static size_t write_callback(char *ptr, size_t size, size_t nmemb, void *userdat
 		logprintf("write_callback - interrupted");
 	}
 	pthread_mutex_unlock(&context->aamp->mLock);
+	if (ret && context->streamDecryptor)
+	{
+		// decrypt received blocks in place, overlapping decryption with rest of download
+		context->streamDecryptor->Update(context->buffer);
+	}
 	return ret;
 }
 
@@ -1767,6 +1844,37 @@ static int progress_callback(
 			}
 		}
 	}
+	if (rc == 0 && dlnow > 0 && context->bandwidthEstimator)
+	{
+		long long now = NOW_STEADY_TS_MS;
+		if (context->sampleTime < 0)
+		{ // first byte(s) downloaded - time until now is connection setup and request latency, not throughput
+			context->sampleTime = now;
+			context->sampleSize = dlnow;
+		}
+		else if (now - context->sampleTime >= BANDWIDTH_SAMPLE_MIN_INTERVAL_MS)
+		{ // also sample intervals without new bytes, so a stall lowers the estimate before download completes
+			context->bandwidthEstimator->AddSample(now, (long long)(dlnow - context->sampleSize), now - context->sampleTime);
+			context->sampleTime = now;
+			context->sampleSize = dlnow;
+			long elapsedMs = (long)(now - context->downloadStartTime);
+			if (context->fragmentDurationMs > 0 && dltotal > dlnow && elapsedMs >= context->fragmentDurationMs / 2)
+			{
+				long bps = context->bandwidthEstimator->GetBandwidth(now, context->fragmentDurationMs);
+				if (bps >= 0 && bps < context->profileBitrate)
+				{
+					double remainingMs = (bps > 0) ? ((dltotal - dlnow) * 8000 / bps) : context->fragmentDurationMs;
+					if (elapsedMs + remainingMs > context->fragmentDurationMs)
+					{ // would complete after the fragment duration - leave it for a lower profile
+						logprintf("Abort download as throughput %ld bps is too low, downloaded %.0f of %.0f bytes in %ld ms, fragment duration %ld ms",
+							bps, dlnow, dltotal, elapsedMs, context->fragmentDurationMs);
+						context->abortReason = eCURL_ABORT_REASON_LOW_BANDWIDTH;
+						rc = -1;
+					}
+				}
+			}
+		}
+	}
 	return rc;
 }
 
@@ -1861,19 +1969,19 @@ static void curl_unlock_callback(CURL *curl, curl_lock_data data, curl_lock_acce
 /**
  * @brief PrivateInstanceAAMP Constructor
  */
-PrivateInstanceAAMP::PrivateInstanceAAMP() : mAbrBitrateData(), mLock(), mMutexAttr(),
+PrivateInstanceAAMP::PrivateInstanceAAMP() : mAbrBitrateData(), mBandwidthEstimator(), mLock(), mMutexAttr(),
 	mpStreamAbstractionAAMP(NULL), mInitSuccess(false), mVideoFormat(FORMAT_INVALID), mAudioFormat(FORMAT_INVALID), mDownloadsDisabled(),
-	mDownloadsEnabled(true), mStreamSink(NULL), profiler(), licenceFromManifest(false), previousAudioType(eAUDIO_UNKNOWN),
+	mDownloadsEnabled(true), mStreamSink(NULL), profiler(), mPlaybackProfiler(), licenceFromManifest(false), previousAudioType(eAUDIO_UNKNOWN),
 	mbDownloadsBlocked(false), streamerIsActive(false), mTSBEnabled(false), mIscDVR(false), mLiveOffset(AAMP_LIVE_OFFSET), mNewLiveOffsetflag(false),
 	fragmentCollectorThreadID(0), seek_pos_seconds(-1), rate(0), pipeline_paused(false), mMaxLanguageCount(0), zoom_mode(VIDEO_ZOOM_FULL),
 	video_muted(false), subtitles_muted(true), audio_volume(100), subscribedTags(), timedMetadata(), IsTuneTypeNew(false), trickStartUTCMS(-1),mLogTimetoTopProfile(true),
 	playStartUTCMS(0), durationSeconds(0.0), culledSeconds(0.0), maxRefreshPlaylistIntervalSecs(DEFAULT_INTERVAL_BETWEEN_PLAYLIST_UPDATES_MS/1000), initialTuneTimeMs(0),
-	mEventListener(NULL), mReportProgressPosn(0.0), mReportProgressTime(0), discardEnteringLiveEvt(false),
+	mEventListener(NULL), mReportProgressPosn(0.0), mReportProgressTime(0), mPlaybackProfileReportTime(0), discardEnteringLiveEvt(false),
 	mIsRetuneInProgress(false), mCondDiscontinuity(), mDiscontinuityTuneOperationId(0), mIsVSS(false),
 	m_fd(-1), mIsLive(false), mTuneCompleted(false), mFirstTune(true), mfirstTuneFmt(-1), mTuneAttempts(0), mPlayerLoadTime(0),
 	mState(eSTATE_RELEASED), mMediaFormat(eMEDIAFORMAT_HLS), mPersistedProfileIndex(0), mAvailableBandwidth(0),
 	mDiscontinuityTuneOperationInProgress(false), mContentType(), mTunedEventPending(false),
-	mSeekOperationInProgress(false), mPendingAsyncEvents(), mCustomHeaders(),
+	mSeekOperationInProgress(false), mPendingAsyncEvents(), mEventQueueLock(), mScheduledEvents(), mDispatchingEvents(), mEventDispatchScheduled(false), mCustomHeaders(),
 	mManifestUrl(""), mTunedManifestUrl(""), mServiceZone(), mVssVirtualStreamId(),
 	mCurrentLanguageIndex(0), noExplicitUserLanguageSelection(true), languageSetByUser(false), preferredLanguagesString(), preferredLanguagesList(),
 #ifdef SESSION_STATS
@@ -1885,6 +1993,7 @@ PrivateInstanceAAMP::PrivateInstanceAAMP() : mAbrBitrateData(), mLock(), mMutexA
 	,mLastDiscontinuityTimeMs(0), mBufUnderFlowStatus(false), mVideoBasePTS(0)
 	,mCustomLicenseHeaders(), mIsIframeTrackPresent(false), mManifestTimeoutMs(-1), mNetworkTimeoutMs(-1)
 	,mBulkTimedMetadata(false), reportMetadata(), mbPlayEnabled(true), mPlayerPreBuffered(false), mPlayerId(PLAYERID_CNTR++),mAampCacheHandler(new AampCacheHandler())
+	,mWorkerPool(new AampWorkerPool("aampWorkerPool", DEFAULT_WORKER_POOL_THREADS))
 	,mAsyncTuneEnabled(false), mWesterosSinkEnabled(false), mEnableRectPropertyEnabled(true), waitforplaystart()
 	,mTuneEventConfigLive(eTUNED_EVENT_ON_GST_PLAYING), mTuneEventConfigVod(eTUNED_EVENT_ON_GST_PLAYING)
 	,mUseAvgBandwidthForABR(false), mParallelFetchPlaylistRefresh(true), mParallelFetchPlaylist(false)
@@ -1900,7 +2009,7 @@ PrivateInstanceAAMP::PrivateInstanceAAMP() : mAbrBitrateData(), mLock(), mMutexA
 #if defined(AAMP_MPD_DRM) || defined(AAMP_HLS_DRM)
 	, mDRMSessionManager(NULL)
 #endif
-	,  mPreCachePlaylistThreadId(0), mPreCachePlaylistThreadFlag(false) , mPreCacheDnldList()
+	,  mPreCachePlaylistTask(NULL), mPreCacheDnldList()
 	, mPreCacheDnldTimeWindow(0), mReportProgressInterval(DEFAULT_REPORT_PROGRESS_INTERVAL), mParallelPlaylistFetchLock(), mAppName()
 	, mABRBufferCheckEnabled(true), mNewAdBreakerEnabled(false), mProgressReportFromProcessDiscontinuity(false), mUseRetuneForUnpairedDiscontinuity(true)
 	, prevPositionMiliseconds(-1), mInitFragmentRetryCount(-1), mPlaylistFetchFailError(0L),mAudioDecoderStreamSync(true)
@@ -1930,6 +2039,7 @@ PrivateInstanceAAMP::PrivateInstanceAAMP() : mAbrBitrateData(), mLock(), mMutexA
 	pthread_mutex_init(&mLock, &mMutexAttr);
 	pthread_mutex_init(&mParallelPlaylistFetchLock, &mMutexAttr);
 	pthread_mutex_init(&mFragmentCachingLock, &mMutexAttr);
+	pthread_mutex_init(&mEventQueueLock, NULL);
 	mCurlShared = curl_share_init();
 	curl_share_setopt(mCurlShared, CURLSHOPT_LOCKFUNC, curl_lock_callback);
 	curl_share_setopt(mCurlShared, CURLSHOPT_UNLOCKFUNC, curl_unlock_callback);
@@ -1943,11 +2053,6 @@ PrivateInstanceAAMP::PrivateInstanceAAMP() : mAbrBitrateData(), mLock(), mMutexA
 		httpRespHeaders[i].data.clear();
 		curlDLTimeout[i] = 0;
 	}
-	for (int i = 0; i < AAMP_MAX_NUM_EVENTS; i++)
-	{
-		mEventListeners[i] = NULL;
-	}
-
 	for (int i = 0; i < AAMP_TRACK_COUNT; i++)
 	{
 		mbTrackDownloadsBlocked[i] = false;
@@ -2003,15 +2108,10 @@ PrivateInstanceAAMP::~PrivateInstanceAAMP()
 	}
 	pthread_mutex_unlock(&gMutex);
 
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	for (int i = 0; i < AAMP_MAX_NUM_EVENTS; i++)
 	{
-		while (mEventListeners[i] != NULL)
-		{
-			ListenerData* pListener = mEventListeners[i];
-			mEventListeners[i] = pListener->pNext;
-			delete pListener;
-		}
+		std::atomic_store(&mEventListeners[i], EventListenerList());
 	}
 
 	if (mNetworkProxy)
@@ -2031,7 +2131,7 @@ PrivateInstanceAAMP::~PrivateInstanceAAMP()
           	mVideoEnd = NULL;
 	}
 #endif
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 
 	pthread_cond_destroy(&mDownloadsDisabled);
 	pthread_cond_destroy(&mCondDiscontinuity);
@@ -2040,6 +2140,7 @@ PrivateInstanceAAMP::~PrivateInstanceAAMP()
 	pthread_mutex_destroy(&mLock);
 	pthread_mutex_destroy(&mParallelPlaylistFetchLock);
 	pthread_mutex_destroy(&mFragmentCachingLock);
+	pthread_mutex_destroy(&mEventQueueLock);
 #ifdef AAMP_HLS_DRM
 	aesCtrAttrDataList.clear();
 	pthread_mutex_destroy(&drmParserMutex);
@@ -2049,6 +2150,11 @@ PrivateInstanceAAMP::~PrivateInstanceAAMP()
 		delete mAampCacheHandler;
 		mAampCacheHandler = NULL;
 	}
+	if (mWorkerPool)
+	{
+		delete mWorkerPool;
+		mWorkerPool = NULL;
+	}
 #if defined(AAMP_MPD_DRM) || defined(AAMP_HLS_DRM)
 	if (mDRMSessionManager)
 	{
@@ -2071,7 +2177,7 @@ PrivateInstanceAAMP::~PrivateInstanceAAMP()
  */
 void PrivateInstanceAAMP::SyncBegin(void)
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 }
 
 /**
@@ -2079,7 +2185,7 @@ void PrivateInstanceAAMP::SyncBegin(void)
  */
 void PrivateInstanceAAMP::SyncEnd(void)
 {
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 }
 
 /**
@@ -2156,6 +2262,29 @@ void PrivateInstanceAAMP::ReportProgress(void)
 		mReportProgressPosn = position;
 		SendEventSync(evt);
 		mReportProgressTime = aamp_GetCurrentTimeMS();
+
+		ReportPlaybackProfile();
+	}
+}
+
+/**
+ * @brief Send playback profile as metrics data event, at the configured interval
+ *
+ * Histograms are cumulative since tune, listeners diff consecutive events for interval values
+ */
+void PrivateInstanceAAMP::ReportPlaybackProfile(void)
+{
+	if (gpGlobalConfig->playbackProfileInterval > 0)
+	{
+		long long now = NOW_STEADY_TS_MS;
+		if ((now - mPlaybackProfileReportTime) >= (gpGlobalConfig->playbackProfileInterval * 1000LL))
+		{
+			mPlaybackProfileReportTime = now;
+			std::string profile = mPlaybackProfiler.ToJsonString();
+			AAMPLOG_INFO("PlaybackProfile:%s", profile.c_str());
+			MetricsDataEventPtr e = std::make_shared<MetricsDataEvent>(MetricsDataType::AAMP_DATA_PLAYBACK_PROFILE, this->mTraceUUID, profile);
+			SendEventAsync(e);
+		}
 	}
 }
 
@@ -2215,20 +2344,9 @@ void PrivateInstanceAAMP::UpdateCullingState(double culledSecs)
 	this->culledSeconds += culledSecs;
 	long long limitMs = (long long) std::round(this->culledSeconds * 1000.0);
 
-	for (auto iter = timedMetadata.begin(); iter != timedMetadata.end(); )
-	{
-		// If the timed metadata has expired due to playlist refresh, remove it from local cache
-		// For X-CONTENT-IDENTIFIER, -X-IDENTITY-ADS, X-MESSAGE_REF in DASH which has _timeMS as 0
-		if (iter->_timeMS != 0 && iter->_timeMS < limitMs)
-		{
-			//logprintf("ERASE(limit:%lld) aamp_ReportTimedMetadata(%lld, '%s', '%s', nb)", limitMs,iter->_timeMS, iter->_name.c_str(), iter->_content.c_str());
-			iter = timedMetadata.erase(iter);
-		}
-		else
-		{
-			iter++;
-		}
-	}
+	// If the timed metadata has expired due to playlist refresh, remove it from local cache
+	timedMetadata.Cull(limitMs);
+	reportMetadata.Cull(limitMs);
 
 	// Check if we are paused and culled past paused playback position
 	// AAMP internally caches fragments in sw and gst buffer, so we should be good here
@@ -2272,16 +2390,13 @@ void PrivateInstanceAAMP::AddEventListener(AAMPEventType eventType, EventListene
 	//logprintf("[AAMP_JS] %s(%d, %p)", __FUNCTION__, eventType, eventListener);
 	if ((eventListener != NULL) && (eventType >= 0) && (eventType < AAMP_MAX_NUM_EVENTS))
 	{
-		ListenerData* pListener = new ListenerData;
-		if (pListener)
-		{
-			//logprintf("[AAMP_JS] %s(%d, %p) new %p", __FUNCTION__, eventType, eventListener, pListener);
-			pthread_mutex_lock(&mLock);
-			pListener->eventListener = eventListener;
-			pListener->pNext = mEventListeners[eventType];
-			mEventListeners[eventType] = pListener;
-			pthread_mutex_unlock(&mLock);
-		}
+		// copy on write, lists already handed to dispatch stay valid
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
+		EventListenerList current = std::atomic_load(&mEventListeners[eventType]);
+		std::vector<EventListener*> *listeners = current ? new std::vector<EventListener*>(*current) : new std::vector<EventListener*>();
+		listeners->push_back(eventListener);
+		std::atomic_store(&mEventListeners[eventType], EventListenerList(listeners));
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 }
 
@@ -2295,22 +2410,26 @@ void PrivateInstanceAAMP::RemoveEventListener(AAMPEventType eventType, EventList
 {
 	if ((eventListener != NULL) && (eventType >= 0) && (eventType < AAMP_MAX_NUM_EVENTS))
 	{
-		pthread_mutex_lock(&mLock);
-		ListenerData** ppLast = &mEventListeners[eventType];
-		while (*ppLast != NULL)
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
+		EventListenerList current = std::atomic_load(&mEventListeners[eventType]);
+		if (current)
 		{
-			ListenerData* pListener = *ppLast;
-			if (pListener->eventListener == eventListener)
+			// most recently added registration is removed first, as before
+			auto it = std::find(current->rbegin(), current->rend(), eventListener);
+			if (it != current->rend())
 			{
-				*ppLast = pListener->pNext;
-				pthread_mutex_unlock(&mLock);
-				AAMPLOG_INFO("[AAMP_JS] %s(%d, %p) delete %p", __FUNCTION__, eventType, eventListener, pListener);
-				delete pListener;
-				return;
+				EventListenerList listeners;
+				if (current->size() > 1)
+				{
+					std::vector<EventListener*> *remaining = new std::vector<EventListener*>(*current);
+					remaining->erase(remaining->begin() + (std::distance(it, current->rend()) - 1));
+					listeners.reset(remaining);
+				}
+				std::atomic_store(&mEventListeners[eventType], listeners);
+				AAMPLOG_INFO("[AAMP_JS] %s(%d, %p) removed", __FUNCTION__, eventType, eventListener);
 			}
-			ppLast = &(pListener->pNext);
 		}
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 }
 
@@ -2507,13 +2626,13 @@ bool PrivateInstanceAAMP::PausePipeline(bool pause, bool forceStopGstreamerPreBu
 void PrivateInstanceAAMP::SendErrorEvent(AAMPTuneFailure tuneFailure, const char * description, bool isRetryEnabled)
 {
 	bool sendErrorEvent = false;
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	if(mState != eSTATE_ERROR)
 	{
 		sendErrorEvent = true;
 		mState = eSTATE_ERROR;
 	}
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 	if (sendErrorEvent)
 	{
 		int code;
@@ -2576,11 +2695,9 @@ void PrivateInstanceAAMP::SendErrorEvent(AAMPTuneFailure tuneFailure, const char
 void PrivateInstanceAAMP::SendEventAsync(AAMPEventPtr e)
 {
 	AAMPEventType eventType = e->getType();
-	if (mEventListener || mEventListeners[0] || mEventListeners[eventType])
+	if (HasEventListeners(eventType))
 	{
-		AsyncEventDescriptor* aed = new AsyncEventDescriptor();
-		aed->event = e;
-		ScheduleEvent(aed);
+		ScheduleEvent(e);
 		if(eventType != AAMP_EVENT_PROGRESS)
 		{
 			AAMPLOG_INFO("PrivateInstanceAAMP::%s:%d event type  %d", __FUNCTION__, __LINE__, eventType);
@@ -2612,53 +2729,46 @@ void PrivateInstanceAAMP::SendEventSync(AAMPEventPtr e)
 		}
 	}
 
-	//TODO protect mEventListener
-	if (mEventListener)
+	EventListener *eventListener = mEventListener.load();
+	if (eventListener)
 	{
-		mEventListener->SendEvent(e);
+		eventListener->SendEvent(e);
 	}
 
 	if ((eventType < 0) || (eventType >= AAMP_MAX_NUM_EVENTS))  //CID:81883 - Resolve OVER_RUN
 		return;
 
-	// Build list of registered event listeners.
-	ListenerData* pList = NULL;
-	pthread_mutex_lock(&mLock);
-	ListenerData* pListener = mEventListeners[eventType];
-	while (pListener != NULL)
+	// Take snapshots of the registered listeners. Published lists are immutable,
+	// so event handlers can add/remove listeners for future events meanwhile.
+	EventListenerList allListeners = std::atomic_load(&mEventListeners[0]);  // listeners registered for "all" event types
+	EventListenerList listeners = std::atomic_load(&mEventListeners[eventType]);
+	if (allListeners)
 	{
-		ListenerData* pNew = new ListenerData;
-		pNew->eventListener = pListener->eventListener;
-		pNew->pNext = pList;
-		pList = pNew;
-		pListener = pListener->pNext;
-	}
-	pListener = mEventListeners[0];  // listeners registered for "all" event types
-	while (pListener != NULL)
-	{
-		ListenerData* pNew = new ListenerData;
-		pNew->eventListener = pListener->eventListener;
-		pNew->pNext = pList;
-		pList = pNew;
-		pListener = pListener->pNext;
+		for (EventListener *listener : *allListeners)
+		{
+			listener->SendEvent(e);
+		}
 	}
-	pthread_mutex_unlock(&mLock);
-
-	// After releasing the lock, dispatch each of the registered listeners.
-	// This allows event handlers to add/remove listeners for future events.
-	while (pList != NULL)
+	if (listeners && (eventType != 0))
 	{
-		ListenerData* pCurrent = pList;
-		if (pCurrent->eventListener != NULL)
+		for (EventListener *listener : *listeners)
 		{
-			//logprintf("[AAMP_JS] %s(type=%d) listener=%p", __FUNCTION__, eventType, pCurrent->eventListener);
-			pCurrent->eventListener->SendEvent(e);
+			//logprintf("[AAMP_JS] %s(type=%d) listener=%p", __FUNCTION__, eventType, listener);
+			listener->SendEvent(e);
 		}
-		pList = pCurrent->pNext;
-		delete pCurrent;
 	}
 }
 
+/**
+ * @brief Check if any listener is registered for event type
+ * @param eventType type of event
+ * @retval true if event has listeners
+ */
+bool PrivateInstanceAAMP::HasEventListeners(AAMPEventType eventType)
+{
+	return (mEventListener || GetEventListenerStatus((AAMPEventType)0) || GetEventListenerStatus(eventType));
+}
+
 /**
  * @brief Notify bitrate change event to listeners
  * @param bitrate new bitrate
@@ -2669,10 +2779,9 @@ void PrivateInstanceAAMP::SendEventSync(AAMPEventPtr e)
  */
 void PrivateInstanceAAMP::NotifyBitRateChangeEvent(int bitrate, BitrateChangeReason reason, int width, int height, double frameRate, double position, bool GetBWIndex)
 {
-	if (mEventListener || mEventListeners[0] || mEventListeners[AAMP_EVENT_BITRATE_CHANGED])
+	if (HasEventListeners(AAMP_EVENT_BITRATE_CHANGED))
 	{
-		AsyncEventDescriptor* e = new AsyncEventDescriptor();
-		e->event = std::make_shared<BitrateChangeEvent>((int)aamp_GetCurrentTimeMS(), bitrate, BITRATEREASON2STRING(reason), width, height, frameRate, position);
+		AAMPEventPtr e = std::make_shared<BitrateChangeEvent>((int)aamp_GetCurrentTimeMS(), bitrate, BITRATEREASON2STRING(reason), width, height, frameRate, position);
 
 		/* START: Added As Part of DELIA-28363 and DELIA-28247 */
 		if(GetBWIndex && (mpStreamAbstractionAAMP != NULL))
@@ -2934,15 +3043,69 @@ void PrivateInstanceAAMP::NotifyOnEnteringLive()
 }
 
 /**
- * @brief Schedule asynchronous event
- * @param e event descriptor
+ * @brief Queue event for dispatch from main loop, coalescing superseded events
+ * @param e event
+ */
+void PrivateInstanceAAMP::ScheduleEvent(AAMPEventPtr e)
+{
+	AAMPEventType eventType = e->getType();
+	bool scheduleDispatch = false;
+	AAMP_MUTEX_LOCK(mEventQueueLock, "PrivateInstanceAAMP::mEventQueueLock");
+	bool queue = true;
+	if (eventType == AAMP_EVENT_PROGRESS)
+	{
+		// only the latest position is of interest, it replaces a progress event not yet dispatched
+		for (auto it = mScheduledEvents.begin(); it != mScheduledEvents.end(); ++it)
+		{
+			if ((*it)->getType() == AAMP_EVENT_PROGRESS)
+			{
+				mScheduledEvents.erase(it);
+				break;
+			}
+		}
+	}
+	else if (eventType == AAMP_EVENT_BUFFERING_CHANGED)
+	{
+		// drop repeated notification of the buffering state last queued, start/end pairs are kept
+		for (auto it = mScheduledEvents.rbegin(); it != mScheduledEvents.rend(); ++it)
+		{
+			if ((*it)->getType() == AAMP_EVENT_BUFFERING_CHANGED)
+			{
+				queue = (std::static_pointer_cast<BufferingChangedEvent>(*it)->buffering() != std::static_pointer_cast<BufferingChangedEvent>(e)->buffering());
+				break;
+			}
+		}
+	}
+	if (queue)
+	{
+		mScheduledEvents.push_back(e);
+		scheduleDispatch = !mEventDispatchScheduled;
+		mEventDispatchScheduled = true;
+	}
+	AAMP_MUTEX_UNLOCK(mEventQueueLock);
+	if (scheduleDispatch)
+	{
+		// SetCallbackAsPending takes mLock, so the idle callback is added outside of mEventQueueLock
+		guint callbackID = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, SendAsynchronousEvent, this, NULL);
+		SetCallbackAsPending(callbackID);
+	}
+}
+
+/**
+ * @brief Dispatch events queued by SendEventAsync, called from main loop
  */
-void PrivateInstanceAAMP::ScheduleEvent(AsyncEventDescriptor* e)
+void PrivateInstanceAAMP::DispatchScheduledEvents()
 {
-	//TODO protect mEventListener
-	e->aamp = this;
-	guint callbackID = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, SendAsynchronousEvent, e, AsyncEventDestroyNotify);
-	SetCallbackAsPending(callbackID);
+	AAMP_MUTEX_LOCK(mEventQueueLock, "PrivateInstanceAAMP::mEventQueueLock");
+	mDispatchingEvents.swap(mScheduledEvents);
+	mEventDispatchScheduled = false;
+	AAMP_MUTEX_UNLOCK(mEventQueueLock);
+	for (AAMPEventPtr &e : mDispatchingEvents)
+	{
+		SendEventSync(e);
+	}
+	// keep capacity of both vectors, dispatch does not allocate in steady state
+	mDispatchingEvents.clear();
 }
 
 /**
@@ -3065,9 +3228,9 @@ void PrivateInstanceAAMP::StopDownloads()
 	traceprintf ("PrivateInstanceAAMP::%s", __FUNCTION__);
 	if (!mbDownloadsBlocked)
 	{
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		mbDownloadsBlocked = true;
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 }
 
@@ -3080,10 +3243,10 @@ void PrivateInstanceAAMP::ResumeDownloads()
 	traceprintf ("PrivateInstanceAAMP::%s", __FUNCTION__);
 	if (mbDownloadsBlocked)
 	{
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		mbDownloadsBlocked = false;
 		//log_current_time("gstreamer-needs-data");
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 }
 
@@ -3103,9 +3266,9 @@ void PrivateInstanceAAMP::StopTrackDownloads(MediaType type)
 	if (!mbTrackDownloadsBlocked[type])
 	{
 		AAMPLOG_TRACE("gstreamer-enough-data from %s source", (type == eMEDIATYPE_AUDIO) ? "audio" : "video");
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		mbTrackDownloadsBlocked[type] = true;
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 		NotifySinkBufferFull(type);
 	}
 	traceprintf ("PrivateInstanceAAMP::%s Enter. type = %d", __FUNCTION__, (int) type);
@@ -3127,10 +3290,10 @@ void PrivateInstanceAAMP::ResumeTrackDownloads(MediaType type)
 	if (mbTrackDownloadsBlocked[type])
 	{
 		AAMPLOG_TRACE("gstreamer-needs-data from %s source", (type == eMEDIATYPE_AUDIO) ? "audio" : "video");
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		mbTrackDownloadsBlocked[type] = false;
 		//log_current_time("gstreamer-needs-data");
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 	traceprintf ("PrivateInstanceAAMP::%s Exit. type = %d", __FUNCTION__, (int) type);
 }
@@ -3392,12 +3555,13 @@ AampCurlInstance PrivateInstanceAAMP::GetPlaylistCurlInstance(MediaType type, bo
  */
 void PrivateInstanceAAMP::ResetCurrentlyAvailableBandwidth(long bitsPerSecond , bool trickPlay,int profile)
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	if (mAbrBitrateData.size())
 	{
 		mAbrBitrateData.erase(mAbrBitrateData.begin(),mAbrBitrateData.end());
 	}
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
+	mBandwidthEstimator.Reset();
 }
 
 /**
@@ -3419,7 +3583,7 @@ long PrivateInstanceAAMP::GetCurrentlyAvailableBandwidth(void)
 	std::vector< long> tmpData;
 	std::vector< long>::iterator tmpDataIter;
 	long long presentTime = aamp_GetCurrentTimeMS();
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	for (bitrateIter = mAbrBitrateData.begin(); bitrateIter != mAbrBitrateData.end();)
 	{
 		//logprintf("[%s][%d] Sz[%d] TimeCheck Pre[%lld] Sto[%lld] diff[%lld] bw[%ld] ",__FUNCTION__,__LINE__,mAbrBitrateData.size(),presentTime,(*bitrateIter).first,(presentTime - (*bitrateIter).first),(long)(*bitrateIter).second);
@@ -3434,7 +3598,7 @@ long PrivateInstanceAAMP::GetCurrentlyAvailableBandwidth(void)
 			bitrateIter++;
 		}
 	}
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 
 	if (tmpData.size())
 	{	
@@ -3485,7 +3649,18 @@ long PrivateInstanceAAMP::GetCurrentlyAvailableBandwidth(void)
 		//logprintf("[%s][%d] No data available for bitrate check , return -1 ",__FUNCTION__,__LINE__);
 		ret = -1;
 	}
-	
+
+	if (gpGlobalConfig->abrThroughputEstimate)
+	{
+		// Throughput sampled during downloads follows a collapse before the fragment completes
+		long estimate = mBandwidthEstimator.GetBandwidth(NOW_STEADY_TS_MS, gpGlobalConfig->abrCacheLife);
+		if (estimate >= 0 && (ret == -1 || estimate < ret))
+		{
+			AAMPLOG_INFO("%s:%d Using throughput estimate %ld bps, fragment based %ld bps", __FUNCTION__, __LINE__, estimate, ret);
+			ret = estimate;
+			mAvailableBandwidth = ret;
+		}
+	}
 	return ret;
 }
 
@@ -3522,6 +3697,115 @@ const char* PrivateInstanceAAMP::MediaTypeString(MediaType fileType)
 	}
 }
 
+/**
+ * @brief Build list of custom http headers configured for requests
+ * @param simType media type of the file requested
+ * @retval header list to be freed by caller with curl_slist_free_all, NULL if none
+ */
+struct curl_slist* PrivateInstanceAAMP::GetCustomHeaders(MediaType simType)
+{
+	struct curl_slist* httpHeaders = NULL;
+	std::string customHeader;
+	std::string headerValue;
+	for (std::unordered_map<std::string, std::vector<std::string>>::iterator it = mCustomHeaders.begin();
+						it != mCustomHeaders.end(); it++)
+	{
+		customHeader.clear();
+		headerValue.clear();
+		customHeader.insert(0, it->first);
+		customHeader.push_back(' ');
+		headerValue = it->second.at(0);
+		if (it->first.compare("X-MoneyTrace:") == 0)
+		{
+			if (mIsLocalPlayback && !mIsFirstRequestToFOG)
+			{
+				continue;
+			}
+			char buf[512];
+			memset(buf, '\0', 512);
+			if (it->second.size() >= 2)
+			{
+				snprintf(buf, 512, "trace-id=%s;parent-id=%s;span-id=%lld",
+						(const char*)it->second.at(0).c_str(),
+						(const char*)it->second.at(1).c_str(),
+						aamp_GetCurrentTimeMS());
+			}
+			else if (it->second.size() == 1)
+			{
+				snprintf(buf, 512, "trace-id=%s;parent-id=%lld;span-id=%lld",
+						(const char*)it->second.at(0).c_str(),
+						aamp_GetCurrentTimeMS(),
+						aamp_GetCurrentTimeMS());
+			}
+			headerValue = buf;
+		}
+		if (it->first.compare("Wifi:") == 0)
+		{
+			if (true == activeInterfaceWifi)
+			{
+				headerValue = "1";
+			}
+			else
+			{
+				 headerValue = "0";
+			}
+		}
+		customHeader.append(headerValue);
+		httpHeaders = curl_slist_append(httpHeaders, customHeader.c_str());
+	}
+
+	if (gpGlobalConfig->logging.curlHeader && (eMEDIATYPE_VIDEO == simType || eMEDIATYPE_PLAYLIST_VIDEO == simType))
+	{
+		int size = gpGlobalConfig->customHeaderStr.size();
+		for (int i=0; i < size; i++)
+		{
+			if (!gpGlobalConfig->customHeaderStr.at(i).empty())
+			{
+				//logprintf ("Custom Header Data: Index( %d ) Data( %s )", i, gpGlobalConfig->customHeaderStr.at(i).c_str());
+				httpHeaders = curl_slist_append(httpHeaders, gpGlobalConfig->customHeaderStr.at(i).c_str());
+			}
+		}
+	}
+	return httpHeaders;
+}
+
+/**
+ * @brief Add download bandwidth sample used for ABR
+ * @param downloadbps measured bandwidth in bits per second
+ */
+void PrivateInstanceAAMP::AddAbrBitrateSample(long downloadbps)
+{
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
+	mAbrBitrateData.push_back(std::make_pair(aamp_GetCurrentTimeMS() ,downloadbps));
+	if(mAbrBitrateData.size() > gpGlobalConfig->abrCacheLength)
+		mAbrBitrateData.erase(mAbrBitrateData.begin());
+	AAMP_MUTEX_UNLOCK(mLock);
+}
+
+/**
+ * @brief Add download bandwidth sample of a completed or timed out video fragment download
+ * @param bytes downloaded bytes
+ * @param downloadTimeMS download time in milliseconds
+ * @param fragmentDurationMs fragment duration in milliseconds, 0 if not known
+ */
+void PrivateInstanceAAMP::AddFragmentBitrateSample(size_t bytes, int downloadTimeMS, int fragmentDurationMs)
+{
+	if(downloadTimeMS > 0 && bytes > gpGlobalConfig->aampAbrThresholdSize)
+	{
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
+		long downloadbps = ((long)(bytes / downloadTimeMS)*8000);
+		long currentProfilebps  = mpStreamAbstractionAAMP->GetVideoBitrate();
+		// extra coding to avoid picking lower profile
+
+		if(downloadbps < currentProfilebps && fragmentDurationMs && downloadTimeMS < fragmentDurationMs/2)
+		{
+			downloadbps = currentProfilebps;
+		}
+		AddAbrBitrateSample(downloadbps);
+		AAMP_MUTEX_UNLOCK(mLock);
+	}
+}
+
 /**
  * @brief Fetch a file from CDN
  * @param remoteUrl url of the file
@@ -3533,12 +3817,13 @@ const char* PrivateInstanceAAMP::MediaTypeString(MediaType fileType)
  * @param resetBuffer true to reset buffer before fetch
  * @param fileType media type of the file
  * @param fragmentDurationSeconds to know the current fragment length in case fragment fetch
+ * @param streamDecryptor decryptor applied to data as it is received, if not NULL
  * @retval true if success
  */
 bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *buffer, std::string& effectiveUrl, 
 				long * http_error, double *downloadTime, const char *range, unsigned int curlInstance, 
 				bool resetBuffer, MediaType fileType, long *bitrate, int * fogError,
-				double fragmentDurationSeconds)
+				double fragmentDurationSeconds, HlsDrmStreamDecryptor *streamDecryptor)
 {
 	MediaType simType = fileType; // remember the requested specific file type; fileType gets overridden later with simple VIDEO/AUDIO
 	MediaTypeTelemetry mediaType = aamp_GetMediaTypeForTelemetry(fileType);
@@ -3560,7 +3845,7 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 		maxDownloadAttempt += DEFAULT_DOWNLOAD_RETRY_COUNT;
 	}
 
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	if (resetBuffer)
 	{
 		if(buffer->avail)
@@ -3575,7 +3860,7 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 		bool isDownloadStalled = false;
 		CurlAbortReason abortReason = eCURL_ABORT_REASON_NONE;
 		double connectTime = 0;
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 
 		// append custom uri parameter with remoteUrl at the end before curl request if curlHeader logging enabled.
 		if (gpGlobalConfig->logging.curlHeader && gpGlobalConfig->uriParameter && simType == eMEDIATYPE_MANIFEST )
@@ -3598,6 +3883,7 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 			context.buffer = buffer;
 			context.responseHeaderData = &httpRespHeaders[curlInstance];
 			context.fileType = simType;
+			context.streamDecryptor = streamDecryptor;
 			curl_easy_setopt(curl, CURLOPT_WRITEDATA, &context);
 			curl_easy_setopt(curl, CURLOPT_HEADERDATA, &context);
 			if(gpGlobalConfig->disableSslVerifyPeer)
@@ -3627,6 +3913,19 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 				progressCtx.startTimeout = gpGlobalConfig->curlDownloadStartTimeout;
 			}
 			progressCtx.stallTimeout = gpGlobalConfig->curlStallTimeout;
+			progressCtx.bandwidthEstimator = NULL;
+			progressCtx.fragmentDurationMs = 0;
+			progressCtx.profileBitrate = 0;
+			if (gpGlobalConfig->abrThroughputEstimate && fileType == eMEDIATYPE_VIDEO && CheckABREnabled() && mpStreamAbstractionAAMP)
+			{
+				progressCtx.bandwidthEstimator = &mBandwidthEstimator;
+				if (gpGlobalConfig->abrAbortSlowFragment && fragmentDurationMs > 0 && !mpStreamAbstractionAAMP->trickplayMode &&
+					!mpStreamAbstractionAAMP->IsLowestProfile(mpStreamAbstractionAAMP->currentProfileIndex))
+				{
+					progressCtx.fragmentDurationMs = fragmentDurationMs;
+					progressCtx.profileBitrate = mpStreamAbstractionAAMP->GetVideoBitrate();
+				}
+			}
                   
 			// note: win32 curl lib doesn't support multi-part range
 			curl_easy_setopt(curl, CURLOPT_RANGE, range);
@@ -3639,68 +3938,7 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 			}
 			if (mCustomHeaders.size() > 0)
 			{
-				std::string customHeader;
-				std::string headerValue;
-				for (std::unordered_map<std::string, std::vector<std::string>>::iterator it = mCustomHeaders.begin();
-									it != mCustomHeaders.end(); it++)
-				{
-					customHeader.clear();
-					headerValue.clear();
-					customHeader.insert(0, it->first);
-					customHeader.push_back(' ');
-					headerValue = it->second.at(0);
-					if (it->first.compare("X-MoneyTrace:") == 0)
-					{
-						if (mIsLocalPlayback && !mIsFirstRequestToFOG)
-						{
-							continue;
-						}
-						char buf[512];
-						memset(buf, '\0', 512);
-						if (it->second.size() >= 2)
-						{
-							snprintf(buf, 512, "trace-id=%s;parent-id=%s;span-id=%lld",
-									(const char*)it->second.at(0).c_str(),
-									(const char*)it->second.at(1).c_str(),
-									aamp_GetCurrentTimeMS());
-						}
-						else if (it->second.size() == 1)
-						{
-							snprintf(buf, 512, "trace-id=%s;parent-id=%lld;span-id=%lld",
-									(const char*)it->second.at(0).c_str(),
-									aamp_GetCurrentTimeMS(),
-									aamp_GetCurrentTimeMS());
-						}
-						headerValue = buf;
-					}
-					if (it->first.compare("Wifi:") == 0)
-					{
-						if (true == activeInterfaceWifi)
-						{
-							headerValue = "1";
-						}
-						else
-						{
-							 headerValue = "0";
-						}
-					}
-					customHeader.append(headerValue);
-					httpHeaders = curl_slist_append(httpHeaders, customHeader.c_str());
-				}
-
-				if (gpGlobalConfig->logging.curlHeader && (eMEDIATYPE_VIDEO == simType || eMEDIATYPE_PLAYLIST_VIDEO == simType))
-				{
-					int size = gpGlobalConfig->customHeaderStr.size();
-					for (int i=0; i < size; i++)
-					{
-						if (!gpGlobalConfig->customHeaderStr.at(i).empty())
-						{
-							//logprintf ("Custom Header Data: Index( %d ) Data( %s )", i, gpGlobalConfig->customHeaderStr.at(i).c_str());
-							httpHeaders = curl_slist_append(httpHeaders, gpGlobalConfig->customHeaderStr.at(i).c_str());
-						}
-					}
-				}
-
+				httpHeaders = GetCustomHeaders(simType);
 				if (httpHeaders != NULL)
 				{
 					curl_easy_setopt(curl, CURLOPT_HTTPHEADER, httpHeaders);
@@ -3713,12 +3951,18 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 				progressCtx.downloadUpdatedTime = -1;
 				progressCtx.downloadSize = -1;
 				progressCtx.abortReason = eCURL_ABORT_REASON_NONE;
+				progressCtx.sampleTime = -1;
+				progressCtx.sampleSize = 0;
 				curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, &progressCtx);
 				if(buffer->ptr != NULL)
 				{
 					traceprintf("%s:%d reset length. buffer %p avail %d", __FUNCTION__, __LINE__, buffer, (int)buffer->avail);
 					buffer->len = 0;
 				}
+				if (streamDecryptor)
+				{
+					streamDecryptor->Reset();
+				}
 
 				isDownloadStalled = false;
 				abortReason = eCURL_ABORT_REASON_NONE;
@@ -3820,7 +4064,8 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 
 					//Attempt retry for local playback since rampdown is disabled for FOG
 					//Attempt retry for partial downloads, which have a higher chance to succeed
-					if((res == CURLE_COULDNT_CONNECT || (res == CURLE_OPERATION_TIMEDOUT && mIsLocalPlayback) || isDownloadStalled) && downloadAttempt < maxDownloadAttempt)
+					if((res == CURLE_COULDNT_CONNECT || (res == CURLE_OPERATION_TIMEDOUT && mIsLocalPlayback) || isDownloadStalled) && downloadAttempt < maxDownloadAttempt &&
+						abortReason != eCURL_ABORT_REASON_LOW_BANDWIDTH)
 					{
 						if(mpStreamAbstractionAAMP)
 						{
@@ -3866,6 +4111,10 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 					*curl errors are below 100 and http error starts from 100
 					*/
 					http_code = res;
+					if (abortReason == eCURL_ABORT_REASON_LOW_BANDWIDTH)
+					{ // report as timeout, so ABR picks a profile by available bandwidth for the retry
+						http_code = CURLE_OPERATION_TIMEDOUT;
+					}
 
 					#if 0
 					if (isDownloadStalled)
@@ -3891,6 +4140,22 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 				curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &connect);
 				connectTime = connect;
 				fileDownloadTime = total;
+				if (res == CURLE_OK && (simType == eMEDIATYPE_VIDEO || simType == eMEDIATYPE_AUDIO || simType == eMEDIATYPE_SUBTITLE))
+				{ // curl times are cumulative from request start, in seconds
+					double lookup = 0, handshake = 0, requestSent = 0, firstByte = 0;
+					curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME, &lookup);
+					curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME, &handshake);
+					curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME, &requestSent);
+					curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &firstByte);
+					if (handshake < connect)
+					{ // no TLS
+						handshake = connect;
+					}
+					mPlaybackProfiler.Record(simType, PLAYBACK_PHASE_DNS, (long long)(lookup * 1000000));
+					mPlaybackProfiler.Record(simType, PLAYBACK_PHASE_CONNECT, (long long)((handshake - lookup) * 1000000));
+					mPlaybackProfiler.Record(simType, PLAYBACK_PHASE_TTFB, (long long)((firstByte - requestSent) * 1000000));
+					mPlaybackProfiler.Record(simType, PLAYBACK_PHASE_TRANSFER, (long long)((total - firstByte) * 1000000));
+				}
 				if(res != CURLE_OK || http_code == 0 || http_code >= 400 || total > 2.0 /*seconds*/)
 				{
 					reqEndLogLevel = eLOGLEVEL_WARN;
@@ -3937,24 +4202,7 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 
 			if (downloadTimeMS > 0 && fileType == eMEDIATYPE_VIDEO && CheckABREnabled())
 			{
-				if(buffer->len > gpGlobalConfig->aampAbrThresholdSize)
-				{
-					pthread_mutex_lock(&mLock);
-					long downloadbps = ((long)(buffer->len / downloadTimeMS)*8000);
-					long currentProfilebps  = mpStreamAbstractionAAMP->GetVideoBitrate();
-					// extra coding to avoid picking lower profile
-
-					if(downloadbps < currentProfilebps && fragmentDurationMs && downloadTimeMS < fragmentDurationMs/2)
-					{
-						downloadbps = currentProfilebps;
-					}
-					
-					mAbrBitrateData.push_back(std::make_pair(aamp_GetCurrentTimeMS() ,downloadbps));
-					//logprintf("CacheSz[%d]ConfigSz[%d] Storing Size [%d] bps[%ld]",mAbrBitrateData.size(),gpGlobalConfig->abrCacheLength, buffer->len, ((long)(buffer->len / downloadTimeMS)*8000));
-					if(mAbrBitrateData.size() > gpGlobalConfig->abrCacheLength)
-						mAbrBitrateData.erase(mAbrBitrateData.begin());
-					pthread_mutex_unlock(&mLock);
-				}
+				AddFragmentBitrateSample(buffer->len, downloadTimeMS, fragmentDurationMs);
 			}
 		}
 		if (http_code == 200 || http_code == 206)
@@ -4084,13 +4332,13 @@ bool PrivateInstanceAAMP::GetFile(std::string remoteUrl,struct GrowableBuffer *b
 				http_code = PARTIAL_FILE_DOWNLOAD_TIME_EXPIRED_AAMP;
 			}
 		}
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	}
 	else
 	{
 		logprintf("downloads disabled");
 	}
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 	if (http_error)
 	{
 		*http_error = http_code;
@@ -4305,6 +4553,11 @@ bool PrivateInstanceAAMP::ProcessCustomGetCurlRequest(std::string& remoteUrl, Gr
 	progressCtx.downloadUpdatedTime = -1;
 	progressCtx.downloadSize = -1;
 	progressCtx.abortReason = eCURL_ABORT_REASON_NONE;
+	progressCtx.bandwidthEstimator = NULL;
+	progressCtx.sampleTime = -1;
+	progressCtx.sampleSize = 0;
+	progressCtx.fragmentDurationMs = 0;
+	progressCtx.profileBitrate = 0;
 	CURLcode res;
 	long httpCode = -1;
 
@@ -4519,7 +4772,7 @@ void PrivateInstanceAAMP::LazilyLoadConfigIfNeeded(void)
  */
 void PrivateInstanceAAMP::TeardownStream(bool newTune)
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	//Have to perfom this for trick and stop operations but avoid ad insertion related ones
 	AAMPLOG_WARN("%s:%d mProgressReportFromProcessDiscontinuity:%d mDiscontinuityTuneOperationId:%d newTune:%d", __FUNCTION__, __LINE__, mProgressReportFromProcessDiscontinuity, mDiscontinuityTuneOperationId, newTune);
 	if ((mDiscontinuityTuneOperationId != 0) && (!newTune || mState == eSTATE_IDLE))
@@ -4542,7 +4795,7 @@ void PrivateInstanceAAMP::TeardownStream(bool newTune)
 			//wait for discont tune operation to finish before proceeding with stop
 			if (mDiscontinuityTuneOperationInProgress)
 			{
-				pthread_cond_wait(&mCondDiscontinuity, &mLock);
+				AAMP_COND_WAIT(mCondDiscontinuity, mLock);
 			}
 			else
 			{
@@ -4561,7 +4814,7 @@ void PrivateInstanceAAMP::TeardownStream(bool newTune)
 	//reset discontinuity related flags
 	mProcessingDiscontinuity[eMEDIATYPE_VIDEO] = false;
 	mProcessingDiscontinuity[eMEDIATYPE_AUDIO] = false;
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 
 	if (mpStreamAbstractionAAMP)
 	{
@@ -4570,9 +4823,9 @@ void PrivateInstanceAAMP::TeardownStream(bool newTune)
 		mpStreamAbstractionAAMP = NULL;
 	}
 
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	mVideoFormat = FORMAT_INVALID;
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 	if (streamerIsActive)
 	{
 #ifdef AAMP_STOP_SINK_ON_SEEK
@@ -5184,6 +5437,8 @@ void PrivateInstanceAAMP::Tune(const char *mainManifestUrl, bool autoPlay, const
 		mTuneAttempts++;
 	}
 	profiler.TuneBegin();
+	mPlaybackProfiler.Reset();
+	mPlaybackProfileReportTime = NOW_STEADY_TS_MS;
 	ResetBufUnderFlowStatus();
 
 	if( !remapUrl )
@@ -5862,7 +6117,10 @@ void PrivateInstanceAAMP::PushFragment(MediaType mediaType, char *ptr, size_t le
 {
 	BlockUntilGstreamerWantsData(NULL, 0, 0);
 	SyncBegin();
-	mStreamSink->Send(mediaType, ptr, len, fragmentTime, fragmentTime, fragmentDuration);
+	{
+		AampPlaybackPhaseTimer sinkPushTimer(mPlaybackProfiler, mediaType, PLAYBACK_PHASE_SINK_PUSH);
+		mStreamSink->Send(mediaType, ptr, len, fragmentTime, fragmentTime, fragmentDuration);
+	}
 	SyncEnd();
 }
 
@@ -5878,7 +6136,10 @@ void PrivateInstanceAAMP::PushFragment(MediaType mediaType, GrowableBuffer* buff
 {
 	BlockUntilGstreamerWantsData(NULL, 0, 0);
 	SyncBegin();
-	mStreamSink->Send(mediaType, buffer, fragmentTime, fragmentTime, fragmentDuration);
+	{
+		AampPlaybackPhaseTimer sinkPushTimer(mPlaybackProfiler, mediaType, PLAYBACK_PHASE_SINK_PUSH);
+		mStreamSink->Send(mediaType, buffer, fragmentTime, fragmentTime, fragmentDuration);
+	}
 	SyncEnd();
 }
 
@@ -6168,10 +6429,10 @@ void PrivateInstanceAAMP::SetAudioVolume(int volume)
  */
 void PrivateInstanceAAMP::DisableDownloads(void)
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	mDownloadsEnabled = false;
 	pthread_cond_broadcast(&mDownloadsDisabled);
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 }
 
 /**
@@ -6188,9 +6449,9 @@ bool PrivateInstanceAAMP::DownloadsAreEnabled(void)
  */
 void PrivateInstanceAAMP::EnableDownloads()
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	mDownloadsEnabled = true;
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 }
 
 /**
@@ -6204,10 +6465,10 @@ void PrivateInstanceAAMP::InterruptableMsSleep(int timeInMs)
 		struct timespec ts;
 		int ret;
 		ts = aamp_GetTimespec(timeInMs);
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		if (mDownloadsEnabled)
 		{
-			ret = pthread_cond_timedwait(&mDownloadsDisabled, &mLock, &ts);
+			ret = AAMP_COND_TIMEDWAIT(mDownloadsDisabled, mLock, ts);
 			if (0 == ret)
 			{
 				//logprintf("sleep interrupted!");
@@ -6219,7 +6480,7 @@ void PrivateInstanceAAMP::InterruptableMsSleep(int timeInMs)
 			}
 #endif
 		}
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 }
 
@@ -6325,6 +6586,7 @@ long long PrivateInstanceAAMP::GetPositionMilliseconds()
 void PrivateInstanceAAMP::SendStream(MediaType mediaType, const void *ptr, size_t len, double fpts, double fdts, double fDuration)
 {
 	profiler.ProfilePerformed(PROFILE_BUCKET_FIRST_BUFFER);
+	AampPlaybackPhaseTimer sinkPushTimer(mPlaybackProfiler, mediaType, PLAYBACK_PHASE_SINK_PUSH);
 	mStreamSink->Send(mediaType, ptr, len, fpts, fdts, fDuration);
 }
 
@@ -6340,9 +6602,28 @@ void PrivateInstanceAAMP::SendStream(MediaType mediaType, const void *ptr, size_
 void PrivateInstanceAAMP::SendStream(MediaType mediaType, GrowableBuffer* buffer, double fpts, double fdts, double fDuration)
 {
 	profiler.ProfilePerformed(PROFILE_BUCKET_FIRST_BUFFER);
+	AampPlaybackPhaseTimer sinkPushTimer(mPlaybackProfiler, mediaType, PLAYBACK_PHASE_SINK_PUSH);
 	mStreamSink->Send(mediaType, buffer, fpts, fdts, fDuration);
 }
 
+/**
+ * @brief Send part of a shared media block to sink without copying
+ * @note  Sink takes its own references, caller keeps its reference.
+ * @param mediaType type of media
+ * @param block reference counted block holding the data
+ * @param ptr start of data within block
+ * @param len length of data
+ * @param fpts pts in seconds
+ * @param fdts dts in seconds
+ * @param fDuration duration of buffer
+ */
+void PrivateInstanceAAMP::SendStream(MediaType mediaType, AampSharedBlock* block, const void *ptr, size_t len, double fpts, double fdts, double fDuration)
+{
+	profiler.ProfilePerformed(PROFILE_BUCKET_FIRST_BUFFER);
+	AampPlaybackPhaseTimer sinkPushTimer(mPlaybackProfiler, mediaType, PLAYBACK_PHASE_SINK_PUSH);
+	mStreamSink->Send(mediaType, block, ptr, len, fpts, fdts, fDuration);
+}
+
 /**
  * @brief Set stream sink
  * @param streamSink pointer of sink object
@@ -6397,7 +6678,7 @@ void PrivateInstanceAAMP::Stop()
 	}
 
 	TeardownStream(true);
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	if (mPendingAsyncEvents.size() > 0)
 	{
 		logprintf("PrivateInstanceAAMP::%s() - mPendingAsyncEvents.size - %d", __FUNCTION__, mPendingAsyncEvents.size());
@@ -6418,12 +6699,15 @@ void PrivateInstanceAAMP::Stop()
 		}
 		mPendingAsyncEvents.clear();
 	}
-	if (timedMetadata.size() > 0)
-	{
-		timedMetadata.clear();
-	}
+	// queued events went with the removed idle callback
+	AAMP_MUTEX_LOCK(mEventQueueLock, "PrivateInstanceAAMP::mEventQueueLock");
+	mScheduledEvents.clear();
+	mEventDispatchScheduled = false;
+	AAMP_MUTEX_UNLOCK(mEventQueueLock);
+	timedMetadata.Clear();
+	reportMetadata.Clear();
 
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 	seek_pos_seconds = -1;
 	culledSeconds = 0;
 	durationSeconds = 0;
@@ -6437,14 +6721,13 @@ void PrivateInstanceAAMP::Stop()
 	mPreferredAudioTrack = AudioTrackInfo();
 	mPreferredTextTrack = TextTrackInfo();
 	// send signal to any thread waiting for play
-	pthread_mutex_lock(&mMutexPlaystart);
+	AAMP_MUTEX_LOCK(mMutexPlaystart, "PrivateInstanceAAMP::mMutexPlaystart");
 	pthread_cond_broadcast(&waitforplaystart);
-	pthread_mutex_unlock(&mMutexPlaystart);
-	if(mPreCachePlaylistThreadFlag)
+	AAMP_MUTEX_UNLOCK(mMutexPlaystart);
+	if(mPreCachePlaylistTask)
 	{
-		pthread_join(mPreCachePlaylistThreadId,NULL);
-		mPreCachePlaylistThreadFlag=false;
-		mPreCachePlaylistThreadId = 0;
+		mWorkerPool->Join(mPreCachePlaylistTask);
+		mPreCachePlaylistTask = NULL;
 	}
 	getAampCacheHandler()->StopPlaylistCache();
 
@@ -6491,33 +6774,38 @@ void PrivateInstanceAAMP::Stop()
 void PrivateInstanceAAMP::SaveTimedMetadata(long long timeMilliseconds, const char* szName, const char* szContent, int nb, const char* id, double durationMS)
 {
 	std::string content(szContent, nb);
-	reportMetadata.push_back(TimedMetadata(timeMilliseconds, std::string((szName == NULL) ? "" : szName), content, std::string((id == NULL) ? "" : id), durationMS));
+	// tags repeated by playlist refresh are stored once
+	reportMetadata.Add(timeMilliseconds, std::string((szName == NULL) ? "" : szName), content, std::string((id == NULL) ? "" : id), durationMS);
 }
 
 /**
  * @brief ReportBulkTimedMetadata Function to send bulk timedMetadata in json format 
- *
+ * Only metadata saved since the previous bulk report is sent
  */
 void PrivateInstanceAAMP::ReportBulkTimedMetadata()
 {
-	std::vector<TimedMetadata>::iterator iter;
-	if(gpGlobalConfig->enableSubscribedTags && reportMetadata.size())
+	std::vector<TimedMetadata> entries;
+	if(gpGlobalConfig->enableSubscribedTags)
 	{
-		AAMPLOG_INFO("%s:%d Sending bulk Timed Metadata",__FUNCTION__,__LINE__);
+		reportMetadata.TakeUnreported(entries);
+	}
+	if(!entries.empty())
+	{
+		AAMPLOG_INFO("%s:%d Sending bulk Timed Metadata, %d entries",__FUNCTION__,__LINE__, (int)entries.size());
 
 		cJSON *root;
 		cJSON *item;
 		root = cJSON_CreateArray();
 		if(root)
 		{
-			for (iter = reportMetadata.begin(); iter != reportMetadata.end(); iter++)
+			for (const TimedMetadata &iter : entries)
 			{
 				cJSON_AddItemToArray(root, item = cJSON_CreateObject());
-				cJSON_AddStringToObject(item, "name", iter->_name.c_str());
-				cJSON_AddStringToObject(item, "id", iter->_id.c_str());
-				cJSON_AddNumberToObject(item, "timeMs", iter->_timeMS);
-				cJSON_AddNumberToObject (item, "durationMs",iter->_durationMS);
-				cJSON_AddStringToObject(item, "data", iter->_content.c_str());
+				cJSON_AddStringToObject(item, "name", iter._name.c_str());
+				cJSON_AddStringToObject(item, "id", iter._id.c_str());
+				cJSON_AddNumberToObject(item, "timeMs", iter._timeMS);
+				cJSON_AddNumberToObject (item, "durationMs",iter._durationMS);
+				cJSON_AddStringToObject(item, "data", iter._content.c_str());
 			}
 
 			char* bulkData = cJSON_PrintUnformatted(root);
@@ -6553,48 +6841,9 @@ void PrivateInstanceAAMP::ReportBulkTimedMetadata()
 void PrivateInstanceAAMP::ReportTimedMetadata(long long timeMilliseconds, const char *szName, const char *szContent,int nb, bool bSyncCall,const char *id, double durationMS)
 {
 	std::string content(szContent, nb);
-	bool bFireEvent = false;
 
-	// Check if timedMetadata was already reported
-	std::vector<TimedMetadata>::iterator i;
-	bool ignoreMetaAdd = false;
-	for (i = timedMetadata.begin(); i != timedMetadata.end(); i++)
-	{
-
-		// Add a boundary check of 1 sec for rounding correction
-		if ((timeMilliseconds >= i->_timeMS-1000 && timeMilliseconds <= i->_timeMS+1000 ) &&
-			(i->_name.compare(szName) == 0)	&&
-			(i->_content.compare(content) == 0))
-		{
-			// Already same exists , ignore
-			ignoreMetaAdd = true;
-			break;
-		}
-
-		if (i->_timeMS < timeMilliseconds)
-		{
-			// move to next entry
-			continue;
-		}
-		else
-		{
-			// New entry in between saved entries.
-			// i->_timeMS >= timeMilliseconds && no similar entry in table
-			timedMetadata.insert(i, TimedMetadata(timeMilliseconds, szName, content, id, durationMS));
-			bFireEvent = true;
-			ignoreMetaAdd = true;
-			break;
-		}
-	}
-
-	if(!ignoreMetaAdd && i == timedMetadata.end())
-	{
-		// Comes here for
-		// 1.No entry in the table
-		// 2.Entries available which is only having time < NewMetatime
-		timedMetadata.push_back(TimedMetadata(timeMilliseconds, szName, content, id, durationMS));
-		bFireEvent = true;
-	}
+	// Add unless timedMetadata was already reported
+	bool bFireEvent = timedMetadata.Add(timeMilliseconds, ((szName == NULL) ? "" : szName), content, ((id == NULL) ? "" : id), durationMS);
 
 	if (bFireEvent)
 	{
@@ -6653,9 +6902,9 @@ void PrivateInstanceAAMP::NotifyFirstFrameReceived()
 	{
 		SetState(eSTATE_PLAYING);
 	}
-	pthread_mutex_lock(&mMutexPlaystart);
+	AAMP_MUTEX_LOCK(mMutexPlaystart, "PrivateInstanceAAMP::mMutexPlaystart");
 	pthread_cond_broadcast(&waitforplaystart);
-	pthread_mutex_unlock(&mMutexPlaystart);
+	AAMP_MUTEX_UNLOCK(mMutexPlaystart);
 
 	TunedEventConfig tunedEventConfig = IsLive() ? mTuneEventConfigLive : mTuneEventConfigVod;
 	if (eTUNED_EVENT_ON_GST_PLAYING == tunedEventConfig)
@@ -6740,16 +6989,16 @@ void PrivateInstanceAAMP::ScheduleRetune(PlaybackErrorType errorType, MediaType
 		/*If underflow is caused by a discontinuity processing, continue playback from discontinuity*/
 		if (IsDiscontinuityProcessPending())
 		{
-			pthread_mutex_lock(&mLock);
+			AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 			if (mDiscontinuityTuneOperationId != 0 || mDiscontinuityTuneOperationInProgress)
 			{
-				pthread_mutex_unlock(&mLock);
+				AAMP_MUTEX_UNLOCK(mLock);
 				logprintf("PrivateInstanceAAMP::%s:%d: Discontinuity Tune handler already spawned(%d) or inprogress(%d)",
 					__FUNCTION__, __LINE__, mDiscontinuityTuneOperationId, mDiscontinuityTuneOperationInProgress);
 				return;
 			}
 			mDiscontinuityTuneOperationId = g_idle_add(PrivateInstanceAAMP_ProcessDiscontinuity, (gpointer) this);
-			pthread_mutex_unlock(&mLock);
+			AAMP_MUTEX_UNLOCK(mLock);
 
 			logprintf("PrivateInstanceAAMP::%s:%d: Underflow due to discontinuity handled", __FUNCTION__, __LINE__);
 			return;
@@ -6871,7 +7120,7 @@ void PrivateInstanceAAMP::SetState(PrivAAMPState state)
 	}
 
 	if ( (state == eSTATE_PLAYING || state == eSTATE_BUFFERING || state == eSTATE_PAUSED)
-		 && mState == eSTATE_SEEKING && (mEventListener || mEventListeners[0] || mEventListeners[AAMP_EVENT_SEEKED]))
+		 && mState == eSTATE_SEEKING && HasEventListeners(AAMP_EVENT_SEEKED))
 	{
 		SeekedEventPtr event = std::make_shared<SeekedEvent>(GetPositionMilliseconds());
 		if (sentSync)
@@ -6884,11 +7133,11 @@ void PrivateInstanceAAMP::SetState(PrivAAMPState state)
 		}
 	}
 
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	mState = state;
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 
-	if (mEventListener || mEventListeners[0] || mEventListeners[AAMP_EVENT_STATE_CHANGED])
+	if (HasEventListeners(AAMP_EVENT_STATE_CHANGED))
 	{
 		if (mState == eSTATE_PREPARING)
 		{
@@ -6921,9 +7170,9 @@ void PrivateInstanceAAMP::SetState(PrivAAMPState state)
  */
 void PrivateInstanceAAMP::GetState(PrivAAMPState& state)
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	state = mState;
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 }
 
 /**
@@ -6991,12 +7240,12 @@ bool PrivateInstanceAAMP::SendTunedEvent(bool isSynchronous)
 	bool ret = false;
 
 	// Required for synchronising btw audio and video tracks in case of cdmidecryptor
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 
 	ret = mTunedEventPending;
 	mTunedEventPending = false;
 
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 
 	if(ret)
 	{
@@ -7024,7 +7273,7 @@ bool PrivateInstanceAAMP::SendVideoEndEvent()
 #ifdef SESSION_STATS
 	char * strVideoEndJson = NULL;
 	// Required for protecting mVideoEnd object
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	if(mVideoEnd)
 	{
 		//Update VideoEnd Data
@@ -7068,7 +7317,7 @@ bool PrivateInstanceAAMP::SendVideoEndEvent()
 	AampOutputProtection::GetAampOutputProcectionInstance()->GetDisplayResolution(iDisplayWidth,iDisplayHeight);
 	mVideoEnd->SetDisplayResolution(iDisplayWidth,iDisplayHeight);
 #endif 
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 
 	if(strVideoEndJson)
 	{
@@ -7095,7 +7344,7 @@ void PrivateInstanceAAMP::UpdateVideoEndProfileResolution(MediaType mediaType, l
 #ifdef SESSION_STATS
 	if(gpGlobalConfig->mEnableVideoEndEvent) // avoid mutex mLock lock if disabled.
 	{
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		if(mVideoEnd)
 		{
 			VideoStatTrackType trackType = VideoStatTrackType::STAT_VIDEO;
@@ -7105,7 +7354,7 @@ void PrivateInstanceAAMP::UpdateVideoEndProfileResolution(MediaType mediaType, l
 			}
 			mVideoEnd->SetProfileResolution(trackType,bitrate,width,height);
 		}
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 #endif
 }
@@ -7135,13 +7384,13 @@ void PrivateInstanceAAMP::UpdateVideoEndTsbStatus(bool btsbAvailable)
 #ifdef SESSION_STATS
 	if(gpGlobalConfig->mEnableVideoEndEvent) // avoid mutex mLock lock if disabled.
 	{
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		if(mVideoEnd)
 		{
 
 			mVideoEnd->SetTsbStatus(btsbAvailable);
 		}
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 #endif
 }   
@@ -7282,7 +7531,7 @@ void PrivateInstanceAAMP::UpdateVideoEndMetrics(MediaType mediaType, long bitrat
 			if( dataType != VideoStatDataType::VE_DATA_UNKNOWN
 					&& trackType != VideoStatTrackType::STAT_UNKNOWN)
 			{
-				pthread_mutex_lock(&mLock);
+				AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 				if(mVideoEnd)
 				{
 					mVideoEnd->Increment_Data(dataType,trackType,bitrate,curlDownloadTime,curlOrHTTPCode,false,audioIndex);
@@ -7296,7 +7545,7 @@ void PrivateInstanceAAMP::UpdateVideoEndMetrics(MediaType mediaType, long bitrat
 						mVideoEnd->Record_License_EncryptionStat(trackType,isEncrypted,keyChanged);
 					}
 				}
-				pthread_mutex_unlock(&mLock);
+				AAMP_MUTEX_UNLOCK(mLock);
 
 			}
 			else
@@ -7327,22 +7576,22 @@ void PrivateInstanceAAMP::UpdateVideoEndMetrics(AAMPAbrInfo & info)
 
 			if(info.abrCalledFor == AAMPAbrType::AAMPAbrBandwidthUpdate)
 			{
-				pthread_mutex_lock(&mLock);
+				AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 				if(mVideoEnd)
 				{
 					mVideoEnd->Increment_NetworkDropCount();
 				}
-				pthread_mutex_unlock(&mLock);
+				AAMP_MUTEX_UNLOCK(mLock);
 			}
 			else if (info.abrCalledFor == AAMPAbrType::AAMPAbrFragmentDownloadFailed
 					|| info.abrCalledFor == AAMPAbrType::AAMPAbrFragmentDownloadFailed)
 			{
-				pthread_mutex_lock(&mLock);
+				AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 				if(mVideoEnd)
 				{
 					mVideoEnd->Increment_ErrorDropCount();
 				}
-				pthread_mutex_unlock(&mLock);
+				AAMP_MUTEX_UNLOCK(mLock);
 			}
 		}
 	}
@@ -7390,7 +7639,7 @@ void PrivateInstanceAAMP::GetPlayerVideoSize(int &width, int &height)
  */
 void PrivateInstanceAAMP::SetCallbackAsDispatched(guint id)
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	std::map<guint, bool>::iterator  itr = mPendingAsyncEvents.find(id);
 	if(itr != mPendingAsyncEvents.end())
 	{
@@ -7402,7 +7651,7 @@ void PrivateInstanceAAMP::SetCallbackAsDispatched(guint id)
 		logprintf("%s:%d id not in mPendingAsyncEvents, insert and mark as not pending", __FUNCTION__, __LINE__, id);
 		mPendingAsyncEvents[id] = false;
 	}
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 }
 
 /**
@@ -7411,7 +7660,7 @@ void PrivateInstanceAAMP::SetCallbackAsDispatched(guint id)
  */
 void PrivateInstanceAAMP::SetCallbackAsPending(guint id)
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	std::map<guint, bool>::iterator  itr = mPendingAsyncEvents.find(id);
 	if(itr != mPendingAsyncEvents.end())
 	{
@@ -7423,7 +7672,7 @@ void PrivateInstanceAAMP::SetCallbackAsPending(guint id)
 	{
 		mPendingAsyncEvents[id] = true;
 	}
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 }
 
 /**
@@ -8543,13 +8792,13 @@ const char* PrivateInstanceAAMP::GetTunedManifestUrl()
  */
 void PrivateInstanceAAMP::SetNetworkProxy(const char * proxy)
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	if(mNetworkProxy)
 	{
 		free(mNetworkProxy);
 	}
 	mNetworkProxy = strdup(proxy);
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 }
 
 /**
@@ -8569,13 +8818,13 @@ const char* PrivateInstanceAAMP::GetNetworkProxy() const
  */
 void PrivateInstanceAAMP::SetLicenseReqProxy(const char * licenseProxy)
 {
-	pthread_mutex_lock(&mLock);
+	AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 	if(mLicenseProxy)
 	{
 		free(mLicenseProxy);
 	}
 	mLicenseProxy = strdup(licenseProxy);
-	pthread_mutex_unlock(&mLock);
+	AAMP_MUTEX_UNLOCK(mLock);
 }
 
 /**
@@ -8650,9 +8899,9 @@ void PrivateInstanceAAMP::StopTrackInjection(MediaType type)
 	if (!mTrackInjectionBlocked[type])
 	{
 		AAMPLOG_TRACE("PrivateInstanceAAMP::%s for type %s", __FUNCTION__, (type == eMEDIATYPE_AUDIO) ? "audio" : "video");
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		mTrackInjectionBlocked[type] = true;
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 	traceprintf ("PrivateInstanceAAMP::%s Exit. type = %d", __FUNCTION__, (int) type);
 }
@@ -8675,9 +8924,9 @@ void PrivateInstanceAAMP::ResumeTrackInjection(MediaType type)
 	if (mTrackInjectionBlocked[type])
 	{
 		AAMPLOG_TRACE("PrivateInstanceAAMP::%s for type %s", __FUNCTION__, (type == eMEDIATYPE_AUDIO) ? "audio" : "video");
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		mTrackInjectionBlocked[type] = false;
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 	traceprintf ("PrivateInstanceAAMP::%s Exit. type = %d", __FUNCTION__, (int) type);
 }
@@ -8714,7 +8963,7 @@ void PrivateInstanceAAMP::NotifyVideoBasePTS(unsigned long long basepts)
 void PrivateInstanceAAMP::SendVTTCueDataAsEvent(VTTCue* cue)
 {
 	//This function is called from an idle handler and hence we call SendEventSync
-	if (mEventListener || mEventListeners[0] || mEventListeners[AAMP_EVENT_WEBVTT_CUE_DATA])
+	if (HasEventListeners(AAMP_EVENT_WEBVTT_CUE_DATA))
 	{
 		WebVttCueEventPtr ev = std::make_shared<WebVttCueEvent>(cue);
 		SendEventSync(ev);
@@ -8730,7 +8979,7 @@ bool PrivateInstanceAAMP::IsSubtitleEnabled(void)
 {
 	// Assumption being that enableSubtec and event listener will not be registered at the same time
 	// in which case subtec gets priority over event listener
-	return (gpGlobalConfig->bEnableSubtec || mEventListeners[AAMP_EVENT_WEBVTT_CUE_DATA] != NULL);
+	return (gpGlobalConfig->bEnableSubtec || GetEventListenerStatus(AAMP_EVENT_WEBVTT_CUE_DATA));
 	//(!IsDashAsset() && (mEventListener || mEventListeners[AAMP_EVENT_WEBVTT_CUE_DATA]));
 }
 
@@ -8741,7 +8990,7 @@ bool PrivateInstanceAAMP::IsSubtitleEnabled(void)
  */
 bool PrivateInstanceAAMP::WebVTTCueListenersRegistered(void)
 {
-	return (mEventListeners[AAMP_EVENT_WEBVTT_CUE_DATA] != NULL);
+	return GetEventListenerStatus(AAMP_EVENT_WEBVTT_CUE_DATA);
 }
 
 /**
@@ -8786,11 +9035,7 @@ void PrivateInstanceAAMP::SendId3MetadataEvent(std::vector<uint8_t> &data)
  */
 bool PrivateInstanceAAMP::GetEventListenerStatus(AAMPEventType eventType)
 {
-	if (mEventListeners[eventType] != NULL)
-	{
-		return true;
-	}
-	return false;
+	return (std::atomic_load(&mEventListeners[eventType]) != nullptr);
 }
 
 /**
@@ -8857,15 +9102,21 @@ void PrivateInstanceAAMP::PreCachePlaylistDownloadTask()
 	if(szPlaylistCount)
 	{
 		PrivAAMPState state;
-		// First wait for Tune to complete to start this functionality
-		pthread_mutex_lock(&mMutexPlaystart);
-		pthread_cond_wait(&waitforplaystart, &mMutexPlaystart);
-		pthread_mutex_unlock(&mMutexPlaystart);
+		// First wait for Tune to complete to start this functionality.
+		// Task may start late behind tune tasks of the worker pool, or run from Stop's join, so
+		// do not wait if playback already started or Stop already signaled
+		AAMP_MUTEX_LOCK(mMutexPlaystart, "PrivateInstanceAAMP::mMutexPlaystart");
+		GetState(state);
+		if(state != eSTATE_PLAYING && state != eSTATE_RELEASED && state != eSTATE_IDLE)
+		{
+			AAMP_COND_WAIT(waitforplaystart, mMutexPlaystart);
+		}
+		AAMP_MUTEX_UNLOCK(mMutexPlaystart);
 		// May be Stop is called to release all resources .
 		// Before download , check the state 
 		GetState(state);
 		// Check for state not IDLE also to avoid DELIA-46092
-		if(state != eSTATE_RELEASED || state != eSTATE_IDLE)
+		if(state != eSTATE_RELEASED && state != eSTATE_IDLE)
 		{
 			CurlInit(eCURLINSTANCE_PLAYLISTPRECACHE, 1, GetNetworkProxy());
 			SetCurlTimeout(mPlaylistTimeoutMs, eCURLINSTANCE_PLAYLISTPRECACHE);
@@ -8932,6 +9183,17 @@ void PrivateInstanceAAMP::SetPreCacheDownloadList(PreCacheUrlList &dnldListInput
 	
 }
 
+/**
+ *   @brief Get latency histograms of fragment processing phases since tune.
+ *
+ *   @return std::string JSON formatted histograms per track and phase
+ */
+std::string PrivateInstanceAAMP::GetPlaybackProfile()
+{
+	// lock free, recorders are not held up by the query
+	return mPlaybackProfiler.ToJsonString();
+}
+
 /**
  *   @brief Get available audio tracks.
  *
@@ -9245,10 +9507,10 @@ bool PrivateInstanceAAMP::TrackDownloadsAreEnabled(MediaType type)
 	}
 	else
 	{
-		pthread_mutex_lock(&mLock);
+		AAMP_MUTEX_LOCK(mLock, "PrivateInstanceAAMP::mLock");
 		// If blocked, track downloads are disabled
 		ret = !mbTrackDownloadsBlocked[type];
-		pthread_mutex_unlock(&mLock);
+		AAMP_MUTEX_UNLOCK(mLock);
 	}
 	return ret;
 }
@@ -27,6 +27,9 @@
 
 #include "AampMemoryUtils.h"
 #include "AampProfiler.h"
+#include "AampTimedMetadataStore.h"
+#include "AampBandwidthEstimator.h"
+#include "AampPlaybackProfiler.h"
 #include "AampDrmHelper.h"
 #include "AampDrmMediaFormat.h"
 #include "AampDrmCallbacks.h"
@@ -48,6 +51,7 @@
 #include <list>
 #include <sstream>
 #include <mutex>
+#include <atomic>
 #include <queue>
 #include <algorithm>
 #include <glib.h>
@@ -219,7 +223,8 @@ enum CurlAbortReason
 {
 	eCURL_ABORT_REASON_NONE = 0,
 	eCURL_ABORT_REASON_STALL_TIMEDOUT,
-	eCURL_ABORT_REASON_START_TIMEDOUT
+	eCURL_ABORT_REASON_START_TIMEDOUT,
+	eCURL_ABORT_REASON_LOW_BANDWIDTH
 };
 
 /**
@@ -252,63 +257,6 @@ enum AudioType
 	eAUDIO_ATMOS
 };
 
-/**
- * @struct AsyncEventDescriptor
- * @brief Used in asynchronous event notification logic
- */
-struct AsyncEventDescriptor
-{
-	/**
-	 * @brief AsyncEventDescriptor constructor
-	 */
-	AsyncEventDescriptor() : event(nullptr), aamp(NULL)
-	{
-	}
-
-	/**
-	 * @brief AsyncEventDescriptor destructor
-	 */
-	virtual ~AsyncEventDescriptor()
-	{
-	}
-
-	AsyncEventDescriptor(const AsyncEventDescriptor &other) = delete;
-	AsyncEventDescriptor& operator=(const AsyncEventDescriptor& other) = delete;
-
-	AAMPEventPtr event;
-	PrivateInstanceAAMP* aamp;
-};
-
-/**
- * @brief Class for Timed Metadata
- */
-class TimedMetadata
-{
-public:
-
-	/**
-	 * @brief TimedMetadata Constructor
-	 */
-	TimedMetadata() : _timeMS(0), _name(""), _content(""), _id(""), _durationMS(0) {}
-
-	/**
-	 * @brief TimedMetadata Constructor
-	 *
-	 * @param[in] timeMS - Time in milliseconds
-	 * @param[in] name - Metadata name
-	 * @param[in] content - Metadata content
-	 */
-	TimedMetadata(long long timeMS, std::string name, std::string content, std::string id, double durMS) : _timeMS(timeMS), _name(name), _content(content), _id(id), _durationMS(durMS) {}
-
-public:
-	long long _timeMS;     /**< Time in milliseconds */
-	std::string _name;       /**< Metadata name */
-	std::string _content;    /**< Metadata content */
-	std::string _id;         /**< Id of the timedMetadata. If not available an Id will bre created */
-	double      _durationMS; /**< Duration in milliseconds */
-};
-
-
 /**
  * @brief Function pointer for the idle task
  * @param[in] arg - Arguments
@@ -337,12 +285,10 @@ struct httpRespHeaderData {
 
 
 /**
- * @brief  Structure of the event listener list
+ * @brief Listeners of an event type. Published lists are never modified, registration
+ * replaces the list, so dispatch can walk a list without holding a lock
  */
-struct ListenerData {
-	EventListener* eventListener;   /**< Event listener */
-	ListenerData* pNext;                /**< Next listener */
-};
+typedef std::shared_ptr<const std::vector<EventListener*>> EventListenerList;
 
 
 #ifdef AAMP_HLS_DRM
@@ -372,9 +318,13 @@ public:
  */
 
 class AampCacheHandler;
+class AampWorkerPool;
+struct AampWorkerTask;
 
 class AampDRMSessionManager;
 
+class HlsDrmStreamDecryptor;
+
 /**
  * @brief Class representing the AAMP player's private instance, which is not exposed to outside world.
  */
@@ -522,6 +472,7 @@ public:
 	void SetTuneEventConfig( TunedEventConfig tuneEventType);
 
 	std::vector< std::pair<long long,long> > mAbrBitrateData;
+	AampBandwidthEstimator mBandwidthEstimator; /**< Throughput sampled during video fragment downloads */
 
 	pthread_mutex_t mLock;// = PTHREAD_MUTEX_INITIALIZER;
 	pthread_mutexattr_t mMutexAttr;
@@ -539,6 +490,7 @@ public:
 	StreamSink* mStreamSink;
 
 	ProfileEventAAMP profiler;
+	AampPlaybackProfiler mPlaybackProfiler; /**< Latency histograms of fragment processing after tune */
 	bool licenceFromManifest;
 	AudioType previousAudioType; /* Used to maintain previous audio type */
 
@@ -594,8 +546,8 @@ public:
 	bool subtitles_muted;
 	int audio_volume;
 	std::vector<std::string> subscribedTags;
-	std::vector<TimedMetadata> timedMetadata;
-	std::vector<TimedMetadata> reportMetadata;
+	AampTimedMetadataStore timedMetadata;     /**< Metadata reported with TimedMetadata events */
+	AampTimedMetadataStore reportMetadata;    /**< Metadata saved for bulk reporting */
 	bool mIsIframeTrackPresent;				/**< flag to check iframe track availability*/
 
 	/* START: Added As Part of DELIA-28363 and DELIA-28247 */
@@ -610,9 +562,10 @@ public:
 	double culledSeconds;
 	float maxRefreshPlaylistIntervalSecs;
 	long long initialTuneTimeMs;
-	EventListener* mEventListener;
+	std::atomic<EventListener*> mEventListener; /**< Listener of RegisterEvents, may be replaced while events are sent */
 	double mReportProgressPosn;
 	long long mReportProgressTime;
+	long long mPlaybackProfileReportTime; /**< Time of last playback profile event */
 	long long mAdPrevProgressTime;
 	uint32_t mAdCurOffset;		//Start position in percentage
 	uint32_t mAdDuration;
@@ -636,8 +589,7 @@ public:
 	pthread_mutex_t drmParserMutex; /**< Mutex to lock DRM parsing logic */
 	bool fragmentCdmEncrypted; /**< Indicates CDM protection added in fragments **/
 #endif
-	pthread_t mPreCachePlaylistThreadId;
-	bool mPreCachePlaylistThreadFlag;
+	AampWorkerTask *mPreCachePlaylistTask; /**< Playlist pre-cache task on worker pool, NULL if not started */
 	bool mABRBufferCheckEnabled;
 	bool mNewAdBreakerEnabled;
 	bool mbPlayEnabled;	//Send buffer to pipeline or just cache them.
@@ -737,9 +689,36 @@ public:
 	 * @param[in] curlInstance - Curl instance to be used
 	 * @param[in] resetBuffer - Flag to reset the out buffer
 	 * @param[in] fileType - File type
+	 * @param[in] streamDecryptor - Decryptor applied to data as it is received, if not NULL
+	 * @return void
+	 */
+	bool GetFile(std::string remoteUrl, struct GrowableBuffer *buffer, std::string& effectiveUrl, long *http_error = NULL, double *downloadTime = NULL, const char *range = NULL,unsigned int curlInstance = 0, bool resetBuffer = true,MediaType fileType = eMEDIATYPE_DEFAULT, long *bitrate = NULL,  int * fogError = NULL, double fragmentDurationSec = 0, HlsDrmStreamDecryptor *streamDecryptor = NULL);
+
+	/**
+	 * @brief Build list of custom http headers configured for requests
+	 *
+	 * @param[in] simType - Media type of the file requested
+	 * @return header list to be freed with curl_slist_free_all, NULL if none
+	 */
+	struct curl_slist* GetCustomHeaders(MediaType simType);
+
+	/**
+	 * @brief Add download bandwidth sample used for ABR
+	 *
+	 * @param[in] downloadbps - Measured bandwidth in bits per second
 	 * @return void
 	 */
-	bool GetFile(std::string remoteUrl, struct GrowableBuffer *buffer, std::string& effectiveUrl, long *http_error = NULL, double *downloadTime = NULL, const char *range = NULL,unsigned int curlInstance = 0, bool resetBuffer = true,MediaType fileType = eMEDIATYPE_DEFAULT, long *bitrate = NULL,  int * fogError = NULL, double fragmentDurationSec = 0);
+	void AddAbrBitrateSample(long downloadbps);
+
+	/**
+	 * @brief Add download bandwidth sample of a completed or timed out video fragment download
+	 *
+	 * @param[in] bytes - Downloaded bytes
+	 * @param[in] downloadTimeMS - Download time in milliseconds
+	 * @param[in] fragmentDurationMs - Fragment duration in milliseconds, 0 if not known
+	 * @return void
+	 */
+	void AddFragmentBitrateSample(size_t bytes, int downloadTimeMS, int fragmentDurationMs);
 
 	/**
 	 * @brief Download VideoEnd Session statistics from fog
@@ -925,6 +904,13 @@ public:
 	 */
 	void SendEventSync(AAMPEventPtr e);
 
+	/**
+	 * @brief Dispatch events queued by SendEventAsync, called from main loop
+	 *
+	 * @return void
+	 */
+	void DispatchScheduledEvents();
+
 	/**
 	 * @brief Notify speed change
 	 *
@@ -1022,6 +1008,13 @@ public:
 	 */
 	void ReportProgress(void);
 
+	/**
+	 *   @brief Send playback profile as metrics data event, at the configured interval
+	 *
+	 *   @return void
+	 */
+	void ReportPlaybackProfile(void);
+
 	/**
 	 *   @brief Report Ad progress event
 	 *
@@ -1075,6 +1068,20 @@ public:
 	 */
 	void SendStream(MediaType mediaType, GrowableBuffer* buffer, double fpts, double fdts, double fDuration);
 
+	/**
+	 * @brief Send part of a shared media block to sink without copying
+	 *
+	 * @param[in] mediaType - Type of media
+	 * @param[in] block - Reference counted block holding the data, caller keeps its reference
+	 * @param[in] ptr - Start of data within block
+	 * @param[in] len - Length of data
+	 * @param[in] fpts - Presentation Time Stamp
+	 * @param[in] fdts - Decode Time Stamp
+	 * @param[in] fDuration - Buffer duration
+	 * @return void
+	 */
+	void SendStream(MediaType mediaType, AampSharedBlock* block, const void *ptr, size_t len, double fpts, double fdts, double fDuration);
+
 	/**
 	 * @brief Setting the stream sink
 	 *
@@ -2294,6 +2301,13 @@ public:
 	 */
 	std::string GetAvailableAudioTracks();
 
+	/**
+	 *   @brief Get latency histograms of fragment processing phases since tune.
+	 *
+	 *   @return std::string JSON formatted histograms per track and phase
+	 */
+	std::string GetPlaybackProfile();
+
 	/**
 	 *   @brief Get available text tracks.
 	 *
@@ -2385,6 +2399,13 @@ public:
 	 */
 	AampCacheHandler * getAampCacheHandler();
 
+	/**
+	 * @brief Get worker pool of the player, for short lived tasks in place of dedicated threads
+	 *
+	 * @return Pointer to AampWorkerPool
+	 */
+	AampWorkerPool * GetWorkerPool() { return mWorkerPool; }
+
 	/*
 	 * @brief Set profile ramp down limit.
 	 *
@@ -2679,12 +2700,20 @@ private:
 	void ExtractServiceZone(std::string url);
 
 	/**
-	 *   @brief Schedule Event
+	 *   @brief Queue event for dispatch from main loop, coalescing superseded events
 	 *
-	 *   @param[in]  e - Pointer to the event descriptor
+	 *   @param[in]  e - Event object
 	 *   @return void
 	 */
-	void ScheduleEvent(struct AsyncEventDescriptor* e);
+	void ScheduleEvent(AAMPEventPtr e);
+
+	/**
+	 *   @brief Check if event type has a listener, including listeners of all events
+	 *
+	 *   @param[in]  eventType - Event type
+	 *   @return true if event would be delivered
+	 */
+	bool HasEventListeners(AAMPEventType eventType);
 
 	/**
 	 * @brief Deliver all pending Ad events to JSPP
@@ -2724,7 +2753,7 @@ private:
 	 */
 	void ConfigureWithLocalOptions();
 
-	ListenerData* mEventListeners[AAMP_MAX_NUM_EVENTS];
+	EventListenerList mEventListeners[AAMP_MAX_NUM_EVENTS]; /**< Listeners per event type, 0 for all events; accessed with std::atomic_load/store */
 	TuneType mTuneType;
 	int m_fd;
 	bool mIsLive;
@@ -2746,6 +2775,10 @@ private:
 	bool mTunedEventPending;
 	bool mSeekOperationInProgress;
 	std::map<guint, bool> mPendingAsyncEvents;
+	pthread_mutex_t mEventQueueLock;              /**< Protects mScheduledEvents and mEventDispatchScheduled, taken after mLock if both are needed */
+	std::vector<AAMPEventPtr> mScheduledEvents;   /**< Events waiting for main loop dispatch, protected by mEventQueueLock */
+	std::vector<AAMPEventPtr> mDispatchingEvents; /**< Events being dispatched, used from main loop only */
+	bool mEventDispatchScheduled;                 /**< Idle callback for mScheduledEvents is pending, protected by mEventQueueLock */
 	std::unordered_map<std::string, std::vector<std::string>> mCustomHeaders;
 	bool mIsFirstRequestToFOG;
 	bool mIsLocalPlayback; /** indicates if the playback is from FOG(TSB/IP-DVR) */
@@ -2772,6 +2805,7 @@ private:
 	bool mProgressReportFromProcessDiscontinuity; /** flag dentoes if progress reporting is in execution from ProcessPendingDiscontinuity*/
 
 	AampCacheHandler *mAampCacheHandler;
+	AampWorkerPool *mWorkerPool; /**< Runs tasks of the player, e.g. init fragment and DRM session setup, ad fulfillment and playlist pre-cache */
 	long mMinBitrate;	/** minimum bitrate limit of profiles to be selected during playback */
 	long mMaxBitrate;	/** Maximum bitrate limit of profiles to be selected during playback */
 	int mMinInitialCacheSeconds; /**< Minimum cached duration before playing in seconds*/
@@ -24,6 +24,7 @@
 
 #include "StreamAbstractionAAMP.h"
 #include "AampUtils.h"
+#include "AampMutex.h"
 #include <assert.h>
 #include <errno.h>
 #include <math.h>
@@ -92,7 +93,7 @@ void MediaTrack::MonitorBufferHealth()
 	while(keepRunning && !abort)
 	{
 		aamp->InterruptableMsSleep(monitorInterval);
-		pthread_mutex_lock(&mutex);
+		AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
 		if (aamp->DownloadsAreEnabled() && !abort)
 		{
 			if ( numberOfFragmentsCached > 0)
@@ -132,12 +133,12 @@ void MediaTrack::MonitorBufferHealth()
 						GetBufferHealthStatusString(bufferStatus));
 			}
 
-			pthread_mutex_unlock(&mutex);
+			AAMP_MUTEX_UNLOCK(mutex);
 
 			// We use another lock inside CheckForMediaTrackInjectionStall for synchronization
 			GetContext()->CheckForMediaTrackInjectionStall(type);
 
-			pthread_mutex_lock(&mutex);
+			AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
 
 			if((!aamp->pipeline_paused) && aamp->IsDiscontinuityProcessPending() && gpGlobalConfig->discontinuityTimeout)
 			{
@@ -165,7 +166,7 @@ void MediaTrack::MonitorBufferHealth()
 		{
 			keepRunning = false;
 		}
-		pthread_mutex_unlock(&mutex);
+		AAMP_MUTEX_UNLOCK(mutex);
 	}
 }
 
@@ -174,24 +175,33 @@ void MediaTrack::MonitorBufferHealth()
  */
 void MediaTrack::UpdateTSAfterInject()
 {
-	pthread_mutex_lock(&mutex);
-	aamp_Free(&cachedFragment[fragmentIdxToInject].fragment.ptr);
-	memset(&cachedFragment[fragmentIdxToInject], 0, sizeof(CachedFragment));
-	fragmentIdxToInject++;
-	if (fragmentIdxToInject == gpGlobalConfig->maxCachedFragmentsPerTrack)
+	int idx = fragmentIdxToInject.load(std::memory_order_relaxed);
+	cachedFragmentBytes -= cachedFragment[idx].cachedSize;
+	cachedFragmentMs -= cachedFragment[idx].cachedMs;
+	cachedDiscontinuities.Remove(cachedFragment[idx].countedDiscontinuity);
+	ReleaseFragmentBuffer(&cachedFragment[idx].fragment);
+	memset(&cachedFragment[idx], 0, sizeof(CachedFragment));
+	idx++;
+	if (idx == gpGlobalConfig->maxCachedFragmentsPerTrack)
 	{
-		fragmentIdxToInject = 0;
+		idx = 0;
 	}
-	numberOfFragmentsCached--;
+	// slot is released to the fetcher by the decrement, so it is done last
+	fragmentIdxToInject.store(idx, std::memory_order_release);
+	numberOfFragmentsCached.fetch_sub(1);
 #ifdef AAMP_DEBUG_FETCH_INJECT
 	if ((1 << type) & AAMP_DEBUG_FETCH_INJECT)
 	{
 		logprintf("%s:%d [%s] updated fragmentIdxToInject = %d numberOfFragmentsCached %d", __FUNCTION__, __LINE__,
-		        name, fragmentIdxToInject, numberOfFragmentsCached);
+		        name, idx, numberOfFragmentsCached.load());
 	}
 #endif
-	pthread_cond_signal(&fragmentInjected);
-	pthread_mutex_unlock(&mutex);
+	if (fetcherWaiting.load())
+	{
+		AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
+		pthread_cond_signal(&fragmentInjected);
+		AAMP_MUTEX_UNLOCK(mutex);
+	}
 }
 
 
@@ -201,14 +211,13 @@ void MediaTrack::UpdateTSAfterInject()
 void MediaTrack::UpdateTSAfterFetch()
 {
 	bool notifyCacheCompleted = false;
-	pthread_mutex_lock(&mutex);
 	cachedFragment[fragmentIdxToFetch].profileIndex = GetContext()->profileIdxForBandwidthNotification;
 	GetContext()->UpdateStreamInfoBitrateData(cachedFragment[fragmentIdxToFetch].profileIndex, cachedFragment[fragmentIdxToFetch].cacheFragStreamInfo);
 #ifdef AAMP_DEBUG_FETCH_INJECT
 	if ((1 << type) & AAMP_DEBUG_FETCH_INJECT)
 	{
 		logprintf("%s:%d [%s] before update fragmentIdxToFetch = %d numberOfFragmentsCached %d",
-		        __FUNCTION__, __LINE__, name, fragmentIdxToFetch, numberOfFragmentsCached);
+		        __FUNCTION__, __LINE__, name, fragmentIdxToFetch, numberOfFragmentsCached.load());
 	}
 #endif
 	totalFetchedDuration += cachedFragment[fragmentIdxToFetch].duration;
@@ -221,14 +230,19 @@ void MediaTrack::UpdateTSAfterFetch()
 		}
 	}
 #endif
-	numberOfFragmentsCached++;
-	assert(numberOfFragmentsCached <= gpGlobalConfig->maxCachedFragmentsPerTrack);
+	cachedFragment[fragmentIdxToFetch].cachedSize = cachedFragment[fragmentIdxToFetch].fragment.len;
+	cachedFragment[fragmentIdxToFetch].cachedMs = (long long)(cachedFragment[fragmentIdxToFetch].duration * 1000);
+	cachedFragmentBytes += cachedFragment[fragmentIdxToFetch].cachedSize;
+	cachedFragmentMs += cachedFragment[fragmentIdxToFetch].cachedMs;
+	cachedDiscontinuities.Add(cachedFragment[fragmentIdxToFetch].discontinuity, cachedFragment[fragmentIdxToFetch].countedDiscontinuity);
 	currentInitialCacheDurationSeconds += cachedFragment[fragmentIdxToFetch].duration;
 
 	if( (eTRACK_VIDEO == type)
 			&& aamp->IsFragmentCachingRequired()
 			&& !cachingCompleted)
 	{
+		// shared with OnSinkBufferFull, only during initial caching
+		AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
 		const int minInitialCacheSeconds = aamp->GetInitialBufferDuration();
 		if(currentInitialCacheDurationSeconds >= minInitialCacheSeconds)
 		{
@@ -237,7 +251,7 @@ void MediaTrack::UpdateTSAfterFetch()
 			notifyCacheCompleted = true;
 			cachingCompleted = true;
 		}
-		else if (sinkBufferIsFull && numberOfFragmentsCached == gpGlobalConfig->maxCachedFragmentsPerTrack)
+		else if (sinkBufferIsFull && IsFragmentCacheFull())
 		{
 			logprintf("## %s:%d [%s] Cache is Full cacheDuration %d minInitialCacheSeconds %d, aborting caching!##",
 					__FUNCTION__, __LINE__, name, currentInitialCacheDurationSeconds, minInitialCacheSeconds);
@@ -249,6 +263,7 @@ void MediaTrack::UpdateTSAfterFetch()
 			AAMPLOG_INFO("## %s:%d [%s] Caching Ongoing cacheDuration %d minInitialCacheSeconds %d##",
 					__FUNCTION__, __LINE__, name, currentInitialCacheDurationSeconds, minInitialCacheSeconds);
 		}
+		AAMP_MUTEX_UNLOCK(mutex);
 	}
 	fragmentIdxToFetch++;
 	if (fragmentIdxToFetch == gpGlobalConfig->maxCachedFragmentsPerTrack)
@@ -259,12 +274,19 @@ void MediaTrack::UpdateTSAfterFetch()
 	if ((1 << type) & AAMP_DEBUG_FETCH_INJECT)
 	{
 		logprintf("%s:%d [%s] updated fragmentIdxToFetch = %d numberOfFragmentsCached %d",
-			__FUNCTION__, __LINE__, name, fragmentIdxToFetch, numberOfFragmentsCached);
+			__FUNCTION__, __LINE__, name, fragmentIdxToFetch, numberOfFragmentsCached.load());
 	}
 #endif
 	totalFragmentsDownloaded++;
-	pthread_cond_signal(&fragmentFetched);
-	pthread_mutex_unlock(&mutex);
+	// publish the fetched slot to the injector
+	int cached = numberOfFragmentsCached.fetch_add(1) + 1;
+	assert(cached <= gpGlobalConfig->maxCachedFragmentsPerTrack);
+	if (injectorWaiting.load())
+	{
+		AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
+		pthread_cond_signal(&fragmentFetched);
+		AAMP_MUTEX_UNLOCK(mutex);
+	}
 	if(notifyCacheCompleted)
 	{
 		aamp->NotifyFragmentCachingComplete();
@@ -291,7 +313,7 @@ bool MediaTrack::WaitForFreeFragmentAvailable( int timeoutMs)
 	{
 		// Still in preparation mode , not to inject any more fragments beyond capacity
 		// Wait for 100ms
-		pthread_mutex_lock(&aamp->mMutexPlaystart);
+		AAMP_MUTEX_LOCK(aamp->mMutexPlaystart, "PrivateInstanceAAMP::mMutexPlaystart");
 		aamp->GetState(state);
 		if(state == eSTATE_PREPARED && totalFragmentsDownloaded > gpGlobalConfig->preplaybuffercount
 				&& !aamp->IsFragmentCachingRequired() )
@@ -301,7 +323,7 @@ bool MediaTrack::WaitForFreeFragmentAvailable( int timeoutMs)
 		struct timespec tspec;
 		tspec = aamp_GetTimespec(timeoutMs);
 
-		pthreadReturnValue = pthread_cond_timedwait(&aamp->waitforplaystart, &aamp->mMutexPlaystart, &tspec);
+		pthreadReturnValue = AAMP_COND_TIMEDWAIT(aamp->waitforplaystart, aamp->mMutexPlaystart, tspec);
 
 		if (ETIMEDOUT == pthreadReturnValue)
 		{
@@ -313,17 +335,20 @@ bool MediaTrack::WaitForFreeFragmentAvailable( int timeoutMs)
 			ret = false;
 		}
 		}
-		pthread_mutex_unlock(&aamp->mMutexPlaystart);	
+		AAMP_MUTEX_UNLOCK(aamp->mMutexPlaystart);	
 	}
 	
-	pthread_mutex_lock(&mutex);
-	if ( ret && (numberOfFragmentsCached == gpGlobalConfig->maxCachedFragmentsPerTrack) )
+	if ( ret && IsFragmentCacheFull() )
 	{
-		if (timeoutMs >= 0)
+		AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
+		// injector signals only when it sees the flag, so check again after setting it
+		fetcherWaiting = true;
+		bool cacheFull = (IsFragmentCacheFull() && !abort);
+		if (cacheFull && (timeoutMs >= 0))
 		{
 			struct timespec tspec = aamp_GetTimespec(timeoutMs);
 
-			pthreadReturnValue = pthread_cond_timedwait(&fragmentInjected, &mutex, &tspec);
+			pthreadReturnValue = AAMP_COND_TIMEDWAIT(fragmentInjected, mutex, tspec);
 
 			if (ETIMEDOUT == pthreadReturnValue)
 			{
@@ -335,7 +360,7 @@ bool MediaTrack::WaitForFreeFragmentAvailable( int timeoutMs)
 				ret = false;
 			}
 		}
-		else
+		else if (cacheFull)
 		{
 #ifdef AAMP_DEBUG_FETCH_INJECT
 			if ((1 << type) & AAMP_DEBUG_FETCH_INJECT)
@@ -343,7 +368,7 @@ bool MediaTrack::WaitForFreeFragmentAvailable( int timeoutMs)
 				logprintf("%s:%d [%s] waiting for fragmentInjected condition", __FUNCTION__, __LINE__, name);
 			}
 #endif
-			pthreadReturnValue = pthread_cond_wait(&fragmentInjected, &mutex);
+			pthreadReturnValue = AAMP_COND_WAIT(fragmentInjected, mutex);
 
 			if (0 != pthreadReturnValue)
 			{
@@ -367,15 +392,16 @@ bool MediaTrack::WaitForFreeFragmentAvailable( int timeoutMs)
 #endif
 			ret = false;
 		}
+		fetcherWaiting = false;
+		AAMP_MUTEX_UNLOCK(mutex);
 	}
 #ifdef AAMP_DEBUG_FETCH_INJECT
 	if ((1 << type) & AAMP_DEBUG_FETCH_INJECT)
 	{
 		logprintf("%s:%d [%s] fragmentIdxToFetch = %d numberOfFragmentsCached %d",
-			__FUNCTION__, __LINE__, name, fragmentIdxToFetch, numberOfFragmentsCached);
+			__FUNCTION__, __LINE__, name, fragmentIdxToFetch, numberOfFragmentsCached.load());
 	}
 #endif
-	pthread_mutex_unlock(&mutex);
 	return ret;
 }
 
@@ -386,29 +412,35 @@ bool MediaTrack::WaitForFreeFragmentAvailable( int timeoutMs)
 bool MediaTrack::WaitForCachedFragmentAvailable()
 {
 	bool ret;
-	pthread_mutex_lock(&mutex);
 	if ((numberOfFragmentsCached == 0) && !(abort || abortInject))
 	{
-#ifdef AAMP_DEBUG_FETCH_INJECT
-		if ((1 << type) & AAMP_DEBUG_FETCH_INJECT)
+		AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
+		// fetcher signals only when it sees the flag, so check again after setting it
+		injectorWaiting = true;
+		if ((numberOfFragmentsCached == 0) && !(abort || abortInject))
 		{
-			logprintf("## %s:%d [%s] Waiting for CachedFragment to be available, eosReached=%d ##", __FUNCTION__, __LINE__, name, eosReached);
-		}
+#ifdef AAMP_DEBUG_FETCH_INJECT
+			if ((1 << type) & AAMP_DEBUG_FETCH_INJECT)
+			{
+				logprintf("## %s:%d [%s] Waiting for CachedFragment to be available, eosReached=%d ##", __FUNCTION__, __LINE__, name, eosReached);
+			}
 #endif
-		if (!eosReached)
-		{
-			pthread_cond_wait(&fragmentFetched, &mutex);
+			if (!eosReached)
+			{
+				AAMP_COND_WAIT(fragmentFetched, mutex);
+			}
 		}
+		injectorWaiting = false;
+		AAMP_MUTEX_UNLOCK(mutex);
 	}
 #ifdef AAMP_DEBUG_FETCH_INJECT
 	if ((1 << type) & AAMP_DEBUG_FETCH_INJECT)
 	{
 		logprintf("%s:%d [%s] fragmentIdxToInject = %d numberOfFragmentsCached %d",
-			__FUNCTION__, __LINE__, name, fragmentIdxToInject, numberOfFragmentsCached);
+			__FUNCTION__, __LINE__, name, fragmentIdxToInject.load(), numberOfFragmentsCached.load());
 	}
 #endif
 	ret = !(abort || abortInject || (numberOfFragmentsCached == 0));
-	pthread_mutex_unlock(&mutex);
 	return ret;
 }
 
@@ -419,7 +451,7 @@ bool MediaTrack::WaitForCachedFragmentAvailable()
  */
 void MediaTrack::AbortWaitForCachedAndFreeFragment(bool immediate)
 {
-	pthread_mutex_lock(&mutex);
+	AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
 	if (immediate)
 	{
 		abort = true;
@@ -434,7 +466,7 @@ void MediaTrack::AbortWaitForCachedAndFreeFragment(bool immediate)
 	}
 	pthread_cond_signal(&aamp->waitforplaystart);
 	pthread_cond_signal(&fragmentFetched);
-	pthread_mutex_unlock(&mutex);
+	AAMP_MUTEX_UNLOCK(mutex);
 
 	GetContext()->AbortWaitForDiscontinuity();
 }
@@ -445,7 +477,7 @@ void MediaTrack::AbortWaitForCachedAndFreeFragment(bool immediate)
  */
 void MediaTrack::AbortWaitForCachedFragment()
 {
-	pthread_mutex_lock(&mutex);
+	AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
 	abortInject = true;
 #ifdef AAMP_DEBUG_FETCH_INJECT
 	if ((1 << type) & AAMP_DEBUG_FETCH_INJECT)
@@ -454,7 +486,7 @@ void MediaTrack::AbortWaitForCachedFragment()
 	}
 #endif
 	pthread_cond_signal(&fragmentFetched);
-	pthread_mutex_unlock(&mutex);
+	AAMP_MUTEX_UNLOCK(mutex);
 
 	GetContext()->AbortWaitForDiscontinuity();
 }
@@ -465,16 +497,21 @@ void MediaTrack::AbortWaitForCachedFragment()
 bool MediaTrack::InjectFragment()
 {
 	bool ret = true;
-	aamp->BlockUntilGstreamerWantsData(NULL, 0, type);
+	bool fragmentAvailable;
+	{
+		AampPlaybackPhaseTimer injectWaitTimer(aamp->mPlaybackProfiler, type, PLAYBACK_PHASE_INJECT_WAIT);
+		aamp->BlockUntilGstreamerWantsData(NULL, 0, type);
+		fragmentAvailable = WaitForCachedFragmentAvailable();
+	}
 
-	if (WaitForCachedFragmentAvailable())
+	if (fragmentAvailable)
 	{
 		bool stopInjection = false;
 		bool fragmentDiscarded = false;
-		CachedFragment* cachedFragment = &this->cachedFragment[fragmentIdxToInject];
+		CachedFragment* cachedFragment = &this->cachedFragment[fragmentIdxToInject.load(std::memory_order_relaxed)];
 #ifdef TRACE
 		logprintf("%s:%d [%s] - fragmentIdxToInject %d cachedFragment %p ptr %p", __FUNCTION__, __LINE__,
-				name, fragmentIdxToInject, cachedFragment, cachedFragment->fragment.ptr);
+				name, fragmentIdxToInject.load(), cachedFragment, cachedFragment->fragment.ptr);
 #endif
 		if (cachedFragment->fragment.ptr)
 		{
@@ -499,11 +536,13 @@ bool MediaTrack::InjectFragment()
 					ret = false;
 				}
 				cachedFragment->discontinuity = false;
+				cachedDiscontinuities.Remove(cachedFragment->countedDiscontinuity);
 			}
 			else if ((cachedFragment->discontinuity || ptsError) && (AAMP_NORMAL_PLAY_RATE == context->aamp->rate))
 			{
 				logprintf("%s:%d - track %s - encountered aamp discontinuity @position - %f", __FUNCTION__, __LINE__, name, cachedFragment->position);
 				cachedFragment->discontinuity = false;
+				cachedDiscontinuities.Remove(cachedFragment->countedDiscontinuity);
 				ptsError = false;
 				if (totalInjectedDuration == 0)
 				{
@@ -604,7 +643,7 @@ bool MediaTrack::InjectFragment()
 			}
 			else
 			{
-				logprintf("%s:%d - %s - NULL ptr to inject. fragmentIdxToInject %d", __FUNCTION__, __LINE__, name, fragmentIdxToInject);
+				logprintf("%s:%d - %s - NULL ptr to inject. fragmentIdxToInject %d", __FUNCTION__, __LINE__, name, fragmentIdxToInject.load());
 			}
 			ret = false;
 		}
@@ -782,11 +821,49 @@ CachedFragment* MediaTrack::GetFetchBuffer(bool initialize)
 			logprintf("%s:%d fragment.ptr already set - possible memory leak", __FUNCTION__, __LINE__);
 		}
 		memset(&cachedFragment->fragment, 0x00, sizeof(GrowableBuffer));
+		AcquireFragmentBuffer(&cachedFragment->fragment);
 	}
 	return cachedFragment;
 }
 
 
+/**
+ * @brief Estimate size of the upcoming fragment from profile bitrate and fragment duration
+ * @retval expected size in bytes, 0 if unknown
+ */
+size_t MediaTrack::GetExpectedFragmentSize()
+{
+	// bandwidth of the currently selected profile, 0 if not known for the track
+	long bitsPerSecond = bandwidthBitsPerSecond;
+	if (bitsPerSecond <= 0 || fragmentDurationSeconds <= 0)
+	{
+		return 0;
+	}
+	// headroom for variable bitrate peaks, buffer grows on demand if exceeded
+	return (size_t)((bitsPerSecond / 8) * fragmentDurationSeconds * FRAGMENT_BUFFER_SIZE_MARGIN);
+}
+
+
+/**
+ * @brief Get a pooled or newly allocated buffer, pre-sized for the upcoming fragment
+ * @param[out] buffer empty buffer to be filled by fragment download
+ */
+void MediaTrack::AcquireFragmentBuffer(GrowableBuffer *buffer)
+{
+	mFragmentBufferPool->Acquire(buffer, GetExpectedFragmentSize());
+}
+
+
+/**
+ * @brief Return a fragment buffer to the buffer pool of the track for reuse
+ * @param[in] buffer buffer to recycle, reset on return
+ */
+void MediaTrack::ReleaseFragmentBuffer(GrowableBuffer *buffer)
+{
+	mFragmentBufferPool->Release(buffer);
+}
+
+
 /**
  * @brief Set current bandwidth of track
  * @param bandwidthBps bandwidth in bits per second
@@ -815,6 +892,51 @@ int MediaTrack::GetCurrentBandWidth()
 	return this->bandwidthBitsPerSecond;
 }
 
+/**
+ * @brief Check if fragment cache reached its slot, byte or duration budget
+ * @retval true if no more fragments to be cached
+ */
+bool MediaTrack::IsFragmentCacheFull()
+{
+	bool ret = (numberOfFragmentsCached == gpGlobalConfig->maxCachedFragmentsPerTrack);
+	// budgets apply only once something is cached, a single fragment larger than budget must still go through
+	if (!ret && numberOfFragmentsCached > 0)
+	{
+		if (gpGlobalConfig->maxCachedFragmentBytesPerTrack > 0 && cachedFragmentBytes >= (size_t)gpGlobalConfig->maxCachedFragmentBytesPerTrack)
+		{
+			ret = true;
+		}
+		else if (gpGlobalConfig->maxCachedFragmentSecondsPerTrack > 0 && cachedFragmentMs >= (long long)(gpGlobalConfig->maxCachedFragmentSecondsPerTrack * 1000))
+		{
+			ret = true;
+		}
+	}
+	return ret;
+}
+
+/**
+ * @brief Get duration of fetched fragments waiting in cache for injection
+ * @retval cached duration in seconds
+ */
+double MediaTrack::GetCachedFragmentDuration()
+{
+	return cachedFragmentMs / 1000.0;
+}
+
+/**
+ * @brief Get buffered duration ahead of play position, in fragment cache and in sink
+ * @retval buffered duration in seconds
+ */
+double MediaTrack::GetTotalBufferedDuration()
+{
+	double sinkBuffered = totalInjectedDuration - GetContext()->GetElapsedTime();
+	if (sinkBuffered < 0)
+	{
+		sinkBuffered = 0;
+	}
+	return sinkBuffered + GetCachedFragmentDuration();
+}
+
 /**
  *   @brief Flushes all media fragments and resets all relevant counters
  * 			Only intended for use on subtitle streams
@@ -825,12 +947,15 @@ void MediaTrack::FlushFragments()
 {
 	for (int i = 0; i < gpGlobalConfig->maxCachedFragmentsPerTrack; i++)
 	{
-		aamp_Free(&cachedFragment[i].fragment.ptr);
+		ReleaseFragmentBuffer(&cachedFragment[i].fragment);
 		memset(&cachedFragment[i], 0, sizeof(CachedFragment));
 	}
 	fragmentIdxToInject = 0;
 	fragmentIdxToFetch = 0;
 	numberOfFragmentsCached = 0;
+	cachedFragmentBytes = 0;
+	cachedFragmentMs = 0;
+	cachedDiscontinuities.Reset();
 	totalFetchedDuration = 0;
 	totalFragmentsDownloaded = 0;
 	totalInjectedDuration = 0;
@@ -848,10 +973,10 @@ MediaTrack::MediaTrack(TrackType type, PrivateInstanceAAMP* aamp, const char* na
 		fragmentInjectorThreadStarted(false), bufferMonitorThreadStarted(false), totalInjectedDuration(0), currentInitialCacheDurationSeconds(0),
 		sinkBufferIsFull(false), cachingCompleted(false), fragmentDurationSeconds(0), segDLFailCount(0),segDrmDecryptFailCount(0),mSegInjectFailCount(0),
 		bufferStatus(BUFFER_STATUS_GREEN), prevBufferStatus(BUFFER_STATUS_GREEN),
-		bandwidthBitsPerSecond(0), totalFetchedDuration(0),
+		bandwidthBitsPerSecond(0), totalFetchedDuration(0), cachedFragmentBytes(0), cachedFragmentMs(0), cachedDiscontinuities(), fetcherWaiting(false), injectorWaiting(false),
 		discontinuityProcessed(false), ptsError(false), cachedFragment(NULL), name(name), type(type), aamp(aamp),
 		mutex(), fragmentFetched(), fragmentInjected(), abortInject(false),
-		mSubtitleParser(NULL), refreshSubtitles(false)
+		mSubtitleParser(NULL), refreshSubtitles(false), mFragmentBufferPool(NULL)
 {
 	cachedFragment = new CachedFragment[gpGlobalConfig->maxCachedFragmentsPerTrack];
 	for(int X =0; X< gpGlobalConfig->maxCachedFragmentsPerTrack; ++X){
@@ -860,6 +985,8 @@ MediaTrack::MediaTrack(TrackType type, PrivateInstanceAAMP* aamp, const char* na
 	pthread_cond_init(&fragmentFetched, NULL);
 	pthread_cond_init(&fragmentInjected, NULL);
 	pthread_mutex_init(&mutex, NULL);
+	// pool never needs more buffers than the cache ring can hold
+	mFragmentBufferPool = new AampBufferPool(name, gpGlobalConfig->maxCachedFragmentsPerTrack);
 }
 
 
@@ -898,6 +1025,9 @@ MediaTrack::~MediaTrack()
 		delete [] cachedFragment;
 		cachedFragment = NULL;
 	}
+	// blocks still held by sink keep the pool alive
+	mFragmentBufferPool->Unref();
+	mFragmentBufferPool = NULL;
 	pthread_cond_destroy(&fragmentFetched);
 	pthread_cond_destroy(&fragmentInjected);
 	pthread_mutex_destroy(&mutex);
@@ -1201,7 +1331,7 @@ void StreamAbstractionAAMP::GetDesiredProfileOnBuffer(int currProfileIndex, int
 
 	long currentBandwidth = GetStreamInfo(currentProfileIndex)->bandwidthBitsPerSecond;
 	long newBandwidth = GetStreamInfo(newProfileIndex)->bandwidthBitsPerSecond;
-	double bufferValue = video->GetBufferedDuration();
+	double bufferValue = video->GetTotalBufferedDuration();
 	// Buffer levels 
 	// Steadystate Buffer = 10sec - Good condition
 	// Lower threshold before rampdown to happen - 5sec 
@@ -1232,7 +1362,7 @@ void StreamAbstractionAAMP::GetDesiredProfileOnBuffer(int currProfileIndex, int
 void StreamAbstractionAAMP::GetDesiredProfileOnSteadyState(int currProfileIndex, int &newProfileIndex, long nwBandwidth)
 {
 	MediaTrack *video = GetMediaTrack(eTRACK_VIDEO);
-	double bufferValue = video->GetBufferedDuration();
+	double bufferValue = video->GetTotalBufferedDuration();
 
 	if(bufferValue > 0 && currProfileIndex == newProfileIndex)
 	{
@@ -2058,31 +2188,16 @@ double StreamAbstractionAAMP::GetLastInjectedFragmentPosition()
  */
 bool MediaTrack::CheckForFutureDiscontinuity(double &cachedDuration)
 {
-	bool ret = false;
-	cachedDuration = 0;
-	pthread_mutex_lock(&mutex);
-
-	int start = fragmentIdxToInject;
-	int count = numberOfFragmentsCached;
-	while (count > 0)
+	// Called from the other track, so cache slots owned by fetcher and injector are not read,
+	// only the counters they publish
+	int discontinuities = cachedDiscontinuities.Pending();
+	bool ret = (discontinuities > 0);
+	cachedDuration = GetCachedFragmentDuration();
+	if (ret)
 	{
-		if (!ret)
-		{
-			ret = ret || cachedFragment[start].discontinuity;
-			if (ret)
-			{
-				AAMPLOG_WARN("%s:%d Found discontinuity for track %s at index: %d and position - %f", __FUNCTION__, __LINE__, name, start, cachedFragment[start].position);
-			}
-		}
-		cachedDuration += cachedFragment[start].duration;
-		if (++start == gpGlobalConfig->maxCachedFragmentsPerTrack)
-		{
-			start = 0;
-		}
-		count--;
+		AAMPLOG_WARN("%s:%d Found %d discontinuity fragments in cache for track %s", __FUNCTION__, __LINE__, discontinuities, name);
 	}
-	AAMPLOG_WARN("%s:%d track %s numberOfFragmentsCached - %d, cachedDuration - %f", __FUNCTION__, __LINE__, name, numberOfFragmentsCached, cachedDuration);
-	pthread_mutex_unlock(&mutex);
+	AAMPLOG_WARN("%s:%d track %s numberOfFragmentsCached - %d, cachedDuration - %f", __FUNCTION__, __LINE__, name, numberOfFragmentsCached.load(std::memory_order_acquire), cachedDuration);
 
 	return ret;
 }
@@ -2097,10 +2212,10 @@ void MediaTrack::OnSinkBufferFull()
 
 	bool notifyCacheCompleted = false;
 
-	pthread_mutex_lock(&mutex);
+	AAMP_MUTEX_LOCK(mutex, "MediaTrack::mutex");
 	sinkBufferIsFull = true;
 	// check if cache buffer is full and caching was needed
-	if( numberOfFragmentsCached == gpGlobalConfig->maxCachedFragmentsPerTrack
+	if( IsFragmentCacheFull()
 			&& (eTRACK_VIDEO == type)
 			&& aamp->IsFragmentCachingRequired()
 			&& !cachingCompleted)
@@ -2110,7 +2225,7 @@ void MediaTrack::OnSinkBufferFull()
 		notifyCacheCompleted = true;
 		cachingCompleted = true;
 	}
-	pthread_mutex_unlock(&mutex);
+	AAMP_MUTEX_UNLOCK(mutex);
 
 	if(notifyCacheCompleted)
 	{
@@ -493,6 +493,46 @@ TEST(AampDrmSessionTests, TestMultipleSessionsSameKey)
 	STRCMP_EQUAL("org.w3.clearkey", drmSession3->getKeySystem().c_str());
 }
 
+TEST(AampDrmSessionTests, TestSessionCacheMetrics)
+{
+	std::string testKeyData = "TESTKEYDATA";
+	setupCurlPerformResponse(testKeyData);
+	setupChallengeCallbacks();
+
+	DrmInfo drmInfo;
+	drmInfo.method = eMETHOD_AES_128;
+	drmInfo.manifestURL = "http://example.com/assets/test.m3u8";
+	drmInfo.keyURI = "file.key";
+	std::shared_ptr<AampClearKeyHelper> drmHelper = std::make_shared<AampClearKeyHelper>(drmInfo);
+
+	const shared_ptr<DrmData> expectedDrmData = make_shared<DrmData>((unsigned char *)testKeyData.c_str(), testKeyData.size());
+	drmHelper->transformLicenseResponse(expectedDrmData);
+
+	mock("OpenCDM").expectOneCall("opencdm_session_update")
+			.withMemoryBufferParameter("keyMessage", expectedDrmData->getData(), (size_t)expectedDrmData->getDataLength())
+			.withIntParameter("keyLength", expectedDrmData->getDataLength())
+			.andReturnValue(0);
+
+	AampDRMSessionManager *sessionManager = getSessionManager();
+	DrmSessionCacheMetrics before = sessionManager->getCacheMetrics();
+
+	// 1st time around - cache miss and a license request
+	AampDrmSession *drmSession1 = createDrmSessionForHelper(drmHelper);
+
+	// 2nd time around - cache hit, no further license request
+	AAMPEvent event;
+	mock("OpenCDM").expectNoCall("opencdm_create_system");
+	mock("OpenCDM").expectNoCall("opencdm_construct_session");
+	AampDrmSession *drmSession2 = sessionManager->createDrmSession(drmHelper, &event, &mAamp);
+	CHECK_EQUAL(drmSession1, drmSession2);
+
+	DrmSessionCacheMetrics after = sessionManager->getCacheMetrics();
+	LONGS_EQUAL(before.cacheMisses + 1, after.cacheMisses);
+	LONGS_EQUAL(before.cacheHits + 1, after.cacheHits);
+	LONGS_EQUAL(before.licenseRequests + 1, after.licenseRequests);
+	LONGS_EQUAL(before.licenseFailures, after.licenseFailures);
+}
+
 TEST(AampDrmSessionTests, TestDashPlayReadySession)
 {
 	string prLicenseServerURL = "http://licenseserver.example/license";
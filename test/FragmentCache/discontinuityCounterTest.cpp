@@ -0,0 +1,87 @@
+#include "AampDiscontinuityCounter.h"
+
+#include "CppUTest/TestHarness.h"
+
+/**
+ * @brief Cache slot fields used by the counter, as in CachedFragment
+ */
+struct TestFragment
+{
+	bool discontinuity;
+	bool countedDiscontinuity;
+};
+
+TEST_GROUP(AampDiscontinuityCounterTests)
+{
+	AampDiscontinuityCounter counter;
+	TestFragment fragment = { false, false };
+
+	// MediaTrack::UpdateTSAfterFetch
+	void Fetch(bool discontinuity)
+	{
+		fragment.discontinuity = discontinuity;
+		counter.Add(fragment.discontinuity, fragment.countedDiscontinuity);
+	}
+
+	// MediaTrack::InjectFragment processing the discontinuity
+	void ProcessDiscontinuity()
+	{
+		fragment.discontinuity = false;
+		counter.Remove(fragment.countedDiscontinuity);
+	}
+
+	// MediaTrack::UpdateTSAfterInject
+	void Release()
+	{
+		counter.Remove(fragment.countedDiscontinuity);
+		fragment = { false, false };
+	}
+};
+
+TEST(AampDiscontinuityCounterTests, InjectedDiscontinuityIsTakenOut)
+{
+	Fetch(true);
+	LONGS_EQUAL(1, counter.Pending());
+	ProcessDiscontinuity();
+	LONGS_EQUAL(0, counter.Pending());
+	Release();
+	LONGS_EQUAL(0, counter.Pending());
+}
+
+TEST(AampDiscontinuityCounterTests, ReleasedUnprocessedDiscontinuityIsTakenOut)
+{
+	// e.g. injected during trick play, where the discontinuity is not processed
+	Fetch(true);
+	Release();
+	LONGS_EQUAL(0, counter.Pending());
+}
+
+TEST(AampDiscontinuityCounterTests, FragmentWithoutDiscontinuityIsNotCounted)
+{
+	Fetch(false);
+	LONGS_EQUAL(0, counter.Pending());
+	ProcessDiscontinuity();
+	Release();
+	LONGS_EQUAL(0, counter.Pending());
+}
+
+TEST(AampDiscontinuityCounterTests, RepeatedDiscontinuitiesDoNotAccumulate)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		Fetch(true);
+		LONGS_EQUAL(1, counter.Pending());
+		ProcessDiscontinuity();
+		Release();
+		Fetch(false);
+		Release();
+	}
+	LONGS_EQUAL(0, counter.Pending());
+}
+
+TEST(AampDiscontinuityCounterTests, ResetClearsPending)
+{
+	Fetch(true);
+	counter.Reset();
+	LONGS_EQUAL(0, counter.Pending());
+}
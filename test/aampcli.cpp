@@ -31,6 +31,7 @@
 #include <priv_aamp.h>
 #include <main_aamp.h>
 #include "../StreamAbstractionAAMP.h"
+#include "../AampMutex.h"
 
 #ifdef IARM_MGR
 #include "host.hpp"
@@ -293,6 +294,8 @@ static void ShowHelp(void)
 	logprintf( "live                          // Seek to live point");
 	logprintf( "underflow                     // Simulate underflow" );
 	logprintf( "retune                        // schedule retune" );
+	logprintf( "playbackprofile               // Show latency histograms of fragment processing since tune" );
+	logprintf( "lockstats [reset]             // Show lock wait and hold times (AAMP_LOCK_PROFILING builds)" );
 	logprintf( "reset                         // delete player instance and create a new one" );
 	logprintf( "get help                      // Show help of get command" );
 	logprintf( "set help                      // Show help of set command" );
@@ -736,6 +739,18 @@ static void ProcessCliCommand(char *cmd)
 	{
 		mSingleton->aamp->mStreamSink->DumpStatus();
 	}
+	else if (strcmp(cmd, "playbackprofile") == 0)
+	{
+		logprintf("PLAYBACK PROFILE: %s", mSingleton->GetPlaybackProfile().c_str());
+	}
+	else if (memcmp(cmd, "lockstats", 9) == 0)
+	{
+#ifdef AAMP_LOCK_PROFILING
+		AampLockProfiler::Dump(strcmp(cmd, "lockstats reset") == 0);
+#else
+		logprintf("lockstats needs a build with CMAKE_AAMP_LOCK_PROFILING");
+#endif
+	}
 	else if (strcmp(cmd, "live") == 0)
 	{
 		mSingleton->SeekToLive();
@@ -0,0 +1,611 @@
+/*
+ * If not stated otherwise in this file or this component's license file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2018 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file abrsimulator.cpp
+ * @brief Offline replay of throughput traces through the ABR logic of StreamAbstractionAAMP
+ *
+ * Usage: abrsimulator [options] <trace file | -t trace>
+ *  -t <kbps:sec,...>  inline throughput trace
+ *  -l <kbps,...>      video profile ladder, default 800,1600,3000,5000,8000
+ *  -f <sec>           fragment duration, default 6
+ *  -d <sec>           content duration, default 600
+ *  -b <sec>           buffered duration above which fetching waits, default 30
+ *  -r <ms>            request latency before the first byte of every download, default 100
+ *  -o <name>=<value>  ABR setting as in aamp.cfg, see kSettings
+ * Trace file has one "<sec> <kbps>" period per line, '#' starts a comment. The trace repeats
+ * until the content is fetched.
+ *
+ * A virtual clock drives aamp_GetCurrentTimeMS. Fragments are "downloaded" at the throughput of
+ * the trace, go through the MediaTrack cache and are injected into a fake sink, which drains as
+ * the virtual clock advances. After each
+ * fragment the bandwidth sample, profile change and timeout rampdown calls are made as the HLS
+ * fetcher loop does, so the decisions are those of StreamAbstractionAAMP and ABRManager.
+ * One line of key=value results is printed for CI to compare runs.
+ */
+
+#include "StreamAbstractionAAMP.h"
+#include "AampUtils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static long long gSimTimeMS = 0; /**< Virtual clock */
+
+/**
+ * @brief Virtual clock for aamp_GetCurrentTimeMS
+ */
+static long long GetSimTimeMS(void)
+{
+	return gSimTimeMS;
+}
+
+/**
+ * @brief Network throughput over time
+ */
+class ThroughputTrace
+{
+public:
+	ThroughputTrace() : mPeriods(), mTotalMS(0)
+	{
+	}
+
+	/**
+	 * @brief Add period of constant throughput
+	 */
+	void AddPeriod(double seconds, double kbps)
+	{
+		if (seconds > 0 && kbps >= 0)
+		{
+			Period period = { mTotalMS, (long long)(seconds * 1000), kbps * 1000 / 8000 };
+			mPeriods.push_back(period);
+			mTotalMS += period.durationMS;
+		}
+	}
+
+	/**
+	 * @brief Load "<sec> <kbps>" lines of a trace file
+	 */
+	bool Load(const char *path)
+	{
+		FILE *f = fopen(path, "r");
+		if (!f)
+		{
+			return false;
+		}
+		char line[256];
+		while (fgets(line, sizeof(line), f))
+		{
+			double seconds, kbps;
+			if (line[0] != '#' && sscanf(line, "%lf %lf", &seconds, &kbps) == 2)
+			{
+				AddPeriod(seconds, kbps);
+			}
+		}
+		fclose(f);
+		return !Empty();
+	}
+
+	/**
+	 * @brief Parse "<kbps>:<sec>,..." inline trace
+	 */
+	bool Parse(const char *spec)
+	{
+		while (spec && *spec)
+		{
+			double seconds, kbps;
+			if (sscanf(spec, "%lf:%lf", &kbps, &seconds) != 2)
+			{
+				return false;
+			}
+			AddPeriod(seconds, kbps);
+			spec = strchr(spec, ',');
+			if (spec)
+			{
+				spec++;
+			}
+		}
+		return !Empty();
+	}
+
+	bool Empty() const { return mTotalMS == 0; }
+
+	/**
+	 * @brief Get time to transfer bytes
+	 * @param[in] startMS transfer start time
+	 * @param[in] bytes bytes to transfer
+	 * @param[in] limitMS max transfer time
+	 * @retval transfer time in milliseconds, -1 if above limit
+	 */
+	long long GetTransferTime(long long startMS, double bytes, long long limitMS) const
+	{
+		long long elapsed = 0;
+		size_t idx = FindPeriod(startMS);
+		long long offset = (startMS % mTotalMS) - mPeriods[idx].startMS;
+		while (elapsed <= limitMS)
+		{
+			const Period &period = mPeriods[idx];
+			long long remainingMS = period.durationMS - offset;
+			double periodBytes = period.bytesPerMS * remainingMS;
+			if (bytes <= periodBytes)
+			{
+				elapsed += (long long)(bytes / period.bytesPerMS);
+				return (elapsed <= limitMS) ? elapsed : -1;
+			}
+			bytes -= periodBytes;
+			elapsed += remainingMS;
+			idx = (idx + 1) % mPeriods.size();
+			offset = 0;
+		}
+		return -1;
+	}
+
+	/**
+	 * @brief Get bytes transferred over an interval
+	 */
+	double GetTransferredBytes(long long startMS, long long durationMS) const
+	{
+		double bytes = 0;
+		size_t idx = FindPeriod(startMS);
+		long long offset = (startMS % mTotalMS) - mPeriods[idx].startMS;
+		while (durationMS > 0)
+		{
+			const Period &period = mPeriods[idx];
+			long long spanMS = std::min(period.durationMS - offset, durationMS);
+			bytes += period.bytesPerMS * spanMS;
+			durationMS -= spanMS;
+			idx = (idx + 1) % mPeriods.size();
+			offset = 0;
+		}
+		return bytes;
+	}
+
+private:
+	struct Period
+	{
+		long long startMS;    /**< Start within trace */
+		long long durationMS; /**< Length of period */
+		double bytesPerMS;    /**< Throughput */
+	};
+
+	size_t FindPeriod(long long timeMS) const
+	{
+		long long position = timeMS % mTotalMS;
+		auto it = std::upper_bound(mPeriods.begin(), mPeriods.end(), position,
+			[](long long value, const Period &period) { return value < period.startMS; });
+		return (it - mPeriods.begin()) - 1;
+	}
+
+	std::vector<Period> mPeriods;
+	long long mTotalMS;
+};
+
+class SimStreamAbstraction;
+
+/**
+ * @brief Track whose fragments are injected into a fake sink as soon as they are fetched
+ */
+class SimTrack : public MediaTrack
+{
+public:
+	SimTrack(TrackType type, PrivateInstanceAAMP *aamp, const char *name, StreamAbstractionAAMP *context) :
+		MediaTrack(type, aamp, name), mContext(context)
+	{
+	}
+
+	SimTrack(const SimTrack&) = delete;
+	SimTrack& operator=(const SimTrack&) = delete;
+
+	void ABRProfileChanged(void) override {}
+	double GetBufferedDuration(void) override { return GetTotalBufferedDuration(); }
+	StreamAbstractionAAMP* GetContext() override { return mContext; }
+	void InjectFragmentInternal(CachedFragment* cachedFragment, bool &fragmentDiscarded) override { fragmentDiscarded = false; }
+
+	/**
+	 * @brief Cache fetched fragment and inject it right away, as the injector thread would
+	 */
+	void AddFragment(double position, double duration)
+	{
+		fragmentDurationSeconds = duration;
+		CachedFragment *cachedFragment = GetFetchBuffer(true);
+		// content is not looked at, sink only accounts duration
+		aamp_AppendBytes(&cachedFragment->fragment, "", 1);
+		cachedFragment->position = position;
+		cachedFragment->duration = duration;
+		cachedFragment->discontinuity = false;
+		UpdateTSAfterFetch();
+		InjectFragment();
+	}
+
+private:
+	StreamAbstractionAAMP *mContext;
+};
+
+/**
+ * @brief Stream abstraction with a fixed video ladder and no audio
+ */
+class SimStreamAbstraction : public StreamAbstractionAAMP
+{
+public:
+	SimStreamAbstraction(PrivateInstanceAAMP *aamp, const std::vector<long> &ladder, double fragmentDuration) :
+		StreamAbstractionAAMP(aamp), mStreamInfo(), mVideo(eTRACK_VIDEO, aamp, "video", this), mAudio(eTRACK_AUDIO, aamp, "audio", this)
+	{
+		for (long bitrate : ladder)
+		{
+			StreamInfo info = { false, bitrate, { 1280, 720, 25.0 }, eAAMP_BITRATE_CHANGE_BY_ABR };
+			mStreamInfo.push_back(info);
+			mAbrManager.addProfile({ false, bitrate, 1280, 720 });
+		}
+		mAbrManager.updateProfile();
+		mVideo.enabled = true;
+		mVideo.fragmentDurationSeconds = fragmentDuration;
+		currentProfileIndex = GetDesiredProfile(false);
+	}
+
+	SimStreamAbstraction(const SimStreamAbstraction&) = delete;
+	SimStreamAbstraction& operator=(const SimStreamAbstraction&) = delete;
+
+	void DumpProfiles(void) override {}
+	AAMPStatusType Init(TuneType tuneType) override { return eAAMPSTATUS_OK; }
+	void Start() override {}
+	void Stop(bool clearChannelData) override {}
+	void GetStreamFormat(StreamOutputFormat &primaryOutputFormat, StreamOutputFormat &audioOutputFormat) override
+	{
+		primaryOutputFormat = FORMAT_MPEGTS;
+		audioOutputFormat = FORMAT_INVALID;
+	}
+	double GetStreamPosition() override { return 0; }
+	double GetFirstPTS() override { return 0; }
+	MediaTrack* GetMediaTrack(TrackType type) override
+	{
+		return (type == eTRACK_VIDEO) ? &mVideo : ((type == eTRACK_AUDIO) ? &mAudio : NULL);
+	}
+	double GetBufferedDuration(void) override { return mVideo.GetBufferedDuration(); }
+	int GetBWIndex(long bandwidth) override { return 0; }
+	std::vector<long> GetVideoBitrates(void) override
+	{
+		std::vector<long> bitrates;
+		for (const StreamInfo &info : mStreamInfo)
+		{
+			bitrates.push_back(info.bandwidthBitsPerSecond);
+		}
+		return bitrates;
+	}
+	std::vector<long> GetAudioBitrates(void) override { return std::vector<long>(); }
+	void StopInjection(void) override {}
+	void StartInjection(void) override {}
+	void NotifyFirstVideoPTS(unsigned long long pts) override {}
+	void SeekPosUpdate(double secondsRelativeToTuneTime) override {}
+
+	SimTrack *GetVideo() { return &mVideo; }
+
+protected:
+	StreamInfo* GetStreamInfo(int idx) override
+	{
+		return (idx >= 0 && idx < (int)mStreamInfo.size()) ? &mStreamInfo[idx] : NULL;
+	}
+
+private:
+	std::vector<StreamInfo> mStreamInfo;
+	SimTrack mVideo;
+	SimTrack mAudio;
+};
+
+/**
+ * @brief Results of a simulation run
+ */
+struct SimResult
+{
+	long long startupMS;     /**< Time to first injected fragment */
+	long long rebufferMS;    /**< Time playback was stalled after start */
+	int rebufferCount;       /**< Number of stalls */
+	int switchCount;         /**< Bitrate changes between consecutive fragments */
+	double bitrateSeconds;   /**< Sum of bitrate x duration of injected fragments */
+	double injectedSeconds;  /**< Duration of injected fragments */
+	int timeoutCount;        /**< Downloads which hit the curl timeout */
+	int skippedCount;        /**< Fragments skipped after timeout at lowest profile */
+};
+
+/**
+ * @brief Fetch loop of a video track with a virtual clock and a draining sink
+ */
+class AbrSimulation
+{
+public:
+	AbrSimulation(PrivateInstanceAAMP *aamp, SimStreamAbstraction *context, const ThroughputTrace &trace,
+			double fragmentDuration, double maxBuffer, long latencyMS) :
+		mAamp(aamp), mContext(context), mTrace(trace), mFragmentDuration(fragmentDuration), mMaxBuffer(maxBuffer),
+		mLatencyMS(latencyMS), mStarted(false), mStalled(false), mStallStartMS(0), mResult()
+	{
+	}
+
+	AbrSimulation(const AbrSimulation&) = delete;
+	AbrSimulation& operator=(const AbrSimulation&) = delete;
+
+	/**
+	 * @brief Fetch content of given duration
+	 */
+	const SimResult &Run(double contentDuration)
+	{
+		SimTrack *video = mContext->GetVideo();
+		int fragmentDurationMs = (int)(mFragmentDuration * 1000);
+		long lastBitrate = -1;
+		double fetched = 0;
+		while (fetched < contentDuration)
+		{
+			double buffered = video->GetBufferedDuration();
+			if (buffered + mFragmentDuration > mMaxBuffer)
+			{ // fetcher waits for space in cache
+				Advance((long long)((buffered + mFragmentDuration - mMaxBuffer) * 1000));
+			}
+
+			mContext->mCheckForRampdown = false;
+			long bitrate = video->GetCurrentBandWidth();
+			double bytes = (double)bitrate * mFragmentDuration / 8;
+			long timeoutMS = mAamp->curlDLTimeout[eCURLINSTANCE_VIDEO];
+			if (timeoutMS <= mLatencyMS)
+			{
+				timeoutMS = mAamp->mNetworkTimeoutMs;
+			}
+			long long transferMS = mTrace.GetTransferTime(gSimTimeMS + mLatencyMS, bytes, timeoutMS - mLatencyMS);
+			if (transferMS < 0)
+			{ // curl timeout, partial fragment is still sampled by GetFile
+				double partial = mTrace.GetTransferredBytes(gSimTimeMS + mLatencyMS, timeoutMS - mLatencyMS);
+				Advance(timeoutMS);
+				mResult.timeoutCount++;
+				mAamp->AddFragmentBitrateSample((size_t)partial, (int)timeoutMS, fragmentDurationMs);
+				if (!mContext->CheckForRampDownLimitReached() && mContext->CheckForRampDownProfile(CURLE_OPERATION_TIMEDOUT))
+				{
+					mContext->mCheckForRampdown = true;
+					continue;
+				}
+				fetched += mFragmentDuration;
+				mResult.skippedCount++;
+				continue;
+			}
+
+			Advance(mLatencyMS + transferMS);
+			mAamp->AddFragmentBitrateSample((size_t)bytes, (int)(mLatencyMS + transferMS), fragmentDurationMs);
+			video->AddFragment(fetched, mFragmentDuration);
+			fetched += mFragmentDuration;
+			OnFragmentInjected(bitrate, lastBitrate);
+			lastBitrate = bitrate;
+
+			// profile check of the HLS fetcher loop after a fragment
+			if (!mContext->mCheckForRampdown)
+			{
+				mContext->CheckForProfileChange();
+			}
+		}
+		// play out what is buffered
+		Advance((long long)(video->GetBufferedDuration() * 1000));
+		return mResult;
+	}
+
+private:
+	/**
+	 * @brief Advance virtual clock, stalling playback when the sink runs dry
+	 */
+	void Advance(long long ms)
+	{
+		if (ms <= 0)
+		{
+			return;
+		}
+		if (mStarted && !mStalled)
+		{
+			long long bufferedMS = (long long)(mContext->GetVideo()->GetBufferedDuration() * 1000);
+			if (ms >= bufferedMS)
+			{
+				gSimTimeMS += bufferedMS;
+				mContext->NotifyPlaybackPaused(true);
+				mStalled = true;
+				mStallStartMS = gSimTimeMS;
+				ms -= bufferedMS;
+			}
+		}
+		gSimTimeMS += ms;
+	}
+
+	/**
+	 * @brief Start or resume playback and account injected fragment
+	 */
+	void OnFragmentInjected(long bitrate, long lastBitrate)
+	{
+		if (!mStarted)
+		{
+			mStarted = true;
+			mResult.startupMS = gSimTimeMS;
+			mContext->NotifyFirstFragmentInjected();
+		}
+		else if (mStalled)
+		{
+			mStalled = false;
+			mResult.rebufferMS += gSimTimeMS - mStallStartMS;
+			mResult.rebufferCount++;
+			mContext->NotifyPlaybackPaused(false);
+		}
+		if (lastBitrate >= 0 && bitrate != lastBitrate)
+		{
+			mResult.switchCount++;
+		}
+		mResult.bitrateSeconds += (double)bitrate * mFragmentDuration;
+		mResult.injectedSeconds += mFragmentDuration;
+	}
+
+	PrivateInstanceAAMP *mAamp;
+	SimStreamAbstraction *mContext;
+	const ThroughputTrace &mTrace;
+	double mFragmentDuration;
+	double mMaxBuffer;
+	long mLatencyMS;
+	bool mStarted;
+	bool mStalled;
+	long long mStallStartMS;
+	SimResult mResult;
+};
+
+/**
+ * @brief aamp.cfg ABR settings which can be overridden with -o
+ */
+static const struct
+{
+	const char *name;
+	int GlobalConfigAAMP::*value;
+	int scale;
+} kSettings[] = {
+	{ "abr-cache-life", &GlobalConfigAAMP::abrCacheLife, 1000 },
+	{ "abr-cache-length", &GlobalConfigAAMP::abrCacheLength, 1 },
+	{ "abr-cache-outlier", &GlobalConfigAAMP::abrOutlierDiffBytes, 1 },
+	{ "abr-nw-consistency", &GlobalConfigAAMP::abrNwConsistency, 1 },
+	{ "abr-skip-duration", &GlobalConfigAAMP::abrSkipDuration, 1 },
+	{ "min-buffer-rampdown", &GlobalConfigAAMP::minABRBufferForRampDown, 1 },
+	{ "max-buffer-rampup", &GlobalConfigAAMP::maxABRBufferForRampUp, 1 },
+	{ "aamp-abr-threshold-size", &GlobalConfigAAMP::aampAbrThresholdSize, 1 },
+};
+
+/**
+ * @brief Apply -o setting
+ */
+static bool ApplySetting(const char *setting)
+{
+	const char *delim = strchr(setting, '=');
+	if (delim)
+	{
+		std::string name(setting, delim - setting);
+		for (const auto &entry : kSettings)
+		{
+			if (name == entry.name)
+			{
+				gpGlobalConfig->*entry.value = atoi(delim + 1) * entry.scale;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static void Usage(const char *program)
+{
+	printf("Usage: %s [-l kbps,...] [-f fragment sec] [-d content sec] [-b max buffer sec] [-r latency ms] [-o setting=value]... <trace file | -t kbps:sec,...>\n", program);
+}
+
+int main(int argc, char **argv)
+{
+	ThroughputTrace trace;
+	std::vector<long> ladder;
+	const char *ladderSpec = "800,1600,3000,5000,8000";
+	const char *traceName = NULL;
+	double fragmentDuration = 6;
+	double contentDuration = 600;
+	double maxBuffer = 30;
+	long latencyMS = 100;
+	std::vector<const char *> settings;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char *arg = argv[i];
+		const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if (arg[0] == '-' && arg[1] && !arg[2] && value)
+		{
+			switch (arg[1])
+			{
+			case 't':
+				if (!trace.Parse(value))
+				{
+					printf("Invalid trace %s\n", value);
+					return 1;
+				}
+				traceName = value;
+				break;
+			case 'l': ladderSpec = value; break;
+			case 'f': fragmentDuration = atof(value); break;
+			case 'd': contentDuration = atof(value); break;
+			case 'b': maxBuffer = atof(value); break;
+			case 'r': latencyMS = atol(value); break;
+			case 'o': settings.push_back(value); break;
+			default:
+				Usage(argv[0]);
+				return 1;
+			}
+			i++;
+		}
+		else if (arg[0] != '-' && !traceName)
+		{
+			if (!trace.Load(arg))
+			{
+				printf("Failed to load trace %s\n", arg);
+				return 1;
+			}
+			traceName = arg;
+		}
+		else
+		{
+			Usage(argv[0]);
+			return 1;
+		}
+	}
+	for (const char *p = ladderSpec; p && *p; p = strchr(p, ','), p = p ? p + 1 : NULL)
+	{
+		long kbps = atol(p);
+		if (kbps > 0)
+		{
+			ladder.push_back(kbps * 1000);
+		}
+	}
+	if (trace.Empty() || ladder.empty() || fragmentDuration <= 0 || contentDuration <= 0 || maxBuffer < fragmentDuration)
+	{
+		Usage(argv[0]);
+		return 1;
+	}
+
+	aamp_SetTimeSource(GetSimTimeMS);
+	PrivateInstanceAAMP *aamp = new PrivateInstanceAAMP();
+	for (const char *setting : settings)
+	{
+		if (!ApplySetting(setting))
+		{
+			printf("Unknown setting %s\n", setting);
+			return 1;
+		}
+	}
+	aamp->SetVideoBitrate(0); // enables ABR
+	aamp->ConfigureNetworkTimeout();
+	aamp->CurlInit(eCURLINSTANCE_VIDEO, 1);
+	aamp->SetCurlTimeout(aamp->mNetworkTimeoutMs, eCURLINSTANCE_VIDEO);
+
+	SimStreamAbstraction *context = new SimStreamAbstraction(aamp, ladder, fragmentDuration);
+	aamp->mpStreamAbstractionAAMP = context;
+	AbrSimulation simulation(aamp, context, trace, fragmentDuration, maxBuffer, latencyMS);
+	const SimResult &result = simulation.Run(contentDuration);
+
+	printf("trace=%s ladder=%s fragment=%.1f content=%.0f startup_ms=%lld rebuffer_ms=%lld rebuffer_count=%d switches=%d avg_kbps=%.0f timeouts=%d skipped=%d\n",
+		traceName, ladderSpec, fragmentDuration, contentDuration, result.startupMS, result.rebufferMS, result.rebufferCount, result.switchCount,
+		(result.injectedSeconds > 0) ? (result.bitrateSeconds / result.injectedSeconds / 1000) : 0, result.timeoutCount, result.skippedCount);
+
+	aamp->mpStreamAbstractionAAMP = NULL;
+	delete context;
+	aamp->CurlTerm(eCURLINSTANCE_VIDEO, 1);
+	delete aamp;
+	aamp_SetTimeSource(NULL);
+	return 0;
+}
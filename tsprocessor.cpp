@@ -30,9 +30,11 @@
 #include <errno.h>
 #include <stdint.h>
 #include <sys/time.h>
+#include <atomic>
 #include "priv_aamp.h"
 
 #include "tsprocessor.h"
+#include "AampWorkerPool.h"
 
 
 /**
@@ -88,6 +90,7 @@ void print_nop(const char *format, ...){}
 #define WAIT_FOR_DATA_MAX_RETRIES 1
 #define MAX_PMT_SECTION_SIZE (1021)
 #define PATPMT_MAX_SIZE (2*1024)
+#define DEMUX_ES_POOL_SIZE 32 //Max empty ES buffers kept per demuxer for reuse once sink releases them
 
 /** Maximum PTS value */
 #define MAX_PTS (0x1FFFFFFFF)
@@ -180,6 +183,7 @@ private:
 	int pes_header_ext_read;
 	GrowableBuffer pes_header;
 	GrowableBuffer es;
+	AampBufferPool *esPool;
 	double position;
 	double duration;
 	unsigned long long base_pts;
@@ -220,7 +224,20 @@ private:
 			}
 			DEBUG_DEMUX("Send : pts %f dts %f", pts, dts);
 			DEBUG_DEMUX("position %f base_pts %llu current_pts %llu diff %f seconds length %d", position, base_pts, current_pts, (double)(current_pts - base_pts) / 90000, (int)es.len );
-			aamp->SendStream(type, es.ptr, es.len, pts, dts, duration);
+			if (es.len > 0)
+			{
+				// hand ES buffer over to the sink instead of copying it, memory returns to the pool
+				// once sink releases it, continue with a pooled buffer of same capacity
+				size_t capacity = es.avail;
+				AampSharedBlock *block = aamp_CreateSharedBlock(&es, esPool);
+				aamp->SendStream(type, block, block->buffer.ptr, block->buffer.len, pts, dts, duration);
+				aamp_SharedBlockUnref(block);
+				esPool->Acquire(&es, capacity);
+			}
+			else
+			{
+				aamp->SendStream(type, es.ptr, es.len, pts, dts, duration);
+			}
 			if (gpGlobalConfig->logging.info)
 			{
 				sentESCount++;
@@ -241,7 +258,7 @@ public:
 	 */
 	Demuxer(class PrivateInstanceAAMP *aamp,MediaType type) : aamp(aamp), pes_state(0),
 		pes_header_ext_len(0), pes_header_ext_read(0), pes_header(),
-		es(), position(0), duration(0), base_pts(0), current_pts(0),
+		es(), esPool(new AampBufferPool("tsDemuxES", DEMUX_ES_POOL_SIZE)), position(0), duration(0), base_pts(0), current_pts(0),
 		current_dts(0), type(type), trickmode(false), finalized_base_pts(false),
 		sentESCount(0), allowPtsRewind(false), first_pts(0)
 	{
@@ -265,6 +282,7 @@ public:
 	{
 		aamp_Free(&es.ptr);
 		aamp_Free(&pes_header.ptr);
+		esPool->Unref();
 	}
 
 
@@ -776,7 +794,7 @@ TSProcessor::TSProcessor(class PrivateInstanceAAMP *aamp,StreamOperation streamO
 	m_throttleCond(), m_basePTSCond(), m_mutex(), m_enabled(true), m_processing(false), m_framesProcessedInSegment(0),
 	m_lastPTSOfSegment(-1), m_streamOperation(streamOperation), m_vidDemuxer(NULL), m_audDemuxer(NULL), m_dsmccDemuxer(NULL),
 	m_demux(false), m_peerTSProcessor(peerTSProcessor), m_packetStartAfterFirstPTS(-1), m_queuedSegment(NULL),
-	m_queuedSegmentPos(0), m_queuedSegmentDuration(0), m_queuedSegmentLen(0), m_queuedSegmentDiscontinuous(false), m_startPosition(-1.0),
+	m_queuedSegmentBlock(NULL), m_queuedSegmentPos(0), m_queuedSegmentDuration(0), m_queuedSegmentLen(0), m_queuedSegmentDiscontinuous(false), m_startPosition(-1.0),
 	m_track(track), m_last_frame_time(0), m_demuxInitialized(false), m_basePTSFromPeer(-1), m_dsmccComponentFound(false), m_dsmccComponent()
 {
 	INFO("constructor - %p", this);
@@ -867,11 +885,7 @@ TSProcessor::~TSProcessor()
 		delete m_dsmccDemuxer;
 	}
 
-	if (m_queuedSegment)
-	{
-		free(m_queuedSegment);
-		m_queuedSegment = NULL;
-	}
+	releaseQueuedSegment();
 
 	pthread_mutex_destroy(&m_mutex);
 	pthread_cond_destroy(&m_throttleCond);
@@ -1970,6 +1984,67 @@ void TSProcessor::setupThrottle(int segmentDurationMsSigned)
 }
 
 
+/**
+ * @struct TSDemuxJob
+ * @brief Elementary stream of a segment demuxed concurrently with the other one
+ */
+struct TSDemuxJob
+{
+	const unsigned char *packets;            /**< First packet to demux */
+	size_t len;                              /**< Length of packets to demux */
+	int pid;                                 /**< PID of the elementary stream */
+	Demuxer *demuxer;                        /**< Demuxer of pid */
+	int dsmccPid;                            /**< DSMCC PID demuxed along, -1 if none */
+	Demuxer *dsmccDemuxer;                   /**< Demuxer of dsmccPid */
+	bool basePtsUpdatedFromCurrentSegment;   /**< PTS errors are ignored once set */
+	std::atomic<bool> *abort;                /**< Set on PTS error, stops the other job */
+	bool ret;                                /**< false on PTS error */
+};
+
+/**
+ * @brief Demux packets of one elementary stream of a segment
+ * @param[in] arg TSDemuxJob
+ * @retval NULL
+ */
+static void* DemuxJobThread(void *arg)
+{
+	TSDemuxJob *job = (TSDemuxJob *)arg;
+	const unsigned char *packetStart = job->packets;
+	size_t len = job->len;
+	for (; (len >= PACKET_SIZE) && !job->abort->load(std::memory_order_relaxed); packetStart += PACKET_SIZE, len -= PACKET_SIZE)
+	{
+		int pid = (packetStart[1] & 0x1f) << 8 | packetStart[2];
+		Demuxer* demuxer = NULL;
+		if (pid == job->pid)
+		{
+			demuxer = job->demuxer;
+		}
+		else if (job->dsmccDemuxer && (pid == job->dsmccPid))
+		{
+			demuxer = job->dsmccDemuxer;
+		}
+		if (demuxer)
+		{
+			bool ptsError = false;
+			bool basePTSUpdated = false;
+			demuxer->processPacket((unsigned char *)packetStart, basePTSUpdated, ptsError);
+			if (ptsError && (demuxer == job->demuxer) && !job->basePtsUpdatedFromCurrentSegment)
+			{
+				WARNING("PTS error, discarding segment");
+				job->ret = false;
+				job->abort->store(true);
+				break;
+			}
+			if (basePTSUpdated)
+			{
+				job->basePtsUpdatedFromCurrentSegment = true;
+			}
+		}
+	}
+	return NULL;
+}
+
+
 /**
  * @brief Demux TS and send elementary streams
  * @param[in] ptr buffer containing TS data
@@ -2036,9 +2111,18 @@ bool TSProcessor::demuxAndSend(const void *ptr, size_t len, double position, dou
 	}
 	INFO("demuxAndSend : len  %d videoPid %d audioPid %d m_pcrPid %d videoComponentCount %d m_demuxInitialized = %d", (int)len, videoPid, audioPid, m_pcrPid, videoComponentCount, m_demuxInitialized);
 
+	// Audio and video demuxers are independent once base PTS of both is final, so from
+	// then on each elementary stream can be demuxed on its own thread
+	bool parallelDemux = (gpGlobalConfig->parallelTsDemux && (ePC_Track_Both == trackToDemux) && !isTrickMode
+			&& m_vidDemuxer && m_audDemuxer && (videoPid >= 0) && (audioPid >= 0));
 	unsigned char * packetStart = (unsigned char *)ptr;
 	while (len >= PACKET_SIZE)
 	{
+		if (parallelDemux && !notifyPeerBasePTS && m_demuxInitialized && (firstPcr || !discontinuous))
+		{
+			ret = demuxConcurrently(packetStart, len, videoPid, audioPid, dsmccPid, basePtsUpdatedFromCurrentSegment);
+			break;
+		}
 		Demuxer* demuxer = NULL;
 		int pid = (packetStart[1] & 0x1f) << 8 | packetStart[2];
 		bool dsmccDemuxerUsed = false;
@@ -2150,6 +2234,38 @@ bool TSProcessor::demuxAndSend(const void *ptr, size_t len, double position, dou
 	return ret;
 }
 
+
+/**
+ * @brief Demux remaining packets of a segment, video on a worker and audio on calling thread
+ * @param[in] packets first packet to demux
+ * @param[in] len length of packets to demux
+ * @param[in] videoPid video PID
+ * @param[in] audioPid audio PID
+ * @param[in] dsmccPid DSMCC PID, demuxed along with video, -1 if none
+ * @param[in] basePtsUpdatedFromCurrentSegment true if base PTS was updated by earlier packets of the segment
+ * @retval true on success, false on PTS error
+ */
+bool TSProcessor::demuxConcurrently(const unsigned char *packets, size_t len, int videoPid, int audioPid, int dsmccPid, bool basePtsUpdatedFromCurrentSegment)
+{
+	std::atomic<bool> abort(false);
+	TSDemuxJob videoJob = { packets, len, videoPid, m_vidDemuxer, dsmccPid, m_dsmccDemuxer, basePtsUpdatedFromCurrentSegment, &abort, true };
+	TSDemuxJob audioJob = { packets, len, audioPid, m_audDemuxer, -1, NULL, basePtsUpdatedFromCurrentSegment, &abort, true };
+	long long startTime = aamp_GetCurrentTimeMS();
+
+	AampWorkerTask *videoTask = aamp->GetWorkerPool()->Submit("tsVideoDemux", &DemuxJobThread, &videoJob, eAAMP_TASK_PRIORITY_TUNE);
+	DemuxJobThread(&audioJob);
+	if (videoTask)
+	{
+		aamp->GetWorkerPool()->Join(videoTask);
+	}
+	else
+	{
+		DemuxJobThread(&videoJob);
+	}
+	INFO("demuxConcurrently : %d packets in %lld ms", (int)(len / PACKET_SIZE), aamp_GetCurrentTimeMS() - startTime);
+	return (videoJob.ret && audioJob.ret);
+}
+
 /**
  * @brief Reset TS processor state
  */
@@ -2205,6 +2321,45 @@ void TSProcessor::flush()
 }
 
 
+/**
+ * @brief Send TS packets as is, without copy if they are part of a shared block
+ * @param[in] block shared block holding the packets, NULL if not shared
+ * @param[in] ptr start of packets
+ * @param[in] len length of packets
+ * @param[in] position position of packets
+ * @param[in] duration duration of packets
+ */
+void TSProcessor::sendPassThrough(AampSharedBlock *block, unsigned char *ptr, size_t len, double position, double duration)
+{
+	if (block)
+	{
+		aamp->SendStream((MediaType)m_track, block, ptr, len, position, position, duration);
+	}
+	else
+	{
+		aamp->SendStream((MediaType)m_track, ptr, len, position, position, duration);
+	}
+}
+
+
+/**
+ * @brief Release queued segment, dropping reference on its shared block or freeing the copy
+ */
+void TSProcessor::releaseQueuedSegment()
+{
+	if (m_queuedSegmentBlock)
+	{
+		aamp_SharedBlockUnref(m_queuedSegmentBlock);
+		m_queuedSegmentBlock = NULL;
+	}
+	else if (m_queuedSegment)
+	{
+		free(m_queuedSegment);
+	}
+	m_queuedSegment = NULL;
+}
+
+
 /**
  * @brief Send queued segment
  * @param[in] basepts new base pts to be set. Valid only for eStreamOp_DEMUX_AUDIO.
@@ -2223,8 +2378,7 @@ void TSProcessor::sendQueuedSegment(long long basepts, double updatedStartPosito
 		}
 		if (eStreamOp_QUEUE_AUDIO == m_streamOperation)
 		{
-			aamp->SendStream((MediaType) m_track, m_queuedSegment, m_queuedSegmentLen, m_queuedSegmentPos,
-			        m_queuedSegmentPos, m_queuedSegmentDuration);
+			sendPassThrough(m_queuedSegmentBlock, m_queuedSegment, m_queuedSegmentLen, m_queuedSegmentPos, m_queuedSegmentDuration);
 		}
 		else if (eStreamOp_DEMUX_AUDIO == m_streamOperation)
 		{
@@ -2241,8 +2395,7 @@ void TSProcessor::sendQueuedSegment(long long basepts, double updatedStartPosito
 		{
 			ERROR("sendQueuedSegment invoked in Invalid stream operation");
 		}
-		free(m_queuedSegment);
-		m_queuedSegment = NULL;
+		releaseQueuedSegment();
 	}
 	else
 	{
@@ -2284,7 +2437,7 @@ void TSProcessor::setBasePTS(double position, long long pts)
  * @param[out] true on PTS error
  * @retval true on success
  */
-bool TSProcessor::sendSegment(char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError)
+bool TSProcessor::sendSegment(char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError, AampSharedBlock *block)
 {
 	bool insPatPmt = false;  //CID:84507 - Initialization
 	unsigned char * packetStart;
@@ -2391,11 +2544,11 @@ bool TSProcessor::sendSegment(char *segment, size_t& size, double position, doub
 					}
 					pthread_mutex_unlock(&m_mutex);
 				}
-				ret = demuxAndSend(packetStart, len, m_startPosition, duration, discontinuous);
+				ret = demuxAndSend(packetStart, len, m_startPosition, duration, discontinuous, ePC_Track_Both);
 			}
 			else if(!gpGlobalConfig->demuxedAudioBeforeVideo)
 			{
-				ret = demuxAndSend(packetStart, len, position, duration, discontinuous);
+				ret = demuxAndSend(packetStart, len, position, duration, discontinuous, ePC_Track_Both);
 			}
 			else
 			{
@@ -2410,16 +2563,14 @@ bool TSProcessor::sendSegment(char *segment, size_t& size, double position, doub
 			if (m_packetStartAfterFirstPTS != -1)
 			{
 
-				aamp->SendStream((MediaType)m_track, packetStart, m_packetStartAfterFirstPTS, position, position, duration);
+				sendPassThrough(block, packetStart, m_packetStartAfterFirstPTS, position, duration);
 				m_peerTSProcessor->sendQueuedSegment();
-				aamp->SendStream((MediaType)m_track, packetStart + m_packetStartAfterFirstPTS,
-				len - m_packetStartAfterFirstPTS, position, position, duration);
+				sendPassThrough(block, packetStart + m_packetStartAfterFirstPTS, len - m_packetStartAfterFirstPTS, position, duration);
 			}
 			else
 			{
 				ERROR("m_packetStartAfterFirstPTS Not updated");
-				aamp->SendStream((MediaType)m_track, packetStart + m_packetStartAfterFirstPTS,
-				len - m_packetStartAfterFirstPTS, position, position, duration);
+				sendPassThrough(block, packetStart + m_packetStartAfterFirstPTS, len - m_packetStartAfterFirstPTS, position, duration);
 			}
 		}
 		else if (eStreamOp_QUEUE_AUDIO == m_streamOperation)
@@ -2428,16 +2579,29 @@ bool TSProcessor::sendSegment(char *segment, size_t& size, double position, doub
 			if (m_queuedSegment)
 			{
 				ERROR("Queued buffer not NULL");
-				free(m_queuedSegment);
+				releaseQueuedSegment();
+			}
+			if (block)
+			{
+				// keep a reference on the fragment instead of copying it
+				aamp_SharedBlockRef(block);
+				m_queuedSegmentBlock = block;
+				m_queuedSegment = packetStart;
+			}
+			else
+			{
+				m_queuedSegment = (unsigned char *)malloc(len);
+				if (m_queuedSegment)
+				{
+					memcpy(m_queuedSegment, packetStart, len);
+				}
 			}
-			m_queuedSegment = (unsigned char *)malloc(len);
 			if (!m_queuedSegment)
 			{
 				ERROR("Failed to allocate memory");
 			}
 			else
 			{
-				memcpy(m_queuedSegment, packetStart, len);
 				m_queuedSegmentLen = len;
 				m_queuedSegmentPos = position;
 				m_queuedSegmentDuration = duration;
@@ -2447,7 +2611,7 @@ bool TSProcessor::sendSegment(char *segment, size_t& size, double position, doub
 		}
 		else
 		{
-			aamp->SendStream((MediaType)m_track, packetStart, len, position, position, duration);
+			sendPassThrough(block, packetStart, len, position, duration);
 		}
 	}
 	if (-1 != duration)
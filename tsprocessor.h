@@ -109,7 +109,7 @@ class TSProcessor : public MediaProcessor
       TSProcessor(const TSProcessor&) = delete;
       TSProcessor& operator=(const TSProcessor&) = delete;
       ~TSProcessor();
-      bool sendSegment( char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError);
+      bool sendSegment( char *segment, size_t& size, double position, double duration, bool discontinuous, bool &ptsError, AampSharedBlock *block = NULL);
       void setRate(double rate, PlayMode mode);
       void setThrottleEnable(bool enable);
 
@@ -132,6 +132,8 @@ class TSProcessor : public MediaProcessor
 
    private:
       class PrivateInstanceAAMP *aamp;
+      void sendPassThrough(AampSharedBlock *block, unsigned char *ptr, size_t len, double position, double duration);
+      void releaseQueuedSegment();
       void setPlayMode( PlayMode mode );
       void processPMTSection( unsigned char* section, int sectionLength );
       void reTimestamp( unsigned char *&packet, int length );
@@ -262,6 +264,7 @@ class TSProcessor : public MediaProcessor
       void sendDiscontinuity(double position);
       void setupThrottle(int segmentDurationMs);
       bool demuxAndSend(const void *ptr, size_t len, double fTimestamp, double fDuration, bool discontinuous, TrackToDemux trackToDemux = ePC_Track_Both);
+      bool demuxConcurrently(const unsigned char *packets, size_t len, int videoPid, int audioPid, int dsmccPid, bool basePtsUpdatedFromCurrentSegment);
       bool msleep(long long throttleDiff);
 
       bool m_havePAT; //!< Set to 1 when PAT buffer examined and loaded all program specific information
@@ -308,6 +311,7 @@ class TSProcessor : public MediaProcessor
       TSProcessor* m_peerTSProcessor;
       int m_packetStartAfterFirstPTS;
       unsigned char * m_queuedSegment;
+      AampSharedBlock *m_queuedSegmentBlock;
       double m_queuedSegmentPos;
       double m_queuedSegmentDuration;
       size_t m_queuedSegmentLen;